@@ -0,0 +1,128 @@
+/**
+ * @file Benchmarks geometry/aabb_tree.h with 100k moving entities.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include "benchmark.h"
+#include "geometry/aabb_tree.h"
+#include "geometry/transform.h"
+
+namespace {
+
+using ogle::AABBTree;
+using ogle::AxisAlignedBox;
+using ogle::Bounds;
+using ogle::Transform;
+using ogle::Vector3f;
+using ogle_benchmark::Report;
+using ogle_benchmark::Timer;
+
+/// Number of entities in the scene.
+constexpr int kNumEntities = 100000;
+
+/// Number of frames to time.
+constexpr int kNumFrames = 20;
+
+/**
+ * @brief Runs frames where some of the entities move by a small step and
+ *        some are replaced, and reports the time per frame.
+ * @param moved_fraction Fraction of entities that move each frame.
+ * @param replaced_fraction Fraction of entities destroyed and recreated
+ *        elsewhere each frame.
+ */
+void RunMovingEntities(const float moved_fraction,
+                       const float replaced_fraction) {
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> position(-500.f, 500.f);
+  std::uniform_real_distribution<float> step(-1.f, 1.f);
+  auto random_position = [&rng, &position]() {
+    return Vector3f{position(rng), position(rng), position(rng)};
+  };
+
+  Bounds local_bounds = Bounds::Empty();
+  local_bounds.box.Include(Vector3f{-0.5f, -0.5f, -0.5f});
+  local_bounds.box.Include(Vector3f{0.5f, 0.5f, 0.5f});
+  local_bounds.sphere = {Vector3f::Zero(), 0.9f};
+
+  AABBTree tree;
+  Transform root(nullptr, nullptr);
+  root.set_spatial_index(&tree);
+  std::vector<std::unique_ptr<Transform>> entities;
+  auto create_entity = [&root, &local_bounds, &random_position]() {
+    std::unique_ptr<Transform> entity(new Transform(&root, nullptr));
+    entity->set_world_position(random_position());
+    entity->set_local_bounds(&local_bounds);
+    return entity;
+  };
+
+  Timer build_timer;
+  for (int i = 0; i < kNumEntities; ++i) {
+    entities.push_back(create_entity());
+  }
+  tree.Update();
+  Report("build", build_timer.seconds() * 1e3, "ms");
+
+  const int num_moved = static_cast<int>(kNumEntities * moved_fraction);
+  const int num_replaced = static_cast<int>(kNumEntities * replaced_fraction);
+  double move_seconds = 0.0;
+  double update_seconds = 0.0;
+  double query_seconds = 0.0;
+  std::int64_t num_found = 0;
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    Timer move_timer;
+    for (int i = 0; i < num_moved; ++i) {
+      Transform* entity = entities[rng() % kNumEntities].get();
+      entity->set_world_position(entity->world_position() +
+                                 Vector3f{step(rng), step(rng), step(rng)});
+    }
+    for (int i = 0; i < num_replaced; ++i) {
+      entities[rng() % kNumEntities] = create_entity();
+    }
+    move_seconds += move_timer.seconds();
+
+    Timer update_timer;
+    tree.Update();
+    update_seconds += update_timer.seconds();
+
+    // A frame's worth of small queries, as for collision or picking.
+    Timer query_timer;
+    for (int query = 0; query < 1000; ++query) {
+      const Vector3f center = random_position();
+      AxisAlignedBox box = AxisAlignedBox::Empty();
+      box.Include(center - Vector3f{10.f, 10.f, 10.f});
+      box.Include(center + Vector3f{10.f, 10.f, 10.f});
+      tree.Query(box, [&num_found](const std::int32_t) {
+        ++num_found;
+        return true;
+      });
+    }
+    query_seconds += query_timer.seconds();
+  }
+
+  Report("move and replace", move_seconds * 1e3 / kNumFrames, "ms/frame");
+  Report("update", update_seconds * 1e3 / kNumFrames, "ms/frame");
+  Report("1000 box queries", query_seconds * 1e3 / kNumFrames, "ms/frame");
+  Report("objects found per query",
+         static_cast<double>(num_found) / (kNumFrames * 1000), "");
+  Report("height", tree.height(), "");
+
+  entities.clear();
+  root.set_spatial_index(nullptr);
+}
+
+}  // namespace
+
+OGLE_BENCHMARK(aabb_tree, AllEntitiesMoving) {
+  RunMovingEntities(1.f, 0.f);
+}
+
+OGLE_BENCHMARK(aabb_tree, TenthOfEntitiesMoving) {
+  RunMovingEntities(0.1f, 0.f);
+}
+
+OGLE_BENCHMARK(aabb_tree, EntitiesMovingAndReplaced) {
+  RunMovingEntities(0.1f, 0.01f);
+}
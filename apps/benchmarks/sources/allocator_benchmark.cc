@@ -0,0 +1,197 @@
+/**
+ * @file Benchmarks allocation throughput of std/thread_arena.h and
+ *       memory/frame_allocator.h against global new and std::allocator.
+ *
+ * Each strategy is used explicitly, so results don't depend on which one
+ * OGLE_ARENA_ALLOCATOR selects for STLAllocator.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchmark.h"
+#include "memory/frame_allocator.h"
+#include "std/thread_arena.h"
+
+namespace {
+
+using ogle::ArenaAllocator;
+using ogle::FrameAllocator;
+using ogle::FrameSTLAllocator;
+using ogle::ThreadArena;
+using ogle_benchmark::Report;
+using ogle_benchmark::Timer;
+
+/// Allocations made by each thread in block benchmarks.
+constexpr int kNumAllocations = 2000000;
+
+/// Blocks each thread keeps live, replaced at random.
+constexpr int kNumLiveBlocks = 1024;
+
+/// Allocations between frame allocator resets, as in a frame.
+constexpr int kAllocationsPerFrame = 10000;
+
+/**
+ * @brief A way to allocate and free raw blocks.
+ */
+struct BlockStrategy {
+  /// Name reported.
+  const char* name;
+
+  /// Allocates a block of a size.
+  void* (*allocate)(std::size_t size);
+
+  /// Frees a block, given its size. Null if blocks are freed by reset.
+  void (*deallocate)(void* memory, std::size_t size);
+};
+
+///@{
+/// Adapts global new and FrameAllocator to BlockStrategy.
+void* NewAllocate(const std::size_t size) { return ::operator new(size); }
+void NewDeallocate(void* memory, std::size_t) { ::operator delete(memory); }
+void* FrameAllocate(const std::size_t size) {
+  return FrameAllocator::ForThread().Allocate(size);
+}
+///@}
+
+/// Strategies compared by block benchmarks.
+const BlockStrategy kBlockStrategies[] = {
+    {"new", NewAllocate, NewDeallocate},
+    {"ThreadArena", ThreadArena::Allocate, ThreadArena::Deallocate},
+    {"FrameAllocator", FrameAllocate, nullptr}};
+
+/**
+ * @brief Allocates and frees small blocks of random sizes, keeping a set
+ *        of them live, as containers of small nodes and strings do.
+ * @param strategy Strategy to allocate with.
+ * @param seed Seed for block sizes and which block is replaced.
+ */
+void ChurnBlocks(const BlockStrategy& strategy, const unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<std::size_t> size(
+      8, ThreadArena::kMaxBlockSize);
+  std::vector<std::pair<void*, std::size_t>> live(kNumLiveBlocks);
+  for (auto& block : live) {
+    block.second = size(rng);
+    block.first = strategy.allocate(block.second);
+  }
+  for (int i = 0; i < kNumAllocations; ++i) {
+    auto& block = live[rng() % kNumLiveBlocks];
+    if (strategy.deallocate != nullptr) {
+      strategy.deallocate(block.first, block.second);
+    }
+    block.second = size(rng);
+    block.first = strategy.allocate(block.second);
+    // Touch the block, as its user would.
+    *static_cast<char*>(block.first) = static_cast<char>(i);
+    if (strategy.deallocate == nullptr && i % kAllocationsPerFrame == 0) {
+      FrameAllocator::ForThread().Reset();
+      for (auto& frame_block : live) {
+        frame_block.first = strategy.allocate(frame_block.second);
+      }
+    }
+  }
+  for (auto& block : live) {
+    if (strategy.deallocate != nullptr) {
+      strategy.deallocate(block.first, block.second);
+    }
+  }
+  FrameAllocator::ForThread().Reset();
+}
+
+/**
+ * @brief Builds and destroys small maps and vectors, as transient per-frame
+ *        work does.
+ * @param num_rounds Containers of each kind to build.
+ * @return Sum of container sizes, so that the work isn't optimized away.
+ */
+template <template <typename> class Allocator>
+std::int64_t BuildContainers(const int num_rounds) {
+  using Map = std::map<int, int, std::less<int>,
+                       Allocator<std::pair<const int, int>>>;
+  using Vector = std::vector<const void*, Allocator<const void*>>;
+  std::int64_t sum = 0;
+  for (int round = 0; round < num_rounds; ++round) {
+    Map map;
+    for (int i = 0; i < 64; ++i) {
+      map.emplace((i * 37 + round) & 127, i);
+    }
+    Vector vector;
+    for (int i = 0; i < 64; ++i) {
+      vector.push_back(&map);
+    }
+    sum += map.size() + vector.size();
+  }
+  return sum;
+}
+
+/**
+ * @brief Times BuildContainers() with an allocator, and reports it.
+ * @param name Name of allocator.
+ * @param reset_frames Whether to reset the frame allocator between rounds.
+ */
+template <template <typename> class Allocator>
+void TimeContainers(const char* name, const bool reset_frames) {
+  constexpr int kNumFrames = 1000;
+  constexpr int kRoundsPerFrame = 100;
+  std::int64_t sum = 0;
+  Timer timer;
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    sum += BuildContainers<Allocator>(kRoundsPerFrame);
+    if (reset_frames) {
+      FrameAllocator::ForThread().Reset();
+    }
+  }
+  const double seconds = timer.seconds();
+  Report((std::string(name) + " map and vector").c_str(),
+         seconds * 1e9 / (kNumFrames * kRoundsPerFrame), "ns/round");
+  if (sum == 0) {
+    Report("unexpected sum", static_cast<double>(sum), "");
+  }
+}
+
+}  // namespace
+
+OGLE_BENCHMARK(allocator, SmallBlocks) {
+  for (const auto& strategy : kBlockStrategies) {
+    Timer timer;
+    ChurnBlocks(strategy, 1);
+    Report(strategy.name, kNumAllocations / timer.seconds() / 1e6,
+           "M allocations/s");
+  }
+}
+
+OGLE_BENCHMARK(allocator, SmallBlocksOnEveryThread) {
+  // The heap is shared between threads, while arenas and frame allocators
+  // belong to one thread each.
+  const int num_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  for (const auto& strategy : kBlockStrategies) {
+    Timer timer;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < num_threads; ++thread) {
+      threads.emplace_back(ChurnBlocks, std::cref(strategy), thread + 1);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    const std::string label = std::string(strategy.name) + " on " +
+                              std::to_string(num_threads) + " threads";
+    Report(label.c_str(),
+           num_threads * kNumAllocations / timer.seconds() / 1e6,
+           "M allocations/s");
+  }
+}
+
+OGLE_BENCHMARK(allocator, Containers) {
+  TimeContainers<std::allocator>("std::allocator", false);
+  TimeContainers<ArenaAllocator>("ArenaAllocator", false);
+  TimeContainers<FrameSTLAllocator>("FrameSTLAllocator", true);
+}
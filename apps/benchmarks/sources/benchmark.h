@@ -0,0 +1,66 @@
+/**
+ * @file benchmark.h
+ * @brief Minimal benchmark registration and reporting.
+ */
+
+#pragma once
+
+#include <chrono>
+
+namespace ogle_benchmark {
+
+/// A benchmark function.
+using BenchmarkFunction = void (*)();
+
+/**
+ * @brief Registers a benchmark when constructed. Used by OGLE_BENCHMARK.
+ */
+class BenchmarkRegistration {
+ public:
+  /**
+   * @brief Constructor.
+   * @param group Name of group the benchmark belongs to, such as a module.
+   * @param name Name of benchmark.
+   * @param function Function that runs the benchmark.
+   */
+  BenchmarkRegistration(const char* group, const char* name,
+                        BenchmarkFunction function);
+};
+
+/**
+ * @brief Measures elapsed wall-clock time.
+ */
+class Timer {
+ public:
+  /**
+   * @brief Constructor. Starts timing.
+   */
+  Timer();
+
+  /**
+   * @brief Accessor.
+   * @return Seconds since construction.
+   */
+  double seconds() const;
+
+ private:
+  /// Time of construction.
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Prints a result of the running benchmark.
+ * @param name What was measured.
+ * @param value Measured value.
+ * @param unit Unit of value, such as "ms/frame".
+ */
+void Report(const char* name, double value, const char* unit);
+
+}  // namespace ogle_benchmark
+
+/// Defines a benchmark function and registers it under a group.
+#define OGLE_BENCHMARK(group, name)                                  \
+  static void group##_##name();                                      \
+  static ogle_benchmark::BenchmarkRegistration                       \
+      group##_##name##_registration(#group, #name, group##_##name);  \
+  static void group##_##name()
@@ -0,0 +1,87 @@
+/**
+ * @file Benchmarks visiting 100k-node algorithms/directed_graph.h graphs in
+ *       topological order, as resource loading does.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "algorithms/directed_graph.h"
+#include "benchmark.h"
+
+namespace {
+
+using ogle_benchmark::Report;
+using ogle_benchmark::Timer;
+
+/// Graph keyed by int, as resource IDs are small keys.
+using Graph = ogle::DirectedGraph<int, int>;
+
+/// Number of nodes in each graph.
+constexpr int kNumNodes = 100000;
+
+/**
+ * @brief Builds a graph, then takes and removes ready nodes until it's
+ *        empty, and reports the time of each.
+ * @param add_edges Callable adding edges to a graph of kNumNodes nodes, keyed
+ *        0 to kNumNodes - 1.
+ */
+template <typename AddEdges>
+void RunTopologicalOrder(AddEdges add_edges) {
+  Graph graph;
+  Timer build_timer;
+  for (int key = 0; key < kNumNodes; ++key) {
+    graph.AddNode(key, key);
+  }
+  add_edges(&graph);
+  Report("build", build_timer.seconds() * 1e3, "ms");
+
+  Timer visit_timer;
+  int num_levels = 0;
+  while (!graph.Empty()) {
+    const auto ready = graph.TakeReady();
+    if (ready.empty()) {
+      break;
+    }
+    for (const auto& node : ready) {
+      graph.Remove(node.first);
+    }
+    ++num_levels;
+  }
+  Report("take and remove all", visit_timer.seconds() * 1e3, "ms");
+  Report("levels", num_levels, "");
+}
+
+}  // namespace
+
+OGLE_BENCHMARK(directed_graph, RandomDAG) {
+  // Each node depends on up to 4 nodes before it, like resources on the
+  // shaders, textures and meshes they use.
+  RunTopologicalOrder([](Graph* graph) {
+    std::mt19937 rng;
+    for (int key = 1; key < kNumNodes; ++key) {
+      const int num_edges = rng() % 5;
+      for (int edge = 0; edge < num_edges; ++edge) {
+        graph->AddEdge(key, rng() % key);
+      }
+    }
+  });
+}
+
+OGLE_BENCHMARK(directed_graph, Chain) {
+  // One node ready at a time, so the cost per TakeReady() dominates.
+  RunTopologicalOrder([](Graph* graph) {
+    for (int key = 1; key < kNumNodes; ++key) {
+      graph->AddEdge(key, key - 1);
+    }
+  });
+}
+
+OGLE_BENCHMARK(directed_graph, SharedDependency) {
+  // Every node depends on node 0, whose removal touches every other node.
+  RunTopologicalOrder([](Graph* graph) {
+    for (int key = 1; key < kNumNodes; ++key) {
+      graph->AddEdge(key, 0);
+    }
+  });
+}
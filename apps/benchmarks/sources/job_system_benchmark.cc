@@ -0,0 +1,107 @@
+/**
+ * @file Benchmarks jobs/job_system.h from one thread up to every hardware
+ *       thread.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchmark.h"
+#include "jobs/job_system.h"
+
+namespace {
+
+using ogle::JobHandle;
+using ogle::JobSystem;
+using ogle_benchmark::Report;
+using ogle_benchmark::Timer;
+
+/// Number of elements processed by ParallelFor.
+constexpr size_t kNumElements = 1 << 22;
+
+/// Number of jobs scheduled to measure overhead.
+constexpr int kNumJobs = 100000;
+
+/**
+ * @brief Gets the numbers of threads to run with: 1, 2, 4 and so on, then
+ *        every hardware thread.
+ * @return Thread counts, each the workers plus the calling thread.
+ */
+std::vector<int> ThreadCounts() {
+  const int max_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  std::vector<int> counts;
+  for (int num_threads = 1; num_threads < max_threads; num_threads *= 2) {
+    counts.push_back(num_threads);
+  }
+  counts.push_back(max_threads);
+  return counts;
+}
+
+/**
+ * @brief Labels a result with a thread count.
+ * @param name What was measured.
+ * @param num_threads Threads it ran on.
+ * @return Label.
+ */
+std::string Label(const char* name, const int num_threads) {
+  return std::string(name) + " on " + std::to_string(num_threads) +
+         " threads";
+}
+
+}  // namespace
+
+OGLE_BENCHMARK(job_system, ParallelForScaling) {
+  std::vector<float> values(kNumElements);
+  double single_thread_seconds = 0.0;
+  for (const int num_threads : ThreadCounts()) {
+    JobSystem job_system(num_threads - 1);
+    Timer timer;
+    job_system.ParallelFor(0, kNumElements, 16384, [&values](
+        const size_t begin, const size_t end) {
+      for (size_t index = begin; index < end; ++index) {
+        const float x = static_cast<float>(index);
+        values[index] = std::sqrt(x) * std::sin(x) + std::cos(x * 0.5f);
+      }
+    });
+    const double seconds = timer.seconds();
+    if (num_threads == 1) {
+      single_thread_seconds = seconds;
+    }
+    Report(Label("ParallelFor", num_threads).c_str(), seconds * 1e3, "ms");
+    Report(Label("speedup", num_threads).c_str(),
+           single_thread_seconds / seconds, "x");
+  }
+}
+
+OGLE_BENCHMARK(job_system, ScheduleOverhead) {
+  for (const int num_threads : ThreadCounts()) {
+    JobSystem job_system(num_threads - 1);
+
+    // Independent empty jobs, scheduled from outside the pool.
+    std::vector<JobHandle> handles;
+    handles.reserve(kNumJobs);
+    Timer independent_timer;
+    for (int job = 0; job < kNumJobs; ++job) {
+      handles.push_back(job_system.Schedule([]() {}));
+    }
+    for (const auto& handle : handles) {
+      job_system.Wait(handle);
+    }
+    Report(Label("independent jobs", num_threads).c_str(),
+           independent_timer.seconds() * 1e9 / kNumJobs, "ns/job");
+
+    // A chain of continuations, which can't run in parallel, so measures
+    // the latency of handing a job on.
+    Timer chain_timer;
+    JobHandle previous;
+    for (int job = 0; job < kNumJobs; ++job) {
+      previous = job_system.Continue(previous, []() {});
+    }
+    job_system.Wait(previous);
+    Report(Label("chained jobs", num_threads).c_str(),
+           chain_timer.seconds() * 1e9 / kNumJobs, "ns/job");
+  }
+}
@@ -0,0 +1,85 @@
+/**
+ * @file Runs ogle's benchmarks.
+ *
+ * usage: benchmarks [group]
+ *
+ * Runs all benchmarks, or only those of one group, and prints their
+ * results. Build with optimization, since timings of debug builds mean
+ * little.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "benchmark.h"
+#include "ogle/ogle.h"
+
+namespace ogle_benchmark {
+
+namespace {
+
+/**
+ * @brief A registered benchmark.
+ */
+struct Benchmark {
+  /// Group the benchmark belongs to.
+  const char* group;
+
+  /// Name of benchmark.
+  const char* name;
+
+  /// Function that runs the benchmark.
+  BenchmarkFunction function;
+};
+
+/**
+ * @brief Gets all registered benchmarks, in registration order.
+ * @return Benchmarks. Created on first use, as registration runs during
+ *         static initialization.
+ */
+std::vector<Benchmark>& Benchmarks() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+}  // namespace
+
+BenchmarkRegistration::BenchmarkRegistration(const char* group,
+                                             const char* name,
+                                             BenchmarkFunction function) {
+  Benchmarks().push_back({group, name, function});
+}
+
+Timer::Timer() : start_(std::chrono::steady_clock::now()) {}
+
+double Timer::seconds() const {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start_).count();
+}
+
+void Report(const char* name, const double value, const char* unit) {
+  std::printf("  %-40s %12.3f%s%s\n", name, value,
+              (*unit != '\0') ? " " : "", unit);
+  std::fflush(stdout);
+}
+
+}  // namespace ogle_benchmark
+
+int main(const int argc, const char* argv[]) {
+  const std::string group = (argc > 1) ? argv[1] : "";
+  int num_run = 0;
+  for (const auto& benchmark : ogle_benchmark::Benchmarks()) {
+    if (!group.empty() && group != benchmark.group) {
+      continue;
+    }
+    std::printf("%s.%s\n", benchmark.group, benchmark.name);
+    std::fflush(stdout);
+    benchmark.function();
+    ++num_run;
+  }
+  if (num_run == 0) {
+    std::fprintf(stderr, "No benchmarks in group %s.\n", group.c_str());
+    return 1;
+  }
+  return 0;
+}
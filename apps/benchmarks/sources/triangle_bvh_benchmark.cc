@@ -0,0 +1,151 @@
+/**
+ * @file Benchmarks building and tracing rays through geometry/triangle_bvh.h.
+ */
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchmark.h"
+#include "geometry/mesh.h"
+#include "geometry/triangle_bvh.h"
+#include "jobs/job_system.h"
+#include "resource/resource_metadata.h"
+
+namespace {
+
+using ogle::JobSystem;
+using ogle::Mesh;
+using ogle::Ray;
+using ogle::ResourceMetadata;
+using ogle::TriangleBVH;
+using ogle::Vector3f;
+using ogle_benchmark::Report;
+using ogle_benchmark::Timer;
+
+/// Number of triangles in the benchmark mesh.
+constexpr int kNumTriangles = 1000000;
+
+/// Width and height in pixels of the image that coherent rays are cast
+/// through.
+constexpr int kImageSize = 512;
+
+/// Distance that rays search.
+constexpr float kMaxDistance = 1000.f;
+
+/**
+ * @brief Builds a mesh of small random triangles filling a cube.
+ * @param[out] mesh Mesh to add triangles to.
+ */
+void BuildTriangleSoup(Mesh* mesh) {
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> position(-50.f, 50.f);
+  std::uniform_real_distribution<float> offset(-1.f, 1.f);
+  for (int i = 0; i < kNumTriangles; ++i) {
+    const Vector3f center{position(rng), position(rng), position(rng)};
+    const Vector3f vertices[3] = {
+        center + Vector3f{offset(rng), offset(rng), offset(rng)},
+        center + Vector3f{offset(rng), offset(rng), offset(rng)},
+        center + Vector3f{offset(rng), offset(rng), offset(rng)}};
+    mesh->AddTriangle(vertices, nullptr, nullptr);
+  }
+}
+
+/**
+ * @brief Times casting rays one at a time, then in packets.
+ * @param bvh BVH to cast against.
+ * @param rays Rays to cast, in packet order.
+ * @param label Kind of rays, prefixed to results.
+ */
+void TraceRays(const TriangleBVH& bvh, const std::vector<Ray<float, 3>>& rays,
+               const std::string& label) {
+  const double num_rays = static_cast<double>(rays.size());
+  int num_hits = 0;
+  Timer closest_timer;
+  for (const auto& ray : rays) {
+    TriangleBVH::Hit hit;
+    num_hits += bvh.ClosestHit(ray, kMaxDistance, &hit) ? 1 : 0;
+  }
+  Report((label + " ClosestHit").c_str(),
+         num_rays / closest_timer.seconds() / 1e6, "Mrays/s");
+
+  Timer any_timer;
+  for (const auto& ray : rays) {
+    bvh.AnyHit(ray, kMaxDistance);
+  }
+  Report((label + " AnyHit").c_str(), num_rays / any_timer.seconds() / 1e6,
+         "Mrays/s");
+
+  Timer packet_timer;
+  for (size_t first = 0; first + TriangleBVH::kPacketSize <= rays.size();
+       first += TriangleBVH::kPacketSize) {
+    TriangleBVH::Hit hits[TriangleBVH::kPacketSize];
+    bvh.ClosestHitPacket(&rays[first], kMaxDistance, hits);
+  }
+  Report((label + " ClosestHitPacket").c_str(),
+         num_rays / packet_timer.seconds() / 1e6, "Mrays/s");
+  Report((label + " hit fraction").c_str(), num_hits / num_rays, "");
+}
+
+}  // namespace
+
+OGLE_BENCHMARK(triangle_bvh, Build) {
+  const ResourceMetadata metadata{};
+  Mesh mesh(metadata);
+  BuildTriangleSoup(&mesh);
+
+  Timer serial_timer;
+  const TriangleBVH serial_bvh(mesh, nullptr);
+  Report("build without jobs", serial_timer.seconds() * 1e3, "ms");
+
+  const int max_workers =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+  for (int num_workers = 1;;
+       num_workers = std::min(2 * num_workers, max_workers)) {
+    JobSystem job_system(num_workers);
+    Timer timer;
+    const TriangleBVH bvh(mesh, &job_system);
+    const std::string label =
+        "build with " + std::to_string(num_workers) + " workers";
+    Report(label.c_str(), timer.seconds() * 1e3, "ms");
+    if (num_workers == max_workers) {
+      break;
+    }
+  }
+}
+
+OGLE_BENCHMARK(triangle_bvh, Trace) {
+  const ResourceMetadata metadata{};
+  Mesh mesh(metadata);
+  BuildTriangleSoup(&mesh);
+  const TriangleBVH bvh(mesh, nullptr);
+
+  // Rays through the pixels of a camera, in 2x2 blocks so that each packet
+  // is coherent.
+  std::vector<Ray<float, 3>> camera_rays;
+  const Vector3f eye{-100.f, 0.f, 0.f};
+  for (int y = 0; y < kImageSize; y += 2) {
+    for (int x = 0; x < kImageSize; x += 2) {
+      for (int lane = 0; lane < TriangleBVH::kPacketSize; ++lane) {
+        const float pixel_x = (x + (lane & 1) - kImageSize / 2) /
+                              static_cast<float>(kImageSize);
+        const float pixel_y = (y + (lane >> 1) - kImageSize / 2) /
+                              static_cast<float>(kImageSize);
+        camera_rays.emplace_back(eye, Vector3f{1.f, pixel_y, pixel_x});
+      }
+    }
+  }
+  TraceRays(bvh, camera_rays, "camera");
+
+  std::vector<Ray<float, 3>> random_rays;
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> position(-50.f, 50.f);
+  std::uniform_real_distribution<float> direction(-1.f, 1.f);
+  for (size_t i = 0; i < camera_rays.size(); ++i) {
+    random_rays.emplace_back(
+        Vector3f{position(rng), position(rng), position(rng)},
+        Vector3f{direction(rng), direction(rng), direction(rng)});
+  }
+  TraceRays(bvh, random_rays, "random");
+}
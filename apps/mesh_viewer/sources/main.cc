@@ -2,13 +2,19 @@
  * @file An app for viewing meshes.
  */
 
+#include <algorithm>
+#include <cmath>
 #include "ogle/ogle.h"
+#include "time/timer.h"
 
 /**
  * @brief Test application to draw a triangle.
  */
 class MeshViewerApplication : public ogle::Application {
  public:
+  /// Configuration module for viewer settings.
+  static const ogle::stl_string kConfigModule;
+
   explicit MeshViewerApplication(std::unique_ptr<ogle::Engine> engine)
       : Application(std::move(engine)) {}
 
@@ -18,32 +24,59 @@ class MeshViewerApplication : public ogle::Application {
       return false;
     }
 
+    // Time resource loading, which dominates startup.
+    ogle::Timer load_timer;
+    load_timer.Reset();
     CHECK(engine_->resource_manager_->LoadResources())
         << "Failed to load resources.";
-    auto mesh = engine_->resource_manager_->GetResource<ogle::Mesh>("cube.obj");
+    LOG(INFO) << "Loaded resources in " << load_timer.Measure() << " s.";
+    auto mesh_config =
+        engine_->configuration_.Get<ogle::stl_string>(kConfigModule, "mesh");
+    const ogle::stl_string mesh_id =
+        mesh_config.second ? mesh_config.first : "cube.obj";
+    auto mesh = engine_->resource_manager_->GetResource<ogle::Mesh>(mesh_id);
     if (!mesh) {
-      LOG(ERROR) << "Failed to load mesh in viewer.";
+      LOG(ERROR) << "Failed to load mesh in viewer: " << mesh_id;
       return false;
     }
+    auto material_config = engine_->configuration_.Get<ogle::stl_string>(
+        kConfigModule, "material");
+    const ogle::stl_string material_id =
+        material_config.second ? material_config.first : "default.mtl";
     auto material =
-        engine_->resource_manager_->GetResource<ogle::Material>("default.mtl");
+        engine_->resource_manager_->GetResource<ogle::Material>(material_id);
     if (!material) {
-      LOG(ERROR) << "Failed to load default.mtl.";
+      LOG(ERROR) << "Failed to load " << material_id << ".";
       return false;
     }
 
     // Create Mesh with renderable buffers.
     buffered_mesh_ = ogle::BufferedMesh::Load(engine_->configuration_, *mesh);
 
-    // Create entity to render.
-    rendered_entity_ = AllocateUniqueObject<ogle::Entity>(
-        &engine_->scene_graph_->root_->transform_);
-    rendered_entity_->transform_.set_world_position({0.f, 0.f, 0.f});
-    if (!rendered_entity_->AddComponent(
-            std::unique_ptr<ogle::MeshRenderer>(ogle::MeshRenderer::Load(
-                engine_->configuration_, *buffered_mesh_.get(), material)))) {
-      LOG(ERROR) << "Failed to add renderer component.";
-      return false;
+    // Create entities to render. More than one copy makes a stress scene
+    // of copies on a square grid, for measuring draw submission.
+    auto num_copies_config =
+        engine_->configuration_.Get<int>(kConfigModule, "num_copies");
+    const int num_copies =
+        num_copies_config.second ? std::max(num_copies_config.first, 1) : 1;
+    const int grid_size =
+        static_cast<int>(std::ceil(std::sqrt(static_cast<float>(num_copies))));
+    constexpr float kGridSpacing = 3.f;
+    for (int i = 0; i < num_copies; ++i) {
+      auto rendered_entity = AllocateUniqueObject<ogle::Entity>(
+          &engine_->scene_graph_->root_->transform_);
+      const float row = static_cast<float>(i / grid_size);
+      const float column = static_cast<float>(i % grid_size);
+      rendered_entity->transform_.set_world_position(
+          {0.f, kGridSpacing * column, kGridSpacing * row});
+      if (!rendered_entity->AddComponent(
+              std::unique_ptr<ogle::MeshRenderer>(ogle::MeshRenderer::Load(
+                  engine_->configuration_, *buffered_mesh_.get(),
+                  material)))) {
+        LOG(ERROR) << "Failed to add renderer component.";
+        return false;
+      }
+      rendered_entities_.emplace_back(std::move(rendered_entity));
     }
 
     // Create light.
@@ -69,6 +102,12 @@ class MeshViewerApplication : public ogle::Application {
       return false;
     }
     camera_entity_->transform_.set_world_position({-3.f, 0.f, 0.f});
+
+    // A benchmark run renders a fixed number of frames, then exits.
+    auto benchmark_frames_config =
+        engine_->configuration_.Get<int>(kConfigModule, "benchmark_frames");
+    benchmark_frames_ =
+        benchmark_frames_config.second ? benchmark_frames_config.first : 0;
     return true;
   }
 
@@ -123,7 +162,48 @@ class MeshViewerApplication : public ogle::Application {
 
     ogle::stl_vector<const ogle::Entity*> light_entities = {
         light_entity_.get()};
+    ogle::Timer render_timer;
+    render_timer.Reset();
     engine_->Render(*camera_entity_.get(), light_entities);
+    const double frame_render_time = render_timer.Measure();
+    render_time_ += frame_render_time;
+    ++num_rendered_frames_;
+    total_render_time_ += frame_render_time;
+    ++num_total_frames_;
+
+    // Report draw submission and frame time periodically. Frame time
+    // includes the buffer swap, which waits for the GPU.
+    constexpr double kStatisticsPeriod = 5.0;
+    if (elapsed_time_ >= next_statistics_time_) {
+      const auto& statistics = engine_->scene_renderer_->statistics();
+      LOG(INFO) << "Culled " << statistics.num_culled << " of "
+                << statistics.num_tested << " objects, and drew "
+                << statistics.num_instances << " objects in "
+                << statistics.num_draws << " draw calls, saved "
+                << statistics.num_state_changes_saved << " of "
+                << statistics.num_state_changes +
+                       statistics.num_state_changes_saved
+                << " state changes and "
+                << statistics.num_api_state_calls_saved << " of "
+                << statistics.num_api_state_calls +
+                       statistics.num_api_state_calls_saved
+                << " API state calls, with " << statistics.num_allocations
+                << " allocations. Average frame time: "
+                << 1000.0 * render_time_ / num_rendered_frames_ << " ms.";
+      next_statistics_time_ = elapsed_time_ + kStatisticsPeriod;
+      render_time_ = 0.0;
+      num_rendered_frames_ = 0;
+    }
+
+    // Runs of builds with and without OGLE_ARENA_ALLOCATOR, with the same
+    // configuration, compare STL allocation strategies.
+    if (benchmark_frames_ > 0 && num_total_frames_ >= benchmark_frames_) {
+      LOG(INFO) << "Rendered " << num_total_frames_ << " frames with the "
+                << ogle::kSTLAllocatorName
+                << " STL allocator. Average frame time: "
+                << 1000.0 * total_render_time_ / num_total_frames_ << " ms.";
+      return false;
+    }
 
     return true;
   }
@@ -132,16 +212,36 @@ class MeshViewerApplication : public ogle::Application {
   /// Entity with camera in scene.
   std::unique_ptr<ogle::Entity> camera_entity_;
 
-  /// Entity instantiated to render the mesh.
-  std::unique_ptr<ogle::Entity> rendered_entity_;
+  /// Entities instantiated to render the mesh.
+  ogle::stl_vector<std::unique_ptr<ogle::Entity>> rendered_entities_;
 
   /// Mesh buffered for rendering.
   std::unique_ptr<ogle::BufferedMesh> buffered_mesh_;
 
   /// Entity for light.
   std::unique_ptr<ogle::Entity> light_entity_;
+
+  /// Elapsed time at which to next report render statistics.
+  double next_statistics_time_ = 0.0;
+
+  /// Time spent rendering since statistics were last reported.
+  double render_time_ = 0.0;
+
+  /// Frames rendered since statistics were last reported.
+  int num_rendered_frames_ = 0;
+
+  /// Frames to render before exiting, or 0 to run until closed.
+  int benchmark_frames_ = 0;
+
+  /// Time spent rendering all frames.
+  double total_render_time_ = 0.0;
+
+  /// Frames rendered in all.
+  int num_total_frames_ = 0;
 };
 
+const ogle::stl_string MeshViewerApplication::kConfigModule = "mesh_viewer";
+
 /**
  * @brief Main entry point.
  * @return 0 on success, something else on failure.
@@ -0,0 +1,247 @@
+/**
+ * @file Tests geometry/aabb_tree.h, as kept up to date by Transforms.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+#include "geometry/aabb_tree.h"
+#include "geometry/transform.h"
+#include "test.h"
+
+namespace {
+
+using ogle::AABBTree;
+using ogle::AxisAlignedBox;
+using ogle::Bounds;
+using ogle::Ray;
+using ogle::Transform;
+using ogle::Vector3f;
+
+/**
+ * @brief Transforms with bounds beneath a root that feeds an AABBTree.
+ */
+class Scene {
+ public:
+  Scene() : root_(nullptr, nullptr), position_(-50.f, 50.f), step_(-2.f, 2.f) {
+    root_.set_spatial_index(&tree_);
+    local_bounds_ = Bounds::Empty();
+    local_bounds_.box.Include(Vector3f{-0.5f, -0.5f, -0.5f});
+    local_bounds_.box.Include(Vector3f{0.5f, 0.5f, 0.5f});
+    local_bounds_.sphere = {Vector3f::Zero(), 0.9f};
+  }
+
+  ~Scene() {
+    transforms_.clear();
+    root_.set_spatial_index(nullptr);
+  }
+
+  /**
+   * @brief Adds a Transform with bounds at a random position.
+   */
+  void Insert() {
+    transforms_.emplace_back(new Transform(&root_, nullptr));
+    transforms_.back()->set_world_position(RandomPosition());
+    transforms_.back()->set_local_bounds(&local_bounds_);
+  }
+
+  /**
+   * @brief Moves a random Transform by a small step, or far away.
+   */
+  void Move() {
+    Transform* transform = RandomTransform();
+    if (rng_() % 4 == 0) {
+      transform->set_world_position(RandomPosition());
+    } else {
+      transform->set_world_position(
+          transform->world_position() +
+          Vector3f{step_(rng_), step_(rng_), step_(rng_)});
+    }
+  }
+
+  /**
+   * @brief Destroys a random Transform.
+   */
+  void Remove() {
+    const size_t index = rng_() % transforms_.size();
+    std::swap(transforms_[index], transforms_.back());
+    transforms_.pop_back();
+  }
+
+  /**
+   * @brief Checks the tree against the Transforms.
+   */
+  void ExpectMatchesTree() {
+    EXPECT(tree_.Validate());
+    EXPECT(tree_.size() == transforms_.size())
+        << "Tree has " << tree_.size() << " leaves for "
+        << transforms_.size() << " transforms.";
+    for (const auto& transform : transforms_) {
+      const std::int32_t proxy = transform->spatial_proxy();
+      EXPECT(proxy != AABBTree::kNullNode);
+      if (proxy == AABBTree::kNullNode) {
+        continue;
+      }
+      EXPECT(tree_.transform(proxy) == transform.get());
+      EXPECT(tree_.fat_box(proxy).Contains(WorldBox(*transform)))
+          << "Fat box of proxy " << proxy << " is stale.";
+    }
+  }
+
+  /**
+   * @brief Checks that box queries report exactly the fat boxes that
+   *        overlap.
+   */
+  void ExpectBoxQueriesMatch() {
+    for (int query = 0; query < 20; ++query) {
+      const Vector3f center = RandomPosition();
+      AxisAlignedBox box = AxisAlignedBox::Empty();
+      box.Include(center - Vector3f{5.f, 5.f, 5.f});
+      box.Include(center + Vector3f{5.f, 5.f, 5.f});
+
+      std::set<std::int32_t> found;
+      tree_.Query(box, [&found](const std::int32_t proxy) {
+        found.insert(proxy);
+        return true;
+      });
+      std::set<std::int32_t> expected;
+      for (const auto& transform : transforms_) {
+        if (tree_.fat_box(transform->spatial_proxy()).Overlaps(box)) {
+          expected.insert(transform->spatial_proxy());
+        }
+      }
+      EXPECT(found == expected) << "Query found " << found.size()
+                                << " proxies, expected " << expected.size();
+    }
+  }
+
+  /**
+   * @brief Checks that ray casts visit every object box that rays hit.
+   */
+  void ExpectRayCastsFindHits() {
+    constexpr float kMaxDistance = 1000.f;
+    for (int cast = 0; cast < 20; ++cast) {
+      Vector3f direction{step_(rng_), step_(rng_), step_(rng_)};
+      direction = direction / direction.Norm();
+      const Ray<float, 3> ray(RandomPosition() - direction * 100.f, direction);
+
+      std::set<Transform*> found;
+      tree_.RayCast(ray, kMaxDistance,
+                    [this, &found, kMaxDistance](const std::int32_t proxy) {
+                      found.insert(tree_.transform(proxy));
+                      return kMaxDistance;
+                    });
+      for (const auto& transform : transforms_) {
+        if (Hits(ray, WorldBox(*transform), kMaxDistance)) {
+          EXPECT(found.count(transform.get()) == 1)
+              << "RayCast missed proxy " << transform->spatial_proxy();
+        }
+      }
+    }
+  }
+
+  AABBTree& tree() { return tree_; }
+  size_t size() const { return transforms_.size(); }
+
+ private:
+  /**
+   * @brief Computes the box that a Transform last gave the tree.
+   * @param transform Transform with the scene's local bounds.
+   * @return World-space box.
+   */
+  const AxisAlignedBox WorldBox(const Transform& transform) const {
+    return local_bounds_.box.Transformed(transform.TransformationMatrix3D());
+  }
+
+  /**
+   * @brief Intersects a ray with a box by the slab test.
+   * @return true if the ray hits the box within max_distance, else false.
+   */
+  static bool Hits(const Ray<float, 3>& ray, const AxisAlignedBox& box,
+                   const float max_distance) {
+    float near = 0.f;
+    float far = max_distance;
+    for (int axis = 0; axis < 3; ++axis) {
+      float t1 = (box.min(axis) - ray.origin_(axis)) / ray.direction_(axis);
+      float t2 = (box.max(axis) - ray.origin_(axis)) / ray.direction_(axis);
+      if (t1 > t2) {
+        std::swap(t1, t2);
+      }
+      near = std::max(near, t1);
+      far = std::min(far, t2);
+    }
+    return near <= far;
+  }
+
+  Vector3f RandomPosition() {
+    return {position_(rng_), position_(rng_), position_(rng_)};
+  }
+
+  Transform* RandomTransform() {
+    return transforms_[rng_() % transforms_.size()].get();
+  }
+
+  AABBTree tree_;
+  Transform root_;
+  Bounds local_bounds_;
+  std::vector<std::unique_ptr<Transform>> transforms_;
+  std::mt19937 rng_;
+  std::uniform_real_distribution<float> position_;
+  std::uniform_real_distribution<float> step_;
+};
+
+}  // namespace
+
+OGLE_TEST(aabb_tree, ChurnKeepsTreeValid) {
+  Scene scene;
+  for (int step = 0; step < 500; ++step) {
+    // Grow to about 1000 transforms, then keep the count level.
+    const int num_inserts = (scene.size() < 1000) ? 20 : 5;
+    for (int i = 0; i < num_inserts; ++i) {
+      scene.Insert();
+    }
+    for (int i = 0; i < 50; ++i) {
+      scene.Move();
+    }
+    for (int i = 0; i < 5; ++i) {
+      scene.Remove();
+    }
+    scene.tree().Update();
+    scene.ExpectMatchesTree();
+    if (step % 50 == 0) {
+      scene.ExpectBoxQueriesMatch();
+      scene.ExpectRayCastsFindHits();
+    }
+  }
+}
+
+OGLE_TEST(aabb_tree, RemoveMovedBeforeUpdate) {
+  Scene scene;
+  for (int i = 0; i < 1000; ++i) {
+    scene.Insert();
+  }
+  scene.tree().Update();
+  scene.ExpectMatchesTree();
+
+  // Transforms destroyed while queued must leave the rest queued.
+  for (int i = 0; i < 2000; ++i) {
+    scene.Move();
+  }
+  for (int i = 0; i < 500; ++i) {
+    scene.Remove();
+  }
+  scene.tree().Update();
+  scene.ExpectMatchesTree();
+  scene.ExpectBoxQueriesMatch();
+
+  while (scene.size() > 0) {
+    scene.Move();
+    scene.Remove();
+  }
+  scene.tree().Update();
+  scene.ExpectMatchesTree();
+  EXPECT(scene.tree().height() == -1);
+}
@@ -0,0 +1,296 @@
+/**
+ * @file Tests algorithms/directed_graph.h against a simple model of its
+ *       edges.
+ */
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+#include "algorithms/directed_graph.h"
+#include "test.h"
+
+namespace {
+
+/// Graph keyed by int, with each node's key as its value, so that keys can
+/// be read back from the nodes in neighbor lists.
+using Graph = ogle::DirectedGraph<int, int>;
+
+/**
+ * @brief A DirectedGraph and the edges it should hold.
+ */
+class ModelGraph {
+ public:
+  /**
+   * @brief Adds a node to both graphs.
+   * @param key Key of new node.
+   */
+  void AddNode(const int key) {
+    EXPECT(graph_.AddNode(key, key));
+    EXPECT(!graph_.AddNode(key, key)) << "Added key " << key << " twice.";
+    out_[key];
+    in_[key];
+  }
+
+  /**
+   * @brief Adds an edge to both graphs.
+   * @param src Key of node that depends on dest.
+   * @param dest Key of node depended on.
+   */
+  void AddEdge(const int src, const int dest) {
+    const bool added = out_[src].insert(dest).second;
+    in_[dest].insert(src);
+    taken_.erase(src);
+    EXPECT(graph_.AddEdge(src, dest) == added)
+        << "Edge " << src << " -> " << dest;
+  }
+
+  /**
+   * @brief Removes a node from both graphs.
+   * @param key Key of node to remove.
+   */
+  void Remove(const int key) {
+    for (const int dest : out_[key]) {
+      in_[dest].erase(key);
+    }
+    for (const int src : in_[key]) {
+      out_[src].erase(key);
+    }
+    out_.erase(key);
+    in_.erase(key);
+    taken_.erase(key);
+    EXPECT(graph_.Remove(key));
+    EXPECT(!graph_.Remove(key)) << "Removed key " << key << " twice.";
+  }
+
+  /**
+   * @brief Takes ready nodes, and checks they are the nodes without edges
+   *        that weren't taken already.
+   * @return Keys taken, sorted.
+   */
+  std::vector<int> TakeReady() {
+    std::vector<int> expected;
+    for (const auto& node : out_) {
+      if (node.second.empty() && taken_.count(node.first) == 0) {
+        expected.push_back(node.first);
+      }
+    }
+    EXPECT(graph_.NumReady() == expected.size())
+        << graph_.NumReady() << " ready, expected " << expected.size();
+
+    std::vector<int> taken;
+    for (const auto& result : graph_.TakeReady()) {
+      EXPECT(*result.second == result.first);
+      taken.push_back(result.first);
+    }
+    std::sort(taken.begin(), taken.end());
+    EXPECT(taken == expected)
+        << "Took " << taken.size() << " nodes, expected " << expected.size();
+    taken_.insert(taken.begin(), taken.end());
+    EXPECT(graph_.NumReady() == 0);
+    return taken;
+  }
+
+  /**
+   * @brief Checks every node's edges, in both directions, against the model.
+   */
+  void ExpectEdgesMatch() {
+    EXPECT(graph_.Size() == out_.size());
+    for (const auto& node : out_) {
+      const auto neighbors = graph_.GetNeighbors(node.first);
+      EXPECT(neighbors.second);
+      std::set<int> neighbor_keys;
+      for (const Graph::Node* neighbor : neighbors.first) {
+        neighbor_keys.insert(neighbor->value_);
+
+        // Every node with a back pointer is some node's neighbor, so this
+        // checks all back pointers.
+        std::set<int> back_pointer_keys;
+        for (const Graph::Node* back_pointer : neighbor->back_pointers()) {
+          back_pointer_keys.insert(back_pointer->value_);
+        }
+        EXPECT(back_pointer_keys == in_[neighbor->value_])
+            << "Back pointers of " << neighbor->value_ << " are wrong.";
+      }
+      EXPECT(neighbor_keys == node.second)
+          << "Neighbors of " << node.first << " are wrong.";
+    }
+  }
+
+  /**
+   * @brief Checks whether a node is in the graph.
+   * @param key Key of node.
+   * @return true if the model has the node.
+   */
+  bool Contains(const int key) const {
+    return out_.count(key) != 0;
+  }
+
+  /// Keys of each node's neighbors.
+  const std::map<int, std::set<int>>& out() const { return out_; }
+
+  Graph& graph() { return graph_; }
+
+ private:
+  Graph graph_;
+
+  /// Keys of each node's neighbors, and of nodes with edges to it.
+  std::map<int, std::set<int>> out_;
+  std::map<int, std::set<int>> in_;
+
+  /// Nodes returned by TakeReady() since they last had edges.
+  std::set<int> taken_;
+};
+
+/**
+ * @brief Builds a random DAG, where nodes only depend on nodes earlier in a
+ *        random order.
+ * @param num_nodes Number of nodes, keyed 0 to num_nodes - 1.
+ * @param max_edges Most edges leaving each node.
+ * @param rng Random number generator.
+ * @param[out] graph Graph to add to.
+ */
+void BuildRandomDAG(const int num_nodes, const int max_edges,
+                    std::mt19937* rng, ModelGraph* graph) {
+  std::vector<int> order(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), *rng);
+  for (const int key : order) {
+    graph->AddNode(key);
+  }
+  for (int i = 1; i < num_nodes; ++i) {
+    const int num_edges = (*rng)() % (max_edges + 1);
+    for (int edge = 0; edge < num_edges; ++edge) {
+      graph->AddEdge(order[i], order[(*rng)() % i]);
+    }
+  }
+}
+
+}  // namespace
+
+OGLE_TEST(directed_graph, TopologicalOrderOnRandomDAGs) {
+  std::mt19937 rng;
+  for (int trial = 0; trial < 5; ++trial) {
+    ModelGraph graph;
+    BuildRandomDAG(2000, 4, &rng, &graph);
+    graph.ExpectEdgesMatch();
+
+    // Each node's dependencies must be removed before it is taken.
+    std::set<int> removed;
+    int num_levels = 0;
+    while (!graph.graph().Empty()) {
+      const auto level = graph.TakeReady();
+      EXPECT(!level.empty()) << "No nodes ready in a DAG.";
+      if (level.empty()) {
+        break;
+      }
+      for (const int key : level) {
+        for (const int dest : graph.out().at(key)) {
+          EXPECT(removed.count(dest) != 0)
+              << key << " was ready before " << dest;
+        }
+      }
+      for (const int key : level) {
+        graph.Remove(key);
+        removed.insert(key);
+      }
+      ++num_levels;
+      if (num_levels % 10 == 0) {
+        graph.ExpectEdgesMatch();
+      }
+    }
+    EXPECT(removed.size() == 2000);
+  }
+}
+
+OGLE_TEST(directed_graph, StopsAtCycles) {
+  std::mt19937 rng;
+  for (int trial = 0; trial < 5; ++trial) {
+    ModelGraph graph;
+    BuildRandomDAG(1000, 3, &rng, &graph);
+
+    // Close a cycle through a few random nodes. Those nodes, and all nodes
+    // that depend on them, can never be ready.
+    std::vector<int> cycle;
+    for (int i = 0; i < 4; ++i) {
+      cycle.push_back(rng() % 1000);
+    }
+    for (size_t i = 0; i < cycle.size(); ++i) {
+      graph.AddEdge(cycle[i], cycle[(i + 1) % cycle.size()]);
+    }
+    std::map<int, std::set<int>> in;
+    for (const auto& node : graph.out()) {
+      for (const int dest : node.second) {
+        in[dest].insert(node.first);
+      }
+    }
+    std::set<int> stuck(cycle.begin(), cycle.end());
+    std::vector<int> to_visit(cycle.begin(), cycle.end());
+    while (!to_visit.empty()) {
+      const int key = to_visit.back();
+      to_visit.pop_back();
+      for (const int src : in[key]) {
+        if (stuck.insert(src).second) {
+          to_visit.push_back(src);
+        }
+      }
+    }
+
+    while (true) {
+      const auto level = graph.TakeReady();
+      if (level.empty()) {
+        break;
+      }
+      for (const int key : level) {
+        EXPECT(stuck.count(key) == 0) << key << " depends on a cycle.";
+        graph.Remove(key);
+      }
+    }
+    EXPECT(graph.graph().Size() == stuck.size())
+        << graph.graph().Size() << " nodes left, expected " << stuck.size();
+    for (const int key : stuck) {
+      EXPECT(graph.Contains(key));
+    }
+    graph.ExpectEdgesMatch();
+  }
+}
+
+OGLE_TEST(directed_graph, RemoveReadyTakenAndWaitingNodes) {
+  std::mt19937 rng;
+  ModelGraph graph;
+  BuildRandomDAG(3000, 5, &rng, &graph);
+  int next_key = 3000;
+  for (int step = 0; step < 300; ++step) {
+    // Take some of the ready nodes. Those left are ready but not taken.
+    if (rng() % 2 == 0) {
+      graph.TakeReady();
+    }
+
+    // Remove random nodes, whether taken, ready, or waiting on edges.
+    for (int i = 0; i < 5 && !graph.out().empty(); ++i) {
+      auto it = graph.out().begin();
+      std::advance(it, rng() % graph.out().size());
+      graph.Remove(it->first);
+    }
+
+    // Add nodes, and edges that may make taken nodes wait again.
+    for (int i = 0; i < 5; ++i) {
+      graph.AddNode(next_key);
+      ++next_key;
+    }
+    for (int i = 0; i < 10; ++i) {
+      auto src = graph.out().begin();
+      std::advance(src, rng() % graph.out().size());
+      auto dest = graph.out().begin();
+      std::advance(dest, rng() % graph.out().size());
+      if (src->first != dest->first) {
+        graph.AddEdge(src->first, dest->first);
+      }
+    }
+    graph.ExpectEdgesMatch();
+  }
+  graph.TakeReady();
+}
@@ -0,0 +1,267 @@
+/**
+ * @file Tests renderer/glfw_state_cache.h against a real OpenGL context.
+ *
+ * Runs headless on a software renderer, such as Mesa llvmpipe under Xvfb.
+ * Skipped if no OpenGL 3.3 context can be created.
+ */
+
+#include "GL/glew.h"
+#include "GLFW/glfw3.h"
+#include "renderer/glfw_state_cache.h"
+#include "test.h"
+
+namespace {
+
+/**
+ * @brief Hidden window whose OpenGL context is current while it exists,
+ *        with a cache for that context and objects to bind.
+ */
+class TestContext {
+ public:
+  TestContext() {
+    if (!glfwInit()) {
+      ogle_test::Skip("Failed to init GLFW.");
+      return;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    window_ = glfwCreateWindow(64, 64, "tests", nullptr, nullptr);
+    if (window_ == nullptr) {
+      ogle_test::Skip("Failed to create OpenGL 3.3 context.");
+      return;
+    }
+    glfwMakeContextCurrent(window_);
+    glewExperimental = true;
+    if (glewInit() != GLEW_OK) {
+      ogle_test::Skip("glewInit failed.");
+      glfwDestroyWindow(window_);
+      window_ = nullptr;
+      return;
+    }
+
+    // glewInit queries extensions in a way that core profiles reject.
+    while (glGetError() != GL_NO_ERROR) {
+    }
+
+    program_ = CreateProgram();
+    glGenVertexArrays(2, vertex_arrays_);
+    glGenBuffers(3, buffers_);
+    glGenTextures(2, textures_);
+    ogle::GLFWStateCache::set_current(&cache_);
+  }
+
+  ~TestContext() {
+    if (window_ != nullptr) {
+      ogle::GLFWStateCache::set_current(nullptr);
+      glDeleteProgram(program_);
+      glDeleteVertexArrays(2, vertex_arrays_);
+      glDeleteBuffers(3, buffers_);
+      glDeleteTextures(2, textures_);
+      glfwDestroyWindow(window_);
+    }
+    glfwTerminate();
+  }
+
+  /**
+   * @brief Checks if the context was created.
+   * @return true if tests can run.
+   */
+  bool valid() const { return window_ != nullptr; }
+
+  /**
+   * @brief Counts calls issued by the cache so far this frame.
+   * @return Count.
+   */
+  std::uint64_t num_issued() const {
+    return cache_.frame_statistics().num_issued_calls;
+  }
+
+  /**
+   * @brief Counts calls skipped by the cache so far this frame.
+   * @return Count.
+   */
+  std::uint64_t num_filtered() const {
+    return cache_.frame_statistics().num_filtered_calls;
+  }
+
+  /// Cache under test.
+  ogle::GLFWStateCache cache_;
+
+  /// Window owning the context.
+  GLFWwindow* window_ = nullptr;
+
+  ///@{
+  /// Objects to bind.
+  GLuint program_ = 0;
+  GLuint vertex_arrays_[2] = {0, 0};
+  GLuint buffers_[3] = {0, 0, 0};
+  GLuint textures_[2] = {0, 0};
+  ///@}
+
+ private:
+  /**
+   * @brief Links a minimal program.
+   * @return Program ID.
+   */
+  static GLuint CreateProgram() {
+    const char* vertex_source =
+        "#version 330 core\nvoid main() { gl_Position = vec4(0.0); }\n";
+    const char* fragment_source =
+        "#version 330 core\nout vec4 color;\n"
+        "void main() { color = vec4(1.0); }\n";
+    const GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex_shader, 1, &vertex_source, nullptr);
+    glCompileShader(vertex_shader);
+    const GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment_shader, 1, &fragment_source, nullptr);
+    glCompileShader(fragment_shader);
+    const GLuint program = glCreateProgram();
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glLinkProgram(program);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    EXPECT(linked == GL_TRUE) << "Failed to link test program.";
+    return program;
+  }
+};
+
+/**
+ * @brief Sets every kind of shadowed state through the cache.
+ * @param context Context to set state in.
+ */
+void SetAllState(TestContext* context) {
+  ogle::GLFWStateCache& cache = context->cache_;
+  cache.UseProgram(context->program_);
+  cache.BindVertexArray(context->vertex_arrays_[0]);
+  cache.BindBuffer(GL_ARRAY_BUFFER, context->buffers_[0]);
+  cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, context->buffers_[1]);
+  cache.BindBuffer(GL_UNIFORM_BUFFER, context->buffers_[2]);
+  cache.SetEnabled(GL_DEPTH_TEST, true);
+  cache.SetEnabled(GL_CULL_FACE, true);
+  cache.SetEnabled(GL_BLEND, false);
+  cache.DepthFunc(GL_LEQUAL);
+  cache.DepthMask(false);
+  cache.CullFace(GL_FRONT);
+  cache.FrontFace(GL_CW);
+  cache.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  cache.BindTexture(0, GL_TEXTURE_2D, context->textures_[0]);
+  cache.BindTexture(3, GL_TEXTURE_2D, context->textures_[1]);
+}
+
+}  // namespace
+
+OGLE_TEST(glfw_state_cache, CachedCallsMatchContext) {
+  TestContext context;
+  if (!context.valid()) {
+    return;
+  }
+  EXPECT(context.cache_.Validate()) << "Unknown state should validate.";
+  SetAllState(&context);
+  EXPECT(glGetError() == GL_NO_ERROR);
+  EXPECT(context.cache_.Validate());
+}
+
+OGLE_TEST(glfw_state_cache, RedundantCallsAreFiltered) {
+  TestContext context;
+  if (!context.valid()) {
+    return;
+  }
+  SetAllState(&context);
+  const std::uint64_t num_issued = context.num_issued();
+  const std::uint64_t num_filtered = context.num_filtered();
+  EXPECT(num_issued > 0);
+  SetAllState(&context);
+  EXPECT(context.num_issued() == num_issued)
+      << context.num_issued() - num_issued << " redundant calls issued.";
+  EXPECT(context.num_filtered() == num_filtered + 15)
+      << context.num_filtered() - num_filtered << " calls filtered.";
+  EXPECT(context.cache_.Validate());
+
+  context.cache_.EndFrame();
+  EXPECT(context.cache_.statistics().num_issued_calls == num_issued);
+  EXPECT(context.num_issued() == 0 && context.num_filtered() == 0);
+}
+
+OGLE_TEST(glfw_state_cache, RawCallsAreDetectedUntilInvalidated) {
+  TestContext context;
+  if (!context.valid()) {
+    return;
+  }
+  SetAllState(&context);
+
+  // Changes made behind the cache's back make it stale.
+  glBindBuffer(GL_ARRAY_BUFFER, context.buffers_[2]);
+  glDisable(GL_DEPTH_TEST);
+  glDepthFunc(GL_ALWAYS);
+  EXPECT(!context.cache_.Validate()) << "Stale state was not detected.";
+
+  // Once invalidated, the next calls are issued and bring it up to date.
+  context.cache_.Invalidate();
+  EXPECT(context.cache_.Validate());
+  const std::uint64_t num_issued = context.num_issued();
+  context.cache_.BindBuffer(GL_ARRAY_BUFFER, context.buffers_[0]);
+  context.cache_.SetEnabled(GL_DEPTH_TEST, true);
+  context.cache_.DepthFunc(GL_LEQUAL);
+  EXPECT(context.num_issued() == num_issued + 3);
+  EXPECT(context.cache_.Validate());
+}
+
+OGLE_TEST(glfw_state_cache, ElementArrayBindingFollowsVertexArray) {
+  TestContext context;
+  if (!context.valid()) {
+    return;
+  }
+  ogle::GLFWStateCache& cache = context.cache_;
+  cache.BindVertexArray(context.vertex_arrays_[0]);
+  cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, context.buffers_[0]);
+  cache.BindVertexArray(context.vertex_arrays_[1]);
+  cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, context.buffers_[1]);
+  EXPECT(cache.Validate());
+
+  // Switching back restores the first vertex array's binding in OpenGL,
+  // which the cache must not assume is still the second one.
+  cache.BindVertexArray(context.vertex_arrays_[0]);
+  EXPECT(cache.Validate());
+  const std::uint64_t num_issued = context.num_issued();
+  cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, context.buffers_[0]);
+  EXPECT(context.num_issued() == num_issued + 1);
+  EXPECT(cache.Validate());
+}
+
+OGLE_TEST(glfw_state_cache, ForgottenObjectsCanBeDeleted) {
+  TestContext context;
+  if (!context.valid()) {
+    return;
+  }
+  ogle::GLFWStateCache& cache = context.cache_;
+  GLuint buffer = 0;
+  GLuint texture = 0;
+  glGenBuffers(1, &buffer);
+  glGenTextures(1, &texture);
+  cache.BindBuffer(GL_ARRAY_BUFFER, buffer);
+  cache.BindTexture(1, GL_TEXTURE_2D, texture);
+  EXPECT(cache.Validate());
+
+  // Deleting bound objects unbinds them in OpenGL.
+  cache.ForgetBuffer(buffer);
+  cache.ForgetTexture(texture);
+  glDeleteBuffers(1, &buffer);
+  glDeleteTextures(1, &texture);
+  EXPECT(cache.Validate());
+
+  // A new object may reuse the ID, and must be bound again.
+  GLuint new_buffer = 0;
+  glGenBuffers(1, &new_buffer);
+  const std::uint64_t num_issued = context.num_issued();
+  cache.BindBuffer(GL_ARRAY_BUFFER, new_buffer);
+  EXPECT(context.num_issued() == num_issued + 1);
+  EXPECT(cache.Validate());
+  cache.ForgetBuffer(new_buffer);
+  glDeleteBuffers(1, &new_buffer);
+}
@@ -0,0 +1,241 @@
+/**
+ * @file Stress tests jobs/job_system.h. Shared data is mostly not atomic,
+ *       so that builds with OGLE_SANITIZE_THREAD check that finishing jobs,
+ *       dependencies, and Wait() order memory as documented.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include "jobs/job_system.h"
+#include "test.h"
+
+namespace {
+
+using ogle::JobHandle;
+using ogle::JobSystem;
+
+/// Numbers of workers to run each test with. 0 runs jobs only in threads
+/// that wait on them.
+constexpr int kWorkerCounts[] = {0, 1, 3};
+
+/**
+ * @brief Schedules a random DAG of jobs, each recording a depth one past
+ *        its deepest dependency.
+ * @param num_jobs Number of jobs.
+ * @param job_system JobSystem to run on.
+ */
+void RunRandomGraph(const int num_jobs, JobSystem* job_system) {
+  std::mt19937 rng(num_jobs);
+  std::vector<int> depths(num_jobs, -1);
+  std::vector<std::vector<int>> dependencies(num_jobs);
+  std::vector<JobHandle> handles;
+  for (int job = 0; job < num_jobs; ++job) {
+    ogle::stl_vector<JobHandle> dependency_handles;
+    const int num_dependencies = (job == 0) ? 0 : rng() % 4;
+    for (int i = 0; i < num_dependencies; ++i) {
+      // Mostly recent jobs, which are likelier to still be running.
+      const int window = std::min(job, 16);
+      const int dependency = job - 1 - static_cast<int>(rng() % window);
+      dependencies[job].push_back(dependency);
+      dependency_handles.push_back(handles[dependency]);
+    }
+    handles.push_back(job_system->Schedule(
+        [&depths, &dependencies, job]() {
+          int depth = 0;
+          for (const int dependency : dependencies[job]) {
+            depth = std::max(depth, depths[dependency] + 1);
+          }
+          depths[job] = depth;
+        },
+        dependency_handles));
+  }
+  for (const auto& handle : handles) {
+    job_system->Wait(handle);
+  }
+  for (int job = 0; job < num_jobs; ++job) {
+    for (const int dependency : dependencies[job]) {
+      EXPECT(depths[dependency] >= 0 && depths[job] > depths[dependency])
+          << "Job " << job << " ran before dependency " << dependency;
+    }
+  }
+}
+
+}  // namespace
+
+OGLE_TEST(job_system, DependencyChains) {
+  constexpr int kNumChains = 32;
+  constexpr int kChainLength = 200;
+  for (const int num_workers : kWorkerCounts) {
+    JobSystem job_system(num_workers);
+    std::vector<std::vector<int>> values(kNumChains,
+                                         std::vector<int>(kChainLength, 0));
+    std::vector<JobHandle> ends;
+    for (int chain = 0; chain < kNumChains; ++chain) {
+      std::vector<int>& chain_values = values[chain];
+      JobHandle previous = job_system.Schedule([&chain_values]() {
+        chain_values[0] = 1;
+      });
+      for (int link = 1; link < kChainLength; ++link) {
+        previous = job_system.Continue(previous, [&chain_values, link]() {
+          chain_values[link] = chain_values[link - 1] + 1;
+        });
+      }
+      ends.push_back(previous);
+    }
+    for (const auto& end : ends) {
+      job_system.Wait(end);
+      EXPECT(end.finished());
+    }
+    for (const auto& chain_values : values) {
+      EXPECT(chain_values.back() == kChainLength)
+          << "Chain ended at " << chain_values.back() << " with "
+          << num_workers << " workers.";
+    }
+
+    RunRandomGraph(5000, &job_system);
+  }
+}
+
+OGLE_TEST(job_system, DependenciesScheduledFromJobs) {
+  for (const int num_workers : kWorkerCounts) {
+    JobSystem job_system(num_workers);
+    for (int round = 0; round < 20; ++round) {
+      // Graphs scheduled from workers go on their own queues, and are
+      // stolen by the other workers.
+      std::vector<JobHandle> graphs;
+      for (int graph = 0; graph < 4; ++graph) {
+        graphs.push_back(job_system.Schedule([&job_system]() {
+          RunRandomGraph(200, &job_system);
+        }));
+      }
+      for (const auto& graph : graphs) {
+        job_system.Wait(graph);
+      }
+    }
+  }
+}
+
+OGLE_TEST(job_system, NestedParallelFor) {
+  static constexpr size_t kNumRows = 64;
+  static constexpr size_t kNumColumns = 1000;
+  for (const int num_workers : kWorkerCounts) {
+    JobSystem job_system(num_workers);
+    std::vector<std::int64_t> cells(kNumRows * kNumColumns, 0);
+    std::vector<std::int64_t> row_sums(kNumRows, 0);
+    job_system.ParallelFor(0, kNumRows, 1, [&](const size_t row_begin,
+                                               const size_t row_end) {
+      for (size_t row = row_begin; row < row_end; ++row) {
+        job_system.ParallelFor(
+            0, kNumColumns, 16,
+            [&cells, row](const size_t begin, const size_t end) {
+              for (size_t column = begin; column < end; ++column) {
+                cells[row * kNumColumns + column] += row * column;
+              }
+            });
+        // The inner loop's writes are visible once it returns.
+        std::int64_t sum = 0;
+        for (size_t column = 0; column < kNumColumns; ++column) {
+          sum += cells[row * kNumColumns + column];
+        }
+        row_sums[row] = sum;
+      }
+    });
+    for (size_t row = 0; row < kNumRows; ++row) {
+      const std::int64_t expected =
+          static_cast<std::int64_t>(row) * kNumColumns * (kNumColumns - 1) / 2;
+      EXPECT(row_sums[row] == expected)
+          << "Row " << row << " summed to " << row_sums[row] << " with "
+          << num_workers << " workers.";
+    }
+    for (size_t index = 0; index < cells.size(); ++index) {
+      const size_t row = index / kNumColumns;
+      const size_t column = index % kNumColumns;
+      EXPECT(cells[index] == static_cast<std::int64_t>(row * column))
+          << "Cell " << index << " was written " << cells[index];
+      if (cells[index] != static_cast<std::int64_t>(row * column)) {
+        break;
+      }
+    }
+  }
+}
+
+OGLE_TEST(job_system, WaitFromOtherThreads) {
+  constexpr int kNumThreads = 4;
+  constexpr int kJobsPerThread = 500;
+  for (const int num_workers : kWorkerCounts) {
+    JobSystem job_system(num_workers);
+    std::vector<std::vector<int>> results(kNumThreads,
+                                          std::vector<int>(kJobsPerThread, 0));
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < kNumThreads; ++thread) {
+      threads.emplace_back([&job_system, &results, thread]() {
+        // Each thread waits on its own jobs, and sleeps while the others'
+        // jobs run, so finishing jobs must wake it.
+        std::vector<int>& thread_results = results[thread];
+        std::vector<JobHandle> handles;
+        for (int job = 0; job < kJobsPerThread; ++job) {
+          handles.push_back(job_system.Schedule(
+              [&thread_results, job]() { thread_results[job] = job + 1; }));
+          if (job % 8 == 7) {
+            job_system.Wait(handles.back());
+            EXPECT(thread_results[job] == job + 1);
+          }
+        }
+        for (const auto& handle : handles) {
+          job_system.Wait(handle);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (const auto& thread_results : results) {
+      for (int job = 0; job < kJobsPerThread; ++job) {
+        EXPECT(thread_results[job] == job + 1)
+            << "Job " << job << " didn't run with " << num_workers
+            << " workers.";
+      }
+    }
+  }
+}
+
+OGLE_TEST(job_system, FinishesJobsQueuedAtShutdown) {
+  for (const int num_workers : kWorkerCounts) {
+    for (int round = 0; round < 50; ++round) {
+      std::atomic<int> num_run{0};
+      int last_value = 0;
+      int expected = 0;
+      {
+        JobSystem job_system(num_workers);
+        JobHandle previous;
+        for (int job = 0; job < 200; ++job) {
+          previous = job_system.Continue(previous, [&num_run, &last_value]() {
+            ++last_value;
+            num_run.fetch_add(1, std::memory_order_relaxed);
+          });
+          ++expected;
+        }
+
+        // Jobs that schedule more jobs while the destructor runs.
+        for (int job = 0; job < 50; ++job) {
+          job_system.Schedule([&job_system, &num_run]() {
+            num_run.fetch_add(1, std::memory_order_relaxed);
+            job_system.Schedule([&num_run]() {
+              num_run.fetch_add(1, std::memory_order_relaxed);
+            });
+          });
+          expected += 2;
+        }
+      }
+      EXPECT(num_run.load() == expected)
+          << "Ran " << num_run.load() << " of " << expected << " jobs with "
+          << num_workers << " workers.";
+      EXPECT(last_value == 200);
+    }
+  }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file Runs ogle's tests.
+ *
+ * usage: tests [group]
+ *
+ * Runs all tests, or only those of one group. Exits with 0 if all passed,
+ * 1 if any failed, and 77 if all that ran were skipped.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <vector>
+#include "ogle/ogle.h"
+#include "test.h"
+
+namespace ogle_test {
+
+namespace {
+
+/**
+ * @brief A registered test.
+ */
+struct Test {
+  /// Group the test belongs to.
+  const char* group;
+
+  /// Name of test.
+  const char* name;
+
+  /// Function that runs the test.
+  TestFunction function;
+};
+
+/// Exit code that CTest treats as a skipped test.
+constexpr int kSkippedExitCode = 77;
+
+/**
+ * @brief Gets all registered tests, in registration order.
+ * @return Tests. Created on first use, as registration runs during static
+ *         initialization.
+ */
+std::vector<Test>& Tests() {
+  static std::vector<Test> tests;
+  return tests;
+}
+
+/// Number of failed expectations in the running test. Atomic, as tests may
+/// expect from jobs and threads that they start.
+std::atomic<int> g_num_failures{0};
+
+/// Whether the running test was skipped.
+bool g_skipped = false;
+
+}  // namespace
+
+TestRegistration::TestRegistration(const char* group, const char* name,
+                                   TestFunction function) {
+  Tests().push_back({group, name, function});
+}
+
+Failure::Failure(const char* file, int line, const char* condition) {
+  message_ << file << ":" << line << ": expected " << condition << ". ";
+}
+
+Failure::~Failure() {
+  ++g_num_failures;
+  std::fprintf(stderr, "%s\n", message_.str().c_str());
+}
+
+std::ostream& Failure::stream() {
+  return message_;
+}
+
+void Skip(const std::string& reason) {
+  g_skipped = true;
+  std::fprintf(stderr, "Skipped: %s\n", reason.c_str());
+}
+
+}  // namespace ogle_test
+
+int main(const int argc, const char* argv[]) {
+  const std::string group = (argc > 1) ? argv[1] : "";
+  int num_run = 0;
+  int num_failed = 0;
+  int num_skipped = 0;
+  for (const auto& test : ogle_test::Tests()) {
+    if (!group.empty() && group != test.group) {
+      continue;
+    }
+    std::printf("[ RUN  ] %s.%s\n", test.group, test.name);
+    std::fflush(stdout);
+    ogle_test::g_num_failures = 0;
+    ogle_test::g_skipped = false;
+    test.function();
+    ++num_run;
+    if (ogle_test::g_num_failures > 0) {
+      ++num_failed;
+      std::printf("[ FAIL ] %s.%s\n", test.group, test.name);
+    } else if (ogle_test::g_skipped) {
+      ++num_skipped;
+      std::printf("[ SKIP ] %s.%s\n", test.group, test.name);
+    } else {
+      std::printf("[  OK  ] %s.%s\n", test.group, test.name);
+    }
+  }
+  std::printf("%d tests run, %d failed, %d skipped.\n", num_run, num_failed,
+              num_skipped);
+  if (num_run == 0) {
+    std::fprintf(stderr, "No tests in group %s.\n", group.c_str());
+    return 1;
+  }
+  if (num_failed > 0) {
+    return 1;
+  }
+  return (num_skipped == num_run) ? ogle_test::kSkippedExitCode : 0;
+}
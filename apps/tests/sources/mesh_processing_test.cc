@@ -0,0 +1,110 @@
+/**
+ * @file Tests geometry/mesh_processing.h.
+ */
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "geometry/mesh.h"
+#include "geometry/mesh_processing.h"
+#include "jobs/job_system.h"
+#include "resource/resource_metadata.h"
+#include "test.h"
+
+namespace {
+
+using ogle::JobSystem;
+using ogle::Mesh;
+using ogle::MeshProcessing;
+using ogle::ResourceMetadata;
+using ogle::Vector2f;
+using ogle::Vector3f;
+using ogle::Vector4f;
+
+/// Quads along each side of the test height field. Large enough that both
+/// passes split into several blocks.
+constexpr int kGridSize = 300;
+
+/**
+ * @brief Builds a welded, textured height field of triangles.
+ * @param[out] mesh Mesh to add to.
+ */
+void BuildHeightField(Mesh* mesh) {
+  auto corner = [](const int x, const int z, Vector3f* vertex, Vector2f* uv) {
+    *vertex = {static_cast<float>(x),
+               std::sin(x * 0.1f) * std::cos(z * 0.07f) * 4.f,
+               static_cast<float>(z)};
+    *uv = {x / static_cast<float>(kGridSize),
+           z / static_cast<float>(kGridSize)};
+  };
+  mesh->BeginWelding();
+  for (int z = 0; z < kGridSize; ++z) {
+    for (int x = 0; x < kGridSize; ++x) {
+      Vector3f vertices[4];
+      Vector2f uvs[4];
+      corner(x, z, &vertices[0], &uvs[0]);
+      corner(x + 1, z, &vertices[1], &uvs[1]);
+      corner(x + 1, z + 1, &vertices[2], &uvs[2]);
+      corner(x, z + 1, &vertices[3], &uvs[3]);
+      const Vector3f first[3] = {vertices[0], vertices[2], vertices[1]};
+      const Vector2f first_uvs[3] = {uvs[0], uvs[2], uvs[1]};
+      const Vector3f second[3] = {vertices[0], vertices[3], vertices[2]};
+      const Vector2f second_uvs[3] = {uvs[0], uvs[3], uvs[2]};
+      mesh->AddTriangle(first, first_uvs, nullptr);
+      mesh->AddTriangle(second, second_uvs, nullptr);
+    }
+  }
+  mesh->EndWelding();
+}
+
+/**
+ * @brief Computes angle-weighted normals and tangents of a new height field.
+ * @param num_threads Threads to start when job_system is null.
+ * @param job_system Job system to run on, or null.
+ * @param[out] normals Vertex normals.
+ * @param[out] tangents Vertex tangents.
+ */
+void ComputeHeightFieldNormals(const int num_threads, JobSystem* job_system,
+                               std::vector<Vector3f>* normals,
+                               ogle::stl_vector<Vector4f>* tangents) {
+  const ResourceMetadata metadata{};
+  Mesh mesh(metadata);
+  BuildHeightField(&mesh);
+  MeshProcessing::ComputeVertexNormals(
+      &mesh, MeshProcessing::NormalWeighting::ANGLE, tangents, num_threads,
+      job_system);
+  normals->clear();
+  for (const auto& vertex : mesh.mesh_vertices()) {
+    normals->push_back(vertex.vertex_normal);
+  }
+}
+
+}  // namespace
+
+OGLE_TEST(mesh_processing, VertexNormalsMatchAcrossJobsAndThreads) {
+  std::vector<Vector3f> serial_normals;
+  ogle::stl_vector<Vector4f> serial_tangents;
+  ComputeHeightFieldNormals(1, nullptr, &serial_normals, &serial_tangents);
+  EXPECT(serial_normals.size() == (kGridSize + 1) * (kGridSize + 1))
+      << "Welded into " << serial_normals.size() << " vertices.";
+  for (const auto& normal : serial_normals) {
+    EXPECT(std::abs(normal.Norm() - 1.0) < 1e-4 && normal.y() > 0.f);
+    if (std::abs(normal.Norm() - 1.0) >= 1e-4 || normal.y() <= 0.f) {
+      break;
+    }
+  }
+
+  // Every vertex sums its faces in the same order, so results are exact.
+  std::vector<Vector3f> normals;
+  ogle::stl_vector<Vector4f> tangents;
+  ComputeHeightFieldNormals(4, nullptr, &normals, &tangents);
+  EXPECT(normals == serial_normals && tangents == serial_tangents)
+      << "Threads changed normals or tangents.";
+  for (const int num_workers : {0, 1, 3}) {
+    JobSystem job_system(num_workers);
+    ComputeHeightFieldNormals(1, &job_system, &normals, &tangents);
+    EXPECT(normals == serial_normals && tangents == serial_tangents)
+        << "Jobs on " << num_workers << " workers changed normals or "
+        << "tangents.";
+  }
+}
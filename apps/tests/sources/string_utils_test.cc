@@ -0,0 +1,101 @@
+/**
+ * @file Tests util/string_utils.h.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "test.h"
+#include "util/string_utils.h"
+
+namespace {
+
+/**
+ * @brief Parses text with ParseFloat and expects the same bits as strtof.
+ * @param text Number to parse.
+ */
+void ExpectParsesLikeStrtof(const char* text) {
+  const char* cursor = text;
+  const char* end = text + std::strlen(text);
+  float value = 0.f;
+  EXPECT(ogle::StringUtils::ParseFloat(&cursor, end, &value))
+      << "Failed to parse " << text;
+  EXPECT(cursor == end) << "Did not consume all of " << text;
+
+  const float expected = std::strtof(text, nullptr);
+  std::uint32_t bits;
+  std::uint32_t expected_bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  std::memcpy(&expected_bits, &expected, sizeof(expected_bits));
+  EXPECT(bits == expected_bits)
+      << text << " parsed as " << value << ", strtof gives " << expected;
+}
+
+}  // namespace
+
+OGLE_TEST(string_utils, ParseFloatSimple) {
+  for (const char* text : {"0", "-0", "1", "-1.5", "0.1", "3.14159",
+                           "1e10", "1.5E-3", "+2.25", "123456789",
+                           "0.000001", "3.4028234e38", "1e-40"}) {
+    ExpectParsesLikeStrtof(text);
+  }
+}
+
+OGLE_TEST(string_utils, ParseFloatNearFloatHalfway) {
+  // These are exactly halfway between two floats once rounded to double, so
+  // rounding the double to float rounds the wrong way.
+  for (const char* text : {"0.663928896188736", "0.0869813822209835",
+                           "6.78088641166687"}) {
+    ExpectParsesLikeStrtof(text);
+  }
+
+  // Find more: round the midpoint of two floats to 15 digits, and keep the
+  // text if it converts back to exactly that midpoint. Below 1 midpoints
+  // have long decimal expansions, so this often happens.
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> distribution(0.001f, 1.f);
+  int num_found = 0;
+  for (int attempt = 0; attempt < 100000 && num_found < 200; ++attempt) {
+    const float lower = distribution(random);
+    const float upper = std::nextafter(lower, 2.f);
+    const double midpoint = (static_cast<double>(lower) + upper) / 2.0;
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.15g", midpoint);
+    if (std::strtod(text, nullptr) == midpoint) {
+      ExpectParsesLikeStrtof(text);
+      ++num_found;
+    }
+  }
+  EXPECT(num_found == 200) << "Found only " << num_found << " cases.";
+}
+
+OGLE_TEST(string_utils, ParseFloatRandom) {
+  std::mt19937 random(2);
+  std::uniform_int_distribution<int> num_digits_distribution(1, 18);
+  std::uniform_int_distribution<int> digit_distribution(0, 9);
+  std::uniform_int_distribution<int> exponent_distribution(-30, 30);
+  for (int index = 0; index < 100000; ++index) {
+    char text[48];
+    int length = 0;
+    if (digit_distribution(random) < 5) {
+      text[length++] = '-';
+    }
+    const int num_digits = num_digits_distribution(random);
+    const int point = std::uniform_int_distribution<int>(0, num_digits)(random);
+    for (int digit = 0; digit < num_digits; ++digit) {
+      if (digit == point) {
+        text[length++] = '.';
+      }
+      text[length++] = static_cast<char>('0' + digit_distribution(random));
+    }
+    if (digit_distribution(random) < 3) {
+      length += std::snprintf(text + length, sizeof(text) - length, "e%d",
+                              exponent_distribution(random));
+    }
+    text[length] = '\0';
+    ExpectParsesLikeStrtof(text);
+  }
+}
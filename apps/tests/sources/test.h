@@ -0,0 +1,82 @@
+/**
+ * @file test.h
+ * @brief Minimal test registration and checking macros.
+ */
+
+#pragma once
+
+#include <sstream>
+#include <string>
+
+namespace ogle_test {
+
+/// A test function.
+using TestFunction = void (*)();
+
+/**
+ * @brief Registers a test when constructed. Used by OGLE_TEST.
+ */
+class TestRegistration {
+ public:
+  /**
+   * @brief Constructor.
+   * @param group Name of group the test belongs to, such as a module.
+   * @param name Name of test.
+   * @param function Function that runs the test.
+   */
+  TestRegistration(const char* group, const char* name,
+                   TestFunction function);
+};
+
+/**
+ * @brief Records a failed expectation, with a message streamed into it.
+ *        May be used from any thread.
+ */
+class Failure {
+ public:
+  /**
+   * @brief Constructor.
+   * @param file Source file of expectation.
+   * @param line Source line of expectation.
+   * @param condition Text of condition that was false.
+   */
+  Failure(const char* file, int line, const char* condition);
+
+  /**
+   * @brief Destructor. Reports the failure.
+   */
+  ~Failure();
+
+  /**
+   * @brief Accessor.
+   * @return Stream for a message explaining the failure.
+   */
+  std::ostream& stream();
+
+ private:
+  /// Message being built.
+  std::ostringstream message_;
+};
+
+/**
+ * @brief Marks the running test as skipped, such as when the machine lacks
+ *        something it needs. The test should return afterwards.
+ * @param reason Why the test cannot run.
+ */
+void Skip(const std::string& reason);
+
+}  // namespace ogle_test
+
+/// Defines a test function and registers it under a group.
+#define OGLE_TEST(group, name)                                         \
+  static void group##_##name();                                        \
+  static ogle_test::TestRegistration group##_##name##_registration(    \
+      #group, #name, group##_##name);                                  \
+  static void group##_##name()
+
+/// Fails the running test if condition is false, and continues it. A
+/// message may be streamed after it.
+#define EXPECT(condition)  \
+  if (condition) {         \
+  } else                   \
+    ogle_test::Failure(__FILE__, __LINE__, #condition).stream()
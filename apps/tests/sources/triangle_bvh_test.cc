@@ -0,0 +1,327 @@
+/**
+ * @file Tests geometry/triangle_bvh.h against brute force, and picking
+ *       through SceneGraph.
+ */
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include "entity/entity.h"
+#include "geometry/mesh.h"
+#include "geometry/triangle_bvh.h"
+#include "jobs/job_system.h"
+#include "math/angle.h"
+#include "renderer/renderer.h"
+#include "renderer/scene_graph.h"
+#include "resource/resource_metadata.h"
+#include "test.h"
+
+namespace {
+
+using ogle::Angle;
+using ogle::Bounds;
+using ogle::Entity;
+using ogle::JobSystem;
+using ogle::Mesh;
+using ogle::Ray;
+using ogle::Renderer;
+using ogle::ResourceMetadata;
+using ogle::SceneGraph;
+using ogle::Transform;
+using ogle::TriangleBVH;
+using ogle::Vector3f;
+
+/// Distance that rays search.
+constexpr float kMaxDistance = 1000.f;
+
+/**
+ * @brief Adds the 12 triangles of an axis-aligned cube to a mesh.
+ * @param corner Corner with the least coordinates.
+ * @param size Length of edges.
+ * @param[out] mesh Mesh to add to.
+ */
+void AddCube(const Vector3f& corner, const float size, Mesh* mesh) {
+  // Each face is a quad of 4 corners, given by the bits of their indices.
+  static const int kFaces[6][4] = {{0, 2, 6, 4}, {1, 5, 7, 3}, {0, 4, 5, 1},
+                                   {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 6, 7, 5}};
+  Vector3f corners[8];
+  for (int index = 0; index < 8; ++index) {
+    corners[index] = corner + Vector3f{(index & 4) ? size : 0.f,
+                                       (index & 2) ? size : 0.f,
+                                       (index & 1) ? size : 0.f};
+  }
+  for (const auto& face : kFaces) {
+    const Vector3f first[3] = {corners[face[0]], corners[face[1]],
+                               corners[face[2]]};
+    const Vector3f second[3] = {corners[face[0]], corners[face[2]],
+                                corners[face[3]]};
+    mesh->AddTriangle(first, nullptr, nullptr);
+    mesh->AddTriangle(second, nullptr, nullptr);
+  }
+}
+
+/**
+ * @brief Adds the 12 triangles of a box centered on the origin to a mesh.
+ * @param extents Half the size of the box along each axis.
+ * @param[out] mesh Mesh to add to.
+ */
+void AddCenteredBox(const Vector3f& extents, Mesh* mesh) {
+  const Vector3f corner = -extents;
+  const Vector3f size = extents * 2.f;
+  static const int kFaces[6][4] = {{0, 2, 6, 4}, {1, 5, 7, 3}, {0, 4, 5, 1},
+                                   {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 6, 7, 5}};
+  Vector3f corners[8];
+  for (int index = 0; index < 8; ++index) {
+    corners[index] = corner + Vector3f{(index & 4) ? size.x() : 0.f,
+                                       (index & 2) ? size.y() : 0.f,
+                                       (index & 1) ? size.z() : 0.f};
+  }
+  for (const auto& face : kFaces) {
+    const Vector3f first[3] = {corners[face[0]], corners[face[1]],
+                               corners[face[2]]};
+    const Vector3f second[3] = {corners[face[0]], corners[face[2]],
+                                corners[face[3]]};
+    mesh->AddTriangle(first, nullptr, nullptr);
+    mesh->AddTriangle(second, nullptr, nullptr);
+  }
+}
+
+/**
+ * @brief Renderer that draws nothing, with the bounds and BVH of a Mesh.
+ */
+class PickableRenderer : public Renderer {
+ public:
+  /**
+   * @brief Constructor.
+   * @param mesh Mesh to pick, with bounds computed.
+   * @param has_bvh Whether the Mesh's BVH is reported, so that the Entity
+   *        can be picked.
+   */
+  PickableRenderer(const Mesh& mesh, const bool has_bvh)
+    : mesh_(mesh), has_bvh_(has_bvh) {}
+
+  void Render(const Transform&, const Entity&,
+              const ogle::stl_vector<const Entity*>&) override {}
+
+  const Bounds* local_bounds() const override { return &mesh_.bounds(); }
+
+  const TriangleBVH* local_bvh() const override {
+    return has_bvh_ ? mesh_.bvh() : nullptr;
+  }
+
+ private:
+  const Mesh& mesh_;
+  const bool has_bvh_;
+};
+
+/**
+ * @brief Adds an Entity with a PickableRenderer beneath a SceneGraph's root.
+ * @param mesh Mesh to pick.
+ * @param has_bvh Whether the Entity can be picked.
+ * @param position World position of Entity.
+ * @param[out] scene_graph Scene to add to.
+ * @return New Entity, owned by the caller.
+ */
+std::unique_ptr<Entity> AddPickableEntity(const Mesh& mesh,
+                                          const bool has_bvh,
+                                          const Vector3f& position,
+                                          SceneGraph* scene_graph) {
+  std::unique_ptr<Entity> entity(
+      new Entity(&scene_graph->root_->transform_));
+  entity->transform_.set_world_position(position);
+  entity->AddComponent(std::unique_ptr<Renderer>(
+      new PickableRenderer(mesh, has_bvh)));
+  return entity;
+}
+
+/**
+ * @brief Builds a mesh of a grid of cubes on integer coordinates, whose faces
+ *        are also faces of BVH node boxes, and a soup of random triangles.
+ * @param num_random_triangles Number of random triangles.
+ * @param[out] mesh Mesh to add to.
+ */
+void BuildTestMesh(const int num_random_triangles, Mesh* mesh) {
+  for (int x = 0; x < 8; ++x) {
+    for (int y = 0; y < 8; ++y) {
+      for (int z = 0; z < 4; ++z) {
+        AddCube(Vector3f{2.f * x, 2.f * y, 2.f * z}, 1.f, mesh);
+      }
+    }
+  }
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> position(-20.f, 40.f);
+  std::uniform_real_distribution<float> offset(-1.f, 1.f);
+  for (int i = 0; i < num_random_triangles; ++i) {
+    const Vector3f center{position(rng), position(rng), position(rng)};
+    const Vector3f vertices[3] = {
+        center + Vector3f{offset(rng), offset(rng), offset(rng)},
+        center + Vector3f{offset(rng), offset(rng), offset(rng)},
+        center + Vector3f{offset(rng), offset(rng), offset(rng)}};
+    mesh->AddTriangle(vertices, nullptr, nullptr);
+  }
+}
+
+/**
+ * @brief Makes rays in random directions, and rays along axes that start on
+ *        and graze the faces of the cubes built by BuildTestMesh().
+ * @return Rays, a multiple of TriangleBVH::kPacketSize in number.
+ */
+std::vector<Ray<float, 3>> MakeRays() {
+  std::vector<Ray<float, 3>> rays;
+  std::mt19937 rng;
+  std::uniform_real_distribution<float> position(-20.f, 40.f);
+  std::uniform_real_distribution<float> direction(-1.f, 1.f);
+  for (int i = 0; i < 2000; ++i) {
+    rays.emplace_back(
+        Vector3f{position(rng), position(rng), position(rng)},
+        Vector3f{direction(rng), direction(rng), direction(rng)});
+  }
+
+  // Both signs of zero, which give opposite infinities as reciprocals.
+  std::uniform_int_distribution<int> coordinate(-1, 16);
+  for (int i = 0; i < 2000; ++i) {
+    const int axis = i % 3;
+    const float sign = (i & 4) ? -1.f : 1.f;
+    const float zero = (i & 8) ? -0.f : 0.f;
+    Vector3f ray_direction{zero, zero, zero};
+    ray_direction(axis) = sign;
+    Vector3f origin{static_cast<float>(coordinate(rng)),
+                    static_cast<float>(coordinate(rng)),
+                    static_cast<float>(coordinate(rng))};
+    origin(axis) = (sign > 0.f) ? -5.f : 25.f;
+    rays.emplace_back(origin, ray_direction);
+  }
+  return rays;
+}
+
+/**
+ * @brief Checks every query of a BVH against brute force over its mesh.
+ * @param mesh Mesh the BVH was built over.
+ * @param bvh BVH to check.
+ */
+void ExpectMatchesBruteForce(const Mesh& mesh, const TriangleBVH& bvh) {
+  const auto rays = MakeRays();
+  std::vector<TriangleBVH::Hit> expected(rays.size());
+  int num_hits = 0;
+  for (size_t index = 0; index < rays.size(); ++index) {
+    const Ray<float, 3>& ray = rays[index];
+    const bool hit_expected = TriangleBVH::ClosestHitBruteForce(
+        mesh, ray, kMaxDistance, &expected[index]);
+    num_hits += hit_expected ? 1 : 0;
+
+    // Equally distant faces may be found in either order, so only the
+    // distance must match.
+    TriangleBVH::Hit hit;
+    EXPECT(bvh.ClosestHit(ray, kMaxDistance, &hit) == hit_expected)
+        << "ClosestHit disagrees on ray " << index;
+    EXPECT(hit.distance == expected[index].distance)
+        << "ClosestHit of ray " << index << " at " << hit.distance
+        << ", expected " << expected[index].distance;
+    EXPECT(bvh.AnyHit(ray, kMaxDistance) == hit_expected)
+        << "AnyHit disagrees on ray " << index;
+  }
+  EXPECT(num_hits > static_cast<int>(rays.size()) / 4)
+      << "Only " << num_hits << " rays hit.";
+
+  // Packets may be computed with different instructions, so allow rounding.
+  for (size_t first = 0; first < rays.size();
+       first += TriangleBVH::kPacketSize) {
+    TriangleBVH::Hit hits[TriangleBVH::kPacketSize];
+    bvh.ClosestHitPacket(&rays[first], kMaxDistance, hits);
+    for (int lane = 0; lane < TriangleBVH::kPacketSize; ++lane) {
+      const TriangleBVH::Hit& expected_hit = expected[first + lane];
+      EXPECT((hits[lane].face == Mesh::kInvalidIndex) ==
+             (expected_hit.face == Mesh::kInvalidIndex))
+          << "ClosestHitPacket disagrees on ray " << first + lane;
+      EXPECT(std::abs(hits[lane].distance - expected_hit.distance) <=
+             1e-4f * expected_hit.distance)
+          << "ClosestHitPacket of ray " << first + lane << " at "
+          << hits[lane].distance << ", expected " << expected_hit.distance;
+    }
+  }
+}
+
+}  // namespace
+
+OGLE_TEST(triangle_bvh, MatchesBruteForce) {
+  const ResourceMetadata metadata{};
+  Mesh mesh(metadata);
+  BuildTestMesh(5000, &mesh);
+  const TriangleBVH bvh(mesh, nullptr);
+  ExpectMatchesBruteForce(mesh, bvh);
+}
+
+OGLE_TEST(triangle_bvh, JobsBuildSameTree) {
+  // Enough triangles that subtrees are built in jobs.
+  const ResourceMetadata metadata{};
+  Mesh mesh(metadata);
+  BuildTestMesh(200000, &mesh);
+  const TriangleBVH serial_bvh(mesh, nullptr);
+  JobSystem job_system(3);
+  const TriangleBVH bvh(mesh, &job_system);
+  EXPECT(bvh.num_nodes() == serial_bvh.num_nodes());
+  for (const auto& ray : MakeRays()) {
+    TriangleBVH::Hit hit;
+    TriangleBVH::Hit serial_hit;
+    bvh.ClosestHit(ray, kMaxDistance, &hit);
+    serial_bvh.ClosestHit(ray, kMaxDistance, &serial_hit);
+    EXPECT(hit.face == serial_hit.face && hit.distance == serial_hit.distance)
+        << "Hit face " << hit.face << ", expected " << serial_hit.face;
+  }
+}
+
+OGLE_TEST(triangle_bvh, EmptyMesh) {
+  const ResourceMetadata metadata{};
+  const Mesh mesh(metadata);
+  const TriangleBVH bvh(mesh, nullptr);
+  const Ray<float, 3> ray(Vector3f::Zero(), Vector3f{1.f, 0.f, 0.f});
+  TriangleBVH::Hit hit;
+  EXPECT(!bvh.ClosestHit(ray, kMaxDistance, &hit));
+  EXPECT(!bvh.AnyHit(ray, kMaxDistance));
+  EXPECT(bvh.num_nodes() == 0);
+}
+
+OGLE_TEST(triangle_bvh, SceneGraphPicksNearestEntity) {
+  const ResourceMetadata metadata{};
+  Mesh cube(metadata);
+  AddCenteredBox(Vector3f{0.5f, 0.5f, 0.5f}, &cube);
+  cube.ComputeBounds();
+  cube.BuildBVH(nullptr);
+  Mesh rod(metadata);
+  AddCenteredBox(Vector3f{1.f, 0.1f, 0.1f}, &rod);
+  rod.ComputeBounds();
+  rod.BuildBVH(nullptr);
+
+  SceneGraph scene_graph;
+  const auto unpickable =
+      AddPickableEntity(cube, false, Vector3f{5.f, 0.f, 0.f}, &scene_graph);
+  const auto near_cube =
+      AddPickableEntity(cube, true, Vector3f{10.f, 0.f, 0.f}, &scene_graph);
+  const auto far_cube =
+      AddPickableEntity(cube, true, Vector3f{20.f, 0.f, 0.f}, &scene_graph);
+  const auto turned_rod =
+      AddPickableEntity(rod, true, Vector3f{0.f, 3.f, 0.f}, &scene_graph);
+  turned_rod->transform_.set_world_orientation(
+      Angle::FromDegrees(90.f), Angle(0.f), Angle(0.f));
+
+  float distance = 0.f;
+  const Ray<float, 3> x_ray(Vector3f::Zero(), Vector3f{1.f, 0.f, 0.f});
+  EXPECT(scene_graph.Pick(x_ray, 1000.f, &distance) == near_cube.get());
+  EXPECT(std::abs(distance - 9.5f) < 1e-4f) << "Picked at " << distance;
+  EXPECT(scene_graph.Pick(x_ray, 9.f, &distance) == nullptr);
+
+  near_cube->transform_.set_world_position(Vector3f{10.f, 5.f, 0.f});
+  EXPECT(scene_graph.Pick(x_ray, 1000.f, &distance) == far_cube.get());
+  EXPECT(std::abs(distance - 19.5f) < 1e-4f) << "Picked at " << distance;
+
+  // The rod lies along z once turned, so it's hit at its end, and is too
+  // thin to be hit half a unit from its axis.
+  const Ray<float, 3> z_ray(Vector3f{0.f, 3.f, -20.f},
+                            Vector3f{0.f, 0.f, 1.f});
+  EXPECT(scene_graph.Pick(z_ray, 1000.f, &distance) == turned_rod.get());
+  EXPECT(std::abs(distance - 19.f) < 1e-4f) << "Picked at " << distance;
+  const Ray<float, 3> offset_z_ray(Vector3f{0.5f, 3.f, -20.f},
+                                   Vector3f{0.f, 0.f, 1.f});
+  EXPECT(scene_graph.Pick(offset_z_ray, 1000.f, &distance) == nullptr);
+}
@@ -6,7 +6,9 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include <algorithm>
 #include <functional>
+#include <limits>
 #include <utility>
 #include "easylogging++.h"  // NOLINT
 
@@ -17,6 +19,13 @@ namespace ogle {
  *
  * KeyType is used to uniquely identify nodes. ValueType describes the data
  * stored in each node.
+ *
+ * The graph tracks which nodes have no outgoing edges, so that nodes may be
+ * visited in topological order (Kahn's algorithm): take the ready nodes with
+ * TakeReady(), then Remove() them, which readies nodes whose only edges
+ * were to them. Each edge keeps its position in both nodes' edge lists, so
+ * removing a node costs time proportional to its number of edges, and adding
+ * an edge time proportional to the smaller degree of its two nodes.
  */
 template<typename KeyType, typename ValueType>
 class DirectedGraph {
@@ -35,7 +44,7 @@ class DirectedGraph {
      * @param value Value to store in node.
      */
     explicit Node(const ValueType& value)
-      : value_(value) {
+      : value_(value), key_(nullptr), ready_index_(kNotReady) {
     }
 
     /**
@@ -58,11 +67,32 @@ class DirectedGraph {
     ValueType value_;
 
    private:
+    /// Value of #ready_index_ for nodes with outgoing edges.
+    static constexpr std::size_t kNotReady =
+        std::numeric_limits<std::size_t>::max();
+
+    /// Value of #ready_index_ for ready nodes returned by TakeReady().
+    static constexpr std::size_t kTaken = kNotReady - 1;
+
+    /// Key of this node, kept by the graph.
+    const KeyType* key_;
+
     /// Nodes this node has an edge to.
     stl_vector<Node*> neighbors_;
 
+    /// Index of each edge in #neighbors_ within the destination node's
+    /// #back_pointers_.
+    stl_vector<std::size_t> neighbor_slots_;
+
     /// Nodes with an edge back to this node.
     stl_vector<Node*> back_pointers_;
+
+    /// Index of each edge in #back_pointers_ within the source node's
+    /// #neighbors_.
+    stl_vector<std::size_t> back_pointer_slots_;
+
+    /// Index in the graph's ready list, #kNotReady, or #kTaken.
+    std::size_t ready_index_;
   };
 
   /**
@@ -77,7 +107,14 @@ class DirectedGraph {
    * @return true if node was inserted, false if key is duplicate.
    */
   const bool AddNode(const KeyType& key, const ValueType& value) {
-    return nodes_.emplace(key, Node(value)).second;
+    const auto result = nodes_.emplace(key, Node(value));
+    if (!result.second) {
+      return false;
+    }
+    Node* node = &result.first->second;
+    node->key_ = &result.first->first;
+    MarkReady(node);
+    return true;
   }
 
   /**
@@ -103,18 +140,25 @@ class DirectedGraph {
     Node* dest_node = &dest_it->second;
     CHECK(src_node != nullptr && dest_node != nullptr)
         << "Both nodes must exist if keys are found to add an edge.";
-    auto back_it = std::find(dest_node->back_pointers_.begin(),
-                             dest_node->back_pointers_.end(), src_node);
-    if (std::find(src_node->neighbors_.begin(), src_node->neighbors_.end(),
-                  dest_node) != src_node->neighbors_.end()) {
-      CHECK(back_it != dest_node->back_pointers_.end())
-          << "Expected to find back pointer.";
+
+    // An edge is in both nodes' lists, so search the shorter. Nodes that
+    // many others depend on have long back pointer lists.
+    const bool exists =
+        (src_node->neighbors_.size() <= dest_node->back_pointers_.size()) ?
+        std::find(src_node->neighbors_.begin(), src_node->neighbors_.end(),
+                  dest_node) != src_node->neighbors_.end() :
+        std::find(dest_node->back_pointers_.begin(),
+                  dest_node->back_pointers_.end(), src_node) !=
+            dest_node->back_pointers_.end();
+    if (exists) {
       return false;
     }
-    CHECK(back_it == dest_node->back_pointers_.end())
-        << "Expected not to find back pointer.";
     src_node->neighbors_.emplace_back(dest_node);
+    src_node->neighbor_slots_.emplace_back(dest_node->back_pointers_.size());
     dest_node->back_pointers_.emplace_back(src_node);
+    dest_node->back_pointer_slots_.emplace_back(
+        src_node->neighbors_.size() - 1);
+    MarkNotReady(src_node);
     return true;
   }
 
@@ -142,13 +186,16 @@ class DirectedGraph {
       const KeyType& key) const {
     const auto node_it = nodes_.find(key);
     if (node_it != nodes_.end()) {
-      return {node_it->neighbors_, true};
+      return {node_it->second.neighbors_, true};
     }
     return {{}, false};
   }
 
   /**
    * @brief Remove a node and all connecting edges from the graph.
+   *
+   * Nodes left without outgoing edges become ready.
+   *
    * @param key Identifies node to remove.
    * @return Flag indicating whether node was removed.
    */
@@ -156,15 +203,17 @@ class DirectedGraph {
     auto node_it = nodes_.find(key);
     if (node_it != nodes_.end()) {
       Node* node = &node_it->second;
-      for (Node* dest_node : node->neighbors_) {
-        dest_node->back_pointers_.erase(std::find(
-            dest_node->back_pointers_.begin(), dest_node->back_pointers_.end(),
-            node));
+      for (std::size_t i = 0; i < node->neighbors_.size(); ++i) {
+        EraseBackPointer(node->neighbors_[i], node->neighbor_slots_[i]);
       }
-      for (Node* src_node : node->back_pointers_) {
-        src_node->neighbors_.erase(std::find(
-            src_node->neighbors_.begin(), src_node->neighbors_.end(), node));
+      for (std::size_t i = 0; i < node->back_pointers_.size(); ++i) {
+        Node* src_node = node->back_pointers_[i];
+        EraseNeighbor(src_node, node->back_pointer_slots_[i]);
+        if (src_node->neighbors_.empty()) {
+          MarkReady(src_node);
+        }
       }
+      MarkNotReady(node);
       nodes_.erase(node_it);
       return true;
     }
@@ -187,6 +236,37 @@ class DirectedGraph {
     return nodes_.size();
   }
 
+  /**
+   * @brief Simple query.
+   * @return Number of nodes with no outgoing edges that TakeReady() has not
+   *         returned.
+   */
+  const std::size_t NumReady() const {
+    return ready_.size();
+  }
+
+  /**
+   * @brief Takes the nodes with no outgoing edges that have not been taken
+   *        already.
+   *
+   * Taken nodes stay in the graph until removed. Removing them readies the
+   * next level of nodes, so repeatedly taking and removing the ready nodes
+   * visits the graph in topological order, one level at a time. If nodes
+   * remain but none are ready, the remaining nodes contain a cycle.
+   *
+   * @return Keys and values of nodes taken.
+   */
+  stl_vector<std::pair<const KeyType&, ValueType*>> TakeReady() {
+    stl_vector<std::pair<const KeyType&, ValueType*>> results;
+    results.reserve(ready_.size());
+    for (Node* node : ready_) {
+      node->ready_index_ = Node::kTaken;
+      results.emplace_back(*node->key_, &node->value_);
+    }
+    ready_.clear();
+    return results;
+  }
+
   /**
    * @brief Retrieves nodes matching a condition.
    * @param match_function A #MatchFunction to test conditions on a Node.
@@ -204,8 +284,76 @@ class DirectedGraph {
   }
 
  private:
+  /**
+   * @brief Adds a node to the ready list, unless it's there or taken.
+   * @param node Node without outgoing edges.
+   */
+  void MarkReady(Node* node) {
+    if (node->ready_index_ == Node::kNotReady) {
+      node->ready_index_ = ready_.size();
+      ready_.emplace_back(node);
+    }
+  }
+
+  /**
+   * @brief Removes a node from the ready list, and clears whether it was
+   *        taken.
+   * @param node Node to remove.
+   */
+  void MarkNotReady(Node* node) {
+    const std::size_t index = node->ready_index_;
+    node->ready_index_ = Node::kNotReady;
+    if (index == Node::kNotReady || index == Node::kTaken) {
+      return;
+    }
+    Node* last = ready_.back();
+    ready_[index] = last;
+    last->ready_index_ = index;
+    ready_.pop_back();
+    node->ready_index_ = Node::kNotReady;
+  }
+
+  /**
+   * @brief Erases an edge from a node's #neighbors_ by moving the last edge
+   *        into its place.
+   * @param node Source node of edge.
+   * @param index Index of edge in node's #neighbors_.
+   */
+  void EraseNeighbor(Node* node, const std::size_t index) {
+    const std::size_t last = node->neighbors_.size() - 1;
+    if (index != last) {
+      node->neighbors_[index] = node->neighbors_[last];
+      node->neighbor_slots_[index] = node->neighbor_slots_[last];
+      node->neighbors_[index]->back_pointer_slots_[
+          node->neighbor_slots_[index]] = index;
+    }
+    node->neighbors_.pop_back();
+    node->neighbor_slots_.pop_back();
+  }
+
+  /**
+   * @brief Erases an edge from a node's #back_pointers_ by moving the last
+   *        edge into its place.
+   * @param node Destination node of edge.
+   * @param index Index of edge in node's #back_pointers_.
+   */
+  void EraseBackPointer(Node* node, const std::size_t index) {
+    const std::size_t last = node->back_pointers_.size() - 1;
+    if (index != last) {
+      node->back_pointers_[index] = node->back_pointers_[last];
+      node->back_pointer_slots_[index] = node->back_pointer_slots_[last];
+      node->back_pointers_[index]->neighbor_slots_[
+          node->back_pointer_slots_[index]] = index;
+    }
+    node->back_pointers_.pop_back();
+    node->back_pointer_slots_.pop_back();
+  }
+
   /// All nodes in graph, keyed by unique ID.
   stl_unordered_map<KeyType, Node> nodes_;
+
+  /// Nodes with no outgoing edges, not yet taken by TakeReady().
+  stl_vector<Node*> ready_;
 };
 
 }  // namespace ogle
@@ -8,6 +8,7 @@
 #include "std/ogle_std.inc"
 #include "config/configuration.h"
 #include "input/keyboard_input.h"
+#include "jobs/job_system.h"
 #include "window/window.h"
 #include "renderer/scene_graph.h"
 #include "renderer/scene_renderer.h"
@@ -60,6 +61,10 @@ class Engine {
   /// Engine configuration.
   Configuration configuration_;
 
+  /// Job system, for subsystems to offload work to. Declared first so that
+  /// it outlives other subsystems, whose jobs may still be running.
+  std::unique_ptr<JobSystem> job_system_;
+
   /// ResourceManager handle.
   std::unique_ptr<ResourceManager> resource_manager_;
 
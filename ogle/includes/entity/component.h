@@ -40,6 +40,20 @@ class Component {
    */
   virtual ~Component() = default;
 
+  /**
+   * @brief Allocates memory for a Component from pools shared by all of them.
+   * @param size Size in bytes.
+   * @return Memory.
+   */
+  static void* operator new(std::size_t size);
+
+  /**
+   * @brief Frees memory allocated for a Component.
+   * @param memory Memory to free.
+   * @param size Size in bytes.
+   */
+  static void operator delete(void* memory, std::size_t size);
+
   /**
    * @brief Accessor.
    * @returns owning entity.
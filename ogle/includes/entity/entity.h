@@ -29,6 +29,20 @@ class Entity {
    */
   explicit Entity(Transform *parent);
 
+  /**
+   * @brief Allocates memory for an Entity from pools shared by all of them.
+   * @param size Size in bytes.
+   * @return Memory.
+   */
+  static void* operator new(std::size_t size);
+
+  /**
+   * @brief Frees memory allocated for an Entity.
+   * @param memory Memory to free.
+   * @param size Size in bytes.
+   */
+  static void operator delete(void* memory, std::size_t size);
+
   /**
    * @brief Renders this Entity.
    *
@@ -43,7 +57,8 @@ class Entity {
   /**
    * @brief Adds component to this entity.
    *
-   * Only one component of a given type can be added at once.
+   * Only one component of a given type can be added at once. Adding a
+   * Renderer sets the bounds of the Entity's Transform.
    *
    * @param component Component to add. Will be owned by entity afterwards.
    * @return success/failure.
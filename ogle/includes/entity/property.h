@@ -40,6 +40,25 @@ class Property {
    */
   Property(const stl_string& name, const stl_vector<PropertyDimIndex>& dims);
 
+  /**
+   * @brief Destructor. Allows inheritance.
+   */
+  virtual ~Property() = default;
+
+  /**
+   * @brief Allocates memory for a Property from pools shared by all of them.
+   * @param size Size in bytes.
+   * @return Memory.
+   */
+  static void* operator new(std::size_t size);
+
+  /**
+   * @brief Frees memory allocated for a Property.
+   * @param memory Memory to free.
+   * @param size Size in bytes.
+   */
+  static void operator delete(void* memory, std::size_t size);
+
   /**
    * @brief Returns true if this is a single value (0-dimensional).
    */
@@ -90,7 +109,7 @@ class Property {
   /**
    * @brief Returns property dimensions.
    */
-  const stl_vector<PropertyDimIndex> dims() const;
+  const stl_vector<PropertyDimIndex>& dims() const;
 
   /**
    * @brief Returns a copy of this property.
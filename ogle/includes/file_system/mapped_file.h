@@ -0,0 +1,69 @@
+/**
+ * @file mapped_file.h
+ * @brief Defines MappedFile.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include "file_system/file_path.h"
+
+namespace ogle {
+
+/**
+ * @brief A file mapped read-only into memory.
+ *
+ * Pages are loaded by the operating system as they are touched, so opening
+ * a mapped file costs nearly nothing and reading it costs no extra copy.
+ */
+class MappedFile {
+ public:
+  /**
+   * @brief Default constructor. No file is mapped.
+   */
+  MappedFile() = default;
+
+  /**
+   * @brief Destructor. Unmaps file.
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * @brief Maps a file, unmapping any file already mapped.
+   *
+   * A missing file is not logged as an error, so optional files such as
+   * caches can be opened without checking for them first.
+   *
+   * @param file_path Path to file to map.
+   * @return Whether the operation was completed successfully.
+   */
+  const bool Open(const FilePath& file_path);
+
+  /**
+   * @brief Unmaps file, if one is mapped.
+   */
+  void Close();
+
+  /**
+   * @brief Returns start of mapped contents. Null if nothing is mapped or the
+   *        file is empty.
+   */
+  const char* data() const;
+
+  /**
+   * @brief Returns size of mapped contents in bytes.
+   */
+  std::size_t size() const;
+
+ private:
+  /// Start of mapped contents.
+  const char* data_ = nullptr;
+
+  /// Size of mapped contents in bytes.
+  std::size_t size_ = 0;
+};
+
+}  // namespace ogle
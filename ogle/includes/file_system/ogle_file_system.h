@@ -8,6 +8,7 @@
 #include "std/ogle_std.inc"
 #include "file_system/directory.h"
 #include "file_system/file_path.h"
+#include "file_system/mapped_file.h"
 #include "file_system/text_file.h"
 #include "file_system/yaml_file.h"
 
@@ -0,0 +1,353 @@
+/**
+ * @file aabb_tree.h
+ * @brief Defines AABBTree.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <algorithm>
+#include <cstdint>
+#include "geometry/bounds.h"
+#include "geometry/frustum.h"
+#include "geometry/ray.h"
+
+namespace ogle {
+
+class Transform;
+
+/**
+ * @brief Dynamic bounding volume tree over the bounds of objects in a scene.
+ *
+ * Each object is a leaf holding a "fat" box: its world-space box grown by a
+ * margin, so that small moves don't change the tree. Internal nodes hold the
+ * union of their children's boxes. Leaves are inserted next to the sibling
+ * that least increases total surface area, and the tree is rebalanced by
+ * rotations on the way back up, keeping its height logarithmic.
+ *
+ * Nodes live in one array and refer to each other by index, so proxies stay
+ * valid while the array grows. Freed nodes are reused.
+ *
+ * Transforms in a tree register themselves on it when moved, and Update()
+ * refits those proxies in one pass.
+ */
+class AABBTree {
+ public:
+  friend class Transform;
+
+  /// Index of no node.
+  static constexpr std::int32_t kNullNode = -1;
+
+  /// Default distance that fat boxes extend past objects' boxes.
+  static constexpr float kDefaultMargin = 0.1f;
+
+  /**
+   * @brief Constructor.
+   * @param margin Distance that fat boxes extend past objects' boxes.
+   */
+  explicit AABBTree(const float margin = kDefaultMargin);
+
+  /**
+   * @brief Adds an object.
+   * @param box World-space box of object.
+   * @param transform Transform of object, returned by queries.
+   * @return Proxy that identifies the object in the tree.
+   */
+  std::int32_t Insert(const AxisAlignedBox& box, Transform* transform);
+
+  /**
+   * @brief Removes an object.
+   * @param proxy Proxy returned by Insert().
+   */
+  void Remove(const std::int32_t proxy);
+
+  /**
+   * @brief Changes the box of an object. It is reinserted only if the box
+   *        leaves its fat box, or has shrunk well inside of it.
+   * @param proxy Proxy returned by Insert().
+   * @param box New world-space box of object.
+   * @return true if the object was reinserted, else false.
+   */
+  bool Move(const std::int32_t proxy, const AxisAlignedBox& box);
+
+  /**
+   * @brief Moves the proxies of all Transforms that moved since the last
+   *        update.
+   */
+  void Update();
+
+  /**
+   * @brief Accessor.
+   * @param proxy Proxy returned by Insert().
+   * @return Transform of object.
+   */
+  Transform* transform(const std::int32_t proxy) const;
+
+  /**
+   * @brief Accessor.
+   * @param proxy Proxy returned by Insert().
+   * @return Fat box of object.
+   */
+  const AxisAlignedBox& fat_box(const std::int32_t proxy) const;
+
+  /**
+   * @brief Accessor.
+   * @return Number of objects in the tree.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Accessor.
+   * @return Height of the tree. 0 for a single leaf, -1 if empty.
+   */
+  int height() const;
+
+  /**
+   * @brief Calls a visitor on every object whose fat box overlaps a box.
+   * @param box World-space box to test.
+   * @param visit Callable taking a proxy, and returning false to end the
+   *        query early.
+   */
+  template <typename Visitor>
+  void Query(const AxisAlignedBox& box, Visitor visit) const;
+
+  /**
+   * @brief Calls a visitor on every object whose fat box may be inside a
+   *        frustum. Subtrees entirely inside are reported without further
+   *        tests.
+   * @param frustum Frustum to test.
+   * @param visit Callable taking a proxy, and returning false to end the
+   *        query early.
+   */
+  template <typename Visitor>
+  void Query(const Frustum& frustum, Visitor visit) const;
+
+  /**
+   * @brief Calls a visitor on every object whose fat box a ray hits within
+   *        some distance, so that it can test the object itself.
+   * @param ray Ray to cast.
+   * @param max_distance Distance along the ray to search.
+   * @param visit Callable taking a proxy, and returning the distance to
+   *        search up to from then on: max_distance to continue, the
+   *        distance of a hit to clip the search to it, or 0 to end it.
+   */
+  template <typename Visitor>
+  void RayCast(const Ray<float, 3>& ray, float max_distance,
+               Visitor visit) const;
+
+  /**
+   * @brief Checks that links, heights, and boxes of all nodes are
+   *        consistent. Walks the whole tree, so use only for debugging and
+   *        testing.
+   * @return true if the tree is consistent, else false. Errors are logged.
+   */
+  bool Validate() const;
+
+ private:
+  /// Deepest tree that queries can walk. Balancing keeps trees far
+  /// shallower than this for any number of objects that fits in memory.
+  static constexpr int kMaxQueryDepth = 128;
+
+  /**
+   * @brief A leaf or internal node of the tree.
+   */
+  struct Node {
+    /// Fat box of a leaf, or union of children's boxes.
+    AxisAlignedBox box;
+
+    /// Parent node, or next free node if this one is free.
+    std::int32_t parent;
+
+    ///@{
+    /// Child nodes, kNullNode for leaves.
+    std::int32_t child1;
+    std::int32_t child2;
+    ///@}
+
+    /// Height of subtree. 0 for leaves, -1 for free nodes.
+    std::int32_t height;
+
+    /// Transform of a leaf's object.
+    Transform* transform;
+
+    /**
+     * @brief Checks if this node holds an object.
+     */
+    bool is_leaf() const { return child1 == kNullNode; }
+  };
+
+  /**
+   * @brief Takes a node from the free list, growing the array if needed.
+   * @return Index of node.
+   */
+  std::int32_t AllocateNode();
+
+  /**
+   * @brief Returns a node to the free list.
+   * @param index Index of node.
+   */
+  void FreeNode(const std::int32_t index);
+
+  /**
+   * @brief Links a leaf into the tree beside the best sibling.
+   * @param leaf Index of leaf, with its box set.
+   */
+  void InsertLeaf(const std::int32_t leaf);
+
+  /**
+   * @brief Unlinks a leaf from the tree, keeping the node.
+   * @param leaf Index of leaf.
+   */
+  void RemoveLeaf(const std::int32_t leaf);
+
+  /**
+   * @brief Rebalances by rotation, and refits boxes and heights, from a
+   *        node up to the root.
+   * @param index Index of lowest node to fix.
+   */
+  void FixUpwards(std::int32_t index);
+
+  /**
+   * @brief Rotates a child up if the subtree at a node is unbalanced.
+   * @param index Index of node.
+   * @return Index of node now at its place in the tree.
+   */
+  std::int32_t Balance(const std::int32_t index);
+
+  /**
+   * @brief Creates a fat box around a box.
+   * @param box Box of object.
+   * @return Box grown by margin.
+   */
+  const AxisAlignedBox Fatten(const AxisAlignedBox& box) const;
+
+  /**
+   * @brief Checks nodes in a subtree, recursively.
+   * @param index Index of root of subtree.
+   * @return Number of leaves, or -1 on error.
+   */
+  int ValidateSubtree(const std::int32_t index) const;
+
+  /// All nodes, including free ones.
+  stl_vector<Node> nodes_;
+
+  /// Root node, or kNullNode if empty.
+  std::int32_t root_;
+
+  /// First node in the free list, or kNullNode.
+  std::int32_t free_list_;
+
+  /// Number of objects.
+  size_t num_leaves_;
+
+  /// Distance that fat boxes extend past objects' boxes.
+  float margin_;
+
+  /// Transforms that moved since the last Update().
+  stl_vector<Transform*> moved_transforms_;
+};
+
+template <typename Visitor>
+void AABBTree::Query(const AxisAlignedBox& box, Visitor visit) const {
+  std::int32_t stack[kMaxQueryDepth];
+  int stack_size = 0;
+  if (root_ != kNullNode) {
+    stack[stack_size++] = root_;
+  }
+  while (stack_size > 0) {
+    const std::int32_t index = stack[--stack_size];
+    const Node& node = nodes_[index];
+    if (!node.box.Overlaps(box)) {
+      continue;
+    }
+    if (node.is_leaf()) {
+      if (!visit(index)) {
+        return;
+      }
+    } else {
+      stack[stack_size++] = node.child1;
+      stack[stack_size++] = node.child2;
+    }
+  }
+}
+
+template <typename Visitor>
+void AABBTree::Query(const Frustum& frustum, Visitor visit) const {
+  // Each entry is a node and the planes it may be outside of.
+  std::int32_t stack[kMaxQueryDepth];
+  std::uint8_t stack_masks[kMaxQueryDepth];
+  int stack_size = 0;
+  if (root_ != kNullNode) {
+    stack[stack_size] = root_;
+    stack_masks[stack_size++] = Frustum::kAllPlanes;
+  }
+  while (stack_size > 0) {
+    --stack_size;
+    const std::int32_t index = stack[stack_size];
+    std::uint8_t plane_mask = stack_masks[stack_size];
+    const Node& node = nodes_[index];
+    if (plane_mask != 0 && !frustum.Intersects(node.box, &plane_mask)) {
+      continue;
+    }
+    if (node.is_leaf()) {
+      if (!visit(index)) {
+        return;
+      }
+    } else {
+      stack[stack_size] = node.child1;
+      stack_masks[stack_size++] = plane_mask;
+      stack[stack_size] = node.child2;
+      stack_masks[stack_size++] = plane_mask;
+    }
+  }
+}
+
+template <typename Visitor>
+void AABBTree::RayCast(const Ray<float, 3>& ray, float max_distance,
+                       Visitor visit) const {
+  // Slab test: the ray is inside the box between the distances at which it
+  // crosses each pair of faces.
+  Vector3f inverse_direction;
+  for (VectorIndex axis = 0; axis < 3; ++axis) {
+    inverse_direction(axis) = 1.f / ray.direction_(axis);
+  }
+  auto hits = [&ray, &inverse_direction](const AxisAlignedBox& box,
+                                         const float max) -> bool {
+    float near = 0.f;
+    float far = max;
+    for (VectorIndex axis = 0; axis < 3; ++axis) {
+      float t1 = (box.min(axis) - ray.origin_(axis)) * inverse_direction(axis);
+      float t2 = (box.max(axis) - ray.origin_(axis)) * inverse_direction(axis);
+      if (t1 > t2) {
+        std::swap(t1, t2);
+      }
+      near = std::max(near, t1);
+      far = std::min(far, t2);
+    }
+    return near <= far;
+  };
+
+  std::int32_t stack[kMaxQueryDepth];
+  int stack_size = 0;
+  if (root_ != kNullNode) {
+    stack[stack_size++] = root_;
+  }
+  while (stack_size > 0) {
+    const std::int32_t index = stack[--stack_size];
+    const Node& node = nodes_[index];
+    if (!hits(node.box, max_distance)) {
+      continue;
+    }
+    if (node.is_leaf()) {
+      max_distance = std::min(max_distance, visit(index));
+      if (max_distance <= 0.f) {
+        return;
+      }
+    } else {
+      stack[stack_size++] = node.child1;
+      stack[stack_size++] = node.child2;
+    }
+  }
+}
+
+}  // namespace ogle
@@ -0,0 +1,160 @@
+/**
+ * @file bounds.h
+ * @brief Defines AxisAlignedBox, BoundingSphere, and Bounds.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include "math/matrix.h"
+#include "math/vector.h"
+
+namespace ogle {
+
+/**
+ * @brief A box with faces perpendicular to the coordinate axes.
+ */
+struct AxisAlignedBox {
+  /**
+   * @brief Creates a box containing no points. Including a point in it
+   *        makes a box containing just that point.
+   * @return New box.
+   */
+  static const AxisAlignedBox Empty();
+
+  /**
+   * @brief Checks if the box contains no points.
+   */
+  const bool empty() const;
+
+  /**
+   * @brief Grows the box to contain a point.
+   * @param point Point to include.
+   */
+  void Include(const Vector3f& point);
+
+  /**
+   * @brief Grows the box to contain another box.
+   * @param box Box to include.
+   */
+  void Include(const AxisAlignedBox& box);
+
+  /**
+   * @brief Computes the center of the box. Not valid if empty.
+   * @return Center point.
+   */
+  const Vector3f center() const;
+
+  /**
+   * @brief Computes distances from the center to the faces of the box.
+   *        Not valid if empty.
+   * @return Half the size along each axis.
+   */
+  const Vector3f extents() const;
+
+  /**
+   * @brief Computes the total area of the box's faces. Not valid if empty.
+   * @return Surface area.
+   */
+  const float SurfaceArea() const;
+
+  /**
+   * @brief Checks if another box lies entirely inside this one.
+   * @param box Box to check.
+   * @return true if contained, else false.
+   */
+  const bool Contains(const AxisAlignedBox& box) const;
+
+  /**
+   * @brief Checks if another box shares any points with this one.
+   * @param box Box to check.
+   * @return true if they overlap, else false.
+   */
+  const bool Overlaps(const AxisAlignedBox& box) const;
+
+  /**
+   * @brief Computes the smallest axis-aligned box containing this box after
+   *        an affine transformation.
+   * @param transform Affine transformation matrix.
+   * @return New box.
+   */
+  const AxisAlignedBox Transformed(const Matrix44f& transform) const;
+
+  /// Corner with smallest coordinates.
+  Vector3f min;
+
+  /// Corner with largest coordinates.
+  Vector3f max;
+};
+
+/**
+ * @brief A sphere containing some object.
+ */
+struct BoundingSphere {
+  /**
+   * @brief Grows the sphere to the smallest sphere containing both it and
+   *        another sphere.
+   * @param sphere Sphere to include.
+   */
+  void Include(const BoundingSphere& sphere);
+
+  /**
+   * @brief Computes a sphere containing this sphere after an affine
+   *        transformation. Exact for rigid transformations.
+   * @param transform Affine transformation matrix.
+   * @return New sphere.
+   */
+  const BoundingSphere Transformed(const Matrix44f& transform) const;
+
+  /// Center point.
+  Vector3f center;
+
+  /// Radius. Negative for a sphere containing no points.
+  float radius;
+};
+
+/**
+ * @brief Box and sphere bounding the same object.
+ *
+ * Testing the sphere is cheaper, but the box fits most objects more
+ * tightly.
+ */
+struct Bounds {
+  /**
+   * @brief Creates bounds containing no points.
+   * @return New bounds.
+   */
+  static const Bounds Empty();
+
+  /**
+   * @brief Computes bounds of points.
+   * @param points Points to bound.
+   * @param num_points Number of points. May be 0.
+   * @param stride Bytes between consecutive points.
+   * @return New bounds. The sphere is centered on the box.
+   */
+  static const Bounds FromPoints(const Vector3f* points,
+                                 const size_t num_points,
+                                 const size_t stride);
+
+  /**
+   * @brief Grows both bounding volumes to contain other bounds.
+   * @param bounds Bounds to include.
+   */
+  void Include(const Bounds& bounds);
+
+  /**
+   * @brief Transforms both bounding volumes.
+   * @param transform Affine transformation matrix.
+   * @return New bounds.
+   */
+  const Bounds Transformed(const Matrix44f& transform) const;
+
+  /// Bounding box.
+  AxisAlignedBox box;
+
+  /// Bounding sphere.
+  BoundingSphere sphere;
+};
+
+}  // namespace ogle
@@ -0,0 +1,165 @@
+/**
+ * @file frustum.h
+ * @brief Defines Frustum and BoundsBatch.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <cstdint>
+#include "geometry/bounds.h"
+#include "math/matrix.h"
+#include "math/vector.h"
+
+namespace ogle {
+
+/**
+ * @brief Bounds of many objects, stored to be tested against a Frustum
+ *        together.
+ *
+ * Each coordinate is kept in its own array, so that several objects can be
+ * tested at once with SIMD instructions.
+ */
+class BoundsBatch {
+ public:
+  friend class Frustum;
+
+  /**
+   * @brief Removes all bounds, keeping storage.
+   */
+  void Clear();
+
+  /**
+   * @brief Adds bounds of an object.
+   * @param bounds Bounds to add.
+   */
+  void Add(const Bounds& bounds);
+
+  /**
+   * @brief Accessor.
+   * @return Number of bounds added.
+   */
+  size_t size() const;
+
+ private:
+  ///@{
+  /// Bounding sphere centers and radii.
+  stl_vector<float> sphere_x_;
+  stl_vector<float> sphere_y_;
+  stl_vector<float> sphere_z_;
+  stl_vector<float> sphere_radius_;
+  ///@}
+
+  ///@{
+  /// Bounding box centers and extents.
+  stl_vector<float> box_x_;
+  stl_vector<float> box_y_;
+  stl_vector<float> box_z_;
+  stl_vector<float> box_extent_x_;
+  stl_vector<float> box_extent_y_;
+  stl_vector<float> box_extent_z_;
+  ///@}
+};
+
+/**
+ * @brief The volume visible to a camera, bounded by 6 planes.
+ *
+ * Planes are stored as (a, b, c, d), with a normal (a, b, c) of unit length
+ * that points into the frustum, so that a*x + b*y + c*z + d is the signed
+ * distance of point (x, y, z) from the plane.
+ */
+class Frustum {
+ public:
+  /// Number of bounding planes.
+  static constexpr int kNumPlanes = 6;
+
+  /// Mask with a bit set for each plane, by index.
+  static constexpr std::uint8_t kAllPlanes = (1 << kNumPlanes) - 1;
+
+  /**
+   * @brief Default constructor. Makes a frustum containing all space.
+   */
+  Frustum();
+
+  /**
+   * @brief Constructor. Extracts planes from a view-projection matrix.
+   *
+   * A point is inside if its clip coordinates satisfy -w <= x, y, z <= w,
+   * so each plane is a sum or difference of the last row and another row.
+   *
+   * @param view_projection Projection matrix times view matrix. Planes are
+   *        in the space that the view matrix transforms from.
+   */
+  explicit Frustum(const Matrix44f& view_projection);
+
+  /**
+   * @brief Accessor.
+   * @param index Plane index, in order left, right, bottom, top, near, far.
+   * @return Plane.
+   */
+  const Vector4f& plane(const int index) const;
+
+  /**
+   * @brief Tests if a sphere may be inside. Conservative: some spheres
+   *        outside near the frustum's corners pass.
+   * @param sphere Sphere to test.
+   * @return false if the sphere is entirely outside, else true.
+   */
+  const bool Intersects(const BoundingSphere& sphere) const;
+
+  /**
+   * @brief Tests if a box may be inside. Conservative in the same way as
+   *        for spheres.
+   * @param box Box to test.
+   * @return false if the box is entirely outside, else true.
+   */
+  const bool Intersects(const AxisAlignedBox& box) const;
+
+  /**
+   * @brief Tests if a box may be inside, against some of the planes.
+   *
+   * Planes that the box is entirely inside of are removed from the mask, as
+   * for bounds.
+   *
+   * @param box Box to test.
+   * @param[in,out] plane_mask Planes to test, as bits set by plane index.
+   * @return false if the box is entirely outside one of the planes, else
+   *         true.
+   */
+  const bool Intersects(const AxisAlignedBox& box,
+                        std::uint8_t* plane_mask) const;
+
+  /**
+   * @brief Tests if bounds may be inside, against some of the planes.
+   *
+   * Planes that the bounds are entirely inside of are removed from the
+   * mask, so that anything contained in the bounds needs only be tested
+   * against the remaining planes. An empty mask means entirely inside.
+   *
+   * @param bounds Bounds to test.
+   * @param[in,out] plane_mask Planes to test, as bits set by plane index.
+   * @return false if either bounding volume is entirely outside one of the
+   *         planes, else true.
+   */
+  const bool Intersects(const Bounds& bounds, std::uint8_t* plane_mask) const;
+
+  /**
+   * @brief Tests a batch of bounds, 4 at a time where SSE is available.
+   *
+   * Bounds are outside if either their sphere or box is entirely outside
+   * of any plane.
+   *
+   * @param batch Bounds to test.
+   * @param[out] visible Set to 1 for each of the bounds that may be
+   *        inside, and 0 for others. Resized to the size of the batch.
+   * @return Number of bounds that may be inside.
+   */
+  size_t Cull(const BoundsBatch& batch,
+              stl_vector<std::uint8_t>* visible) const;
+
+ private:
+  /// Bounding planes.
+  Vector4f planes_[kNumPlanes];
+};
+
+}  // namespace ogle
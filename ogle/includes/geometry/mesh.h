@@ -6,37 +6,45 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include <cstdint>
 #include <memory>
+#include "geometry/bounds.h"
 #include "math/vector.h"
 #include "memory/buffer.h"
 #include "resource/resource.h"
 
 namespace ogle {
 
+class JobSystem;
+class TriangleBVH;
+
 /**
  * @brief A mesh representation with face-vertex connectivity information.
  *
  * Meshes contain detailed information about the mesh suitable for high-level
  * operations and algorithms. They are prepared for use on a rendering device by
  * constructing a BufferedMesh.
+ *
+ * Connectivity is stored in flat arrays of 32-bit indices. Once faces have
+ * been added, #BuildAdjacency builds:
+ *   1) A compressed (CSR) table of the faces around each vertex.
+ *   2) Half-edges: half-edge 3f + i runs from vertex i of face f to vertex
+ *      (i + 1) % 3, and is paired with the opposite half-edge of the
+ *      neighboring face, if any.
  */
 class Mesh : public Resource {
  public:
+  friend class MeshCache;
   friend class MeshProcessing;
 
-  struct MeshFace;
-
   /**
-   * @brief Mesh vertex, associated attributes, and face connections.
+   * @brief Mesh vertex and associated attributes.
    */
   struct MeshVertex {
     Vector3f vertex;  ///< Vertex location.
     Vector2f uv;  ///< 2D texture coordinate.
     Vector3f vertex_normal;  ///< Vertex normal.
 
-    /// Faces connected to this Vertex.
-    ogle::stl_vector<const MeshFace*> adjoining_faces;
-
     /**
      * @brief Less than operator. Compares vertex attributes in order.
      * @param lhs Left operand.
@@ -46,37 +54,69 @@ class Mesh : public Resource {
     friend const bool operator<(const MeshVertex& lhs, const MeshVertex& rhs);
   };
 
-  using VertexIndex = stl_vector<MeshVertex>::size_type;
+  ///@{
+  /// Indices of vertices, faces, and half-edges.
+  using VertexIndex = std::uint32_t;
+  using FaceIndex = std::uint32_t;
+  using HalfEdgeIndex = std::uint32_t;
+  ///@}
+
+  /// Index marking an absent vertex, face, or half-edge.
+  static constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFF;
+
+  /// Number of vertices per face. Only triangles are stored.
+  static constexpr int kVerticesPerFace = 3;
 
   /**
    * @brief A single face of a mesh.
    */
   struct MeshFace {
-    /// Indices of vertices making up this face.
-    stl_vector<VertexIndex> vertex_indices;
+    /// Indices of vertices making up this face, in counter-clockwise order.
+    VertexIndex vertex_indices[kVerticesPerFace];
   };
 
-  /// Number of vertices per face. Only triangles are stored.
-  static constexpr int kVerticesPerFace = 3;
+  /**
+   * @brief Range of faces adjoining a vertex.
+   */
+  class FaceRange {
+   public:
+    FaceRange(const FaceIndex* begin, const FaceIndex* end)
+      : begin_(begin), end_(end) {}
+    const FaceIndex* begin() const { return begin_; }
+    const FaceIndex* end() const { return end_; }
+    std::size_t size() const { return end_ - begin_; }
+
+   private:
+    const FaceIndex* begin_;
+    const FaceIndex* end_;
+  };
 
   /// Type identifying mesh resources.
   static constexpr ResourceType kResourceType = ResourceType::MESH;
 
   explicit Mesh(const ResourceMetadata& metadata);
 
+  /**
+   * @brief Destructor.
+   */
+  ~Mesh();
+
   /**
    * @brief Loads a new mesh from resource metadata.
    * @param metadata Metadata for mesh.
+   * @param job_system Job system to parse and process the mesh on, or null
+   *        to start threads for it.
    * @return New mesh, or null on failure.
    */
-  static std::unique_ptr<Mesh> Load(const ResourceMetadata& metadata);
+  static std::unique_ptr<Mesh> Load(const ResourceMetadata& metadata,
+                                    JobSystem* job_system);
 
   /**
    * @brief Adds a new face to this mesh.
    *
    * An empty argument is ignored; the corresponding vertex attribute is zeroed
-   * out. All non-empty vectors passed to this function must be of equal
-   * length.
+   * out. All non-empty vectors passed to this function must have
+   * #kVerticesPerFace elements.
    *
    * @param vertices Face vertices.
    * @param uvs 2D texture coordinates.
@@ -87,11 +127,132 @@ class Mesh : public Resource {
                      const stl_vector<Vector2f>& uvs,
                      const stl_vector<Vector3f>& vertex_normals);
 
+  /**
+   * @brief Adds a new triangular face to this mesh.
+   *
+   * Unlike #AddFace, no temporary containers are needed, which makes this the
+   * preferred entry point for loaders.
+   *
+   * @param vertices #kVerticesPerFace face vertices.
+   * @param uvs #kVerticesPerFace texture coordinates, or null to zero them.
+   * @param vertex_normals #kVerticesPerFace normals, or null to zero them.
+   */
+  void AddTriangle(const Vector3f* vertices, const Vector2f* uvs,
+                   const Vector3f* vertex_normals);
+
+  /**
+   * @brief Starts welding identical vertices as faces are added.
+   *
+   * While welding, a face vertex whose position, texture coordinate, and
+   * normal are bitwise equal to those of a vertex already in the mesh reuses
+   * that vertex instead of adding a new one. -0 and 0 are considered equal.
+   * Vertices added before welding starts are not welded.
+   */
+  void BeginWelding();
+
+  /**
+   * @brief Stops welding vertices and frees the weld table.
+   */
+  void EndWelding();
+
   /**
    * @brief Clears all mesh representation data.
    */
   void Clear();
 
+  /**
+   * @brief Builds vertex-face and half-edge adjacency from the mesh's faces.
+   *
+   * Adding faces afterward discards adjacency until this is called again.
+   * Edges shared by more than two faces are paired arbitrarily; the extra
+   * half-edges are left without an opposite.
+   */
+  void BuildAdjacency();
+
+  /**
+   * @brief Checks if adjacency is built and up to date.
+   */
+  const bool has_adjacency() const;
+
+  /**
+   * @brief Gets faces adjoining a vertex. Adjacency must be built.
+   * @param vertex_index Vertex to get faces for.
+   * @return Faces containing the vertex, in increasing order.
+   */
+  FaceRange vertex_faces(const VertexIndex vertex_index) const;
+
+  /**
+   * @brief Gets the face a half-edge belongs to.
+   */
+  static FaceIndex HalfEdgeFace(const HalfEdgeIndex half_edge) {
+    return half_edge / kVerticesPerFace;
+  }
+
+  /**
+   * @brief Gets the next half-edge around the same face.
+   */
+  static HalfEdgeIndex NextHalfEdge(const HalfEdgeIndex half_edge) {
+    return (half_edge % kVerticesPerFace == kVerticesPerFace - 1) ?
+        half_edge - (kVerticesPerFace - 1) : half_edge + 1;
+  }
+
+  /**
+   * @brief Gets the previous half-edge around the same face.
+   */
+  static HalfEdgeIndex PrevHalfEdge(const HalfEdgeIndex half_edge) {
+    return (half_edge % kVerticesPerFace == 0) ?
+        half_edge + (kVerticesPerFace - 1) : half_edge - 1;
+  }
+
+  /**
+   * @brief Gets the vertex a half-edge starts from.
+   */
+  VertexIndex HalfEdgeOrigin(const HalfEdgeIndex half_edge) const {
+    return mesh_faces_[half_edge / kVerticesPerFace]
+        .vertex_indices[half_edge % kVerticesPerFace];
+  }
+
+  /**
+   * @brief Gets the vertex a half-edge ends at.
+   */
+  VertexIndex HalfEdgeTarget(const HalfEdgeIndex half_edge) const {
+    return HalfEdgeOrigin(NextHalfEdge(half_edge));
+  }
+
+  /**
+   * @brief Gets the half-edge running the other way along the same edge.
+   *        Adjacency must be built.
+   * @param half_edge Half-edge to find opposite of.
+   * @return Opposite half-edge, or #kInvalidIndex on a boundary edge.
+   */
+  HalfEdgeIndex OppositeHalfEdge(const HalfEdgeIndex half_edge) const;
+
+  /**
+   * @brief Recomputes bounds from vertex positions. Loading computes them,
+   *        so this is only needed after changing vertices.
+   */
+  void ComputeBounds();
+
+  /**
+   * @brief Returns bounds of vertices, as of the last ComputeBounds(). Empty
+   *        until then.
+   */
+  const Bounds& bounds() const;
+
+  /**
+   * @brief Builds a TriangleBVH over the faces, for casting rays against the
+   *        mesh. Adding or clearing faces discards it; rebuild it after
+   *        moving vertices.
+   * @param job_system Job system to build on, or null to build on the
+   *        calling thread.
+   */
+  void BuildBVH(JobSystem* job_system);
+
+  /**
+   * @brief Returns BVH built by BuildBVH(), or null if there is none.
+   */
+  const TriangleBVH* bvh() const;
+
   /**
    * @brief Returns vertices.
    */
@@ -108,6 +269,61 @@ class Mesh : public Resource {
 
   /// Mesh faces.
   stl_vector<MeshFace> mesh_faces_;
+
+  /// Start of each vertex's faces in #vertex_faces_, plus a final entry
+  /// holding the total. Empty if adjacency is not built.
+  stl_vector<std::uint32_t> vertex_face_offsets_;
+
+  /// Faces around each vertex, grouped by vertex.
+  stl_vector<FaceIndex> vertex_faces_;
+
+  /// Opposite of each half-edge, or #kInvalidIndex on boundaries.
+  stl_vector<HalfEdgeIndex> opposite_half_edges_;
+
+  /// Bounds of vertices.
+  Bounds bounds_;
+
+  /// BVH over faces, or null if not built.
+  std::unique_ptr<TriangleBVH> bvh_;
+
+ private:
+  /**
+   * @brief Slot in the open-addressing table used to weld vertices.
+   */
+  struct WeldSlot {
+    std::uint32_t hash;          ///< Hash of the vertex's attributes.
+    std::uint32_t vertex_index;  ///< Index of vertex, or #kInvalidIndex.
+  };
+
+
+  /**
+   * @brief Finds a vertex with the same attributes, adding it if none exists.
+   * @param mesh_vertex Vertex to find.
+   * @return Index of the matching vertex.
+   */
+  VertexIndex WeldVertex(MeshVertex&& mesh_vertex);
+
+  /**
+   * @brief Inserts a vertex index into the weld table without checking for a
+   *        match.
+   * @param hash Hash of the vertex's attributes.
+   * @param index Index of vertex.
+   */
+  void InsertWeldSlot(const std::uint32_t hash, const VertexIndex index);
+
+  /**
+   * @brief Discards adjacency built by #BuildAdjacency.
+   */
+  void ClearAdjacency();
+
+  /// Whether vertices are currently being welded.
+  bool welding_ = false;
+
+  /// Open-addressing table of welded vertices. Size is a power of 2.
+  stl_vector<WeldSlot> weld_slots_;
+
+  /// Number of occupied slots in #weld_slots_.
+  std::size_t num_weld_slots_used_ = 0;
 };
 
 }  // namespace ogle
@@ -0,0 +1,86 @@
+/**
+ * @file mesh_cache.h
+ * @brief Defines MeshCache.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <cstdint>
+#include <memory>
+#include "file_system/file_path.h"
+#include "geometry/mesh.h"
+
+namespace ogle {
+
+class ResourceMetadata;
+
+/**
+ * @brief Reads and writes compiled binary meshes (.omesh files).
+ *
+ * A cache file holds a Mesh's vertices, faces, and adjacency exactly as they
+ * are laid out in memory, behind a header with a magic number, a format
+ * version, and a hash identifying the source file and load options it was
+ * built from. Loading one is a single pass of copies from a memory-mapped
+ * file. Files use the byte order of the machine that wrote them, and are
+ * meant as a local cache rather than a distribution format.
+ */
+class MeshCache {
+ public:
+  /// Extension appended to a source file's path to name its cache file.
+  static const stl_string kFileExtension;
+
+  /// Version of the cache format. Files of other versions are ignored.
+  static constexpr std::uint32_t kVersion = 2;
+
+  /**
+   * @brief Computes a hash identifying the source of a cached mesh, from the
+   *        contents of the file it is loaded from.
+   *
+   * The hash is fast rather than cryptographic, so it detects edits to the
+   * source but not deliberate collisions.
+   *
+   * @param source Contents of the source file. May be null if empty.
+   * @param source_size Size of contents in bytes.
+   * @param load_options Values of any options that affect the loaded mesh.
+   * @return Hash value.
+   */
+  static std::uint64_t HashSource(
+      const char* source, const std::size_t source_size,
+      const stl_vector<std::uint64_t>& load_options);
+
+  /**
+   * @brief Loads a mesh from a cache file, if it was built from a matching
+   *        source.
+   * @param cache_path Path to cache file.
+   * @param source_hash Hash of the mesh's source, from #HashSource.
+   * @param metadata Metadata for the mesh.
+   * @return New mesh, or null if the cache file is missing, stale, or
+   *         malformed.
+   */
+  static std::unique_ptr<Mesh> Read(const FilePath& cache_path,
+                                    const std::uint64_t source_hash,
+                                    const ResourceMetadata& metadata);
+
+  /**
+   * @brief Writes a mesh to a cache file.
+   * @param cache_path Path to cache file.
+   * @param source_hash Hash of the mesh's source, from #HashSource.
+   * @param mesh Mesh to write.
+   * @return Whether the operation was completed successfully.
+   */
+  static const bool Write(const FilePath& cache_path,
+                          const std::uint64_t source_hash, const Mesh& mesh);
+
+ private:
+  /**
+   * @brief Checks that adjacency read from a cache file only refers to faces
+   *        and half-edges that exist, so a corrupt file can't cause reads
+   *        out of bounds.
+   * @param mesh Mesh with adjacency read.
+   * @return Whether adjacency is consistent with the mesh's faces.
+   */
+  static const bool ValidAdjacency(const Mesh& mesh);
+};
+
+}  // namespace ogle
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include <cstdint>
 #include <memory>
 #include "geometry/mesh.h"
 #include "math/vector.h"
@@ -13,6 +14,7 @@
 namespace ogle {
 
 class FilePath;
+class JobSystem;
 class ResourceMetadata;
 
 /**
@@ -20,6 +22,51 @@ class ResourceMetadata;
  */
 class MeshLoader {
  public:
+  /**
+   * @brief Metadata field giving the number of threads used to parse a mesh.
+   *
+   * If absent or 1, the mesh is parsed serially. 0 selects one thread per
+   * hardware thread, or per thread of the job system loading the mesh.
+   * Output is identical for any number of threads.
+   */
+  static const stl_string kLoaderThreadsField;
+
+  /**
+   * @brief Metadata field selecting whether identical vertices are welded.
+   *
+   * Welding is on unless this is set to false. Welded meshes share vertices
+   * between faces, so the index buffer built from them is much smaller than
+   * one vertex per face corner.
+   */
+  static const stl_string kWeldVerticesField;
+
+  /**
+   * @brief Metadata field selecting whether faces and vertices are reordered
+   *        for the GPU's vertex cache.
+   *
+   * Off unless set to true. Cache statistics before and after are logged.
+   */
+  static const stl_string kOptimizeVertexCacheField;
+
+  /**
+   * @brief Metadata field selecting whether a compiled copy of the mesh is
+   *        kept next to its source file.
+   *
+   * On unless set to false. The first load writes <source>.omesh; later
+   * loads read it instead of parsing the source, as long as the source's size
+   * and modification time and the load options are unchanged.
+   */
+  static const stl_string kMeshCacheField;
+
+  /**
+   * @brief Metadata field selecting whether a TriangleBVH is built over the
+   *        mesh, for casting rays against it such as when picking.
+   *
+   * Off unless set to true. The BVH is built after every load, including
+   * loads from the compiled copy.
+   */
+  static const stl_string kBuildBVHField;
+
   /**
    * @brief Creates a Mesh from parsing a file.
    *
@@ -27,9 +74,12 @@ class MeshLoader {
    *   1) All faces are triangular.
    *
    * @param metadata Metadata for mesh to load.
+   * @param job_system Job system to parse and process the mesh on, or null
+   *        to start threads for it.
    * @return New mesh, or null on failure.
    */
-  static std::unique_ptr<Mesh> LoadMesh(const ResourceMetadata& metadata);
+  static std::unique_ptr<Mesh> LoadMesh(const ResourceMetadata& metadata,
+                                        JobSystem* job_system);
 
  private:
   /**
@@ -38,10 +88,73 @@ class MeshLoader {
   struct MeshAttributes {
     stl_vector<Vector3f> vertices;
     stl_vector<Vector2f> tex_coords_uv;
-    stl_vector<Vector3f> tex_coords_uvw;
     stl_vector<Vector3f> normals;
   };
 
+  /**
+   * @brief Options for loading a mesh, read from its metadata.
+   */
+  struct LoadOptions {
+    int num_threads = 1;  ///< Threads used to parse the mesh.
+    bool weld_vertices = true;  ///< Whether identical vertices are welded.
+    bool optimize_vertex_cache = false;  ///< Whether to optimize for cache.
+    bool use_cache = true;  ///< Whether to read and write a compiled mesh.
+    bool build_bvh = false;  ///< Whether to build a BVH over the mesh.
+    JobSystem* job_system = nullptr;  ///< Job system to run on, or null.
+  };
+
+  /**
+   * @brief Reads mesh load options from metadata.
+   * @param metadata Metadata for mesh.
+   * @param[out] options Options read. Fields absent from the metadata keep
+   *             their defaults.
+   * @return true on success, false if an option has an invalid value.
+   */
+  static const bool ReadLoadOptions(const ResourceMetadata& metadata,
+                                    LoadOptions* options);
+
+  /**
+   * @brief Raw indices of one triangular face read from OBJ text.
+   *
+   * Indices are left unresolved so that faces can be read before it is known
+   * where the text they came from falls in the file.
+   */
+  struct OBJFace {
+    /// OBJ position, texture coordinate, and normal indices of each face
+    /// vertex. Absent indices are 0.
+    int obj_indices[Mesh::kVerticesPerFace][3];
+
+    /// Number of positions, texture coordinates, and normals read before this
+    /// face in the same text.
+    std::uint32_t num_defined[3];
+  };
+
+  /**
+   * @brief One newline-aligned chunk of OBJ text and the records read from it.
+   */
+  struct OBJChunk {
+    const char* begin = nullptr;  ///< Start of chunk text.
+    const char* end = nullptr;    ///< End of chunk text.
+
+    /// Vertex attributes read from the chunk.
+    MeshAttributes attributes;
+
+    /// Faces read from the chunk, in order.
+    stl_vector<OBJFace> faces;
+
+    /// Lines read from the chunk. On error, the line that failed.
+    std::uint64_t num_lines = 0;
+
+    /// Error message, or null if the chunk parsed successfully.
+    const char* error = nullptr;
+
+    /// Positions, texture coordinates, and normals in all preceding chunks.
+    std::size_t base[3] = {0, 0, 0};
+
+    /// Lines in all preceding chunks.
+    std::uint64_t first_line = 0;
+  };
+
   /**
    * @brief Supported formats for parsing Meshes.
    */
@@ -61,9 +174,87 @@ class MeshLoader {
   /**
    * @brief Loads a mesh from an OBJ file.
    * @param metadata Metadata for mesh to load.
+   * @param options Options read from metadata.
    * @return New mesh, or null on failure.
    */
-  static std::unique_ptr<Mesh> LoadOBJ(const ResourceMetadata& metadata);
+  static std::unique_ptr<Mesh> LoadOBJ(const ResourceMetadata& metadata,
+                                       const LoadOptions& options);
+
+  /**
+   * @brief Parses OBJ text, emitting faces directly into a Mesh.
+   *
+   * The text is walked in place with a cursor; no strings are created per
+   * line or per token.
+   *
+   * @param begin Start of OBJ text.
+   * @param end End of OBJ text.
+   * @param[out] mesh_data Vertex attributes parsed from the text.
+   * @param[out] mesh Mesh to add faces to.
+   * @return true on success, false if the text is malformed.
+   */
+  static const bool ParseOBJ(const char* begin, const char* end,
+                             MeshAttributes* mesh_data, Mesh* mesh);
+
+  /**
+   * @brief Parses OBJ text on several threads.
+   *
+   * The text is split into newline-aligned chunks which are parsed
+   * concurrently. A prefix sum over the chunks' attribute counts then places
+   * each chunk's attributes in one array, and faces are resolved and added to
+   * the Mesh in file order. The resulting Mesh is identical to the one built
+   * by ParseOBJ.
+   *
+   * @param begin Start of OBJ text.
+   * @param end End of OBJ text.
+   * @param num_threads Most chunks to split the text into, and so threads to
+   *        use, including the calling thread.
+   * @param job_system Job system to parse chunks on, or null to start a
+   *        thread per chunk.
+   * @param[out] mesh Mesh to add faces to.
+   * @return true on success, false if the text is malformed.
+   */
+  static const bool ParseOBJParallel(const char* begin, const char* end,
+                                     const int num_threads,
+                                     JobSystem* job_system, Mesh* mesh);
+
+  /**
+   * @brief Parses one chunk of OBJ text, recording faces without resolving
+   *        them.
+   * @param[in,out] chunk Chunk to parse. Its text bounds must be set.
+   */
+  static void ParseOBJChunk(OBJChunk* chunk);
+
+  /**
+   * @brief Walks OBJ text, storing vertex attributes and passing each face to
+   *        a handler.
+   * @param begin Start of OBJ text.
+   * @param end End of OBJ text.
+   * @param[out] mesh_data Vertex attributes parsed from the text.
+   * @param[out] line_number Number of lines read. On error, the line that
+   *             failed.
+   * @param handle_face Callable taking a const OBJFace& and returning an error
+   *        message, or null on success.
+   * @return Error message, or null on success.
+   */
+  template <typename FaceHandler>
+  static const char* ParseOBJText(const char* begin, const char* end,
+                                  MeshAttributes* mesh_data,
+                                  std::uint64_t* line_number,
+                                  FaceHandler handle_face);
+
+  /**
+   * @brief Resolves the indices of a face and adds it to a Mesh.
+   * @param face Face read from OBJ text.
+   * @param mesh_data All vertex attributes read so far.
+   * @param base Positions, texture coordinates, and normals that preceded the
+   *        text the face was read from.
+   * @param[out] mesh Mesh to add the face to, or null to only check that the
+   *             face's indices are valid.
+   * @return Error message, or null on success.
+   */
+  static const char* AddOBJFace(const OBJFace& face,
+                                const MeshAttributes& mesh_data,
+                                const std::size_t base[3], Mesh* mesh);
 };
 
 }  // namespace ogle
@@ -1,5 +1,5 @@
 /**
- * @file mesh_processing.cc
+ * @file mesh_processing.h
  * @brief Defines MeshProcessing.
  */
 
@@ -7,19 +7,77 @@
 
 #include "std/ogle_std.inc"
 #include "geometry/mesh.h"
+#include "math/vector.h"
 
 namespace ogle {
 
+class JobSystem;
+
 class MeshProcessing {
  public:
+  /**
+   * @brief How face normals are weighted when summed at a vertex.
+   */
+  enum class NormalWeighting {
+    UNIFORM,  // Every face counts equally.
+    AREA,     // Faces count in proportion to their area.
+    ANGLE     // Faces count in proportion to their angle at the vertex.
+  };
+
   /**
    * @brief Computes vertex normals as average of surrounding face normals.
    *
-   * It's assumed each face is triangular.
+   * Faces around each vertex are found through the mesh's adjacency, which
+   * is built first if necessary.
    *
    * @param[in,out] mesh Mesh to compute normals for.
    */
   static void ComputeAveragedNormals(Mesh* mesh);
+
+  /**
+   * @brief Computes vertex normals, and optionally tangents, from faces.
+   *
+   * Face normals are computed once into a flat array. Each vertex then sums
+   * the normals of its faces, found through the mesh's adjacency. Both passes
+   * are split across jobs or threads, and since every vertex sums its own
+   * faces in a fixed order, results do not depend on how they are split.
+   *
+   * Vertices with no faces are given zero normals and tangents.
+   *
+   * @param[in,out] mesh Mesh to compute normals for.
+   * @param weighting How face normals are weighted at each vertex.
+   * @param[out] tangents If not null, receives a tangent per vertex, pointing
+   *             along increasing u and orthogonal to the normal. w holds the
+   *             handedness, so that bitangent = w * normal.Cross(tangent).
+   * @param num_threads Most threads to start when job_system is null. 0
+   *        uses one per hardware thread.
+   * @param job_system Job system to run both passes on, or null to start
+   *        threads for them.
+   */
+  static void ComputeVertexNormals(Mesh* mesh,
+                                   const NormalWeighting weighting,
+                                   stl_vector<Vector4f>* tangents,
+                                   const int num_threads,
+                                   JobSystem* job_system);
+
+  /**
+   * @brief Reorders faces and vertices for post-transform cache locality.
+   *
+   * Faces are reordered with Tom Forsyth's "Linear-Speed Vertex Cache
+   * Optimisation", which greedily emits the face whose vertices score best
+   * for an LRU cache of #kOptimizedCacheSize entries. Vertices are then
+   * renumbered in order of first use, so that vertex fetches also run mostly
+   * forward through memory. Vertices not used by any face are moved to the
+   * end.
+   *
+   * The mesh's adjacency is rebuilt for the new order.
+   *
+   * @param[in,out] mesh Mesh to optimize.
+   */
+  static void OptimizeVertexCache(Mesh* mesh);
+
+  /// Size of the LRU cache modeled by #OptimizeVertexCache.
+  static constexpr int kOptimizedCacheSize = 32;
 };
 
 }  // namespace ogle
@@ -6,10 +6,16 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include "geometry/aabb_tree.h"
+#include "geometry/bounds.h"
+#include "geometry/frustum.h"
 #include "geometry/mesh.h"
+#include "geometry/mesh_cache.h"
 #include "geometry/mesh_loader.h"
 #include "geometry/mesh_processing.h"
 #include "geometry/ray.h"
 #include "geometry/transform.h"
 #include "geometry/transformation_matrix.h"
+#include "geometry/triangle_bvh.h"
+#include "geometry/vertex_cache_simulator.h"
 
@@ -6,6 +6,8 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include <cstdint>
+#include "geometry/bounds.h"
 #include "math/angle.h"
 #include "math/matrix.h"
 #include "math/quaternion.h"
@@ -13,6 +15,7 @@
 
 namespace ogle {
 
+class AABBTree;
 class Entity;
 
 /**
@@ -20,9 +23,19 @@ class Entity;
  *
  * Representation with respect to both the world and space local to a parent.
  * Local space is defined by a hierarchy of transforms.
+ *
+ * Each Transform also keeps world-space bounds of the object at it, and of
+ * its whole subtree. They are refit lazily: moving a Transform only marks
+ * it and its ancestors dirty, and RefitBounds() recomputes just the dirty
+ * part of the tree.
+ *
+ * A Transform in a spatial index keeps a proxy in it for its object's
+ * bounds, and queues itself to be moved there when it moves.
  */
 class Transform {
  public:
+  friend class AABBTree;
+
   //@{
   /// Axes that represent front, right, and up directions in world space.
   static const Vector3f kFrontAxis;
@@ -33,7 +46,8 @@ class Transform {
   /**
    * @brief Constructor.
    *
-   * Zeros out world position and orientation. Attaches Transform to Entity.
+   * Zeros out world position and orientation. Attaches Transform to Entity,
+   * and to the parent's spatial index.
    *
    * @param parent Parent Transform. Can be null.
    * @param entity Entity to attach to. Can be null.
@@ -45,6 +59,20 @@ class Transform {
    */
   ~Transform();
 
+  /**
+   * @brief Allocates memory for a Transform from pools shared by all of them.
+   * @param size Size in bytes.
+   * @return Memory.
+   */
+  static void* operator new(std::size_t size);
+
+  /**
+   * @brief Frees memory allocated for a Transform.
+   * @param memory Memory to free.
+   * @param size Size in bytes.
+   */
+  static void operator delete(void* memory, std::size_t size);
+
   /**
    * @brief Sets world position and adjusts children's local coordinates.
    * @param new_position New world position.
@@ -144,7 +172,93 @@ class Transform {
    */
   const Matrix44f TransformationMatrix3D() const;
 
+  /**
+   * @brief Computes world-space bounds of an object at this Transform.
+   * @param local_bounds Bounds in the object's local space.
+   * @return Bounds, transformed as by TransformationMatrix3D().
+   */
+  const Bounds WorldBounds(const Bounds& local_bounds) const;
+
+  /**
+   * @brief Sets bounds of the object at this Transform, such as a rendered
+   *        mesh.
+   * @param local_bounds Bounds in local space, which must outlive the
+   *        Transform or be replaced. nullptr if the object is unbounded, so
+   *        that it must never be culled.
+   */
+  void set_local_bounds(const Bounds* local_bounds);
+
+  /**
+   * @brief Recomputes world-space bounds of this Transform and its
+   *        descendants, where any have moved since the last refit.
+   */
+  void RefitBounds();
+
+  /**
+   * @brief Adds the objects of this Transform and its descendants to a
+   *        spatial index, removing them from any previous one.
+   * @param spatial_index Spatial index, or nullptr to remove them.
+   */
+  void set_spatial_index(AABBTree* spatial_index);
+
+  /**
+   * @brief Accessor.
+   * @return Proxy of object in spatial index, or AABBTree::kNullNode if not
+   *         in one.
+   */
+  const std::int32_t spatial_proxy() const;
+
+  ///@{
+  /// Bounds accessors. Valid as of the last RefitBounds().
+
+  /**
+   * @brief Checks if the object at this Transform has bounds.
+   */
+  const bool has_object_bounds() const;
+
+  /**
+   * @brief World-space bounds of the object at this Transform. Empty if it
+   *        has none.
+   */
+  const Bounds& object_bounds() const;
+
+  /**
+   * @brief World-space bounds of the objects at this Transform and its
+   *        descendants. Objects without bounds are left out.
+   */
+  const Bounds& subtree_bounds() const;
+
+  /**
+   * @brief Checks if any object at this Transform or its descendants is
+   *        unbounded, so that the subtree's bounds do not contain it.
+   */
+  const bool subtree_unbounded() const;
+
+  /**
+   * @brief Number of objects with bounds at this Transform and its
+   *        descendants.
+   */
+  const size_t subtree_num_bounded() const;
+  ///@}
+
  private:
+  /**
+   * @brief Marks the object's bounds, and the subtree bounds of this
+   *        Transform and its ancestors, for refitting.
+   */
+  void MarkBoundsDirty();
+
+  /**
+   * @brief Adds, moves, or removes the object's proxy in the spatial index
+   *        to match its bounds.
+   */
+  void UpdateSpatialProxy();
+
+  /**
+   * @brief Removes the object's proxy from the spatial index, if it has one.
+   */
+  void RemoveSpatialProxy();
+
   /// Child Transforms. It's assumed that the # of child Transforms, and changes
   /// to them, remains small.
   stl_vector<Transform*> children_;
@@ -160,6 +274,41 @@ class Transform {
 
   /// Entity attached to this transform.
   Entity* entity_;
+
+  /// Whether an object was set with set_local_bounds().
+  bool has_object_;
+
+  /// Local-space bounds of object, or nullptr if unbounded.
+  const Bounds* local_bounds_;
+
+  /// World-space bounds of object.
+  Bounds object_bounds_;
+
+  /// World-space bounds of subtree.
+  Bounds subtree_bounds_;
+
+  /// Whether an object in the subtree is unbounded.
+  bool subtree_unbounded_;
+
+  /// Number of objects with bounds in the subtree.
+  size_t subtree_num_bounded_;
+
+  /// Whether object_bounds_ needs refitting.
+  bool object_bounds_dirty_;
+
+  /// Whether subtree bounds need refitting. Also set on all ancestors of a
+  /// Transform that has it set.
+  bool subtree_bounds_dirty_;
+
+  /// Spatial index containing the object, shared with the rest of the tree.
+  AABBTree* spatial_index_;
+
+  /// Proxy of object in spatial index.
+  std::int32_t spatial_proxy_;
+
+  /// Index of this Transform in the spatial index's queue of moved
+  /// Transforms, or -1 if not queued.
+  std::int32_t spatial_moved_index_;
 };
 
 }  // namespace ogle
@@ -58,6 +58,20 @@ class TransformationMatrix {
    */
   static const Matrix33f RotationMatrixZ3D(const Angle theta_z);
 
+  /**
+   * @brief Builds a matrix to transform normals by.
+   *
+   * This is the inverse transpose of the upper-left 3x3 block of a
+   * transformation, computed from cofactors and scaled by the absolute
+   * value of its determinant. Transformed normals must be renormalized, but
+   * the inverse and its division are avoided, and there is no failure for
+   * singular matrices.
+   *
+   * @param transformation Affine transformation of points.
+   * @return Resulting Matrix.
+   */
+  static const Matrix33f NormalMatrix3D(const Matrix44f& transformation);
+
   /**
    * @brief Builds a camera view matrix.
    * @param camera_position Camera world position.
@@ -0,0 +1,203 @@
+/**
+ * @file triangle_bvh.h
+ * @brief Defines TriangleBVH.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <cstdint>
+#include "geometry/bounds.h"
+#include "geometry/mesh.h"
+#include "geometry/ray.h"
+#include "math/vector.h"
+
+namespace ogle {
+
+class JobSystem;
+
+/**
+ * @brief Bounding volume hierarchy over the triangles of a Mesh, for casting
+ *        rays against it.
+ *
+ * Built top-down, splitting each node where the binned surface area
+ * heuristic estimates rays are cheapest to trace. Nodes are kept in one
+ * array in depth-first order, so a node's first child directly follows it.
+ * Triangles are copied in leaf order, with edges precomputed for
+ * intersection.
+ *
+ * The BVH does not refer to the Mesh after it is built, and must be rebuilt
+ * if the Mesh changes.
+ */
+class TriangleBVH {
+ public:
+  /// Number of rays traced together by ClosestHitPacket().
+  static constexpr int kPacketSize = 4;
+
+  /**
+   * @brief Intersection of a ray with a triangle.
+   */
+  struct Hit {
+    /// Distance along ray.
+    float distance;
+
+    /// Face hit, or Mesh::kInvalidIndex for none.
+    Mesh::FaceIndex face;
+
+    ///@{
+    /// Barycentric coordinates of the hit point, weighting the face's
+    /// second and third vertices.
+    float u;
+    float v;
+    ///@}
+  };
+
+  /**
+   * @brief Constructor. Builds the BVH.
+   * @param mesh Mesh to build over.
+   * @param job_system Job system to build large subtrees on, or null to
+   *        build on the calling thread. Results are the same either way.
+   */
+  TriangleBVH(const Mesh& mesh, JobSystem* job_system);
+
+  /**
+   * @brief Finds the nearest triangle a ray hits.
+   * @param ray Ray to cast.
+   * @param max_distance Distance along the ray to search.
+   * @param[out] hit Nearest hit. Face is Mesh::kInvalidIndex if none.
+   * @return true if a triangle was hit, else false.
+   */
+  const bool ClosestHit(const Ray<float, 3>& ray, const float max_distance,
+                        Hit* hit) const;
+
+  /**
+   * @brief Checks if a ray hits any triangle, as for line of sight. Stops at
+   *        the first hit found.
+   * @param ray Ray to cast.
+   * @param max_distance Distance along the ray to search.
+   * @return true if a triangle was hit, else false.
+   */
+  const bool AnyHit(const Ray<float, 3>& ray, const float max_distance) const;
+
+  /**
+   * @brief Finds the nearest triangles hit by a packet of rays, traced
+   *        together with SSE where available.
+   *
+   * Nodes are visited if any ray in the packet hits them, so this is
+   * fastest for coherent rays, such as those through neighboring pixels.
+   *
+   * @param rays #kPacketSize rays to cast.
+   * @param max_distance Distance along the rays to search.
+   * @param[out] hits #kPacketSize nearest hits, as for ClosestHit().
+   * @return Number of rays that hit a triangle.
+   */
+  int ClosestHitPacket(const Ray<float, 3>* rays, const float max_distance,
+                       Hit* hits) const;
+
+  /**
+   * @brief Finds the nearest triangle a ray hits by testing every face of a
+   *        mesh. A reference for checking BVH results.
+   * @param mesh Mesh to test.
+   * @param ray Ray to cast.
+   * @param max_distance Distance along the ray to search.
+   * @param[out] hit Nearest hit, as for ClosestHit().
+   * @return true if a triangle was hit, else false.
+   */
+  static const bool ClosestHitBruteForce(const Mesh& mesh,
+                                         const Ray<float, 3>& ray,
+                                         const float max_distance, Hit* hit);
+
+  /**
+   * @brief Accessor.
+   * @return Bounds of all triangles.
+   */
+  const AxisAlignedBox& box() const;
+
+  /**
+   * @brief Accessor.
+   * @return Number of nodes.
+   */
+  size_t num_nodes() const;
+
+ private:
+  /// Deepest a tree can be built. Traversal stacks hold this many nodes.
+  static constexpr int kMaxDepth = 64;
+
+  /**
+   * @brief A node of the tree. 32 bytes, so two fit in a cache line.
+   */
+  struct Node {
+    /// Bounds of triangles beneath node.
+    AxisAlignedBox box;
+
+    /// First triangle of a leaf, or index of second child of an interior
+    /// node.
+    std::uint32_t offset;
+
+    /// Number of triangles in a leaf, 0 for interior nodes.
+    std::uint16_t num_triangles;
+
+    /// Axis that an interior node was split along.
+    std::uint16_t axis;
+  };
+
+  /**
+   * @brief A triangle stored for Moller-Trumbore intersection.
+   */
+  struct Triangle {
+    Vector3f vertex0;  ///< First vertex.
+    Vector3f edge1;    ///< Second vertex minus first.
+    Vector3f edge2;    ///< Third vertex minus first.
+  };
+
+  /// Per-triangle data used while building.
+  struct BuildData;
+
+  /**
+   * @brief Builds the subtree over a range of faces in #faces_.
+   * @param build_data Per-triangle data.
+   * @param begin Start of range.
+   * @param end End of range.
+   * @param depth Depth of subtree's root.
+   * @param job_system Job system to build large subtrees on, or null.
+   * @param[out] nodes Nodes to append subtree to. Node offsets are relative
+   *        to the start of this array.
+   */
+  void BuildSubtree(const BuildData& build_data, const std::uint32_t begin,
+                    const std::uint32_t end, const int depth,
+                    JobSystem* job_system, stl_vector<Node>* nodes);
+
+  /**
+   * @brief Tests a ray against a triangle.
+   * @param triangle Triangle to test.
+   * @param ray Ray to test.
+   * @param max_distance Distance along the ray to search.
+   * @param[out] hit Set to the hit, if there is one.
+   * @return true if the triangle is hit closer than max_distance.
+   */
+  static const bool IntersectTriangle(const Triangle& triangle,
+                                      const Ray<float, 3>& ray,
+                                      const float max_distance, Hit* hit);
+
+  /**
+   * @brief Finds hits of a ray, stopping at the first if asked.
+   * @param ray Ray to cast.
+   * @param max_distance Distance along the ray to search.
+   * @param any_hit Whether to stop at the first hit found.
+   * @param[out] hit Nearest hit found.
+   * @return true if a triangle was hit, else false.
+   */
+  const bool Trace(const Ray<float, 3>& ray, const float max_distance,
+                   const bool any_hit, Hit* hit) const;
+
+  /// Nodes in depth-first order. The root is first.
+  stl_vector<Node> nodes_;
+
+  /// Triangles in leaf order.
+  stl_vector<Triangle> triangles_;
+
+  /// Mesh faces of triangles in leaf order.
+  stl_vector<Mesh::FaceIndex> faces_;
+};
+
+}  // namespace ogle
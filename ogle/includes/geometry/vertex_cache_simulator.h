@@ -0,0 +1,65 @@
+/**
+ * @file vertex_cache_simulator.h
+ * @brief Defines VertexCacheSimulator.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include "geometry/mesh.h"
+
+namespace ogle {
+
+/**
+ * @brief Software model of a GPU's post-transform vertex cache.
+ *
+ * Used to measure how well a Mesh's face order reuses transformed vertices.
+ */
+class VertexCacheSimulator {
+ public:
+  /**
+   * @brief Replacement policies for cached vertices.
+   */
+  enum class Policy {
+    FIFO,  // Oldest vertex is evicted; hits don't refresh entries.
+    LRU    // Least recently used vertex is evicted.
+  };
+
+  /**
+   * @brief Measured cache efficiency of a face order.
+   */
+  struct Statistics {
+    std::size_t num_misses = 0;  ///< Vertices transformed.
+
+    /// Average cache miss ratio: vertices transformed per triangle. Ranges
+    /// from about 0.5 for ideal orders on large meshes to 3.
+    double acmr = 0.0;
+
+    /// Average transform to vertex ratio: vertices transformed per vertex
+    /// referenced. 1 is ideal.
+    double atvr = 0.0;
+  };
+
+  /**
+   * @brief Constructor.
+   * @param policy Replacement policy.
+   * @param cache_size Number of vertices the cache holds.
+   */
+  VertexCacheSimulator(const Policy policy, const std::size_t cache_size);
+
+  /**
+   * @brief Runs a mesh's faces through an empty cache, in order.
+   * @param mesh Mesh to simulate.
+   * @return Cache statistics.
+   */
+  Statistics Simulate(const Mesh& mesh) const;
+
+ private:
+  /// Replacement policy.
+  Policy policy_;
+
+  /// Number of vertices the cache holds.
+  std::size_t cache_size_;
+};
+
+}  // namespace ogle
@@ -0,0 +1,255 @@
+/**
+ * @file job_system.h
+ * @brief Defines JobSystem and JobHandle.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "config/configuration.h"
+
+namespace ogle {
+
+class JobSystem;
+
+/**
+ * @brief Refers to a job scheduled on a JobSystem, to wait on it or make
+ *        other jobs depend on it.
+ *
+ * Handles are cheap to copy. A default-constructed handle refers to no job,
+ * and counts as finished.
+ */
+class JobHandle {
+ public:
+  friend class JobSystem;
+
+  /**
+   * @brief Checks if the job has finished running. Its effects are visible
+   *        to the caller once this returns true.
+   */
+  const bool finished() const;
+
+ private:
+  /**
+   * @brief A unit of work and the jobs waiting on it.
+   */
+  struct Job {
+    /// Work to run.
+    std::function<void()> function;
+
+    /// Unfinished dependencies, plus one until scheduling is done. The job
+    /// is queued when this reaches 0.
+    std::atomic<int> num_pending{1};
+
+    /// Set once function has returned.
+    std::atomic<bool> finished{false};
+
+    /// Guards finished while continuations are added or taken.
+    std::mutex mutex;
+
+    /// Jobs depending on this one.
+    stl_vector<std::shared_ptr<Job>> continuations;
+  };
+
+  /// Job referred to, or null.
+  std::shared_ptr<Job> job_;
+};
+
+/**
+ * @brief Pool of worker threads that run jobs, balanced by work stealing.
+ *
+ * Each worker has its own deque of jobs. Jobs scheduled from a worker go on
+ * the back of its deque, and it runs jobs from the back, so recently
+ * scheduled work runs while its data is still in cache. Idle workers steal
+ * from the front of other deques, taking the oldest and usually largest
+ * jobs. Jobs scheduled from other threads go on a shared deque that all
+ * workers steal from.
+ *
+ * Threads waiting on a job run other jobs meanwhile, so jobs may wait on
+ * jobs they schedule without deadlocking the pool.
+ */
+class JobSystem {
+ public:
+  ///@{
+  /// Configuration attributes.
+  static const stl_string kConfigModule;
+  static const stl_string kConfigAttributeWorkerThreads;
+  ///@}
+
+  /**
+   * @brief Constructor. Starts worker threads.
+   * @param num_workers Number of worker threads. May be 0, in which case
+   *        jobs only run in threads that wait on them.
+   */
+  explicit JobSystem(const int num_workers);
+
+  /**
+   * @brief Destructor. Finishes queued jobs, then stops worker threads.
+   */
+  ~JobSystem();
+
+  /**
+   * @brief Creates a JobSystem sized from configuration.
+   *
+   * The number of workers is read from worker_threads in the jobs module. If
+   * absent or negative, one worker is started for each hardware thread
+   * besides the calling one.
+   *
+   * @param configuration Engine configuration.
+   * @return New JobSystem.
+   */
+  static std::unique_ptr<JobSystem> Load(const Configuration& configuration);
+
+  /**
+   * @brief Schedules a job to run as soon as a thread is free.
+   * @param function Work to run.
+   * @return Handle to job.
+   */
+  JobHandle Schedule(std::function<void()> function);
+
+  /**
+   * @brief Schedules a job to run after other jobs finish.
+   * @param function Work to run.
+   * @param dependencies Jobs that must finish first.
+   * @return Handle to job.
+   */
+  JobHandle Schedule(std::function<void()> function,
+                     const stl_vector<JobHandle>& dependencies);
+
+  /**
+   * @brief Schedules a continuation of a job, to run after it finishes.
+   * @param parent Job to continue.
+   * @param function Work to run.
+   * @return Handle to continuation.
+   */
+  JobHandle Continue(const JobHandle& parent, std::function<void()> function);
+
+  /**
+   * @brief Runs other jobs until a job finishes.
+   * @param handle Job to wait on.
+   */
+  void Wait(const JobHandle& handle);
+
+  /**
+   * @brief Runs a function over a range of indices, split into jobs.
+   *
+   * The calling thread runs the first chunk and waits on the rest.
+   *
+   * @param begin First index.
+   * @param end Index past the last.
+   * @param grain_size Most indices per job. Should be large enough that a
+   *        chunk takes longer to run than to schedule.
+   * @param function Callable taking the (begin, end) indices of a chunk.
+   */
+  template <typename Function>
+  void ParallelFor(const size_t begin, const size_t end,
+                   const size_t grain_size, Function function);
+
+  /**
+   * @brief Accessor.
+   * @return Number of worker threads.
+   */
+  int num_workers() const;
+
+ private:
+  using Job = JobHandle::Job;
+
+  /**
+   * @brief Jobs queued on a worker, or on the shared queue.
+   */
+  struct JobQueue {
+    /// Guards jobs.
+    std::mutex mutex;
+
+    /// Jobs in the order scheduled.
+    stl_deque<std::shared_ptr<Job>> jobs;
+  };
+
+  /**
+   * @brief Queues a job whose dependencies have finished.
+   * @param job Job to queue.
+   */
+  void Enqueue(std::shared_ptr<Job> job);
+
+  /**
+   * @brief Takes a job to run: from the back of the calling worker's own
+   *        queue if it has one, else from the front of another queue.
+   * @return Job, or null if none are queued.
+   */
+  std::shared_ptr<Job> Dequeue();
+
+  /**
+   * @brief Runs a job, then queues continuations that are now ready.
+   * @param job Job to run.
+   */
+  void Run(const std::shared_ptr<Job>& job);
+
+  /**
+   * @brief Loop run by each worker thread.
+   * @param worker_index Index of worker's queue.
+   */
+  void WorkerLoop(const int worker_index);
+
+  /**
+   * @brief Gets the queue index of the calling thread.
+   * @return Worker index, or the shared queue's index if the caller is not
+   *         a worker of this JobSystem.
+   */
+  int CurrentQueueIndex() const;
+
+  /// Queues of each worker, followed by the shared queue.
+  std::unique_ptr<JobQueue[]> queues_;
+
+  /// Number of worker threads.
+  int num_workers_;
+
+  /// Worker threads.
+  stl_vector<std::thread> workers_;
+
+  /// Number of jobs in all queues. May briefly be below the true count.
+  std::atomic<std::int64_t> num_queued_;
+
+  /// Number of threads in Wait(), which need waking when jobs finish.
+  std::atomic<int> num_waiting_;
+
+  /// Set to stop workers.
+  bool stopping_;
+
+  /// Guards sleeping on wake_, and stopping_.
+  std::mutex sleep_mutex_;
+
+  /// Signaled when jobs are queued, or finish while threads are waiting.
+  std::condition_variable wake_;
+};
+
+template <typename Function>
+void JobSystem::ParallelFor(const size_t begin, const size_t end,
+                            const size_t grain_size, Function function) {
+  if (begin >= end) {
+    return;
+  }
+  const size_t chunk_size = std::max<size_t>(1, grain_size);
+  stl_vector<JobHandle> chunks;
+  chunks.reserve((end - begin - 1) / chunk_size);
+  for (size_t chunk_begin = begin + chunk_size; chunk_begin < end;
+       chunk_begin += chunk_size) {
+    const size_t chunk_end = std::min(end, chunk_begin + chunk_size);
+    chunks.push_back(Schedule([&function, chunk_begin, chunk_end]() {
+      function(chunk_begin, chunk_end);
+    }));
+  }
+  function(begin, std::min(end, begin + chunk_size));
+  for (const auto& chunk : chunks) {
+    Wait(chunk);
+  }
+}
+
+}  // namespace ogle
@@ -0,0 +1,10 @@
+/**
+ * @file ogle_jobs.h
+ * @brief Group header for jobs library.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include "jobs/job_system.h"
+#include "jobs/task_queue.h"
@@ -0,0 +1,44 @@
+/**
+ * @file task_queue.h
+ * @brief Defines TaskQueue.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <functional>
+#include <mutex>
+
+namespace ogle {
+
+/**
+ * @brief Queue of tasks posted from any thread, to be run by one owning
+ *        thread.
+ *
+ * Used to funnel work that must happen on a particular thread, such as
+ * creating GL objects on the thread that owns the context, out of jobs.
+ */
+class TaskQueue {
+ public:
+  /**
+   * @brief Adds a task to run later on the owning thread. Thread-safe.
+   * @param task Task to run.
+   */
+  void Post(std::function<void()> task);
+
+  /**
+   * @brief Runs posted tasks in the order posted, including any posted by
+   *        the tasks themselves. Call only from the owning thread.
+   * @return Number of tasks run.
+   */
+  size_t RunAll();
+
+ private:
+  /// Guards tasks_.
+  std::mutex mutex_;
+
+  /// Tasks not yet run.
+  stl_deque<std::function<void()>> tasks_;
+};
+
+}  // namespace ogle
@@ -44,9 +44,7 @@ class Vector {
    * @brief Copy constructor.
    * @param other Vector to copy into this one.
    */
-  Vector(const Vector& other)
-    : data_(other.data_) {
-  }
+  Vector(const Vector& other) = default;
 
   /**
    * @brief Constructor that takes list of values.
@@ -104,10 +102,7 @@ class Vector {
    * @param rhs Vector to copy data from.
    * @return Reference to this Vector.
    */
-  Vector& operator=(const Vector& rhs) {
-    std::copy(rhs.data_.begin(), rhs.data_.end(), data_.begin());
-    return *this;
-  }
+  Vector& operator=(const Vector& rhs) = default;
 
   /**
    * @brief Equality operator.
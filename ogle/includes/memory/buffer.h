@@ -1,13 +1,18 @@
 /**
  * @file buffer.h
- * @brief Defines Buffer.
+ * @brief Defines Buffer and BufferView.
  */
 
 #pragma once
 
 #include "std/ogle_std.inc"
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iterator>
+#include <new>
+#include <type_traits>
 #include "easylogging++.h"  // NOLINT
 
 namespace ogle {
@@ -15,22 +20,135 @@ namespace ogle {
 /// Type for indexing into a Buffer.
 using BufferIndex = std::uint32_t;
 
+/**
+ * @brief A range of elements in memory owned by someone else.
+ *
+ * Views are cheap to copy and slice, so they can hand parts of a Buffer
+ * around without copying its contents. A view is invalid once the memory it
+ * refers to is freed.
+ */
+template<typename T>
+class BufferView {
+ public:
+  /**
+   * @brief Constructor. Creates an empty view.
+   */
+  BufferView() : data_(nullptr), num_elements_(0) {
+  }
+
+  /**
+   * @brief Constructor. Creates a view of an array.
+   * @param data Start of array. Only null if num_elements is 0.
+   * @param num_elements How many elements are in array.
+   */
+  BufferView(T* data, BufferIndex num_elements)
+    : data_(data), num_elements_(num_elements) {
+  }
+
+  /**
+   * @brief Converting constructor, for viewing elements as const.
+   * @param other View to copy.
+   */
+  template<typename U, typename = typename std::enable_if<
+                           std::is_convertible<U*, T*>::value>::type>
+  BufferView(const BufferView<U>& other)  // NOLINT
+    : data_(other.data()), num_elements_(other.num_elements()) {
+  }
+
+  /**
+   * @brief Creates a view of a sub-range of this view.
+   *
+   * A fatal error occurs if the sub-range does not fit in this view.
+   *
+   * @param begin Index of first element.
+   * @param num_elements How many elements to view.
+   * @return View of sub-range.
+   */
+  BufferView Slice(const BufferIndex begin,
+                   const BufferIndex num_elements) const {
+    CHECK(begin <= num_elements_ && num_elements <= num_elements_ - begin)
+        << "Slice is out of range of BufferView.";
+    return BufferView(data_ + begin, num_elements);
+  }
+
+  /**
+   * @brief Accesses an element. The index is not checked.
+   * @param index Index of element.
+   * @return Element.
+   */
+  T& operator[](const BufferIndex index) const {
+    return data_[index];
+  }
+
+  ///@{
+  /// Iterators over elements.
+  T* begin() const { return data_; }
+  T* end() const { return data_ + num_elements_; }
+  ///@}
+
+  /**
+   * @brief Returns size of view, in bytes.
+   * @return
+   */
+  std::uint64_t SizeInBytes() const {
+    return num_elements_ * sizeof(T);
+  }
+
+  /**
+   * @brief Accessor.
+   * @return Number of elements in view.
+   */
+  const BufferIndex num_elements() const {
+    return num_elements_;
+  }
+
+  /**
+   * @brief Accessor.
+   * @return Start of elements viewed.
+   */
+  T* data() const {
+    return data_;
+  }
+
+ private:
+  /// Start of elements viewed.
+  T* data_;
+
+  /// Number of elements viewed.
+  BufferIndex num_elements_;
+};
+
 /**
  * @brief Memory buffer class that cleans up after itself.
+ *
+ * Storage allocated by a Buffer is aligned as requested, so that SIMD code
+ * may use aligned loads on it. A Buffer may instead adopt memory allocated
+ * elsewhere, such as a mapped file or mapped GPU buffer, along with a
+ * function to free it.
  */
 template<typename T>
 class Buffer {
  public:
+  /// Frees memory adopted by a Buffer, given its start.
+  using Deleter = std::function<void(T*)>;
+
+  /// Alignment of storage, in bytes, if none is requested.
+  static constexpr std::size_t kDefaultAlignment = alignof(std::max_align_t);
+
   /**
    * @brief Constructor. Creates a buffer of requested size.
    *
    * Doesn't initialize values in buffer.
    *
    * @param num_elements How many elements to reserve.
+   * @param alignment Alignment of storage in bytes, such as 32 or 64 for
+   *        SIMD. Must be a power of 2. At least alignof(T) is used.
    */
-  explicit Buffer(BufferIndex num_elements = 0)
-    : num_elements_(num_elements) {
-    data_ = AllocateBuffer<T>(num_elements_);
+  explicit Buffer(BufferIndex num_elements = 0,
+                  std::size_t alignment = kDefaultAlignment)
+    : num_elements_(num_elements),
+      alignment_(std::max(alignment, alignof(T))) {
+    data_ = AllocateStorage(num_elements_, alignment_);
   }
 
   /**
@@ -38,47 +156,68 @@ class Buffer {
    * @param init_list Initial elements to copy.
    */
   Buffer(std::initializer_list<T> init_list)
-    : num_elements_(init_list.size()) {
-    data_ = AllocateBuffer<T>(num_elements_);
-    if (num_elements_ > 0) {
-      std::copy(std::begin(init_list), std::end(init_list), data_);
-    }
+    : Buffer(static_cast<BufferIndex>(init_list.size())) {
+    std::copy(std::begin(init_list), std::end(init_list), data_);
   }
 
   /**
    * @brief Constructor. Creates a buffer that wraps existing array.
    * @param data Array that is taken as Buffer storage. The Buffer takes
-   *        ownership of this memory. Cannot be null.
+   *        ownership of this memory, which must have been allocated with
+   *        new[]. Cannot be null.
    * @param num_elements How many elements are in array.
    */
   Buffer(T* data, BufferIndex num_elements)
+    : Buffer(data, num_elements, [](T* array) { delete[] array; }) {
+  }
+
+  /**
+   * @brief Constructor. Creates a buffer that adopts memory allocated
+   *        elsewhere, without copying it.
+   * @param data Memory that is taken as Buffer storage. Cannot be null.
+   * @param num_elements How many elements are in memory.
+   * @param deleter Function called with data to free it when the Buffer is
+   *        destroyed. Cannot be empty.
+   */
+  Buffer(T* data, BufferIndex num_elements, Deleter deleter)
     : num_elements_(num_elements),
-      data_(data) {
+      alignment_(alignof(T)),
+      data_(data),
+      deleter_(std::move(deleter)) {
     CHECK(data_ != nullptr) << "Cannot create Buffer from null data.";
+    CHECK(deleter_) << "Cannot create Buffer without a deleter.";
   }
 
   /**
    * @brief Constructor that copies data from a stl_vector.
    * @param data_vector Vector to copy.
+   * @param alignment Alignment of storage, as for Buffer(BufferIndex).
    */
-  explicit Buffer(const stl_vector<T>& data_vector)
-    : num_elements_(data_vector.size()) {
-    data_ = AllocateBuffer<T>(num_elements_);
-    if (num_elements_ > 0) {
-      std::copy(std::begin(data_vector), std::end(data_vector), data_);
-    }
+  explicit Buffer(const stl_vector<T>& data_vector,
+                  std::size_t alignment = kDefaultAlignment)
+    : Buffer(static_cast<BufferIndex>(data_vector.size()), alignment) {
+    std::copy(std::begin(data_vector), std::end(data_vector), data_);
+  }
+
+  /**
+   * @brief Constructor that copies data from a view.
+   * @param view Elements to copy.
+   * @param alignment Alignment of storage, as for Buffer(BufferIndex).
+   */
+  explicit Buffer(const BufferView<const T>& view,
+                  std::size_t alignment = kDefaultAlignment)
+    : Buffer(view.num_elements(), alignment) {
+    std::copy(view.begin(), view.end(), data_);
   }
 
   /**
    * @brief Copy constructor.
-   * @param other Buffer to copy contents from. Shallow.
+   * @param other Buffer to copy contents from. Storage has the same
+   *        alignment.
    */
   Buffer(const Buffer& other)
-    : num_elements_(other.num_elements_) {
-    data_ = AllocateBuffer<T>(num_elements_);
-    if (num_elements_ > 0) {
-      std::copy_n(std::begin(other.data_), num_elements_, data_);
-    }
+    : Buffer(other.num_elements_, other.alignment_) {
+    std::copy_n(other.data_, num_elements_, data_);
   }
 
   /**
@@ -86,40 +225,43 @@ class Buffer {
    * @param other Buffer to take data from. Invalid afterwards.
    */
   Buffer(Buffer&& other)  // NOLINT
-    : num_elements_(other.num_elements_) {
-    data_ = other.data_;
+    : num_elements_(other.num_elements_),
+      alignment_(other.alignment_),
+      data_(other.data_),
+      deleter_(std::move(other.deleter_)) {
     other.data_ = nullptr;
     other.num_elements_ = 0;
+    other.deleter_ = nullptr;
   }
 
   /**
    * @brief Destructor. Deletes data held by buffer.
    */
   ~Buffer() {
-    if (data_ != nullptr) {
-      delete[] data_;
-    }
+    Release();
   }
 
   /**
    * @brief Copy assignment operator.
    *
-   * Deletes existing data held by this Buffer, if a different amount of
-   * space is required to hold the new contents.
+   * Deletes existing data held by this Buffer, unless it allocated storage
+   * of the same size and alignment that can be reused.
    *
-   * @param other Buffer to copy contents from. Shallow.
+   * @param other Buffer to copy contents from.
    * @return Reference to this Buffer.
    */
   Buffer& operator=(const Buffer& other) {
-    if (num_elements_ != other.num_elements_) {
-      delete[] data_;
-      num_elements_ = other.num_elements_;
-      data_ = AllocateBuffer<T>(num_elements_);
+    if (this == &other) {
+      return *this;
     }
-    if (num_elements_ > 0) {
-      CHECK(data_ != nullptr) << "Cannot copy to null data in Buffer.";
-      std::copy_n(std::begin(other.data_), num_elements_, data_);
+    if (deleter_ || num_elements_ != other.num_elements_ ||
+        alignment_ != other.alignment_) {
+      Release();
+      num_elements_ = other.num_elements_;
+      alignment_ = other.alignment_;
+      data_ = AllocateStorage(num_elements_, alignment_);
     }
+    std::copy_n(other.data_, num_elements_, data_);
     return *this;
   }
 
@@ -132,11 +274,17 @@ class Buffer {
    * @return Reference to this Buffer.
    */
   Buffer& operator=(Buffer&& other) {  // NOLINT
-    delete[] data_;
+    if (this == &other) {
+      return *this;
+    }
+    Release();
     num_elements_ = other.num_elements_;
+    alignment_ = other.alignment_;
     data_ = other.data_;
+    deleter_ = std::move(other.deleter_);
     other.data_ = nullptr;
     other.num_elements_ = 0;
+    other.deleter_ = nullptr;
     return *this;
   }
 
@@ -162,6 +310,22 @@ class Buffer {
     }
   }
 
+  /**
+   * @brief Creates a view of all elements, without copying them.
+   * @return View, valid while this Buffer holds the same data.
+   */
+  BufferView<const T> View() const {
+    return BufferView<const T>(data_, num_elements_);
+  }
+
+  /**
+   * @brief Creates a modifiable view of all elements, without copying them.
+   * @return View, valid while this Buffer holds the same data.
+   */
+  BufferView<T> MutableView() {
+    return BufferView<T>(data_, num_elements_);
+  }
+
   /**
    * @brief Accessor.
    * @return Number of elements in buffer.
@@ -170,6 +334,15 @@ class Buffer {
     return num_elements_;
   }
 
+  /**
+   * @brief Accessor.
+   * @return Alignment of storage in bytes. Adopted memory is assumed to
+   *         have alignof(T).
+   */
+  std::size_t alignment() const {
+    return alignment_;
+  }
+
   /**
    * @brief Accessor.
    * @return Access to data stored in Buffer.
@@ -178,13 +351,79 @@ class Buffer {
     return data_;
   }
 
+  /**
+   * @brief Accessor.
+   * @return Modifiable access to data stored in Buffer.
+   */
+  T* mutable_data() {
+    return data_;
+  }
+
  private:
+  /**
+   * @brief Allocates aligned storage and default-initializes its elements.
+   *
+   * The heap address is kept just before the first element, to free it.
+   * A fatal error occurs if allocation fails.
+   *
+   * @param num_elements How many elements to allocate.
+   * @param alignment Alignment in bytes. Must be a power of 2.
+   * @return Storage, or null if num_elements is 0.
+   */
+  static T* AllocateStorage(const BufferIndex num_elements,
+                            const std::size_t alignment) {
+    CHECK((alignment & (alignment - 1)) == 0)
+        << "Buffer alignment must be a power of 2: " << alignment;
+    if (num_elements == 0) {
+      return nullptr;
+    }
+    void* memory = ::operator new(
+        num_elements * sizeof(T) + sizeof(void*) + alignment - 1);
+    CHECK(memory != nullptr) << "Buffer allocation failed.";
+    const auto address =
+        (reinterpret_cast<std::uintptr_t>(memory) + sizeof(void*) +
+         alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+    reinterpret_cast<void**>(address)[-1] = memory;
+    T* data = reinterpret_cast<T*>(address);
+    for (BufferIndex index = 0; index < num_elements; ++index) {
+      new (data + index) T;
+    }
+    return data;
+  }
+
+  /**
+   * @brief Frees data held by buffer, whether allocated or adopted.
+   */
+  void Release() {
+    if (data_ == nullptr) {
+      return;
+    }
+    if (deleter_) {
+      deleter_(data_);
+      deleter_ = nullptr;
+    } else {
+      for (BufferIndex index = 0; index < num_elements_; ++index) {
+        data_[index].~T();
+      }
+      ::operator delete(reinterpret_cast<void**>(data_)[-1]);
+    }
+    data_ = nullptr;
+  }
+
   /// Number of elements stored.
   BufferIndex num_elements_;
 
+  /// Alignment of storage in bytes.
+  std::size_t alignment_;
+
   /// The data owned by this Buffer.
   T* data_;
+
+  /// Frees adopted data. Empty if the Buffer allocated data itself.
+  Deleter deleter_;
 };
 
-}  // namespace ogle
+template<typename T>
+constexpr std::size_t Buffer<T>::kDefaultAlignment;
 
+}  // namespace ogle
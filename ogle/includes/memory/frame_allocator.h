@@ -0,0 +1,164 @@
+/**
+ * @file frame_allocator.h
+ * @brief Defines FrameAllocator.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ogle {
+
+/**
+ * @brief Linear allocator for memory needed only until the end of a frame.
+ *
+ * Allocating bumps an offset into a block, and nothing is freed until
+ * Reset() releases everything at once. When a frame outgrows the block,
+ * more blocks are added, and Reset() replaces them with one block large
+ * enough for the whole frame, so steady-state frames take no memory from
+ * the heap.
+ *
+ * Each thread has its own allocator, from ForThread(). Application resets
+ * that of the thread running its loop at the end of each frame.
+ */
+class FrameAllocator {
+ public:
+  /// Size of first block, in bytes.
+  static constexpr std::size_t kDefaultBlockSize = 256 * 1024;
+
+  /**
+   * @brief Constructor.
+   * @param block_size Size of first block, in bytes.
+   */
+  explicit FrameAllocator(const std::size_t block_size = kDefaultBlockSize);
+
+  FrameAllocator(const FrameAllocator&) = delete;
+  FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+  /**
+   * @brief Gets the calling thread's allocator.
+   * @return Allocator.
+   */
+  static FrameAllocator& ForThread();
+
+  /**
+   * @brief Allocates memory valid until the next Reset().
+   * @param size Size in bytes.
+   * @param alignment Alignment in bytes. Must be a power of 2.
+   * @return Memory.
+   */
+  void* Allocate(const std::size_t size,
+                 const std::size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * @brief Allocates an uninitialized array valid until the next Reset().
+   * @param count Number of elements.
+   * @return Array.
+   */
+  template<typename T>
+  T* AllocateArray(const std::size_t count) {
+    return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  /**
+   * @brief Releases all memory allocated since the last reset. Objects in
+   *        it are not destroyed.
+   */
+  void Reset();
+
+  /**
+   * @brief Accessor.
+   * @return Bytes allocated since the last reset.
+   */
+  std::size_t bytes_used() const;
+
+  /**
+   * @brief Accessor.
+   * @return Bytes held in blocks.
+   */
+  std::size_t capacity() const;
+
+ private:
+  /**
+   * @brief A block of memory that allocations are taken from.
+   */
+  struct Block {
+    /// Memory.
+    std::unique_ptr<char[]> memory;
+
+    /// Size in bytes.
+    std::size_t size;
+  };
+
+  /// Blocks, the last of which is being allocated from.
+  stl_vector<Block> blocks_;
+
+  /// Offset of unused memory in the last block.
+  std::size_t offset_;
+
+  /// Bytes allocated since the last reset.
+  std::size_t bytes_used_;
+
+  /// Smallest size of a new block.
+  std::size_t block_size_;
+};
+
+/**
+ * @brief STL allocator that allocates from the calling thread's
+ *        FrameAllocator.
+ *
+ * Containers using it must be used on one thread, and destroyed before the
+ * end of the frame. Freeing memory does nothing; it is reclaimed by Reset().
+ */
+template<typename T>
+class FrameSTLAllocator {
+ public:
+  /// Type allocated.
+  using value_type = T;
+
+  /**
+   * @brief Constructor.
+   */
+  FrameSTLAllocator() = default;
+
+  /**
+   * @brief Converting constructor, for rebinding to other types.
+   */
+  template<typename U>
+  FrameSTLAllocator(const FrameSTLAllocator<U>&) {  // NOLINT
+  }
+
+  /**
+   * @brief Allocates storage.
+   * @param count Number of objects to allocate storage for.
+   * @return Storage.
+   */
+  T* allocate(const std::size_t count) {
+    return FrameAllocator::ForThread().AllocateArray<T>(count);
+  }
+
+  /**
+   * @brief Does nothing; storage is reclaimed at the end of the frame.
+   */
+  void deallocate(T*, const std::size_t) {
+  }
+};
+
+template<typename T, typename U>
+bool operator==(const FrameSTLAllocator<T>&, const FrameSTLAllocator<U>&) {
+  return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const FrameSTLAllocator<T>&, const FrameSTLAllocator<U>&) {
+  return false;
+}
+
+/// Vector for temporary data used within a frame.
+template<typename T>
+using frame_vector = std::vector<T, FrameSTLAllocator<T>>;
+
+}  // namespace ogle
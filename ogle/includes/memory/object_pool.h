@@ -0,0 +1,228 @@
+/**
+ * @file object_pool.h
+ * @brief Defines ObjectPool and ObjectPoolSet.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+namespace ogle {
+
+/**
+ * @brief Allocates blocks of one size from slabs, in O(1) time.
+ *
+ * Slabs hold many blocks side by side, so objects allocated together share
+ * cache lines and pages, instead of being scattered across the heap. Blocks
+ * are aligned to and padded to a multiple of the cache line size, so no two
+ * objects share a line. Freed blocks go on a free list for reuse; slabs are
+ * not returned to the heap until the pool is destroyed.
+ *
+ * With thread caches enabled, each thread keeps a few free blocks of its
+ * own, so most allocations need no lock. Such a pool must outlive all
+ * threads that use it.
+ */
+class ObjectPool {
+ public:
+  /// Blocks are aligned to, and padded to a multiple of, this many bytes.
+  static constexpr std::size_t kCacheLineSize = 64;
+
+  /**
+   * @brief Occupancy of a pool.
+   */
+  struct Statistics {
+    /// Name of pool.
+    stl_string name;
+
+    /// Size of each block in bytes.
+    std::size_t block_size;
+
+    /// Number of slabs allocated.
+    std::size_t num_slabs;
+
+    /// Number of blocks in all slabs.
+    std::size_t num_blocks;
+
+    /// Number of blocks allocated and not freed.
+    std::size_t num_live;
+
+    /// Most blocks live at once.
+    std::size_t peak_live;
+
+    /**
+     * @brief Finds how much of the pool is unused.
+     * @return Fraction of blocks that are free, from 0 to 1.
+     */
+    float fragmentation() const;
+  };
+
+  /**
+   * @brief Constructor. Slabs are allocated on demand.
+   * @param name Name of pool, for statistics.
+   * @param block_size Smallest size of each block in bytes.
+   * @param thread_cache Whether threads cache free blocks.
+   */
+  ObjectPool(const stl_string& name, const std::size_t block_size,
+             const bool thread_cache);
+
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+  /**
+   * @brief Destructor. Frees all slabs.
+   */
+  ~ObjectPool();
+
+  /**
+   * @brief Allocates a block.
+   * @return Block.
+   */
+  void* Allocate();
+
+  /**
+   * @brief Frees a block. May be called from any thread.
+   * @param memory Block returned by Allocate(), or nullptr.
+   */
+  void Free(void* memory);
+
+  /**
+   * @brief Gets current occupancy of pool.
+   * @return Statistics.
+   */
+  Statistics statistics() const;
+
+  /**
+   * @brief Gets current occupancy of all pools in existence.
+   * @return Statistics of each pool.
+   */
+  static stl_vector<Statistics> AllStatistics();
+
+  /**
+   * @brief Accessor.
+   * @return Size of each block in bytes.
+   */
+  std::size_t block_size() const;
+
+ private:
+  friend struct ThreadPoolCache;
+
+  /**
+   * @brief A free block, linked into a free list.
+   */
+  struct FreeBlock {
+    /// Next free block.
+    FreeBlock* next;
+  };
+
+  /**
+   * @brief Takes blocks from the shared free list, adding a slab if empty.
+   * @param max_blocks Most blocks to take.
+   * @param[out] num_taken Number of blocks taken.
+   * @return List of blocks taken.
+   */
+  FreeBlock* TakeBlocks(const std::size_t max_blocks, std::size_t* num_taken);
+
+  /**
+   * @brief Returns blocks to the shared free list.
+   * @param first First block of list.
+   * @param last Last block of list.
+   */
+  void ReturnBlocks(FreeBlock* first, FreeBlock* last);
+
+  /// Name of pool, for statistics.
+  stl_string name_;
+
+  /// Size of each block in bytes.
+  std::size_t block_size_;
+
+  /// Number of blocks in each slab.
+  std::size_t blocks_per_slab_;
+
+  /// Index of pool's list in each thread's cache, or -1 for none.
+  int cache_index_;
+
+  /// Guards free_list_ and slabs_.
+  mutable std::mutex mutex_;
+
+  /// Free blocks not cached by any thread.
+  FreeBlock* free_list_;
+
+  /// Memory allocated for each slab, which may start before its first
+  /// aligned block.
+  stl_vector<void*> slabs_;
+
+  ///@{
+  /// Counts of live blocks.
+  std::atomic<std::size_t> num_live_;
+  std::atomic<std::size_t> peak_live_;
+  ///@}
+};
+
+/**
+ * @brief A family of ObjectPools of increasing block size, for objects of
+ *        types derived from a common base.
+ *
+ * Each allocation comes from the pool with the smallest blocks that fit it.
+ * Allocations larger than the largest pool are made with global new.
+ */
+class ObjectPoolSet {
+ public:
+  /**
+   * @brief Constructor. Pools are created on demand.
+   * @param name Name of family. Pools are named by it and their size.
+   * @param max_size Largest size to pool in bytes.
+   * @param thread_cache Whether threads cache free blocks.
+   */
+  ObjectPoolSet(const stl_string& name, const std::size_t max_size,
+                const bool thread_cache);
+
+  ObjectPoolSet(const ObjectPoolSet&) = delete;
+  ObjectPoolSet& operator=(const ObjectPoolSet&) = delete;
+
+  /**
+   * @brief Destructor. Destroys all pools.
+   */
+  ~ObjectPoolSet();
+
+  /**
+   * @brief Allocates memory.
+   * @param size Size in bytes.
+   * @return Memory.
+   */
+  void* Allocate(const std::size_t size);
+
+  /**
+   * @brief Frees memory.
+   * @param memory Memory returned by Allocate(), or nullptr.
+   * @param size Size passed to Allocate().
+   */
+  void Free(void* memory, const std::size_t size);
+
+ private:
+  /**
+   * @brief Gets the pool for a size, creating it if needed.
+   * @param size Size in bytes, at most #max_size_.
+   * @return Pool.
+   */
+  ObjectPool* GetPool(const std::size_t size);
+
+  /// Name of family.
+  stl_string name_;
+
+  /// Largest size to pool in bytes.
+  std::size_t max_size_;
+
+  /// Whether threads cache free blocks.
+  bool thread_cache_;
+
+  /// Guards creation of pools.
+  std::mutex mutex_;
+
+  /// Pool for each multiple of ObjectPool::kCacheLineSize.
+  std::unique_ptr<std::atomic<ObjectPool*>[]> pools_;
+};
+
+}  // namespace ogle
@@ -7,4 +7,6 @@
 
 #include "std/ogle_std.inc"
 #include "memory/buffer.h"
+#include "memory/frame_allocator.h"
+#include "memory/object_pool.h"
 
@@ -14,6 +14,7 @@
 #include "file_system/ogle_file_system.h"
 #include "geometry/ogle_geometry.h"
 #include "input/ogle_input.h"
+#include "jobs/ogle_jobs.h"
 #include "math/ogle_math.h"
 #include "renderer/ogle_renderer.h"
 #include "resource/ogle_resource.h"
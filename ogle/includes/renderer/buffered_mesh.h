@@ -8,6 +8,7 @@
 #include "std/ogle_std.inc"
 #include "math/vector.h"
 #include "memory/buffer.h"
+#include "renderer/vertex_layout.h"
 
 namespace ogle {
 
@@ -29,20 +30,32 @@ using NormalBuffer = Buffer<Vector3f>;
 /// Index buffer type.
 using IndexBuffer = Buffer<std::uint32_t>;
 
+/// Buffer of interleaved vertices, laid out by a VertexLayout.
+using InterleavedVertexBuffer = Buffer<std::uint8_t>;
+
 /**
  * @brief A 3D geometry mesh that has been prepared for rendering.
  *
  * It is subclassed to implement meshes that are ready to be rendered by
  * specific graphics APIs and hardware. It is meant to prepare raw data buffers,
  * not to provide more functionality for the Mesh.
+ *
+ * Vertex data is arranged according to a VertexLayout. Interleaved layouts
+ * fill only #interleaved_vertices(); split layouts fill only the separate
+ * attribute buffers.
  */
 class BufferedMesh {
  public:
+  /// Configuration attribute selecting the vertex layout, by name. The
+  /// interleaved layout is used if absent.
+  static const stl_string kConfigAttributeVertexLayout;
+
   /**
    * @brief Constructor.
    * @param mesh Const reference to mesh to prepare for rendering.
+   * @param vertex_layout Arrangement of vertex data in buffers.
    */
-  explicit BufferedMesh(const Mesh& mesh);
+  BufferedMesh(const Mesh& mesh, const VertexLayout& vertex_layout);
 
   /**
    * @brief Destructor.
@@ -67,8 +80,29 @@ class BufferedMesh {
   virtual const TexCoordUVBuffer& uvs() const = 0;
   virtual const NormalBuffer& normals() const = 0;
   virtual const IndexBuffer& indices() const = 0;
+  virtual const InterleavedVertexBuffer& interleaved_vertices() const = 0;
   //@}
 
+  /**
+   * @brief Returns Mesh that buffers were prepared for.
+   */
+  const Mesh& mesh() const;
+
+  /**
+   * @brief Returns arrangement of vertex data in buffers.
+   */
+  const VertexLayout& vertex_layout() const;
+
+  /**
+   * @brief Identifies the vertex array state set up over these buffers.
+   *        Draws with the same key use the same vertex array, so it need not
+   *        be bound again between them.
+   * @param instanced Whether the vertex array also enables per-instance
+   *        attributes.
+   * @return Key.
+   */
+  virtual const void* vertex_array_key(const bool instanced) const = 0;
+
  protected:
   /**
    * @brief Prepares buffers for rendering the Mesh.
@@ -78,6 +112,9 @@ class BufferedMesh {
 
   /// Reference to Mesh to prepare buffers for.
   const Mesh& mesh_;
+
+  /// Arrangement of vertex data in buffers.
+  VertexLayout vertex_layout_;
 };
 
 }  // namespace ogle
@@ -7,6 +7,7 @@
 
 #include "std/ogle_std.inc"
 #include "entity/component.h"
+#include "geometry/frustum.h"
 #include "math/matrix.h"
 
 namespace ogle {
@@ -44,6 +45,13 @@ class Camera : public Component {
    * @return Matrix.
    */
   virtual Matrix44f GetProjectionMatrix() const = 0;
+
+  /**
+   * @brief Computes the world-space volume visible to the camera.
+   * @param transform Transform from which to view scene.
+   * @return Frustum.
+   */
+  Frustum GetFrustum(const Transform& transform) const;
 };
 
 }  // namespace ogle
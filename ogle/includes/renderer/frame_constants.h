@@ -0,0 +1,94 @@
+/**
+ * @file frame_constants.h
+ * @brief Defines FrameConstants and FrameConstantsBuffer.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <cstdint>
+#include <memory>
+
+namespace ogle {
+
+class Configuration;
+class Entity;
+
+/**
+ * @brief Shader constants shared by every draw in a frame.
+ *
+ * Laid out to match a std140 uniform block, which shader programs declare
+ * as:
+ *
+ *     layout (std140) uniform FrameConstants {
+ *       mat4 view_matrix;
+ *       mat4 projection_matrix;
+ *       vec4 light_position;
+ *       vec4 light_ambient_color;
+ *       vec4 light_diffuse_color;
+ *       vec4 light_specular_color;
+ *     };
+ *
+ * Matrices are column-major. Light position is in the world frame.
+ */
+struct FrameConstants {
+  /// Name of uniform block in shader programs.
+  static const stl_string kBlockName;
+
+  /// Uniform buffer binding point that the block is bound to.
+  static constexpr std::uint32_t kBindingPoint = 0;
+
+  /**
+   * @brief Fills constants from the camera and lights of a frame.
+   *
+   * Only the first light is used. Without lights, light colors are black.
+   *
+   * @param camera_entity Entity with attached Camera.
+   * @param light_entities Entities with attached Lights.
+   * @return Success/failure.
+   */
+  bool Set(const Entity& camera_entity,
+           const stl_vector<const Entity*>& light_entities);
+
+  float view_matrix[16];
+  float projection_matrix[16];
+  float light_position[4];
+  float light_ambient_color[4];
+  float light_diffuse_color[4];
+  float light_specular_color[4];
+};
+
+/**
+ * @brief GPU buffer holding FrameConstants for shader programs to read.
+ *
+ * Subclasses implement it for specific APIs.
+ */
+class FrameConstantsBuffer {
+ public:
+  /**
+   * @brief Destructor.
+   */
+  virtual ~FrameConstantsBuffer() = default;
+
+  /**
+   * @brief Creates a FrameConstantsBuffer.
+   * @param configuration Rendering configuration.
+   * @return New buffer, or nullptr on failure.
+   */
+  static std::unique_ptr<FrameConstantsBuffer> Load(
+      const Configuration& configuration);
+
+  /**
+   * @brief Replaces buffer contents.
+   * @param constants Constants for frame.
+   */
+  virtual void Update(const FrameConstants& constants) = 0;
+
+ protected:
+  /**
+   * @brief Default constructor.
+   */
+  FrameConstantsBuffer() = default;
+};
+
+}  // namespace ogle
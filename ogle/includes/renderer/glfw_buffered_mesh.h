@@ -7,27 +7,65 @@
 
 #include "std/ogle_std.inc"
 #include "renderer/buffered_mesh.h"
+#include "renderer/opengl_primitive_types.h"
 
 namespace ogle {
 
 /**
  * @brief A BufferedMesh implementation for OpenGL, GLSL, and GLFW.
+ *
+ * Create() uploads the buffers to OpenGL and sets up two vertex arrays over
+ * them: one for plain draws and one that also reads per-instance matrices
+ * from an instance buffer. All GLFWMeshRenderers of the mesh draw with
+ * these, so a mesh is uploaded once however many copies of it are drawn.
+ * An OpenGL context must be current to create and destroy the mesh.
  */
 class GLFWBufferedMesh : public BufferedMesh {
  public:
   /**
    * @brief Constructor.
    * @param mesh Mesh to prepare buffers for.
+   * @param vertex_layout Arrangement of vertex data in buffers.
    */
-  explicit GLFWBufferedMesh(const Mesh& mesh);
+  GLFWBufferedMesh(const Mesh& mesh, const VertexLayout& vertex_layout);
+
+  /**
+   * @brief Destructor. Deallocates OpenGL objects.
+   */
+  ~GLFWBufferedMesh() override;
 
   const VertexBuffer& vertices() const override;
   const TexCoordUVBuffer& uvs() const override;
   const NormalBuffer& normals() const override;
   const IndexBuffer& indices() const override;
+  const InterleavedVertexBuffer& interleaved_vertices() const override;
+
+  /**
+   * @brief Keys are the addresses of the vertex array IDs.
+   */
+  const void* vertex_array_key(const bool instanced) const override;
 
+  /**
+   * @brief Prepares buffers and uploads them to OpenGL.
+   * @return success or failure.
+   */
   bool Create() override;
 
+  /**
+   * @brief Accessor.
+   * @param instanced Whether to get the vertex array that enables
+   *        per-instance attributes.
+   * @return OpenGL ID of vertex array, which also binds the index buffer.
+   */
+  ogle::GLuint vertex_array_id(const bool instanced) const;
+
+  /**
+   * @brief Accessor.
+   * @return OpenGL ID of the buffer that the instanced vertex array reads
+   *         per-instance model-view and normal matrices from.
+   */
+  ogle::GLuint instance_buffer_id() const;
+
  protected:
   /// Vertex buffer.
   VertexBuffer vertices_;
@@ -40,6 +78,46 @@ class GLFWBufferedMesh : public BufferedMesh {
 
   /// Index buffer.
   IndexBuffer indices_;
+
+  /// Interleaved vertex attributes.
+  InterleavedVertexBuffer interleaved_vertices_;
+
+ private:
+  /**
+   * @brief Uploads vertex and index buffers to OpenGL.
+   */
+  void UploadBuffers();
+
+  /**
+   * @brief Points the bound vertex array's vertex attributes and index
+   *        buffer at the uploaded buffers.
+   */
+  void SetVertexAttributes();
+
+  /**
+   * @brief Points the bound vertex array's per-instance attributes at the
+   *        instance buffer.
+   */
+  void SetInstanceAttributes();
+
+  /// OpenGL ID for vertex buffer. Holds all attributes in interleaved
+  /// layouts, or positions in split layouts.
+  ogle::GLuint vertex_buffer_id_;
+
+  /// OpenGL ID for normal buffer, used only by split layouts.
+  ogle::GLuint normal_buffer_id_;
+
+  /// OpenGL ID for texture coordinate buffer, used only by split layouts.
+  ogle::GLuint uv_buffer_id_;
+
+  /// OpenGL ID for index buffer.
+  ogle::GLuint index_buffer_id_;
+
+  /// OpenGL ID for per-instance matrix buffer.
+  ogle::GLuint instance_buffer_id_;
+
+  /// OpenGL IDs for vertex arrays without and with per-instance attributes.
+  ogle::GLuint vertex_array_ids_[2];
 };
 
 }  // namespace ogle
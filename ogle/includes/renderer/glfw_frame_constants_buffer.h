@@ -0,0 +1,43 @@
+/**
+ * @file glfw_frame_constants_buffer.h
+ * @brief Defines GLFWFrameConstantsBuffer.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include "renderer/frame_constants.h"
+#include "renderer/opengl_primitive_types.h"
+
+namespace ogle {
+
+/**
+ * @brief FrameConstantsBuffer implemented as an OpenGL uniform buffer.
+ */
+class GLFWFrameConstantsBuffer : public FrameConstantsBuffer {
+ public:
+  /**
+   * @brief Constructor. Call Create() to complete object construction.
+   */
+  GLFWFrameConstantsBuffer();
+
+  /**
+   * @brief Destructor. Deallocates OpenGL objects.
+   */
+  ~GLFWFrameConstantsBuffer() override;
+
+  /**
+   * @brief Allocates uniform buffer and binds it to
+   *        FrameConstants::kBindingPoint.
+   * @return Success/failure.
+   */
+  bool Create();
+
+  void Update(const FrameConstants& constants) override;
+
+ private:
+  /// OpenGL ID for uniform buffer.
+  ogle::GLuint uniform_buffer_id_;
+};
+
+}  // namespace ogle
@@ -6,9 +6,10 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include "math/matrix.h"
 #include "renderer/glfw_buffered_mesh.h"
 #include "renderer/mesh_renderer.h"
-#include "renderer/opengl_primitive_types.h"
+#include "renderer/shader_program.h"
 
 namespace ogle {
 
@@ -25,18 +26,14 @@ class GLFWMeshRenderer : public MeshRenderer {
   /**
    * @brief Constructor. Call Create() to complete object construction.
    *
-   * @param mesh Mesh to render.
+   * @param mesh Mesh to render. Must be a GLFWBufferedMesh, whose vertex
+   *        arrays are shared by all renderers of it.
    * @param material Material to use in render pass.
    */
   GLFWMeshRenderer(const BufferedMesh& mesh, Material* material);
 
   /**
-   * @brief Destructor. Deallocates OpenGL objects.
-   */
-  ~GLFWMeshRenderer() override;
-
-  /**
-   * @brief Allocates OpenGL objects used for rendering.
+   * @brief Prepares to render with the material's program.
    * @return success/failure.
    */
   bool Create();
@@ -44,23 +41,95 @@ class GLFWMeshRenderer : public MeshRenderer {
   void Render(const Transform& transform, const Entity& camera,
               const stl_vector<const Entity*>& lights) override;
 
+  /**
+   * @brief Render mesh, skipping binds of the program, material variables,
+   *        and vertex array when the previous draw left them bound.
+   *
+   * Camera and light constants are read from the frame constants uniform
+   * block, so only model matrices are set per draw. Model-view and normal
+   * matrices are computed here once per draw, rather than per vertex.
+   */
+  void Render(const Transform& transform, const Entity& camera,
+              const stl_vector<const Entity*>& lights,
+              const BoundState& previous) override;
+
+  /**
+   * @brief Instancing is possible between renderers of the same BufferedMesh
+   *        and Material, if the material's program reads the model matrix
+   *        from the per-instance attribute.
+   */
+  bool CanInstance(const Renderer& other) const override;
+
+  void RenderInstanced(const stl_vector<const Transform*>& transforms,
+                       const Entity& camera,
+                       const stl_vector<const Entity*>& lights,
+                       const BoundState& previous) override;
+
+  BoundState bound_state() const override;
+
  private:
   struct Data;
 
-  /// Material to use to render mesh.
-  Material* material_;
+  /**
+   * @brief Binds program, variables, and vertex array for a draw, skipping
+   *        state left bound by the previous draw.
+   * @param previous State bound by the previous draw in this frame.
+   */
+  void BindState(const BoundState& previous);
 
-  /// OpenGL ID for vertex buffer.
-  ogle::GLuint vertex_buffer_id_;
+  /**
+   * @brief Compiles model matrix uniforms that the material's program
+   *        takes.
+   */
+  void CompileMatrixVariables();
 
-  /// OpenGL ID for normal buffer.
-  ogle::GLuint normal_buffer_id_;
+  /**
+   * @brief Gets view matrix of camera.
+   * @param camera Entity with attached camera.
+   * @param[out] view_matrix View matrix.
+   * @return Success/failure.
+   */
+  static bool GetViewMatrix(const Entity& camera, Matrix44f* view_matrix);
 
-  /// OpenGL ID for vertex buffer array object.
-  ogle::GLuint vertex_array_id_;
+  /**
+   * @brief Uploads model-view and normal matrices to the mesh's instance
+   *        buffer, which its instanced vertex array reads.
+   * @param view_matrix Camera view matrix.
+   * @param transforms Transforms of instances.
+   * @param num_instances Number of instances.
+   */
+  void UploadInstances(const Matrix44f& view_matrix,
+                       const Transform* const* transforms,
+                       const size_t num_instances);
+
+  /// Mesh to render, with the OpenGL objects to draw it.
+  const GLFWBufferedMesh& gl_mesh_;
+
+  /// Material to use to render mesh.
+  Material* material_;
 
-  /// OpenGL ID for index buffer.
-  ogle::GLuint index_buffer_id_;
+  /// Whether the material's program takes per-instance model-view and
+  /// normal matrices.
+  bool instanced_;
+
+  ///@{
+  /// Whether the material's program takes each model matrix uniform. Only
+  /// set for programs that are not instanced.
+  bool uses_model_matrix_;
+  bool uses_model_view_matrix_;
+  bool uses_normal_matrix_;
+  ///@}
+
+  ///@{
+  /// Model matrix uniforms compiled against the material's program.
+  ShaderProgram::CompiledVariable model_matrix_variable_;
+  ShaderProgram::CompiledVariable model_view_matrix_variable_;
+  ShaderProgram::CompiledVariable normal_matrix_variable_;
+  ///@}
+
+  /// Link generation of program that model matrix uniforms were compiled
+  /// against.
+  std::uint32_t matrix_link_generation_;
 };
 
 }  // namespace ogle
@@ -0,0 +1,267 @@
+/**
+ * @file glfw_state_cache.h
+ * @brief Defines GLFWStateCache.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <cstdint>
+#include "renderer/opengl_primitive_types.h"
+
+namespace ogle {
+
+/**
+ * @brief Shadow copy of OpenGL context state, which skips calls that would
+ *        not change it.
+ *
+ * Covers the bound program, vertex array, array, element array, and uniform
+ * buffers, the depth test, face culling, and blending switches and their
+ * settings, and 2D textures bound to each texture unit. For the shadow copy
+ * to stay correct, all changes to this state must go through the cache, or
+ * be followed by Invalidate().
+ *
+ * The element array buffer binding belongs to the bound vertex array, so it
+ * becomes unknown whenever the vertex array changes.
+ *
+ * OpenGL contexts are current on one thread, so the cache must only be used
+ * on the thread that owns the window's context. The window owns the cache
+ * for its context, and makes it available through current().
+ */
+class GLFWStateCache {
+ public:
+  /// Number of texture units whose bindings are shadowed. Binds on higher
+  /// units are always issued.
+  static constexpr GLuint kMaxTextureUnits = 16;
+
+  /**
+   * @brief Counts of state changes for one frame.
+   */
+  struct Statistics {
+    /// Number of calls passed on to OpenGL.
+    std::uint64_t num_issued_calls = 0;
+
+    /// Number of calls skipped because they would not change state.
+    std::uint64_t num_filtered_calls = 0;
+  };
+
+  /**
+   * @brief Constructor. All state starts out unknown.
+   */
+  GLFWStateCache();
+
+  /**
+   * @brief Gets the cache for the current OpenGL context.
+   * @return Cache, or nullptr if there is no current context.
+   */
+  static GLFWStateCache* current();
+
+  /**
+   * @brief Sets the cache for the current OpenGL context.
+   * @param cache Cache, or nullptr when the context is destroyed.
+   */
+  static void set_current(GLFWStateCache* cache);
+
+  /**
+   * @brief Marks all state unknown, so that the next call to set each is
+   *        issued. Use after code outside the cache changes state.
+   */
+  void Invalidate();
+
+  /**
+   * @brief Checks known state against state queried from OpenGL.
+   *
+   * Queries stall the pipeline, so use only for debugging and testing.
+   *
+   * @return true if all known state matches, else false. Mismatches are
+   *         logged.
+   */
+  bool Validate() const;
+
+  /**
+   * @brief Makes a program current, as glUseProgram.
+   * @param program Program ID.
+   */
+  void UseProgram(const GLuint program);
+
+  /**
+   * @brief Binds a vertex array, as glBindVertexArray.
+   * @param vertex_array Vertex array ID.
+   */
+  void BindVertexArray(const GLuint vertex_array);
+
+  /**
+   * @brief Binds a buffer, as glBindBuffer. Binds to targets that are not
+   *        shadowed are always issued.
+   * @param target Buffer target.
+   * @param buffer Buffer ID.
+   */
+  void BindBuffer(const GLenum target, const GLuint buffer);
+
+  /**
+   * @brief Enables or disables a capability, as glEnable and glDisable.
+   *        Capabilities that are not shadowed are always changed.
+   * @param capability GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, or another
+   *        capability.
+   * @param enabled Whether to enable.
+   */
+  void SetEnabled(const GLenum capability, const bool enabled);
+
+  /**
+   * @brief Sets depth comparison, as glDepthFunc.
+   * @param function Comparison function.
+   */
+  void DepthFunc(const GLenum function);
+
+  /**
+   * @brief Enables or disables depth writes, as glDepthMask.
+   * @param enabled Whether to write depth.
+   */
+  void DepthMask(const bool enabled);
+
+  /**
+   * @brief Sets faces to cull, as glCullFace.
+   * @param mode Faces to cull.
+   */
+  void CullFace(const GLenum mode);
+
+  /**
+   * @brief Sets winding of front faces, as glFrontFace.
+   * @param mode Winding.
+   */
+  void FrontFace(const GLenum mode);
+
+  /**
+   * @brief Sets blending factors, as glBlendFunc.
+   * @param source_factor Source factor.
+   * @param destination_factor Destination factor.
+   */
+  void BlendFunc(const GLenum source_factor, const GLenum destination_factor);
+
+  /**
+   * @brief Binds a texture to a texture unit, as glActiveTexture followed by
+   *        glBindTexture.
+   *
+   * Leaves the unit active. Only GL_TEXTURE_2D bindings are shadowed.
+   *
+   * @param unit Texture unit, counting from 0.
+   * @param target Texture target.
+   * @param texture Texture ID.
+   */
+  void BindTexture(const GLuint unit, const GLenum target,
+                   const GLuint texture);
+
+  ///@{
+  /// Clears bindings of an object that is about to be deleted, since
+  /// OpenGL may reuse its ID.
+  void ForgetProgram(const GLuint program);
+  void ForgetVertexArray(const GLuint vertex_array);
+  void ForgetBuffer(const GLuint buffer);
+  void ForgetTexture(const GLuint texture);
+  ///@}
+
+  /**
+   * @brief Ends counting for the current frame.
+   */
+  void EndFrame();
+
+  /**
+   * @brief Accessor.
+   * @return Counts for the last frame ended with EndFrame().
+   */
+  const Statistics& statistics() const;
+
+  /**
+   * @brief Accessor.
+   * @return Counts so far in the current frame.
+   */
+  const Statistics& frame_statistics() const;
+
+ private:
+  /// Value of shadowed state that is not known.
+  static constexpr GLuint kUnknown = ~GLuint(0);
+
+  ///@{
+  /// Indices of shadowed buffer targets.
+  static constexpr int kArrayBuffer = 0;
+  static constexpr int kElementArrayBuffer = 1;
+  static constexpr int kUniformBuffer = 2;
+  static constexpr int kNumBufferTargets = 3;
+  ///@}
+
+  ///@{
+  /// Indices of shadowed capabilities.
+  static constexpr int kDepthTest = 0;
+  static constexpr int kCullFace = 1;
+  static constexpr int kBlend = 2;
+  static constexpr int kNumCapabilities = 3;
+  ///@}
+
+  /**
+   * @brief Updates a shadowed value, and counts whether the call setting it
+   *        is issued or filtered.
+   * @param[in,out] shadow Shadowed value.
+   * @param value New value.
+   * @return true if the value changed, and the call must be issued.
+   */
+  bool Update(GLuint* shadow, const GLuint value);
+
+  /**
+   * @brief Gets the index of a shadowed buffer target.
+   * @param target Buffer target.
+   * @return Index, or -1 if the target is not shadowed.
+   */
+  static int BufferTargetIndex(const GLenum target);
+
+  /**
+   * @brief Gets the index of a shadowed capability.
+   * @param capability Capability.
+   * @return Index, or -1 if the capability is not shadowed.
+   */
+  static int CapabilityIndex(const GLenum capability);
+
+  /**
+   * @brief Makes a texture unit active, as glActiveTexture.
+   * @param unit Texture unit, counting from 0.
+   */
+  void ActiveTexture(const GLuint unit);
+
+  /// Current program.
+  GLuint program_;
+
+  /// Bound vertex array.
+  GLuint vertex_array_;
+
+  /// Buffers bound to shadowed targets.
+  GLuint buffers_[kNumBufferTargets];
+
+  /// Whether each shadowed capability is enabled.
+  GLuint capabilities_[kNumCapabilities];
+
+  ///@{
+  /// Fixed-function settings.
+  GLuint depth_function_;
+  GLuint depth_mask_;
+  GLuint cull_face_;
+  GLuint front_face_;
+  GLuint blend_source_factor_;
+  GLuint blend_destination_factor_;
+  ///@}
+
+  /// Active texture unit, counting from 0.
+  GLuint active_texture_unit_;
+
+  /// 2D textures bound to each texture unit.
+  GLuint textures_[kMaxTextureUnits];
+
+  /// Counts for the frame in progress.
+  Statistics frame_statistics_;
+
+  /// Counts for the last frame ended.
+  Statistics statistics_;
+
+  /// Cache for the current context.
+  static GLFWStateCache* current_;
+};
+
+}  // namespace ogle
@@ -33,7 +33,7 @@ class GLSLShader : public Shader {
    * @brief Builds Shader from loaded text.
    * @return Success/failure.
    */
-  bool Create();
+  bool Create() override;
 
  protected:
   /// OpenGL-generated shader ID.
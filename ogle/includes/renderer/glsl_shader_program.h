@@ -44,6 +44,34 @@ class GLSLShaderProgram : public ShaderProgram {
   void SetVariable(const stl_string& variable_name,
                    const Property& value) override;
 
+  /**
+   * @brief Checks whether linked program has an active vertex attribute.
+   * @param attribute_name Attribute name.
+   * @return Whether attribute exists.
+   */
+  bool HasAttribute(const stl_string& attribute_name) const;
+
+  /**
+   * @brief Checks whether linked program has an active uniform variable.
+   * @param variable_name Uniform variable name.
+   * @return Whether uniform exists.
+   */
+  bool HasUniform(const stl_string& variable_name) const;
+
+  /**
+   * @brief Only float scalars, vectors of 2-4 elements, and square matrices
+   *        of 2x2 to 4x4 are supported.
+   */
+  bool CompileVariable(const stl_string& variable_name,
+                       const PropertyType type, const std::uint8_t rows,
+                       const std::uint8_t columns,
+                       CompiledVariable* compiled) const override;
+
+  using ShaderProgram::CompileVariable;
+
+  void SetCompiledVariable(const CompiledVariable& variable,
+                           const void* data) override;
+
  protected:
   /**
    * @brief Get location of uniform variable.
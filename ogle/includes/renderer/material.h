@@ -6,14 +6,15 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include <cstdint>
 #include "entity/property.h"
 #include "math/vector.h"
+#include "renderer/shader_program.h"
 #include "resource/resource.h"
 
 namespace ogle {
 
 class ResourceManager;
-class ShaderProgram;
 
 /**
  * @brief A material (shader program + variable bindings) to draw a surface
@@ -72,6 +73,12 @@ class Material : public Resource {
    */
   bool LoadMTL(const stl_string& text);
 
+  /**
+   * @brief Accessor.
+   * @return Shader program used by this material.
+   */
+  const ShaderProgram* shader_program() const;
+
   /**
    * @brief Uses shader program for rendering.
    */
@@ -93,17 +100,41 @@ class Material : public Resource {
    */
   void SetVariable(const stl_string& name, const Property& variable);
 
+  /**
+   * @brief Sets a variable compiled against material's shader program.
+   * @param variable Compiled variable.
+   * @param data Row-major values to set.
+   */
+  void SetCompiledVariable(const ShaderProgram::CompiledVariable& variable,
+                           const void* data);
+
   /**
    * @brief Passes variables bound to material to shader program.
+   *
+   * Bindings are compiled against the program on first use, and again
+   * after it relinks. Otherwise no lookups or allocations are made.
    */
   void SetBoundVariables();
 
  private:
+  /**
+   * @brief Compiles variable bindings against shader program. Bindings the
+   *        program does not support are logged and skipped.
+   */
+  void CompileBindings();
+
   /// Shader program to use for this material.
   ShaderProgram* shader_program_;
 
   /// Variables to set for the shader program.
   stl_vector<std::unique_ptr<Property>> variable_bindings_;
+
+  /// Variable bindings compiled against the shader program.
+  stl_vector<ShaderProgram::CompiledVariable> compiled_bindings_;
+
+  /// Link generation of shader program that bindings were compiled against.
+  /// 0 if they need compiling.
+  std::uint32_t compiled_link_generation_;
 };
 
 }  // namespace ogle
@@ -31,6 +31,16 @@ class MeshRenderer : public Renderer {
   static MeshRenderer* Load(const Configuration& configuration,
                             const BufferedMesh& mesh, Material* material);
 
+  /**
+   * @brief Bounds of the rendered Mesh.
+   */
+  const Bounds* local_bounds() const override;
+
+  /**
+   * @brief BVH of the rendered Mesh, if it was loaded with one.
+   */
+  const TriangleBVH* local_bvh() const override;
+
  protected:
   /**
    * @brief Constructor.
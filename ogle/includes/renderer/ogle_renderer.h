@@ -8,8 +8,11 @@
 #include "std/ogle_std.inc"
 #include "renderer/buffered_mesh.h"
 #include "renderer/camera.h"
+#include "renderer/frame_constants.h"
 #include "renderer/glfw_buffered_mesh.h"
+#include "renderer/glfw_frame_constants_buffer.h"
 #include "renderer/glfw_mesh_renderer.h"
+#include "renderer/glfw_state_cache.h"
 #include "renderer/glsl_shader.h"
 #include "renderer/glsl_shader_program.h"
 #include "renderer/light.h"
@@ -17,9 +20,11 @@
 #include "renderer/mesh_renderer.h"
 #include "renderer/opengl_primitive_types.h"
 #include "renderer/perspective_camera.h"
+#include "renderer/render_queue.h"
 #include "renderer/renderer.h"
 #include "renderer/scene_graph.h"
 #include "renderer/scene_renderer.h"
 #include "renderer/shader.h"
 #include "renderer/shader_program.h"
+#include "renderer/vertex_layout.h"
 
@@ -13,6 +13,7 @@ namespace ogle {
 
 using GLint = std::int32_t;
 using GLuint = std::uint32_t;
+using GLenum = std::uint32_t;
 using GLfloat = float;
 using GLdouble = double;
 
@@ -0,0 +1,155 @@
+/**
+ * @file render_queue.h
+ * @brief Defines RenderQueue.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <cstdint>
+
+namespace ogle {
+
+class Renderer;
+class Transform;
+
+/**
+ * @brief Queue of draws to submit in one frame, ordered by sort key.
+ *
+ * Each draw is tagged with a 64-bit key packing, from most to least
+ * significant bits: layer, shader program, material, vertex array, and
+ * depth. Sorting by key groups draws that share GPU state, so that
+ * consecutive draws can skip redundant binds, and orders draws that share
+ * all state front to back.
+ */
+class RenderQueue {
+ public:
+  /// Sort key type.
+  using SortKey = std::uint64_t;
+
+  /// Number of bits of the sort key for each field.
+  static constexpr int kLayerBits = 8;
+  static constexpr int kShaderProgramBits = 10;
+  static constexpr int kMaterialBits = 14;
+  static constexpr int kVertexArrayBits = 16;
+  static constexpr int kDepthBits = 16;
+
+  /**
+   * @brief A single queued draw.
+   */
+  struct Item {
+    /// Key to sort by.
+    SortKey key;
+
+    /// Renderer to draw with.
+    Renderer* renderer;
+
+    /// Position and orientation at which to draw.
+    const Transform* transform;
+  };
+
+  /**
+   * @brief Counts of draws and state binds for one frame.
+   */
+  struct Statistics {
+    /// Number of draw calls submitted.
+    std::uint64_t num_draws = 0;
+
+    /// Number of objects drawn, which exceeds the number of draw calls when
+    /// objects are instanced.
+    std::uint64_t num_instances = 0;
+
+    /// Number of shader program, material, and vertex array binds made.
+    std::uint64_t num_state_changes = 0;
+
+    /// Number of those binds skipped because the state was already bound.
+    std::uint64_t num_state_changes_saved = 0;
+
+    /// Number of bounds tested against the view frustum, of single
+    /// renderers or of subtrees of them.
+    std::uint64_t num_tested = 0;
+
+    /// Number of renderers not drawn because they were out of view.
+    std::uint64_t num_culled = 0;
+
+    /// Number of heap allocations made while rendering. Should be 0 once
+    /// the scene has been drawn before. Only counted in builds where
+    /// AllocationCounter::enabled().
+    std::uint64_t num_allocations = 0;
+
+    /// Number of graphics API state calls issued while rendering.
+    std::uint64_t num_api_state_calls = 0;
+
+    /// Number of graphics API state calls skipped because they would not
+    /// have changed state.
+    std::uint64_t num_api_state_calls_saved = 0;
+  };
+
+  /**
+   * @brief Removes all items. Sort IDs assigned to state objects are kept.
+   */
+  void Clear();
+
+  /**
+   * @brief Adds a draw to the queue.
+   * @param renderer Renderer to draw with.
+   * @param transform Position and orientation at which to draw.
+   * @param depth Non-negative distance measure from the camera. Only its
+   *        ordering matters.
+   */
+  void Add(Renderer* renderer, const Transform* transform, const float depth);
+
+  /**
+   * @brief Sorts items by key, with a stable LSD radix sort.
+   */
+  void Sort();
+
+  /**
+   * @brief Accessor.
+   * @return Queued items, in sorted order after calling Sort().
+   */
+  const stl_vector<Item>& items() const;
+
+  /**
+   * @brief Quantizes a depth to fit in the depth field of a sort key.
+   *
+   * For non-negative floats the IEEE bit pattern increases with the value,
+   * so the top bits give a coarse but monotonic quantization.
+   *
+   * @param depth Non-negative depth.
+   * @return Quantized depth.
+   */
+  static SortKey QuantizeDepth(const float depth);
+
+ private:
+  /**
+   * @brief Gets a compact ID for a state object, assigning one if needed.
+   *
+   * IDs are assigned in order of first appearance. When a field runs out of
+   * IDs, assignment starts over, which may only cost sorting quality.
+   *
+   * @param object State object, or nullptr.
+   * @param num_bits Bits available for the ID.
+   * @param[in,out] ids IDs assigned so far.
+   * @return ID, which is 0 for nullptr.
+   */
+  static SortKey SortID(const void* object, const int num_bits,
+                        stl_unordered_map<const void*, SortKey>* ids);
+
+  /// Queued items.
+  stl_vector<Item> items_;
+
+  /// Scratch space for sorting.
+  stl_vector<Item> sort_buffer_;
+
+  /// Sort IDs of shader programs.
+  stl_unordered_map<const void*, SortKey> shader_program_ids_;
+
+  /// Sort IDs of materials.
+  stl_unordered_map<const void*, SortKey> material_ids_;
+
+  /// Sort IDs of vertex array owners.
+  stl_unordered_map<const void*, SortKey> vertex_array_ids_;
+};
+
+}  // namespace ogle
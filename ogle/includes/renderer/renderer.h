@@ -6,13 +6,16 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include <cstdint>
 #include "entity/component.h"
 #include "math/vector.h"
 
 namespace ogle {
 
+struct Bounds;
 class Entity;
 class Transform;
+class TriangleBVH;
 
 /**
  * @brief Base class for all renderers.
@@ -33,6 +36,26 @@ class Renderer : public Component {
   /// Run-time type for all renderers.
   static constexpr ComponentType kComponentType = ComponentType::RENDERER;
 
+  /**
+   * @brief GPU state objects bound by a draw.
+   *
+   * Identifies state that consecutive draws may share, so that they can
+   * skip rebinding it. nullptr means unknown state that must always be
+   * bound.
+   */
+  struct BoundState {
+    /// Shader program in use.
+    const void* shader_program;
+
+    /// Material whose variables are set on the shader program.
+    const void* material;
+
+    /// Key identifying vertex array state: vertex and index data, and
+    /// which attributes are enabled. Draws with the same key may reuse each
+    /// other's vertex array.
+    const void* vertex_array;
+  };
+
   /**
    * @brief Render object.
    * @param transform Position and orientation at which to render.
@@ -42,11 +65,89 @@ class Renderer : public Component {
   virtual void Render(const Transform& transform, const Entity& camera,
                       const stl_vector<const Entity*>& lights) = 0;
 
+  /**
+   * @brief Render object, following a draw that left some state bound.
+   *
+   * By default, ignores previous state and binds everything.
+   *
+   * @param transform Position and orientation at which to render.
+   * @param camera Entity with attached camera to render from.
+   * @param lights Entities with attached lights.
+   * @param previous State bound by the previous draw in this frame.
+   */
+  virtual void Render(const Transform& transform, const Entity& camera,
+                      const stl_vector<const Entity*>& lights,
+                      const BoundState& previous);
+
+  /**
+   * @brief Checks whether this renderer can draw another renderer's object
+   *        as an instance, in the same draw call as its own.
+   *
+   * False by default.
+   *
+   * @param other Renderer to check.
+   * @return Whether RenderInstanced() may be used for both.
+   */
+  virtual bool CanInstance(const Renderer& other) const;
+
+  /**
+   * @brief Render one copy of object per transform.
+   *
+   * By default, calls Render() for each transform.
+   *
+   * @param transforms Positions and orientations at which to render.
+   * @param camera Entity with attached camera to render from.
+   * @param lights Entities with attached lights.
+   * @param previous State bound by the previous draw in this frame.
+   */
+  virtual void RenderInstanced(const stl_vector<const Transform*>& transforms,
+                               const Entity& camera,
+                               const stl_vector<const Entity*>& lights,
+                               const BoundState& previous);
+
+  /**
+   * @brief Identifies state this renderer binds to draw.
+   * @return State objects. All nullptr by default.
+   */
+  virtual BoundState bound_state() const;
+
+  /**
+   * @brief Gets bounds of what this renderer draws, used to skip drawing
+   *        objects that are out of view.
+   * @return Bounds in the local space of the rendered Transform, or nullptr
+   *         if unbounded, so that it is always drawn. nullptr by default.
+   */
+  virtual const Bounds* local_bounds() const;
+
+  /**
+   * @brief Gets triangles of what this renderer draws, used to pick objects
+   *        with rays.
+   * @return BVH in the local space of the rendered Transform, or nullptr if
+   *         the object can't be picked. nullptr by default.
+   */
+  virtual const TriangleBVH* local_bvh() const;
+
+  /**
+   * @brief Accessor.
+   * @return Layer to draw in. Lower layers are drawn first.
+   */
+  std::uint8_t layer() const;
+
+  /**
+   * @brief Mutator.
+   * @param layer Layer to draw in.
+   */
+  void set_layer(const std::uint8_t layer);
+
  protected:
   /**
    * @brief Default constructor.
    */
   Renderer();
+
+ private:
+  /// Layer to draw in.
+  std::uint8_t layer_;
 };
 
 }  // namespace ogle
@@ -7,6 +7,8 @@
 
 #include "std/ogle_std.inc"
 #include "entity/entity.h"
+#include "geometry/aabb_tree.h"
+#include "geometry/ray.h"
 
 namespace ogle {
 
@@ -14,6 +16,9 @@ namespace ogle {
  * @brief Tracks all Entities in scene.
  *
  * It is assumed that the SceneGraph is a tree, with no cycles.
+ *
+ * Entities beneath the root with bounds are also kept in a spatial index,
+ * for queries by region, frustum, or ray.
  */
 class SceneGraph {
  public:
@@ -22,9 +27,38 @@ class SceneGraph {
    */
   SceneGraph();
 
+  /**
+   * @brief Destructor. Removes remaining Entities from the spatial index.
+   */
+  ~SceneGraph();
+
+  /**
+   * @brief Accessor. First moves Entities in the spatial index that moved
+   *        since the last call.
+   * @return Spatial index of Entities with bounds. Proxies' Transforms are
+   *         attached to the Entities.
+   */
+  const AABBTree& spatial_index();
+
+  /**
+   * @brief Finds the nearest Entity whose rendered triangles a ray hits, as
+   *        for picking with the mouse. Only Entities whose Renderer has a
+   *        BVH can be hit, such as MeshRenderers of Meshes loaded with one.
+   * @param ray World-space ray to cast.
+   * @param max_distance Distance along the ray to search.
+   * @param[out] distance Distance along the ray of the hit, if any. May be
+   *             null.
+   * @return Entity hit, or null if none.
+   */
+  Entity* Pick(const Ray<float, 3>& ray, const float max_distance,
+               float* distance);
+
   /// Entity at root of graph. All other Entities are beneath it.
   std::unique_ptr<Entity> root_;
+
+ private:
+  /// Spatial index of Entities with bounds.
+  AABBTree spatial_index_;
 };
 
 }  // namespace ogle
-
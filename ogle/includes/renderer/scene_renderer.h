@@ -6,14 +6,42 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include <cstdint>
+#include <memory>
+#include "geometry/frustum.h"
+#include "renderer/frame_constants.h"
+#include "renderer/render_queue.h"
 
 namespace ogle {
 
+class Configuration;
 class Entity;
+class Renderer;
 class SceneGraph;
+class Transform;
 
+/**
+ * @brief Draws all renderable Entities in a SceneGraph.
+ *
+ * Renderables with bounds are culled against the camera's view frustum.
+ * Subtrees of the Transform hierarchy whose bounds are out of view are
+ * skipped whole, and those entirely in view are not tested further. Leaves
+ * and objects in subtrees partly in view are tested in batches. The rest
+ * are gathered into a RenderQueue and submitted in sort key order, so that
+ * draws sharing a shader program, material, or vertex array can skip
+ * rebinding them. Runs of renderers that can be instanced together
+ * are drawn with a single call.
+ *
+ * Camera and light constants are uploaded once per frame to a
+ * FrameConstantsBuffer, which shader programs read as a uniform block.
+ */
 class SceneRenderer {
  public:
+  /// Configuration attribute that enables checking cached graphics state
+  /// against the graphics API after each frame. Checking stalls the
+  /// pipeline, so it is off unless set to true.
+  static const stl_string kConfigAttributeValidateState;
+
   /**
    * @brief Default constructor.
    */
@@ -25,14 +53,20 @@ class SceneRenderer {
   virtual ~SceneRenderer() = default;
 
   /**
-   * @brief Render a specific Entity in graph.
+   * @brief Allocates GPU objects used for all draws.
+   * @param configuration Rendering configuration.
+   * @return Success/failure.
+   */
+  virtual bool Create(const Configuration& configuration);
+
+  /**
+   * @brief Queue renderers of an Entity and its descendants that may be in
+   *        view. Renderers that need testing on their own are held back to be
+   *        culled.
    * @param camera_entity Entity containing camera for rendering.
-   * @param light_entities Entities containing lights for scene.
-   * @param entity Entity to render.
+   * @param entity Entity to queue.
    */
-  virtual void Render(const Entity& camera_entity,
-                      const stl_vector<const Entity*>& light_entities,
-                      Entity* entity);
+  virtual void Enqueue(const Entity& camera_entity, Entity* entity);
 
   /**
    * @brief Render entire scene.
@@ -43,6 +77,87 @@ class SceneRenderer {
   virtual void RenderScene(const Entity& camera_entity,
                            const stl_vector<const Entity*>& light_entities,
                            SceneGraph* scene_graph);
+
+  /**
+   * @brief Accessor.
+   * @return Culling, draw, and state change counts for the last rendered
+   *         frame.
+   */
+  const RenderQueue::Statistics& statistics() const;
+
+ protected:
+  /**
+   * @brief A renderer awaiting culling.
+   */
+  struct CullCandidate {
+    /// Renderer to draw with.
+    Renderer* renderer;
+
+    /// Position and orientation at which to draw.
+    const Transform* transform;
+  };
+
+  /**
+   * @brief Queues renderers in a subtree that may be in view.
+   * @param camera_entity Entity containing camera for rendering.
+   * @param transform Root of subtree, with bounds refit.
+   * @param plane_mask Frustum planes that the subtree may be outside of.
+   */
+  void EnqueueSubtree(const Entity& camera_entity, Transform* transform,
+                      std::uint8_t plane_mask);
+
+  /**
+   * @brief Adds a draw to the render queue.
+   * @param camera_entity Entity containing camera for rendering.
+   * @param renderer Renderer to draw with.
+   * @param transform Position and orientation at which to draw.
+   */
+  void QueueDraw(const Entity& camera_entity, Renderer* renderer,
+                 const Transform* transform);
+
+  /**
+   * @brief Queues the renderers held back by Enqueue() that are in view.
+   * @param camera_entity Entity containing camera for rendering.
+   */
+  void Cull(const Entity& camera_entity);
+
+  /**
+   * @brief Submits all queued draws in order.
+   * @param camera_entity Entity containing camera for rendering.
+   * @param light_entities Entities containing lights for scene.
+   */
+  void Submit(const Entity& camera_entity,
+              const stl_vector<const Entity*>& light_entities);
+
+  /// Camera and light constants for the frame being rendered.
+  FrameConstants frame_constants_;
+
+  /// GPU buffer that frame constants are uploaded to.
+  std::unique_ptr<FrameConstantsBuffer> frame_constants_buffer_;
+
+  /// Draws for the frame being rendered. Kept to reuse its storage.
+  RenderQueue render_queue_;
+
+  /// View frustum of the frame being rendered.
+  Frustum frustum_;
+
+  /// World-space bounds of renderers awaiting culling.
+  BoundsBatch cull_bounds_;
+
+  /// Renderers awaiting culling, in the same order as their bounds.
+  stl_vector<CullCandidate> cull_candidates_;
+
+  /// Whether each renderer awaiting culling is in view.
+  stl_vector<std::uint8_t> cull_visible_;
+
+  /// Counts for the last rendered frame.
+  RenderQueue::Statistics statistics_;
+
+  /// Whether to check cached graphics state after each frame.
+  bool validate_state_ = false;
+
+  /// Transforms of the instances being submitted. Kept to reuse its storage.
+  stl_vector<const Transform*> instance_transforms_;
 };
 
 }  // namespace ogle
@@ -46,6 +46,21 @@ class Shader : public Resource {
    */
   static std::unique_ptr<Shader> Load(const ResourceMetadata& metadata);
 
+  /**
+   * @brief Reads shader text without compiling it, so that it may be done
+   *        off the thread owning the graphics context.
+   * @param metadata Metadata for shader file.
+   * @return New shader, which must be built with Create() before use.
+   */
+  static std::unique_ptr<Shader> Read(const ResourceMetadata& metadata);
+
+  /**
+   * @brief Builds Shader from loaded text. Must be called on the thread
+   *        owning the graphics context.
+   * @return Success/failure.
+   */
+  virtual bool Create() = 0;
+
   /**
    * @brief Accessor.
    * @return Shader text.
@@ -6,13 +6,14 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include <cstdint>
 #include <memory>
+#include "entity/property.h"
 #include "math/matrix.h"
 #include "resource/resource.h"
 
 namespace ogle {
 
-class Property;
 class ResourceManager;
 class ResourceMetadata;
 class Shader;
@@ -31,6 +32,19 @@ class ShaderProgram : public Resource {
     /// Model matrix.
     static const stl_string kModelMatrixArg;
 
+    /// Product of view and model matrices.
+    static const stl_string kModelViewMatrixArg;
+
+    /// 3x3 matrix transforming normals to the eye frame.
+    static const stl_string kNormalMatrixArg;
+
+    /// Model-view matrix as a per-instance vertex attribute, which replaces
+    /// the model-view matrix in instanced programs.
+    static const stl_string kInstanceModelViewMatrixArg;
+
+    /// Normal matrix as a per-instance vertex attribute.
+    static const stl_string kInstanceNormalMatrixArg;
+
     /// View matrix.
     static const stl_string kViewMatrixArg;
 
@@ -50,6 +64,30 @@ class ShaderProgram : public Resource {
     static const stl_string kLightSpecularColor;
   };
 
+  /**
+   * @brief A shader variable resolved against a linked program.
+   *
+   * Setting a compiled variable needs no name lookups or allocations.
+   * Compiled variables are only valid for the link generation they were
+   * compiled against.
+   */
+  struct CompiledVariable {
+    /// Implementation-specific location of variable in program.
+    std::int32_t location;
+
+    /// Type of values.
+    PropertyType type;
+
+    /// Rows of values. 1 for scalars.
+    std::uint8_t rows;
+
+    /// Columns of values. 1 for scalars and vectors.
+    std::uint8_t columns;
+
+    /// Row-major values to set, or nullptr if values are passed when set.
+    const void* data;
+  };
+
   /// Type identifying shader program resources.
   static constexpr ResourceType kResourceType = ResourceType::SHADER_PROGRAM;
 
@@ -97,12 +135,61 @@ class ShaderProgram : public Resource {
   virtual void SetVariable(const stl_string& variable_name,
                            const Property& value) = 0;
 
+  /**
+   * @brief Resolves a shader variable for setting later.
+   * @param variable_name Name of variable in shader program.
+   * @param type Type of values.
+   * @param rows Rows of values. 1 for scalars.
+   * @param columns Columns of values. 1 for scalars and vectors.
+   * @param[out] compiled Compiled variable, with no data.
+   * @return Whether the program has a variable of a supported type.
+   */
+  virtual bool CompileVariable(const stl_string& variable_name,
+                               const PropertyType type,
+                               const std::uint8_t rows,
+                               const std::uint8_t columns,
+                               CompiledVariable* compiled) const = 0;
+
+  /**
+   * @brief Resolves a shader variable bound to a property's values.
+   *
+   * The property must outlive the compiled variable.
+   *
+   * @param variable_name Name of variable in shader program.
+   * @param value Property holding values.
+   * @param[out] compiled Compiled variable.
+   * @return Whether the program has a variable of a supported type.
+   */
+  bool CompileVariable(const stl_string& variable_name, const Property& value,
+                       CompiledVariable* compiled) const;
+
+  /**
+   * @brief Sets a compiled variable on program, which must be in use.
+   * @param variable Compiled variable.
+   * @param data Row-major values to set.
+   */
+  virtual void SetCompiledVariable(const CompiledVariable& variable,
+                                   const void* data) = 0;
+
+  /**
+   * @brief Accessor.
+   *
+   * Incremented each time the program links, which invalidates variables
+   * compiled against it.
+   *
+   * @return Link generation. 0 if never linked.
+   */
+  std::uint32_t link_generation() const;
+
  protected:
   /**
    * @brief Constructor.
    * @param metadata Resource metadata.
    */
   explicit ShaderProgram(const ResourceMetadata& metadata);
+
+  /// Number of times the program has linked.
+  std::uint32_t link_generation_;
 };
 
 }  // namespace ogle
@@ -0,0 +1,161 @@
+/**
+ * @file vertex_layout.h
+ * @brief Defines VertexLayout.
+ */
+
+#pragma once
+
+#include "std/ogle_std.inc"
+#include <cstdint>
+
+namespace ogle {
+
+/**
+ * @brief Per-vertex attributes a BufferedMesh can provide to shaders.
+ */
+enum class VertexAttribute {
+  POSITION,  // 3D vertex position.
+  NORMAL,    // 3D vertex normal.
+  UV         // 2D texture coordinate.
+};
+
+/**
+ * @brief Storage types for components of vertex attributes.
+ */
+enum class VertexComponentType {
+  FLOAT,   // 32-bit float.
+  INT16,   // 16-bit signed integer.
+  UINT16,  // 16-bit unsigned integer.
+  INT8,    // 8-bit signed integer.
+  UINT8    // 8-bit unsigned integer.
+};
+
+/**
+ * @brief Describes how one attribute is stored for each vertex.
+ */
+struct VertexAttributeFormat {
+  VertexAttribute attribute;  ///< Attribute stored.
+  std::uint32_t location;  ///< Shader input location.
+  std::uint32_t num_components;  ///< Number of components stored.
+  VertexComponentType type;  ///< Storage type of each component.
+
+  /// Whether integer components are mapped from [-1, 1] (signed) or [0, 1]
+  /// (unsigned) to their full range, rather than rounded.
+  bool normalized;
+
+  /// Byte offset of the attribute within an interleaved vertex. 0 when
+  /// attributes are stored in separate streams.
+  std::uint32_t offset;
+};
+
+/**
+ * @brief Describes how vertex attributes are arranged in vertex buffers.
+ *
+ * In an interleaved layout, all attributes of a vertex are packed together
+ * and vertices follow each other #stride() bytes apart, so one buffer holds
+ * the whole mesh. In a split layout, each attribute is stored as floats in a
+ * separate, tightly packed stream.
+ */
+class VertexLayout {
+ public:
+  ///@{
+  /// Shader input locations of standard attributes.
+  static constexpr std::uint32_t kPositionLocation = 0;
+  static constexpr std::uint32_t kNormalLocation = 1;
+  static constexpr std::uint32_t kUVLocation = 2;
+  ///@}
+
+  ///@{
+  /// Shader input locations of per-instance matrices, which take one
+  /// location per column: four for the model-view matrix, and three for the
+  /// normal matrix.
+  static constexpr std::uint32_t kInstanceModelViewMatrixLocation = 3;
+  static constexpr std::uint32_t kInstanceNormalMatrixLocation = 7;
+  ///@}
+
+  ///@{
+  /// Names identifying standard layouts in configuration files.
+  static const stl_string kSplitLayoutName;
+  static const stl_string kInterleavedLayoutName;
+  static const stl_string kInterleavedCompactLayoutName;
+  ///@}
+
+  /**
+   * @brief Default constructor. Creates a split layout.
+   */
+  VertexLayout();
+
+  /**
+   * @brief Creates a layout from its configuration name.
+   * @param name One of the standard layout names.
+   * @param[out] layout Layout created.
+   * @return true on success, false if the name is unknown.
+   */
+  static const bool FromName(const stl_string& name, VertexLayout* layout);
+
+  /**
+   * @brief Creates a split layout with position, normal, and texture
+   *        coordinate streams of floats.
+   * @return New layout.
+   */
+  static VertexLayout Split();
+
+  /**
+   * @brief Creates an interleaved layout.
+   *
+   * Attribute offsets are assigned in order, each aligned to 4 bytes, and
+   * the stride is rounded up to a multiple of 4 bytes.
+   *
+   * @param attributes Attributes to store. Offsets are ignored.
+   * @return New layout.
+   */
+  static VertexLayout Interleaved(
+      const stl_vector<VertexAttributeFormat>& attributes);
+
+  /**
+   * @brief Gets size of one component of a type.
+   * @param type Component type.
+   * @return Size in bytes.
+   */
+  static std::uint32_t ComponentSize(const VertexComponentType type);
+
+  /**
+   * @brief Encodes an attribute's values into an interleaved vertex.
+   * @param format Format of attribute.
+   * @param values Values to encode.
+   * @param num_values Number of values available. Components past these are
+   *        set to 0.
+   * @param[out] vertex Start of vertex to write to.
+   */
+  static void PackAttribute(const VertexAttributeFormat& format,
+                            const float* values, const int num_values,
+                            std::uint8_t* vertex);
+
+  /**
+   * @brief Returns whether attributes are interleaved.
+   */
+  const bool interleaved() const;
+
+  /**
+   * @brief Returns size of an interleaved vertex in bytes. 0 for split
+   *        layouts.
+   */
+  std::uint32_t stride() const;
+
+  /**
+   * @brief Returns formats of stored attributes.
+   */
+  const stl_vector<VertexAttributeFormat>& attributes() const;
+
+ private:
+  /// Whether attributes are interleaved.
+  bool interleaved_;
+
+  /// Size of an interleaved vertex in bytes.
+  std::uint32_t stride_;
+
+  /// Formats of stored attributes.
+  stl_vector<VertexAttributeFormat> attributes_;
+};
+
+}  // namespace ogle
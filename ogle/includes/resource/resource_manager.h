@@ -9,11 +9,13 @@
 #include <utility>
 #include "file_system/file_path.h"
 #include "geometry/mesh.h"
+#include "jobs/task_queue.h"
 #include "renderer/shader.h"
 #include "resource/resource.h"
 
 namespace ogle {
 
+class JobSystem;
 class ResourceMetadata;
 
 /**
@@ -23,6 +25,13 @@ class ResourceMetadata;
  */
 class ResourceManager {
  public:
+  /**
+   * @brief Constructor.
+   * @param job_system Job system to load resources with. May be null, in
+   *        which case resources are loaded on the calling thread only.
+   */
+  explicit ResourceManager(JobSystem* job_system = nullptr);
+
   /**
    * @brief Adds directory to list to search for Resources.
    * @param directory_path Path to add.
@@ -38,6 +47,12 @@ class ResourceManager {
 
   /**
    * @brief Loads all resources from configured directories.
+   *
+   * Resources are loaded in waves of those whose dependencies have all been
+   * loaded. Within a wave, files are read and parsed in parallel by the job
+   * system, while graphics objects are created afterward on the calling
+   * thread, which must own the graphics context.
+   *
    * @return true if all resources were loaded, else false.
    */
   const bool LoadResources();
@@ -67,6 +82,23 @@ class ResourceManager {
    */
   Resource* FindResource(const ResourceID& id);
 
+  /**
+   * @brief Loads as much of a resource as can be done off the thread owning
+   *        the graphics context. Graphics objects are created by tasks
+   *        posted to #context_tasks_. Safe to call from jobs.
+   * @param metadata Resource metadata.
+   * @param[out] resource Set to the loaded resource, or null on failure,
+   *             once #context_tasks_ have been run.
+   */
+  void ReadResource(const ResourceMetadata& metadata,
+                    std::unique_ptr<Resource>* resource);
+
+  /// Job system to load resources with. May be null.
+  JobSystem* job_system_;
+
+  /// Tasks to run on the thread owning the graphics context.
+  TaskQueue context_tasks_;
+
   /// All tracked resources.
   stl_map<ResourceID, std::unique_ptr<Resource>> resources_;
 
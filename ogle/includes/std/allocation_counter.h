@@ -0,0 +1,46 @@
+/**
+ * @file allocation_counter.h
+ * @brief Defines AllocationCounter.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace ogle {
+
+/**
+ * @brief Counts heap allocations made through global new and delete.
+ *
+ * When ogle is built with OGLE_COUNT_ALLOCATIONS or OGLE_TRACKING_ALLOCATOR,
+ * it replaces the global allocation operators to keep these counts, so they
+ * cover STL containers and all objects allocated with new. Take the
+ * difference of counts around a section of code to find how many
+ * allocations it made.
+ *
+ * Every allocation then updates a counter shared by all threads, so other
+ * builds keep the system allocator, and all counts are zero.
+ */
+class AllocationCounter {
+ public:
+  /**
+   * @brief Checks if allocations are being counted.
+   * @return true if built with OGLE_COUNT_ALLOCATIONS or
+   *         OGLE_TRACKING_ALLOCATOR, else false.
+   */
+  static const bool enabled();
+
+  /**
+   * @brief Total allocations made since program start, on all threads.
+   * @return Count.
+   */
+  static std::uint64_t num_allocations();
+
+  /**
+   * @brief Total deallocations made since program start, on all threads.
+   * @return Count.
+   */
+  static std::uint64_t num_deallocations();
+};
+
+}  // namespace ogle
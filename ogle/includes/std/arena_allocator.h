@@ -0,0 +1,28 @@
+/**
+ * @file arena_allocator.h
+ * @brief Defines arena memory allocation strategies.
+ *
+ * This allocation strategy serves STL containers from arenas owned by each
+ * thread, so that their many small allocations avoid the global heap and
+ * its locks. C++ new/delete operators are unchanged.
+ */
+
+#pragma once
+
+#include <memory>
+#include "std/thread_arena.h"
+
+namespace ogle {
+
+/**
+ * @brief Arena allocator implementation.
+ *
+ * Reuses ArenaAllocator.
+ */
+template<typename T>
+using STLAllocator = ArenaAllocator<T>;
+
+/// Name of this strategy, for logs comparing builds.
+constexpr char kSTLAllocatorName[] = "arena";
+
+}  // namespace ogle
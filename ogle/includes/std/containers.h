@@ -7,6 +7,7 @@
 
 #include "std/custom_allocator.h"
 
+#include <deque>
 #include <functional>
 #include <list>
 #include <map>
@@ -18,14 +19,18 @@
 
 namespace ogle {
 
+template <typename T>
+using stl_deque = std::deque<T, STLAllocator<T>>;
+
 template <typename T>
 using stl_list = std::list<T, STLAllocator<T>>;
 
 template <typename K, typename V, typename C = std::less<K>>
 using stl_map = std::map<K, V, C, STLAllocator<std::pair<const K, V>>>;
 
-using stl_string =
-    std::basic_string<char, std::char_traits<char>, STLAllocator<char>>;
+/// Strings keep the standard allocator whatever the strategy, because the
+/// standard library only hashes, streams and converts those strings.
+using stl_string = std::string;
 
 template <typename K, typename V, typename H = std::hash<K>,
           typename E = std::equal_to<K>>
@@ -4,7 +4,8 @@
  *
  * Redefines both STL allocators and global C++ new/delete operators.
  * This is done simply by including a header file for the desired allocation
- * strategy.
+ * strategy. Build with OGLE_ARENA_ALLOCATOR defined to use arena_allocator.h,
+ * or OGLE_TRACKING_ALLOCATOR defined to use tracking_allocator.h.
  *
  * Some invaluables notes are collected here:
  *
@@ -20,5 +21,11 @@
 
 #pragma once
 
+#if defined(OGLE_ARENA_ALLOCATOR)
+#include "std/arena_allocator.h"
+#elif defined(OGLE_TRACKING_ALLOCATOR)
+#include "std/tracking_allocator.h"
+#else
 #include "std/default_allocator.h"
+#endif
 
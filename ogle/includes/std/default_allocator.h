@@ -20,5 +20,8 @@ namespace ogle {
 template<typename T>
 using STLAllocator = std::allocator<T>;
 
+/// Name of this strategy, for logs comparing builds.
+constexpr char kSTLAllocatorName[] = "default";
+
 }  // namespace ogle
 
@@ -0,0 +1,159 @@
+/**
+ * @file memory_tracker.h
+ * @brief Defines MemoryTracker and MemoryScope.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "std/containers.h"
+
+namespace ogle {
+
+/// Subsystems that memory is accounted to.
+enum class MemoryTag : std::uint8_t {
+  UNTAGGED,  // Allocated outside any MemoryScope.
+  MESH,      // Mesh geometry and loading.
+  RESOURCE,  // Resource metadata, dependency tracking and loading.
+  RENDERER,  // Renderer state and copies of data uploaded to the GPU.
+  ENTITY,    // Entities, Components, Transforms and Properties.
+  CONFIG,    // Configuration and YAML documents.
+  BEGIN = UNTAGGED,
+  END = CONFIG
+};
+
+/**
+ * @brief Accounts heap memory to the subsystem that allocated it.
+ *
+ * When ogle is built with OGLE_TRACKING_ALLOCATOR, global new and delete
+ * record every allocation against the MemoryTag of the innermost MemoryScope
+ * on the allocating thread. STL containers allocate through global new, so
+ * they are covered too. The tag and size are kept in a small header before
+ * each allocation, so memory is credited back to the right subsystem
+ * wherever it is freed.
+ *
+ * Each thread counts into its own counters, which only it writes, so
+ * recording costs a few uncontended stores. Queries sum the counters of
+ * all threads. Peaks are taken from those sums, so they are the highest
+ * usage seen by a query or at the end of a frame, not within one.
+ *
+ * In other builds nothing is recorded and all statistics are zero.
+ */
+class MemoryTracker {
+ public:
+  /// Number of tags.
+  static constexpr int kNumTags = static_cast<int>(MemoryTag::END) + 1;
+
+  /**
+   * @brief Memory usage of one subsystem.
+   */
+  struct Statistics {
+    /// Bytes allocated and not freed.
+    std::int64_t live_bytes;
+
+    /// Most bytes live at once.
+    std::int64_t peak_bytes;
+
+    /// Allocations made since program start.
+    std::uint64_t num_allocations;
+
+    /// Deallocations made since program start.
+    std::uint64_t num_deallocations;
+
+    /// Allocations made during the last frame.
+    std::uint64_t frame_allocations;
+
+    /// Bytes allocated during the last frame.
+    std::uint64_t frame_bytes;
+  };
+
+  /**
+   * @brief Checks if allocations are being tracked.
+   * @return true if built with OGLE_TRACKING_ALLOCATOR, else false.
+   */
+  static const bool enabled();
+
+  /**
+   * @brief Gets the tag that the calling thread is allocating under.
+   * @return Tag of innermost MemoryScope, or MemoryTag::UNTAGGED.
+   */
+  static MemoryTag current_tag();
+
+  /**
+   * @brief Records an allocation. Called by global new.
+   * @param tag Tag to account to.
+   * @param size Size in bytes.
+   */
+  static void RecordAllocation(const MemoryTag tag, const std::size_t size);
+
+  /**
+   * @brief Records a deallocation. Called by global delete.
+   * @param tag Tag the memory was accounted to.
+   * @param size Size in bytes.
+   */
+  static void RecordDeallocation(const MemoryTag tag, const std::size_t size);
+
+  /**
+   * @brief Marks the end of a frame, for per-frame allocation rates.
+   */
+  static void EndFrame();
+
+  /**
+   * @brief Gets current usage of a subsystem.
+   * @param tag Tag of subsystem.
+   * @return Statistics.
+   */
+  static Statistics statistics(const MemoryTag tag);
+
+  /**
+   * @brief Writes current usage of all subsystems as a JSON object, keyed
+   *        by tag name.
+   * @return JSON text.
+   */
+  static stl_string ToJSON();
+
+  /**
+   * @brief Writes ToJSON() to a file.
+   * @param file_path Path of file to write.
+   * @return true on success, else false.
+   */
+  static const bool WriteJSON(const stl_string& file_path);
+
+  /**
+   * @brief Gets the name of a tag.
+   * @param tag Tag.
+   * @return Lowercase name.
+   */
+  static const char* TagName(const MemoryTag tag);
+};
+
+/**
+ * @brief Accounts memory allocated by the calling thread to a subsystem,
+ *        until destroyed.
+ *
+ * Scopes nest; the innermost applies. They do not carry over to jobs, which
+ * must open their own.
+ */
+class MemoryScope {
+ public:
+  /**
+   * @brief Constructor. Starts accounting to a tag.
+   * @param tag Tag to account to.
+   */
+  explicit MemoryScope(const MemoryTag tag);
+
+  MemoryScope(const MemoryScope&) = delete;
+  MemoryScope& operator=(const MemoryScope&) = delete;
+
+  /**
+   * @brief Destructor. Restores the enclosing scope's tag.
+   */
+  ~MemoryScope();
+
+ private:
+  /// Tag of enclosing scope.
+  MemoryTag previous_tag_;
+};
+
+}  // namespace ogle
@@ -0,0 +1,94 @@
+/**
+ * @file thread_arena.h
+ * @brief Defines ThreadArena and ArenaAllocator.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace ogle {
+
+/**
+ * @brief Allocates small blocks from arenas owned by the calling thread.
+ *
+ * Blocks are rounded up to a size class and carved from chunks taken from
+ * the heap. Freed blocks go back to the arena that allocated them, to be
+ * reused by its next allocation of that class; blocks freed by another
+ * thread are handed over without locks. When a thread exits its arena is
+ * kept, with any blocks still free in it, and reused by the next thread
+ * to start, so threads spawned for short tasks don't each take new chunks.
+ * Chunks are never returned to the heap. Larger blocks are allocated with
+ * global new.
+ */
+class ThreadArena {
+ public:
+  /// Largest block served from arenas, in bytes.
+  static constexpr std::size_t kMaxBlockSize = 256;
+
+  /**
+   * @brief Allocates a block.
+   * @param size Size in bytes.
+   * @return Block, aligned for any fundamental type.
+   */
+  static void* Allocate(const std::size_t size);
+
+  /**
+   * @brief Frees a block. May be called from any thread.
+   * @param memory Block returned by Allocate().
+   * @param size Size passed to Allocate().
+   */
+  static void Deallocate(void* memory, const std::size_t size);
+};
+
+/**
+ * @brief STL allocator that allocates from ThreadArena.
+ */
+template<typename T>
+class ArenaAllocator {
+ public:
+  /// Type allocated.
+  using value_type = T;
+
+  /**
+   * @brief Constructor.
+   */
+  ArenaAllocator() = default;
+
+  /**
+   * @brief Converting constructor, for rebinding to other types.
+   */
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U>&) {  // NOLINT
+  }
+
+  /**
+   * @brief Allocates storage.
+   * @param count Number of objects to allocate storage for.
+   * @return Storage.
+   */
+  T* allocate(const std::size_t count) {
+    return static_cast<T*>(ThreadArena::Allocate(count * sizeof(T)));
+  }
+
+  /**
+   * @brief Frees storage.
+   * @param memory Storage returned by allocate().
+   * @param count Number of objects passed to allocate().
+   */
+  void deallocate(T* memory, const std::size_t count) {
+    ThreadArena::Deallocate(memory, count * sizeof(T));
+  }
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+  return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+  return false;
+}
+
+}  // namespace ogle
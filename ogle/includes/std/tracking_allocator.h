@@ -0,0 +1,27 @@
+/**
+ * @file tracking_allocator.h
+ * @brief Defines tracking memory allocation strategies.
+ *
+ * This allocation strategy accounts all heap memory to the subsystem that
+ * allocated it; see MemoryTracker. Global C++ new/delete operators do the
+ * accounting, and the default STL allocator allocates through them.
+ */
+
+#pragma once
+
+#include <memory>
+
+namespace ogle {
+
+/**
+ * @brief Tracking allocator implementation.
+ *
+ * Reuses std::allocator, which is tracked by global new.
+ */
+template<typename T>
+using STLAllocator = std::allocator<T>;
+
+/// Name of this strategy, for logs comparing builds.
+constexpr char kSTLAllocatorName[] = "tracking";
+
+}  // namespace ogle
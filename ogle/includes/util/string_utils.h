@@ -6,6 +6,7 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include <cstdint>
 
 namespace ogle {
 
@@ -55,6 +56,43 @@ class StringUtils {
    * @return New string.
    */
   static const stl_string Upper(const stl_string& input);
+
+  /**
+   * @brief Advances cursor past spaces, tabs, and carriage returns.
+   *
+   * Newlines are not skipped, so line-oriented parsers can stop at them.
+   *
+   * @param[in,out] cursor Position in text buffer.
+   * @param end End of text buffer.
+   */
+  static void SkipSpaces(const char** cursor, const char* end);
+
+  /**
+   * @brief Parses a float from a text buffer without allocating memory.
+   *
+   * Leading spaces are skipped. On success, @p cursor is advanced past the
+   * characters that were consumed.
+   *
+   * @param[in,out] cursor Position in text buffer.
+   * @param end End of text buffer.
+   * @param[out] value Parsed value.
+   * @return true if a float was parsed.
+   */
+  static const bool ParseFloat(const char** cursor, const char* end,
+                               float* value);
+
+  /**
+   * @brief Parses a base-10 integer from a text buffer without allocating.
+   *
+   * Leading spaces are skipped. On success, @p cursor is advanced past the
+   * characters that were consumed.
+   *
+   * @param[in,out] cursor Position in text buffer.
+   * @param end End of text buffer.
+   * @param[out] value Parsed value.
+   * @return true if an integer was parsed and fits in an int.
+   */
+  static const bool ParseInt(const char** cursor, const char* end, int* value);
 };
 
 }  // namespace ogle
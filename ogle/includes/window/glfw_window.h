@@ -6,6 +6,7 @@
 #pragma once
 
 #include "std/ogle_std.inc"
+#include "renderer/glfw_state_cache.h"
 #include "window/window.h"
 
 class GLFWwindow;  // From GLFW.
@@ -95,6 +96,9 @@ class GLFWWindow : public Window {
    * An opaque type which can't be stored in a smart pointer.
    */
   GLFWwindow* window_;
+
+  /// Cache of state of the window's OpenGL context.
+  GLFWStateCache gl_state_;
 };
 
 }  // namespace ogle
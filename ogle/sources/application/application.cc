@@ -5,6 +5,7 @@
 
 #include "application/application.h"
 #include "easylogging++.h"  // NOLINT
+#include "memory/frame_allocator.h"
 
 namespace ogle {
 
@@ -44,6 +45,10 @@ void Application::RunApplication() {
       last_update_carry_over = last_update_timestep_;
 
       main_timer_.Reset();
+
+      // Memory allocated for this frame is no longer needed.
+      FrameAllocator::ForThread().Reset();
+      MemoryTracker::EndFrame();
     }
 
     ++loop_count_;
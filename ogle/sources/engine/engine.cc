@@ -15,7 +15,10 @@ Engine::Engine(const Configuration& configuration)
 }
 
 bool Engine::Create() {
-  resource_manager_ = AllocateUniqueObject<ogle::ResourceManager>();
+  job_system_ = JobSystem::Load(configuration_);
+
+  resource_manager_ =
+      AllocateUniqueObject<ogle::ResourceManager>(job_system_.get());
   auto resource_dir_config = configuration_.Get<stl_string>(
       "resource", "resource_dir");
   if (!resource_dir_config.second) {
@@ -33,6 +36,10 @@ bool Engine::Create() {
 
   scene_graph_ = AllocateUniqueObject<ogle::SceneGraph>();
   scene_renderer_ = AllocateUniqueObject<ogle::SceneRenderer>();
+  if (!scene_renderer_->Create(configuration_)) {
+    LOG(ERROR) << "Failed to create scene renderer.";
+    return false;
+  }
 
   return true;
 }
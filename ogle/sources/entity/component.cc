@@ -5,9 +5,36 @@
 
 #include "entity/component.h"
 #include "entity/entity.h"
+#include "memory/object_pool.h"
 
 namespace ogle {
 
+namespace {
+
+/**
+ * @brief Gets the pools that components are allocated from.
+ *
+ * Never destroyed, so that objects may be freed during static destruction.
+ *
+ * @return Pools.
+ */
+ObjectPoolSet& ComponentPools() {
+  static ObjectPoolSet* pools =
+      AllocateObject<ObjectPoolSet>("component", 1024, true);
+  return *pools;
+}
+
+}  // namespace
+
+void* Component::operator new(std::size_t size) {
+  MemoryScope memory_scope(MemoryTag::ENTITY);
+  return ComponentPools().Allocate(size);
+}
+
+void Component::operator delete(void* memory, std::size_t size) {
+  ComponentPools().Free(memory, size);
+}
+
 Component::Component(const ComponentType type)
     : type_(type), entity_(nullptr) {}
 
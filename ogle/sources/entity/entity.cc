@@ -5,9 +5,37 @@
 
 #include "entity/entity.h"
 #include <algorithm>
+#include "memory/object_pool.h"
+#include "renderer/renderer.h"
 
 namespace ogle {
 
+namespace {
+
+/**
+ * @brief Gets the pools that entities are allocated from.
+ *
+ * Never destroyed, so that objects may be freed during static destruction.
+ *
+ * @return Pools.
+ */
+ObjectPoolSet& EntityPools() {
+  static ObjectPoolSet* pools =
+      AllocateObject<ObjectPoolSet>("entity", sizeof(Entity), true);
+  return *pools;
+}
+
+}  // namespace
+
+void* Entity::operator new(std::size_t size) {
+  MemoryScope memory_scope(MemoryTag::ENTITY);
+  return EntityPools().Allocate(size);
+}
+
+void Entity::operator delete(void* memory, std::size_t size) {
+  EntityPools().Free(memory, size);
+}
+
 Entity::Entity(Transform *parent)
   : transform_(parent, this) {
 }
@@ -18,6 +46,10 @@ bool Entity::AddComponent(std::unique_ptr<Component> component) {
                      return element->type() == component->type();
                    }) == components_.end()) {
     component->set_entity(this);
+    if (component->type() == ComponentType::RENDERER) {
+      transform_.set_local_bounds(
+          static_cast<const Renderer*>(component.get())->local_bounds());
+    }
     components_.emplace_back(std::move(component));
     return true;
   }
@@ -5,9 +5,36 @@
 
 #include "entity/property.h"
 #include "easylogging++.h"  // NOLINT
+#include "memory/object_pool.h"
 
 namespace ogle {
 
+namespace {
+
+/**
+ * @brief Gets the pools that properties are allocated from.
+ *
+ * Never destroyed, so that objects may be freed during static destruction.
+ *
+ * @return Pools.
+ */
+ObjectPoolSet& PropertyPools() {
+  static ObjectPoolSet* pools =
+      AllocateObject<ObjectPoolSet>("property", 256, true);
+  return *pools;
+}
+
+}  // namespace
+
+void* Property::operator new(std::size_t size) {
+  MemoryScope memory_scope(MemoryTag::ENTITY);
+  return PropertyPools().Allocate(size);
+}
+
+void Property::operator delete(void* memory, std::size_t size) {
+  PropertyPools().Free(memory, size);
+}
+
 std::ostream& operator<<(std::ostream& os, const PropertyType type) {
   switch (type) {
     case PropertyType::BOOLEAN: os << "bool"; break;
@@ -56,7 +83,7 @@ void Property::set_name(const stl_string& name) {
   name_ = name;
 }
 
-const stl_vector<PropertyDimIndex> Property::dims() const {
+const stl_vector<PropertyDimIndex>& Property::dims() const {
   return dims_;
 }
 
@@ -0,0 +1,130 @@
+/**
+ * @file mapped_file.cc
+ * @brief Implementation of mapped_file.h.
+ */
+
+#include "file_system/mapped_file.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "easylogging++.h"  // NOLINT
+
+namespace ogle {
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+#ifdef _WIN32
+
+const bool MappedFile::Open(const FilePath& file_path) {
+  Close();
+  HANDLE file = CreateFileA(file_path.str().c_str(), GENERIC_READ,
+                            FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    if (GetLastError() != ERROR_FILE_NOT_FOUND) {
+      LOG(ERROR) << "Failed to open file: " << file_path;
+    }
+    return false;
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    LOG(ERROR) << "Failed to determine size of file: " << file_path;
+    CloseHandle(file);
+    return false;
+  }
+  if (file_size.QuadPart == 0) {
+    CloseHandle(file);
+    return true;
+  }
+
+  // The view keeps the file mapped after both handles are closed.
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0,
+                                      nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    LOG(ERROR) << "Failed to map file: " << file_path;
+    return false;
+  }
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (view == nullptr) {
+    LOG(ERROR) << "Failed to map file: " << file_path;
+    return false;
+  }
+  data_ = static_cast<const char*>(view);
+  size_ = static_cast<std::size_t>(file_size.QuadPart);
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#else
+
+const bool MappedFile::Open(const FilePath& file_path) {
+  Close();
+  const int file = open(file_path.str().c_str(), O_RDONLY);
+  if (file == -1) {
+    if (errno != ENOENT) {
+      LOG(ERROR) << "Failed to open file: " << file_path;
+    }
+    return false;
+  }
+  struct stat file_status;
+  if (fstat(file, &file_status) != 0) {
+    LOG(ERROR) << "Failed to determine size of file: " << file_path;
+    close(file);
+    return false;
+  }
+  if (file_status.st_size == 0) {
+    close(file);
+    return true;
+  }
+
+  // The mapping stays valid after the descriptor is closed.
+  const auto file_size = static_cast<std::size_t>(file_status.st_size);
+  void* view = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (view == MAP_FAILED) {
+    LOG(ERROR) << "Failed to map file: " << file_path;
+    return false;
+  }
+  data_ = static_cast<const char*>(view);
+  size_ = file_size;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#endif
+
+const char* MappedFile::data() const {
+  return data_;
+}
+
+std::size_t MappedFile::size() const {
+  return size_;
+}
+
+}  // namespace ogle
@@ -13,13 +13,26 @@ namespace ogle {
 
 const bool TextFile::ReadTextFile(const FilePath& file_path,
                                   stl_string* text) {
-  std::ifstream in_file(file_path.str());
+  std::ifstream in_file(file_path.str(), std::ios::in | std::ios::binary);
   if (!in_file.is_open()) {
     LOG(ERROR) << "Failed to open file: " << file_path.str();
     return false;
   }
-  *text = stl_string(std::istreambuf_iterator<char>(in_file),
-                     std::istreambuf_iterator<char>());
+
+  // Size the string once and read in bulk; going through stream iterators
+  // one character at a time is far too slow for large assets.
+  in_file.seekg(0, std::ios::end);
+  const std::streamoff file_size = in_file.tellg();
+  if (file_size < 0) {
+    LOG(ERROR) << "Failed to determine size of file: " << file_path.str();
+    return false;
+  }
+  in_file.seekg(0, std::ios::beg);
+  text->resize(static_cast<stl_string::size_type>(file_size));
+  if (file_size > 0 && !in_file.read(&(*text)[0], file_size)) {
+    LOG(ERROR) << "Failed to read file: " << file_path.str();
+    return false;
+  }
   return true;
 }
 
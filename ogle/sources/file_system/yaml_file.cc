@@ -43,6 +43,7 @@ std::ostream& operator<<(std::ostream& os, const YAMLFile& yaml_file) {
 }
 
 bool YAMLFile::Load(const FilePath& file_path) {
+  MemoryScope memory_scope(MemoryTag::CONFIG);
   data_->root_node_ = YAML::LoadFile(file_path.str());
   if (!data_->root_node_) {
     LOG(ERROR) << "Failed to load YAML from: " << file_path.str();
@@ -86,6 +87,9 @@ const std::pair<T, bool> YAMLFile::Get(
 template const std::pair<stl_string, bool>
 YAMLFile::Get<stl_string>(const stl_vector<stl_string>& keys) const;
 
+template const std::pair<bool, bool>
+YAMLFile::Get<bool>(const stl_vector<stl_string>& keys) const;
+
 template const std::pair<int, bool>
 YAMLFile::Get<int>(const stl_vector<stl_string>& keys) const;
 
@@ -0,0 +1,344 @@
+/**
+ * @file aabb_tree.cc
+ * @brief Implements aabb_tree.h.
+ */
+
+#include "geometry/aabb_tree.h"
+#include <algorithm>
+#include "easylogging++.h"  // NOLINT
+#include "geometry/transform.h"
+
+namespace ogle {
+
+constexpr std::int32_t AABBTree::kNullNode;
+constexpr float AABBTree::kDefaultMargin;
+constexpr int AABBTree::kMaxQueryDepth;
+
+namespace {
+
+/**
+ * @brief Computes the smallest box containing two boxes.
+ * @param box1 First box.
+ * @param box2 Second box.
+ * @return New box.
+ */
+const AxisAlignedBox Union(const AxisAlignedBox& box1,
+                           const AxisAlignedBox& box2) {
+  AxisAlignedBox box = box1;
+  box.Include(box2);
+  return box;
+}
+
+}  // namespace
+
+AABBTree::AABBTree(const float margin)
+  : root_(kNullNode), free_list_(kNullNode), num_leaves_(0),
+    margin_(margin) {
+}
+
+std::int32_t AABBTree::Insert(const AxisAlignedBox& box,
+                              Transform* transform) {
+  const std::int32_t leaf = AllocateNode();
+  nodes_[leaf].box = Fatten(box);
+  nodes_[leaf].height = 0;
+  nodes_[leaf].transform = transform;
+  InsertLeaf(leaf);
+  ++num_leaves_;
+  return leaf;
+}
+
+void AABBTree::Remove(const std::int32_t proxy) {
+  CHECK(proxy >= 0 && proxy < static_cast<std::int32_t>(nodes_.size()) &&
+        nodes_[proxy].is_leaf() && nodes_[proxy].height == 0)
+      << "Invalid AABBTree proxy.";
+  RemoveLeaf(proxy);
+  FreeNode(proxy);
+  --num_leaves_;
+}
+
+bool AABBTree::Move(const std::int32_t proxy, const AxisAlignedBox& box) {
+  // Objects that shrink are reinserted too, so that their fat boxes don't
+  // stay much larger than they are.
+  const AxisAlignedBox& fat_box = nodes_[proxy].box;
+  if (fat_box.Contains(box)) {
+    AxisAlignedBox largest_box = box;
+    for (VectorIndex axis = 0; axis < 3; ++axis) {
+      largest_box.min(axis) -= 4.f * margin_;
+      largest_box.max(axis) += 4.f * margin_;
+    }
+    if (largest_box.Contains(fat_box)) {
+      return false;
+    }
+  }
+  RemoveLeaf(proxy);
+  nodes_[proxy].box = Fatten(box);
+  InsertLeaf(proxy);
+  return true;
+}
+
+void AABBTree::Update() {
+  for (Transform* transform : moved_transforms_) {
+    transform->spatial_moved_index_ = -1;
+    transform->UpdateSpatialProxy();
+  }
+  moved_transforms_.clear();
+}
+
+Transform* AABBTree::transform(const std::int32_t proxy) const {
+  return nodes_[proxy].transform;
+}
+
+const AxisAlignedBox& AABBTree::fat_box(const std::int32_t proxy) const {
+  return nodes_[proxy].box;
+}
+
+size_t AABBTree::size() const { return num_leaves_; }
+
+int AABBTree::height() const {
+  return (root_ == kNullNode) ? -1 : nodes_[root_].height;
+}
+
+bool AABBTree::Validate() const {
+  if (root_ != kNullNode && nodes_[root_].parent != kNullNode) {
+    LOG(ERROR) << "AABBTree root has a parent.";
+    return false;
+  }
+  const int num_leaves = (root_ == kNullNode) ? 0 : ValidateSubtree(root_);
+  if (num_leaves < 0) {
+    return false;
+  }
+  if (static_cast<size_t>(num_leaves) != num_leaves_) {
+    LOG(ERROR) << "AABBTree has " << num_leaves << " leaves, expected "
+               << num_leaves_ << ".";
+    return false;
+  }
+  size_t num_free = 0;
+  for (std::int32_t index = free_list_; index != kNullNode;
+       index = nodes_[index].parent) {
+    if (nodes_[index].height != -1 || ++num_free > nodes_.size()) {
+      LOG(ERROR) << "AABBTree free list is corrupt.";
+      return false;
+    }
+  }
+  if (num_free + 2 * num_leaves_ != nodes_.size() + (num_leaves_ > 0)) {
+    LOG(ERROR) << "AABBTree leaked nodes.";
+    return false;
+  }
+  return true;
+}
+
+std::int32_t AABBTree::AllocateNode() {
+  if (free_list_ == kNullNode) {
+    free_list_ = static_cast<std::int32_t>(nodes_.size());
+    nodes_.emplace_back();
+    nodes_.back().parent = kNullNode;
+  }
+  const std::int32_t index = free_list_;
+  Node& node = nodes_[index];
+  free_list_ = node.parent;
+  node.parent = kNullNode;
+  node.child1 = kNullNode;
+  node.child2 = kNullNode;
+  node.height = 0;
+  node.transform = nullptr;
+  return index;
+}
+
+void AABBTree::FreeNode(const std::int32_t index) {
+  nodes_[index].parent = free_list_;
+  nodes_[index].height = -1;
+  free_list_ = index;
+}
+
+void AABBTree::InsertLeaf(const std::int32_t leaf) {
+  if (root_ == kNullNode) {
+    root_ = leaf;
+    nodes_[leaf].parent = kNullNode;
+    return;
+  }
+
+  // Descend toward the sibling that adds the least surface area, which
+  // approximates the surface area heuristic's cost of the tree. Making a
+  // new parent here costs its whole area; going further down also grows
+  // the boxes of this node and its ancestors.
+  const AxisAlignedBox leaf_box = nodes_[leaf].box;
+  std::int32_t index = root_;
+  while (!nodes_[index].is_leaf()) {
+    const Node& node = nodes_[index];
+    const float area = node.box.SurfaceArea();
+    const float combined_area = Union(node.box, leaf_box).SurfaceArea();
+    const float cost = 2.f * combined_area;
+    const float inherited_cost = 2.f * (combined_area - area);
+    auto descend_cost = [&](const std::int32_t child) -> float {
+      const Node& child_node = nodes_[child];
+      const float new_area = Union(child_node.box, leaf_box).SurfaceArea();
+      return inherited_cost +
+             (child_node.is_leaf() ? new_area
+                                   : new_area - child_node.box.SurfaceArea());
+    };
+    const float cost1 = descend_cost(node.child1);
+    const float cost2 = descend_cost(node.child2);
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+    index = (cost1 < cost2) ? node.child1 : node.child2;
+  }
+
+  // Nodes may move as the array grows, so they're referred to by index.
+  const std::int32_t sibling = index;
+  const std::int32_t old_parent = nodes_[sibling].parent;
+  const std::int32_t new_parent = AllocateNode();
+  nodes_[new_parent].parent = old_parent;
+  nodes_[new_parent].box = Union(leaf_box, nodes_[sibling].box);
+  nodes_[new_parent].height = nodes_[sibling].height + 1;
+  nodes_[new_parent].child1 = sibling;
+  nodes_[new_parent].child2 = leaf;
+  if (old_parent == kNullNode) {
+    root_ = new_parent;
+  } else if (nodes_[old_parent].child1 == sibling) {
+    nodes_[old_parent].child1 = new_parent;
+  } else {
+    nodes_[old_parent].child2 = new_parent;
+  }
+  nodes_[sibling].parent = new_parent;
+  nodes_[leaf].parent = new_parent;
+  FixUpwards(nodes_[leaf].parent);
+}
+
+void AABBTree::RemoveLeaf(const std::int32_t leaf) {
+  if (leaf == root_) {
+    root_ = kNullNode;
+    return;
+  }
+
+  // Replace the leaf's parent with its sibling.
+  const std::int32_t parent = nodes_[leaf].parent;
+  const std::int32_t grandparent = nodes_[parent].parent;
+  const std::int32_t sibling = (nodes_[parent].child1 == leaf)
+                                   ? nodes_[parent].child2
+                                   : nodes_[parent].child1;
+  nodes_[sibling].parent = grandparent;
+  FreeNode(parent);
+  if (grandparent == kNullNode) {
+    root_ = sibling;
+  } else {
+    if (nodes_[grandparent].child1 == parent) {
+      nodes_[grandparent].child1 = sibling;
+    } else {
+      nodes_[grandparent].child2 = sibling;
+    }
+    FixUpwards(grandparent);
+  }
+}
+
+void AABBTree::FixUpwards(std::int32_t index) {
+  while (index != kNullNode) {
+    index = Balance(index);
+    Node& node = nodes_[index];
+    const Node& child1 = nodes_[node.child1];
+    const Node& child2 = nodes_[node.child2];
+    node.height = 1 + std::max(child1.height, child2.height);
+    node.box = Union(child1.box, child2.box);
+    index = node.parent;
+  }
+}
+
+std::int32_t AABBTree::Balance(const std::int32_t index) {
+  Node& a = nodes_[index];
+  if (a.is_leaf() || a.height < 2) {
+    return index;
+  }
+  const std::int32_t index_b = a.child1;
+  const std::int32_t index_c = a.child2;
+  Node& b = nodes_[index_b];
+  Node& c = nodes_[index_c];
+  const std::int32_t balance = c.height - b.height;
+  if (balance >= -1 && balance <= 1) {
+    return index;
+  }
+
+  // Rotate the taller child up into a's place. Of its children, the taller
+  // stays with it and the shorter is given to a.
+  const bool c_taller = balance > 1;
+  const std::int32_t index_up = c_taller ? index_c : index_b;
+  Node& up = c_taller ? c : b;
+  const Node& other = c_taller ? b : c;
+  const std::int32_t index_f = up.child1;
+  const std::int32_t index_g = up.child2;
+  const bool f_taller = nodes_[index_f].height > nodes_[index_g].height;
+  const std::int32_t index_keep = f_taller ? index_f : index_g;
+  const std::int32_t index_give = f_taller ? index_g : index_f;
+
+  up.child1 = index;
+  up.child2 = index_keep;
+  up.parent = a.parent;
+  a.parent = index_up;
+  if (up.parent == kNullNode) {
+    root_ = index_up;
+  } else if (nodes_[up.parent].child1 == index) {
+    nodes_[up.parent].child1 = index_up;
+  } else {
+    nodes_[up.parent].child2 = index_up;
+  }
+
+  Node& give = nodes_[index_give];
+  const Node& keep = nodes_[index_keep];
+  if (c_taller) {
+    a.child2 = index_give;
+  } else {
+    a.child1 = index_give;
+  }
+  give.parent = index;
+  a.box = Union(other.box, give.box);
+  a.height = 1 + std::max(other.height, give.height);
+  up.box = Union(a.box, keep.box);
+  up.height = 1 + std::max(a.height, keep.height);
+  return index_up;
+}
+
+const AxisAlignedBox AABBTree::Fatten(const AxisAlignedBox& box) const {
+  AxisAlignedBox fat_box = box;
+  for (VectorIndex axis = 0; axis < 3; ++axis) {
+    fat_box.min(axis) -= margin_;
+    fat_box.max(axis) += margin_;
+  }
+  return fat_box;
+}
+
+int AABBTree::ValidateSubtree(const std::int32_t index) const {
+  const Node& node = nodes_[index];
+  if (node.is_leaf()) {
+    if (node.child2 != kNullNode || node.height != 0 ||
+        node.transform == nullptr) {
+      LOG(ERROR) << "AABBTree leaf " << index << " is malformed.";
+      return -1;
+    }
+    return 1;
+  }
+  const Node& child1 = nodes_[node.child1];
+  const Node& child2 = nodes_[node.child2];
+  if (child1.parent != index || child2.parent != index) {
+    LOG(ERROR) << "AABBTree node " << index << " has unlinked children.";
+    return -1;
+  }
+  if (node.height != 1 + std::max(child1.height, child2.height)) {
+    LOG(ERROR) << "AABBTree node " << index << " has wrong height.";
+    return -1;
+  }
+  if (node.height >= kMaxQueryDepth) {
+    LOG(ERROR) << "AABBTree is too deep to query.";
+    return -1;
+  }
+  if (!node.box.Contains(child1.box) || !node.box.Contains(child2.box)) {
+    LOG(ERROR) << "AABBTree node " << index << " doesn't contain children.";
+    return -1;
+  }
+  const int num_leaves1 = ValidateSubtree(node.child1);
+  const int num_leaves2 = ValidateSubtree(node.child2);
+  if (num_leaves1 < 0 || num_leaves2 < 0) {
+    return -1;
+  }
+  return num_leaves1 + num_leaves2;
+}
+
+}  // namespace ogle
@@ -0,0 +1,167 @@
+/**
+ * @file bounds.cc
+ * @brief Implements bounds.h.
+ */
+
+#include "geometry/bounds.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace ogle {
+
+const AxisAlignedBox AxisAlignedBox::Empty() {
+  constexpr float kInfinity = std::numeric_limits<float>::infinity();
+  return {{kInfinity, kInfinity, kInfinity},
+          {-kInfinity, -kInfinity, -kInfinity}};
+}
+
+const bool AxisAlignedBox::empty() const {
+  return min.x() > max.x() || min.y() > max.y() || min.z() > max.z();
+}
+
+void AxisAlignedBox::Include(const Vector3f& point) {
+  for (VectorIndex axis = 0; axis < 3; ++axis) {
+    min(axis) = std::min(min(axis), point(axis));
+    max(axis) = std::max(max(axis), point(axis));
+  }
+}
+
+void AxisAlignedBox::Include(const AxisAlignedBox& box) {
+  for (VectorIndex axis = 0; axis < 3; ++axis) {
+    min(axis) = std::min(min(axis), box.min(axis));
+    max(axis) = std::max(max(axis), box.max(axis));
+  }
+}
+
+const Vector3f AxisAlignedBox::center() const { return (min + max) * .5f; }
+
+const Vector3f AxisAlignedBox::extents() const { return (max - min) * .5f; }
+
+const float AxisAlignedBox::SurfaceArea() const {
+  const Vector3f size = max - min;
+  return 2.f * (size.x() * size.y() + size.y() * size.z() +
+                size.z() * size.x());
+}
+
+const bool AxisAlignedBox::Contains(const AxisAlignedBox& box) const {
+  for (VectorIndex axis = 0; axis < 3; ++axis) {
+    if (box.min(axis) < min(axis) || box.max(axis) > max(axis)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const bool AxisAlignedBox::Overlaps(const AxisAlignedBox& box) const {
+  for (VectorIndex axis = 0; axis < 3; ++axis) {
+    if (box.max(axis) < min(axis) || box.min(axis) > max(axis)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const AxisAlignedBox AxisAlignedBox::Transformed(
+    const Matrix44f& transform) const {
+  if (empty()) {
+    return *this;
+  }
+
+  // Each new extent sums the magnitudes of the old extents along the
+  // transformed axes.
+  const Vector3f old_center = center();
+  const Vector3f old_extents = extents();
+  Vector3f new_center;
+  Vector3f new_extents;
+  for (MatrixIndex i = 0; i < 3; ++i) {
+    new_center(i) = transform(i, 3);
+    new_extents(i) = 0.f;
+    for (MatrixIndex j = 0; j < 3; ++j) {
+      new_center(i) += transform(i, j) * old_center(j);
+      new_extents(i) += std::abs(transform(i, j)) * old_extents(j);
+    }
+  }
+  return {new_center - new_extents, new_center + new_extents};
+}
+
+void BoundingSphere::Include(const BoundingSphere& sphere) {
+  if (sphere.radius < 0.f) {
+    return;
+  }
+  const Vector3f offset = sphere.center - center;
+  const float distance = static_cast<float>(offset.Norm());
+  if (radius >= 0.f && distance + sphere.radius <= radius) {
+    return;
+  }
+  if (radius < 0.f || distance + radius <= sphere.radius) {
+    *this = sphere;
+    return;
+  }
+
+  // Span from the far side of this sphere to the far side of the other.
+  const float new_radius = (distance + radius + sphere.radius) * .5f;
+  center += offset * ((new_radius - radius) / distance);
+  radius = new_radius;
+}
+
+const BoundingSphere BoundingSphere::Transformed(
+    const Matrix44f& transform) const {
+  BoundingSphere new_sphere;
+  float max_scale_squared = 0.f;
+  for (MatrixIndex i = 0; i < 3; ++i) {
+    new_sphere.center(i) = transform(i, 3);
+    float scale_squared = 0.f;
+    for (MatrixIndex j = 0; j < 3; ++j) {
+      new_sphere.center(i) += transform(i, j) * center(j);
+      scale_squared += transform(j, i) * transform(j, i);
+    }
+    max_scale_squared = std::max(max_scale_squared, scale_squared);
+  }
+  new_sphere.radius =
+      radius < 0.f ? radius : radius * std::sqrt(max_scale_squared);
+  return new_sphere;
+}
+
+const Bounds Bounds::Empty() {
+  return {AxisAlignedBox::Empty(), {Vector3f::Zero(), -1.f}};
+}
+
+const Bounds Bounds::FromPoints(const Vector3f* points, const size_t num_points,
+                                const size_t stride) {
+  auto point_at = [points, stride](const size_t index) -> const Vector3f& {
+    return *reinterpret_cast<const Vector3f*>(
+        reinterpret_cast<const std::uint8_t*>(points) + index * stride);
+  };
+  Bounds bounds = Empty();
+  for (size_t index = 0; index < num_points; ++index) {
+    bounds.box.Include(point_at(index));
+  }
+  if (bounds.box.empty()) {
+    return bounds;
+  }
+
+  // Centering on the box is not optimal, but is within a factor of
+  // sqrt(3) of it, and keeps both volumes about the same point.
+  bounds.sphere.center = bounds.box.center();
+  float max_distance_squared = 0.f;
+  for (size_t index = 0; index < num_points; ++index) {
+    max_distance_squared =
+        std::max(max_distance_squared,
+                 (point_at(index) - bounds.sphere.center).NormSquared());
+  }
+  bounds.sphere.radius = std::sqrt(max_distance_squared);
+  return bounds;
+}
+
+void Bounds::Include(const Bounds& bounds) {
+  box.Include(bounds.box);
+  sphere.Include(bounds.sphere);
+}
+
+const Bounds Bounds::Transformed(const Matrix44f& transform) const {
+  return {box.Transformed(transform), sphere.Transformed(transform)};
+}
+
+}  // namespace ogle
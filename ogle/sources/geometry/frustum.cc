@@ -0,0 +1,221 @@
+/**
+ * @file frustum.cc
+ * @brief Implements frustum.h.
+ */
+
+#include "geometry/frustum.h"
+#include <cmath>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace ogle {
+
+constexpr int Frustum::kNumPlanes;
+constexpr std::uint8_t Frustum::kAllPlanes;
+
+void BoundsBatch::Clear() {
+  for (auto* values : {&sphere_x_, &sphere_y_, &sphere_z_, &sphere_radius_,
+                       &box_x_, &box_y_, &box_z_, &box_extent_x_,
+                       &box_extent_y_, &box_extent_z_}) {
+    values->clear();
+  }
+}
+
+void BoundsBatch::Add(const Bounds& bounds) {
+  sphere_x_.push_back(bounds.sphere.center.x());
+  sphere_y_.push_back(bounds.sphere.center.y());
+  sphere_z_.push_back(bounds.sphere.center.z());
+  sphere_radius_.push_back(bounds.sphere.radius);
+  const Vector3f center = bounds.box.center();
+  const Vector3f extents = bounds.box.extents();
+  box_x_.push_back(center.x());
+  box_y_.push_back(center.y());
+  box_z_.push_back(center.z());
+  box_extent_x_.push_back(extents.x());
+  box_extent_y_.push_back(extents.y());
+  box_extent_z_.push_back(extents.z());
+}
+
+size_t BoundsBatch::size() const { return sphere_x_.size(); }
+
+Frustum::Frustum() {
+  for (auto& plane : planes_) {
+    plane = {0.f, 0.f, 0.f, 1.f};
+  }
+}
+
+Frustum::Frustum(const Matrix44f& view_projection) {
+  const Matrix44f& m = view_projection;
+  for (int index = 0; index < kNumPlanes; ++index) {
+    const MatrixIndex row = index / 2;
+    const float sign = (index % 2 == 0) ? 1.f : -1.f;
+    Vector4f& plane = planes_[index];
+    for (MatrixIndex column = 0; column < 4; ++column) {
+      plane(column) = m(3, column) + sign * m(row, column);
+    }
+    plane /= static_cast<float>(plane.Shrunk().Norm());
+  }
+}
+
+const Vector4f& Frustum::plane(const int index) const {
+  return planes_[index];
+}
+
+const bool Frustum::Intersects(const BoundingSphere& sphere) const {
+  for (const auto& plane : planes_) {
+    if (!(plane.Shrunk().Dot(sphere.center) + plane.w() >= -sphere.radius)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const bool Frustum::Intersects(const AxisAlignedBox& box) const {
+  const Vector3f center = box.center();
+  const Vector3f extents = box.extents();
+  for (const auto& plane : planes_) {
+    // Distance from the center to the box's corner farthest into the plane.
+    const float reach = std::abs(plane.x()) * extents.x() +
+                        std::abs(plane.y()) * extents.y() +
+                        std::abs(plane.z()) * extents.z();
+    if (!(plane.Shrunk().Dot(center) + plane.w() >= -reach)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const bool Frustum::Intersects(const AxisAlignedBox& box,
+                               std::uint8_t* plane_mask) const {
+  const Vector3f center = box.center();
+  const Vector3f extents = box.extents();
+  for (int index = 0; index < kNumPlanes; ++index) {
+    const std::uint8_t plane_bit = 1 << index;
+    if ((*plane_mask & plane_bit) == 0) {
+      continue;
+    }
+    const Vector4f& plane = planes_[index];
+    const float distance = plane.Shrunk().Dot(center) + plane.w();
+    const float reach = std::abs(plane.x()) * extents.x() +
+                        std::abs(plane.y()) * extents.y() +
+                        std::abs(plane.z()) * extents.z();
+    if (!(distance >= -reach)) {
+      return false;
+    }
+    if (distance >= reach) {
+      *plane_mask &= ~plane_bit;
+    }
+  }
+  return true;
+}
+
+const bool Frustum::Intersects(const Bounds& bounds,
+                               std::uint8_t* plane_mask) const {
+  const Vector3f center = bounds.box.center();
+  const Vector3f extents = bounds.box.extents();
+  for (int index = 0; index < kNumPlanes; ++index) {
+    const std::uint8_t plane_bit = 1 << index;
+    if ((*plane_mask & plane_bit) == 0) {
+      continue;
+    }
+    const Vector4f& plane = planes_[index];
+    const Vector3f normal = plane.Shrunk();
+    const float sphere_distance = normal.Dot(bounds.sphere.center) + plane.w();
+    const float box_distance = normal.Dot(center) + plane.w();
+    const float reach = std::abs(plane.x()) * extents.x() +
+                        std::abs(plane.y()) * extents.y() +
+                        std::abs(plane.z()) * extents.z();
+    if (!(sphere_distance >= -bounds.sphere.radius) ||
+        !(box_distance >= -reach)) {
+      return false;
+    }
+    if (sphere_distance >= bounds.sphere.radius || box_distance >= reach) {
+      *plane_mask &= ~plane_bit;
+    }
+  }
+  return true;
+}
+
+size_t Frustum::Cull(const BoundsBatch& batch,
+                     stl_vector<std::uint8_t>* visible) const {
+  const size_t num_bounds = batch.size();
+  visible->resize(num_bounds);
+  size_t num_visible = 0;
+  size_t index = 0;
+
+  // Comparisons are written so that NaN bounds, such as the center of an
+  // empty box, are outside.
+
+#ifdef __SSE__
+  // Test 4 bounds per iteration.
+  const __m128 sign_mask = _mm_set1_ps(-0.f);
+  for (; index + 4 <= num_bounds; index += 4) {
+    const __m128 sphere_x = _mm_loadu_ps(&batch.sphere_x_[index]);
+    const __m128 sphere_y = _mm_loadu_ps(&batch.sphere_y_[index]);
+    const __m128 sphere_z = _mm_loadu_ps(&batch.sphere_z_[index]);
+    const __m128 negative_radius = _mm_xor_ps(
+        _mm_loadu_ps(&batch.sphere_radius_[index]), sign_mask);
+    const __m128 box_x = _mm_loadu_ps(&batch.box_x_[index]);
+    const __m128 box_y = _mm_loadu_ps(&batch.box_y_[index]);
+    const __m128 box_z = _mm_loadu_ps(&batch.box_z_[index]);
+    const __m128 extent_x = _mm_loadu_ps(&batch.box_extent_x_[index]);
+    const __m128 extent_y = _mm_loadu_ps(&batch.box_extent_y_[index]);
+    const __m128 extent_z = _mm_loadu_ps(&batch.box_extent_z_[index]);
+
+    __m128 inside = _mm_cmpeq_ps(sphere_x, sphere_x);  // All set but NaN.
+    for (const auto& plane : planes_) {
+      const __m128 a = _mm_set1_ps(plane.x());
+      const __m128 b = _mm_set1_ps(plane.y());
+      const __m128 c = _mm_set1_ps(plane.z());
+      const __m128 d = _mm_set1_ps(plane.w());
+      const __m128 sphere_distance = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(a, sphere_x), _mm_mul_ps(b, sphere_y)),
+          _mm_add_ps(_mm_mul_ps(c, sphere_z), d));
+      const __m128 box_distance = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(a, box_x), _mm_mul_ps(b, box_y)),
+          _mm_add_ps(_mm_mul_ps(c, box_z), d));
+      const __m128 negative_reach = _mm_xor_ps(
+          _mm_add_ps(
+              _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign_mask, a), extent_x),
+                         _mm_mul_ps(_mm_andnot_ps(sign_mask, b), extent_y)),
+              _mm_mul_ps(_mm_andnot_ps(sign_mask, c), extent_z)),
+          sign_mask);
+      inside = _mm_and_ps(
+          inside,
+          _mm_and_ps(_mm_cmpge_ps(sphere_distance, negative_radius),
+                     _mm_cmpge_ps(box_distance, negative_reach)));
+    }
+
+    const int mask = _mm_movemask_ps(inside);
+    for (int lane = 0; lane < 4; ++lane) {
+      const std::uint8_t lane_visible = (mask >> lane) & 1;
+      (*visible)[index + lane] = lane_visible;
+      num_visible += lane_visible;
+    }
+  }
+#endif
+
+  for (; index < num_bounds; ++index) {
+    bool inside = true;
+    for (const auto& plane : planes_) {
+      const float sphere_distance = plane.x() * batch.sphere_x_[index] +
+                                    plane.y() * batch.sphere_y_[index] +
+                                    plane.z() * batch.sphere_z_[index] +
+                                    plane.w();
+      const float box_distance = plane.x() * batch.box_x_[index] +
+                                 plane.y() * batch.box_y_[index] +
+                                 plane.z() * batch.box_z_[index] + plane.w();
+      const float reach = std::abs(plane.x()) * batch.box_extent_x_[index] +
+                          std::abs(plane.y()) * batch.box_extent_y_[index] +
+                          std::abs(plane.z()) * batch.box_extent_z_[index];
+      inside = inside && sphere_distance >= -batch.sphere_radius_[index] &&
+               box_distance >= -reach;
+    }
+    (*visible)[index] = inside ? 1 : 0;
+    num_visible += inside ? 1 : 0;
+  }
+  return num_visible;
+}
+
+}  // namespace ogle
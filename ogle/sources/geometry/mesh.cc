@@ -4,12 +4,57 @@
  */
 
 #include "geometry/mesh.h"
+#include <cstring>
 #include "easylogging++.h"  // NOLINT
 #include "file_system/file_path.h"
 #include "geometry/mesh_loader.h"
+#include "geometry/triangle_bvh.h"
 
 namespace ogle {
 
+namespace {
+
+/// Number of floats in a vertex's attributes.
+constexpr int kFloatsPerWeldKey = 8;
+
+/// Initial number of slots in a weld table. Must be a power of 2.
+constexpr std::size_t kInitialWeldSlots = 1024;
+
+/**
+ * @brief Gathers the bits of a vertex's attributes for hashing and comparing.
+ * @param mesh_vertex Vertex to build key for.
+ * @param[out] key Bit patterns of attributes, with -0 replaced by 0.
+ */
+void BuildWeldKey(const Mesh::MeshVertex& mesh_vertex,
+                  std::uint32_t key[kFloatsPerWeldKey]) {
+  std::memcpy(&key[0], mesh_vertex.vertex.data(), 3 * sizeof(float));
+  std::memcpy(&key[3], mesh_vertex.uv.data(), 2 * sizeof(float));
+  std::memcpy(&key[5], mesh_vertex.vertex_normal.data(), 3 * sizeof(float));
+  for (int i = 0; i < kFloatsPerWeldKey; ++i) {
+    if (key[i] == 0x80000000) {
+      key[i] = 0;
+    }
+  }
+}
+
+/**
+ * @brief Hashes a weld key.
+ * @param key Key built by BuildWeldKey.
+ * @return Hash value.
+ */
+std::uint32_t HashWeldKey(const std::uint32_t key[kFloatsPerWeldKey]) {
+  std::uint64_t hash = 0;
+  for (int i = 0; i < kFloatsPerWeldKey; ++i) {
+    hash = (hash ^ key[i]) * 0x9E3779B97F4A7C15ULL;
+    hash ^= hash >> 32;
+  }
+  return static_cast<std::uint32_t>(hash);
+}
+
+}  // namespace
+
+constexpr std::uint32_t Mesh::kInvalidIndex;
+
 const bool operator<(const Mesh::MeshVertex& lhs, const Mesh::MeshVertex& rhs) {
   if (lhs.vertex < rhs.vertex) {
     return true;
@@ -31,18 +76,22 @@ const bool operator<(const Mesh::MeshVertex& lhs, const Mesh::MeshVertex& rhs) {
 }
 
 Mesh::Mesh(const ResourceMetadata& metadata)
-  : Resource(metadata) {
+  : Resource(metadata), bounds_(Bounds::Empty()) {
 }
 
-std::unique_ptr<Mesh> Mesh::Load(const ResourceMetadata& metadata) {
-  return std::move(MeshLoader::LoadMesh(metadata));
+Mesh::~Mesh() = default;
+
+std::unique_ptr<Mesh> Mesh::Load(const ResourceMetadata& metadata,
+                                 JobSystem* job_system) {
+  MemoryScope memory_scope(MemoryTag::MESH);
+  return std::move(MeshLoader::LoadMesh(metadata, job_system));
 }
 
 const bool Mesh::AddFace(const stl_vector<Vector3f>& vertices,
                          const stl_vector<Vector2f>& uvs,
                          const stl_vector<Vector3f>& vertex_normals) {
-  if (vertices.empty()) {
-    LOG(ERROR) << "Cannot add new face from empty vertices.";
+  if (vertices.size() != kVerticesPerFace) {
+    LOG(ERROR) << "Faces must have " << kVerticesPerFace << " vertices.";
     return false;
   }
 
@@ -52,32 +101,202 @@ const bool Mesh::AddFace(const stl_vector<Vector3f>& vertices,
     return false;
   }
 
-  stl_vector<VertexIndex> face_vertices;
-  for (stl_vector<Vector3f>::size_type index = 0; index < vertices.size();
-       index++) {
+  AddTriangle(vertices.data(), uvs.empty() ? nullptr : uvs.data(),
+              vertex_normals.empty() ? nullptr : vertex_normals.data());
+  return true;
+}
+
+void Mesh::AddTriangle(const Vector3f* vertices, const Vector2f* uvs,
+                       const Vector3f* vertex_normals) {
+  CHECK(mesh_faces_.size() < kInvalidIndex / kVerticesPerFace)
+      << "Too many faces.";
+  ClearAdjacency();
+  bvh_.reset();
+  MeshFace mesh_face;
+  for (int index = 0; index < kVerticesPerFace; index++) {
     MeshVertex mesh_vertex;
     mesh_vertex.vertex = vertices[index];
-    mesh_vertex.uv = (!uvs.empty())? uvs[index] : Vector2f::Zero();
-    mesh_vertex.vertex_normal = (!vertex_normals.empty())?
+    mesh_vertex.uv = (uvs != nullptr) ? uvs[index] : Vector2f::Zero();
+    mesh_vertex.vertex_normal = (vertex_normals != nullptr)?
         vertex_normals[index] : Vector3f::Zero();
 
-    mesh_vertices_.emplace_back(std::move(mesh_vertex));
-    face_vertices.emplace_back(mesh_vertices_.size() - 1);
-  }
-  mesh_faces_.emplace_back(std::move(MeshFace{std::move(face_vertices)}));
-  const MeshFace* new_mesh_face = &mesh_faces_.back();
-  for (const VertexIndex index : new_mesh_face->vertex_indices) {
-    mesh_vertices_[index].adjoining_faces.emplace_back(new_mesh_face);
+    if (welding_) {
+      mesh_face.vertex_indices[index] = WeldVertex(std::move(mesh_vertex));
+    } else {
+      CHECK(mesh_vertices_.size() < kInvalidIndex) << "Too many vertices.";
+      mesh_vertices_.emplace_back(std::move(mesh_vertex));
+      mesh_face.vertex_indices[index] =
+          static_cast<VertexIndex>(mesh_vertices_.size() - 1);
+    }
   }
+  mesh_faces_.emplace_back(mesh_face);
+}
 
-  return true;
+void Mesh::BeginWelding() {
+  welding_ = true;
+  weld_slots_.assign(kInitialWeldSlots, WeldSlot{0, kInvalidIndex});
+  num_weld_slots_used_ = 0;
+}
+
+void Mesh::EndWelding() {
+  welding_ = false;
+  stl_vector<WeldSlot>().swap(weld_slots_);
+  num_weld_slots_used_ = 0;
 }
 
 void Mesh::Clear() {
   mesh_vertices_.clear();
   mesh_faces_.clear();
+  ClearAdjacency();
+  bvh_.reset();
+  ComputeBounds();
+  if (welding_) {
+    BeginWelding();
+  }
 }
 
+void Mesh::BuildAdjacency() {
+  const std::size_t num_vertices = mesh_vertices_.size();
+  const std::size_t num_half_edges = mesh_faces_.size() * kVerticesPerFace;
+
+  // Count faces per vertex, then prefix sum the counts into offsets.
+  vertex_face_offsets_.assign(num_vertices + 1, 0);
+  for (const auto& mesh_face : mesh_faces_) {
+    for (const VertexIndex vertex_index : mesh_face.vertex_indices) {
+      ++vertex_face_offsets_[vertex_index + 1];
+    }
+  }
+  for (std::size_t index = 0; index < num_vertices; ++index) {
+    vertex_face_offsets_[index + 1] += vertex_face_offsets_[index];
+  }
+
+  // Scatter faces into place. Faces are visited in order, so each vertex's
+  // faces end up sorted.
+  vertex_faces_.resize(num_half_edges);
+  stl_vector<std::uint32_t> fill(vertex_face_offsets_.begin(),
+                                 vertex_face_offsets_.end() - 1);
+  for (FaceIndex face_index = 0; face_index < mesh_faces_.size();
+       ++face_index) {
+    for (const VertexIndex vertex_index :
+             mesh_faces_[face_index].vertex_indices) {
+      vertex_faces_[fill[vertex_index]++] = face_index;
+    }
+  }
+
+  // Pair each half-edge a->b with a half-edge b->a in a face around b.
+  opposite_half_edges_.assign(num_half_edges, kInvalidIndex);
+  for (HalfEdgeIndex half_edge = 0; half_edge < num_half_edges; ++half_edge) {
+    if (opposite_half_edges_[half_edge] != kInvalidIndex) {
+      continue;
+    }
+    const VertexIndex origin = HalfEdgeOrigin(half_edge);
+    const VertexIndex target = HalfEdgeTarget(half_edge);
+    for (const FaceIndex face_index : vertex_faces(target)) {
+      const auto& vertex_indices = mesh_faces_[face_index].vertex_indices;
+      for (int corner = 0; corner < kVerticesPerFace; ++corner) {
+        const HalfEdgeIndex candidate = face_index * kVerticesPerFace + corner;
+        if (vertex_indices[corner] == target &&
+            HalfEdgeTarget(candidate) == origin && candidate != half_edge &&
+            opposite_half_edges_[candidate] == kInvalidIndex) {
+          opposite_half_edges_[half_edge] = candidate;
+          opposite_half_edges_[candidate] = half_edge;
+          break;
+        }
+      }
+      if (opposite_half_edges_[half_edge] != kInvalidIndex) {
+        break;
+      }
+    }
+  }
+}
+
+const bool Mesh::has_adjacency() const {
+  return !vertex_face_offsets_.empty();
+}
+
+Mesh::FaceRange Mesh::vertex_faces(const VertexIndex vertex_index) const {
+  const FaceIndex* faces = vertex_faces_.data();
+  return FaceRange(faces + vertex_face_offsets_[vertex_index],
+                   faces + vertex_face_offsets_[vertex_index + 1]);
+}
+
+Mesh::HalfEdgeIndex Mesh::OppositeHalfEdge(
+    const HalfEdgeIndex half_edge) const {
+  return opposite_half_edges_[half_edge];
+}
+
+Mesh::VertexIndex Mesh::WeldVertex(MeshVertex&& mesh_vertex) {
+  std::uint32_t key[kFloatsPerWeldKey];
+  BuildWeldKey(mesh_vertex, key);
+  const std::uint32_t hash = HashWeldKey(key);
+
+  // Linear probe for a vertex with identical attributes.
+  const std::size_t mask = weld_slots_.size() - 1;
+  for (std::size_t slot = hash & mask;
+       weld_slots_[slot].vertex_index != kInvalidIndex;
+       slot = (slot + 1) & mask) {
+    const WeldSlot& weld_slot = weld_slots_[slot];
+    if (weld_slot.hash == hash) {
+      std::uint32_t existing_key[kFloatsPerWeldKey];
+      BuildWeldKey(mesh_vertices_[weld_slot.vertex_index], existing_key);
+      if (std::memcmp(key, existing_key, sizeof(key)) == 0) {
+        return weld_slot.vertex_index;
+      }
+    }
+  }
+
+  CHECK(mesh_vertices_.size() < kInvalidIndex) << "Too many vertices.";
+  mesh_vertices_.emplace_back(std::move(mesh_vertex));
+  const auto index = static_cast<VertexIndex>(mesh_vertices_.size() - 1);
+
+  // Keep the table at most half full so probe sequences stay short.
+  if ((num_weld_slots_used_ + 1) * 2 > weld_slots_.size()) {
+    stl_vector<WeldSlot> old_slots(weld_slots_.size() * 2,
+                                   WeldSlot{0, kInvalidIndex});
+    old_slots.swap(weld_slots_);
+    num_weld_slots_used_ = 0;
+    for (const auto& old_slot : old_slots) {
+      if (old_slot.vertex_index != kInvalidIndex) {
+        InsertWeldSlot(old_slot.hash, old_slot.vertex_index);
+      }
+    }
+  }
+  InsertWeldSlot(hash, index);
+  return index;
+}
+
+void Mesh::InsertWeldSlot(const std::uint32_t hash, const VertexIndex index) {
+  const std::size_t mask = weld_slots_.size() - 1;
+  std::size_t slot = hash & mask;
+  while (weld_slots_[slot].vertex_index != kInvalidIndex) {
+    slot = (slot + 1) & mask;
+  }
+  weld_slots_[slot] = WeldSlot{hash, index};
+  ++num_weld_slots_used_;
+}
+
+void Mesh::ClearAdjacency() {
+  if (has_adjacency()) {
+    stl_vector<std::uint32_t>().swap(vertex_face_offsets_);
+    stl_vector<FaceIndex>().swap(vertex_faces_);
+    stl_vector<HalfEdgeIndex>().swap(opposite_half_edges_);
+  }
+}
+
+void Mesh::ComputeBounds() {
+  bounds_ = Bounds::FromPoints(
+      mesh_vertices_.empty() ? nullptr : &mesh_vertices_[0].vertex,
+      mesh_vertices_.size(), sizeof(MeshVertex));
+}
+
+const Bounds& Mesh::bounds() const { return bounds_; }
+
+void Mesh::BuildBVH(JobSystem* job_system) {
+  bvh_ = AllocateUniqueObject<TriangleBVH>(*this, job_system);
+}
+
+const TriangleBVH* Mesh::bvh() const { return bvh_.get(); }
+
 const stl_vector<Mesh::MeshVertex>& Mesh::mesh_vertices() const {
   return mesh_vertices_;
 }
@@ -0,0 +1,291 @@
+/**
+ * @file mesh_cache.cc
+ * @brief Implements mesh_cache.h.
+ */
+
+#include "geometry/mesh_cache.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+#include "easylogging++.h"  // NOLINT
+#include "file_system/mapped_file.h"
+#include "resource/resource_metadata.h"
+
+namespace ogle {
+
+namespace {
+
+/// Identifies mesh cache files.
+constexpr char kMagic[4] = {'O', 'M', 'S', 'H'};
+
+/**
+ * @brief Header at the start of every cache file.
+ *
+ * The header is followed by, in order:
+ *   1) num_vertices Mesh::MeshVertex.
+ *   2) num_faces Mesh::MeshFace.
+ *   3) If has_adjacency: num_vertices + 1 vertex face offsets,
+ *      num_faces * 3 vertex faces, and num_faces * 3 opposite half-edges.
+ */
+struct CacheHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint64_t source_hash;
+  std::uint32_t num_vertices;
+  std::uint32_t num_faces;
+  std::uint32_t has_adjacency;
+  std::uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable<Mesh::MeshVertex>::value,
+              "Mesh vertices must be trivially copyable to be cached.");
+static_assert(std::is_trivially_copyable<Mesh::MeshFace>::value,
+              "Mesh faces must be trivially copyable to be cached.");
+
+/**
+ * @brief Copies an array out of cache file contents.
+ * @param[in,out] cursor Position in contents. Advanced past the array.
+ * @param num_values Number of values to copy.
+ * @param[out] values Vector to copy values into.
+ */
+template <typename T>
+void ReadArray(const char** cursor, const std::size_t num_values,
+               stl_vector<T>* values) {
+  values->resize(num_values);
+  if (num_values != 0) {
+    std::memcpy(values->data(), *cursor, num_values * sizeof(T));
+  }
+  *cursor += num_values * sizeof(T);
+}
+
+/**
+ * @brief Writes an array to a cache file.
+ * @param values Values to write.
+ * @param[out] out_file Stream to write to.
+ */
+template <typename T>
+void WriteArray(const stl_vector<T>& values, std::ofstream* out_file) {
+  out_file->write(reinterpret_cast<const char*>(values.data()),
+                  values.size() * sizeof(T));
+}
+
+/**
+ * @brief Makes a path for a temporary file next to a file, unique to this
+ *        process and call, so concurrent writers never share one.
+ * @param file_path Path to file.
+ * @return Temporary file path.
+ */
+FilePath TemporaryPath(const FilePath& file_path) {
+  static std::atomic<std::uint64_t> num_temporary_paths(0);
+#ifdef _WIN32
+  const auto process_id = GetCurrentProcessId();
+#else
+  const auto process_id = getpid();
+#endif
+  std::ostringstream temporary_path;
+  temporary_path << file_path.str() << ".tmp" << process_id << "."
+                 << num_temporary_paths.fetch_add(1);
+  return FilePath(temporary_path.str());
+}
+
+/**
+ * @brief Replaces a file with another, in one step, so readers see either
+ *        the old file or the new one.
+ * @param from_path Path to file to move.
+ * @param to_path Path to file to replace.
+ * @return Whether the operation was completed successfully.
+ */
+const bool MoveOverFile(const FilePath& from_path, const FilePath& to_path) {
+#ifdef _WIN32
+  return MoveFileExA(from_path.str().c_str(), to_path.str().c_str(),
+                     MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return std::rename(from_path.str().c_str(), to_path.str().c_str()) == 0;
+#endif
+}
+
+}  // namespace
+
+const stl_string MeshCache::kFileExtension = "omesh";
+
+constexpr std::uint32_t MeshCache::kVersion;
+
+std::uint64_t MeshCache::HashSource(
+    const char* source, const std::size_t source_size,
+    const stl_vector<std::uint64_t>& load_options) {
+  // FNV-1a over 64-bit words, mixing high bits down after each so every
+  // input bit reaches the low bits that the next word is XORed into.
+  constexpr std::uint64_t kPrime = 0x100000001B3ULL;
+  std::uint64_t hash = 0xCBF29CE484222325ULL;
+  auto hash_word = [&hash](const std::uint64_t word) {
+    hash = (hash ^ word) * kPrime;
+    hash ^= hash >> 32;
+  };
+  hash_word(source_size);
+  std::size_t offset = 0;
+  for (; offset + sizeof(std::uint64_t) <= source_size;
+       offset += sizeof(std::uint64_t)) {
+    std::uint64_t word;
+    std::memcpy(&word, source + offset, sizeof(word));
+    hash_word(word);
+  }
+  if (offset < source_size) {
+    std::uint64_t last_word = 0;
+    std::memcpy(&last_word, source + offset, source_size - offset);
+    hash_word(last_word);
+  }
+  for (const std::uint64_t option : load_options) {
+    hash_word(option);
+  }
+  return hash;
+}
+
+std::unique_ptr<Mesh> MeshCache::Read(const FilePath& cache_path,
+                                      const std::uint64_t source_hash,
+                                      const ResourceMetadata& metadata) {
+  MappedFile cache_file;
+  if (!cache_file.Open(cache_path)) {
+    return nullptr;
+  }
+
+  CacheHeader header;
+  if (cache_file.size() < sizeof(header)) {
+    LOG(WARNING) << "Mesh cache file is truncated: " << cache_path;
+    return nullptr;
+  }
+  std::memcpy(&header, cache_file.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion) {
+    LOG(WARNING) << "Mesh cache file has unknown format: " << cache_path;
+    return nullptr;
+  }
+  if (header.source_hash != source_hash) {
+    // The source or load options changed since the cache was written.
+    return nullptr;
+  }
+
+  const std::size_t num_vertices = header.num_vertices;
+  const std::size_t num_half_edges =
+      static_cast<std::size_t>(header.num_faces) * Mesh::kVerticesPerFace;
+  std::size_t expected_size = sizeof(header) +
+      num_vertices * sizeof(Mesh::MeshVertex) +
+      header.num_faces * sizeof(Mesh::MeshFace);
+  if (header.has_adjacency) {
+    expected_size += (num_vertices + 1) * sizeof(std::uint32_t) +
+        num_half_edges * (sizeof(Mesh::FaceIndex) +
+                          sizeof(Mesh::HalfEdgeIndex));
+  }
+  if (cache_file.size() != expected_size) {
+    LOG(WARNING) << "Mesh cache file has wrong size: " << cache_path;
+    return nullptr;
+  }
+
+  auto mesh = AllocateUniqueObject<Mesh>(metadata);
+  const char* cursor = cache_file.data() + sizeof(header);
+  ReadArray(&cursor, num_vertices, &mesh->mesh_vertices_);
+  ReadArray(&cursor, header.num_faces, &mesh->mesh_faces_);
+  for (const auto& mesh_face : mesh->mesh_faces_) {
+    for (const Mesh::VertexIndex index : mesh_face.vertex_indices) {
+      if (index >= num_vertices) {
+        LOG(WARNING) << "Mesh cache file has invalid face: " << cache_path;
+        return nullptr;
+      }
+    }
+  }
+  if (header.has_adjacency) {
+    ReadArray(&cursor, num_vertices + 1, &mesh->vertex_face_offsets_);
+    ReadArray(&cursor, num_half_edges, &mesh->vertex_faces_);
+    ReadArray(&cursor, num_half_edges, &mesh->opposite_half_edges_);
+    if (!ValidAdjacency(*mesh)) {
+      LOG(WARNING) << "Mesh cache file has invalid adjacency, rebuilding: "
+                   << cache_path;
+      mesh->ClearAdjacency();
+      mesh->BuildAdjacency();
+    }
+  }
+  return mesh;
+}
+
+const bool MeshCache::ValidAdjacency(const Mesh& mesh) {
+  const std::size_t num_faces = mesh.mesh_faces_.size();
+  const std::size_t num_half_edges = num_faces * Mesh::kVerticesPerFace;
+  const auto& offsets = mesh.vertex_face_offsets_;
+  if (offsets.empty() || offsets.front() != 0 ||
+      offsets.back() != num_half_edges) {
+    return false;
+  }
+  for (std::size_t index = 1; index < offsets.size(); ++index) {
+    if (offsets[index] < offsets[index - 1]) {
+      return false;
+    }
+  }
+  for (const Mesh::FaceIndex face : mesh.vertex_faces_) {
+    if (face >= num_faces) {
+      return false;
+    }
+  }
+  for (const Mesh::HalfEdgeIndex half_edge : mesh.opposite_half_edges_) {
+    if (half_edge >= num_half_edges && half_edge != Mesh::kInvalidIndex) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const bool MeshCache::Write(const FilePath& cache_path,
+                            const std::uint64_t source_hash,
+                            const Mesh& mesh) {
+  // Write a temporary file, then move it over the cache file. Other threads
+  // writing the same cache, and a crash mid-write, never leave a partial
+  // file behind for Read() to map.
+  const FilePath temporary_path = TemporaryPath(cache_path);
+  std::ofstream out_file(temporary_path.str(),
+                         std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out_file.is_open()) {
+    LOG(ERROR) << "Failed to open mesh cache file for writing: "
+               << temporary_path;
+    return false;
+  }
+
+  CacheHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.source_hash = source_hash;
+  header.num_vertices = static_cast<std::uint32_t>(mesh.mesh_vertices_.size());
+  header.num_faces = static_cast<std::uint32_t>(mesh.mesh_faces_.size());
+  header.has_adjacency = mesh.has_adjacency() ? 1 : 0;
+  header.reserved = 0;
+  out_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  WriteArray(mesh.mesh_vertices_, &out_file);
+  WriteArray(mesh.mesh_faces_, &out_file);
+  if (header.has_adjacency) {
+    WriteArray(mesh.vertex_face_offsets_, &out_file);
+    WriteArray(mesh.vertex_faces_, &out_file);
+    WriteArray(mesh.opposite_half_edges_, &out_file);
+  }
+
+  out_file.close();
+  if (!out_file) {
+    LOG(ERROR) << "Failed to write mesh cache file: " << temporary_path;
+    std::remove(temporary_path.str().c_str());
+    return false;
+  }
+  if (!MoveOverFile(temporary_path, cache_path)) {
+    LOG(ERROR) << "Failed to replace mesh cache file: " << cache_path;
+    std::remove(temporary_path.str().c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace ogle
@@ -4,28 +4,170 @@
  */
 
 #include "geometry/mesh_loader.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <thread>
 #include "easylogging++.h"  // NOLINT
-#include "file_system/text_file.h"
+#include "file_system/mapped_file.h"
 #include "geometry/mesh.h"
+#include "geometry/mesh_cache.h"
 #include "geometry/mesh_processing.h"
+#include "geometry/vertex_cache_simulator.h"
+#include "jobs/job_system.h"
 #include "resource/resource_metadata.h"
 #include "util/string_utils.h"
 
 namespace ogle {
 
-std::unique_ptr<Mesh> MeshLoader::LoadMesh(const ResourceMetadata& metadata) {
+namespace {
+
+/// Most values that can be given on a single OBJ vertex attribute line.
+constexpr int kMaxOBJAttributeValues = 4;
+
+/// Size of FIFO vertex cache simulated to report optimization results.
+constexpr std::size_t kSimulatedFIFOCacheSize = 16;
+
+/// Smallest amount of OBJ text worth parsing on its own thread.
+constexpr std::ptrdiff_t kMinOBJChunkSize = 1 << 20;
+
+/**
+ * @brief Tests if a keyword token matches an expected keyword.
+ * @param keyword Start of keyword token. Not null-terminated.
+ * @param keyword_length Length of keyword token.
+ * @param expected Null-terminated keyword to compare against.
+ * @return true on a match.
+ */
+inline bool KeywordEquals(const char* keyword,
+                          const std::ptrdiff_t keyword_length,
+                          const char* expected) {
+  return static_cast<std::size_t>(keyword_length) == std::strlen(expected) &&
+         std::strncmp(keyword, expected, keyword_length) == 0;
+}
+
+/**
+ * @brief Tests if the cursor has reached the end of meaningful line content.
+ * @param cursor Position in line.
+ * @param line_end End of line.
+ * @return true at end of line or at the start of a trailing comment.
+ */
+inline bool AtLineEnd(const char* cursor, const char* line_end) {
+  return cursor >= line_end || *cursor == '#';
+}
+
+/**
+ * @brief Reads all floats remaining on an OBJ line.
+ * @param[in,out] cursor Position in line.
+ * @param line_end End of line.
+ * @param[out] values Parsed values.
+ * @return Number of values parsed, or -1 if a token is not a float or there
+ *         are too many values.
+ */
+int ParseOBJFloats(const char** cursor, const char* line_end,
+                   float values[kMaxOBJAttributeValues]) {
+  int num_values = 0;
+  StringUtils::SkipSpaces(cursor, line_end);
+  while (!AtLineEnd(*cursor, line_end)) {
+    if (num_values == kMaxOBJAttributeValues ||
+        !StringUtils::ParseFloat(cursor, line_end, &values[num_values])) {
+      return -1;
+    }
+    ++num_values;
+    StringUtils::SkipSpaces(cursor, line_end);
+  }
+  return num_values;
+}
+
+/**
+ * @brief Parses a single face vertex specifier: v, v/t, v//n, or v/t/n.
+ * @param[in,out] cursor Position in line.
+ * @param line_end End of line.
+ * @param[out] obj_indices Raw OBJ indices for vertex, texture coordinate, and
+ *             normal. Absent indices are set to 0, which OBJ never uses.
+ * @return true on success.
+ */
+bool ParseOBJFaceVertex(const char** cursor, const char* line_end,
+                        int obj_indices[3]) {
+  obj_indices[0] = obj_indices[1] = obj_indices[2] = 0;
+  if (!StringUtils::ParseInt(cursor, line_end, &obj_indices[0])) {
+    return false;
+  }
+  if (*cursor < line_end && **cursor == '/') {
+    ++*cursor;
+    if (*cursor < line_end && **cursor != '/' && **cursor != ' ' &&
+        **cursor != '\t' && **cursor != '\r') {
+      if (!StringUtils::ParseInt(cursor, line_end, &obj_indices[1])) {
+        return false;
+      }
+    }
+    if (*cursor < line_end && **cursor == '/') {
+      ++*cursor;
+      if (!StringUtils::ParseInt(cursor, line_end, &obj_indices[2])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Converts an OBJ index to an index into an attribute array.
+ *
+ * OBJ indices start at 1, but memory indices start at 0. Negative indices
+ * count back from the last value defined, so -1 is the latest value.
+ *
+ * @param obj_index Index parsed from OBJ file.
+ * @param num_values Number of attribute values defined so far.
+ * @param[out] index Converted index.
+ * @return Error message, or null if the index refers to a defined value.
+ */
+const char* ConvertOBJIndex(const int obj_index, const std::size_t num_values,
+                            std::size_t* index) {
+  if (obj_index == 0) {
+    return "Invalid 0 index parsed from OBJ file.";
+  } else if (obj_index < 0) {
+    const auto num_back = static_cast<std::size_t>(-(obj_index + 1)) + 1;
+    if (num_back > num_values) {
+      return "Face refers to attribute that is not defined.";
+    }
+    *index = num_values - num_back;
+    return nullptr;
+  }
+  *index = static_cast<std::size_t>(obj_index) - 1;
+  if (*index >= num_values) {
+    return "Face refers to attribute that is not defined.";
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+const stl_string MeshLoader::kLoaderThreadsField = "loader_threads";
+const stl_string MeshLoader::kWeldVerticesField = "weld_vertices";
+const stl_string MeshLoader::kOptimizeVertexCacheField =
+    "optimize_vertex_cache";
+const stl_string MeshLoader::kMeshCacheField = "mesh_cache";
+const stl_string MeshLoader::kBuildBVHField = "build_bvh";
+
+std::unique_ptr<Mesh> MeshLoader::LoadMesh(const ResourceMetadata& metadata,
+                                           JobSystem* job_system) {
   if (metadata.type() != ResourceType::MESH) {
     LOG(ERROR) << "Attempted to load Mesh from incorrect metadata type: "
                << metadata.type();
     return nullptr;
   }
 
+  LoadOptions options;
+  options.job_system = job_system;
+  if (!ReadLoadOptions(metadata, &options)) {
+    return nullptr;
+  }
   const MeshFileFormat mesh_format = DetermineMeshFormat(metadata);
 
   std::unique_ptr<Mesh> new_mesh = nullptr;
   switch (mesh_format) {
     case MeshFileFormat::OBJ: {
-      new_mesh = std::move(LoadOBJ(metadata));
+      new_mesh = std::move(LoadOBJ(metadata, options));
       break;
     }
 
@@ -38,6 +180,10 @@ std::unique_ptr<Mesh> MeshLoader::LoadMesh(const ResourceMetadata& metadata) {
   }
 
   CHECK(new_mesh != nullptr) << "Mesh should have been created.";
+  new_mesh->ComputeBounds();
+  if (options.build_bvh) {
+    new_mesh->BuildBVH(options.job_system);
+  }
   return new_mesh;
 }
 
@@ -50,156 +196,420 @@ const MeshLoader::MeshFileFormat MeshLoader::DetermineMeshFormat(
   return MeshFileFormat::UNKNOWN;
 }
 
-std::unique_ptr<Mesh> MeshLoader::LoadOBJ(const ResourceMetadata& metadata) {
-  stl_string text;
+const bool MeshLoader::ReadLoadOptions(const ResourceMetadata& metadata,
+                                       LoadOptions* options) {
+  const auto loader_threads_config = metadata.Get<int>(kLoaderThreadsField);
+  if (loader_threads_config.second) {
+    options->num_threads = loader_threads_config.first;
+    if (options->num_threads < 0) {
+      LOG(ERROR) << "Invalid number of loader threads: "
+                 << options->num_threads;
+      return false;
+    } else if (options->num_threads == 0) {
+      options->num_threads = (options->job_system != nullptr) ?
+          options->job_system->num_workers() + 1 :
+          std::max(1U, std::thread::hardware_concurrency());
+    }
+  }
+
+  const auto weld_vertices_config = metadata.Get<bool>(kWeldVerticesField);
+  if (weld_vertices_config.second) {
+    options->weld_vertices = weld_vertices_config.first;
+  }
+  const auto optimize_vertex_cache_config =
+      metadata.Get<bool>(kOptimizeVertexCacheField);
+  if (optimize_vertex_cache_config.second) {
+    options->optimize_vertex_cache = optimize_vertex_cache_config.first;
+  }
+  const auto mesh_cache_config = metadata.Get<bool>(kMeshCacheField);
+  if (mesh_cache_config.second) {
+    options->use_cache = mesh_cache_config.first;
+  }
+  const auto build_bvh_config = metadata.Get<bool>(kBuildBVHField);
+  if (build_bvh_config.second) {
+    options->build_bvh = build_bvh_config.first;
+  }
+  return true;
+}
+
+std::unique_ptr<Mesh> MeshLoader::LoadOBJ(const ResourceMetadata& metadata,
+                                          const LoadOptions& options) {
   const auto& file_path = metadata.resource_path();
-  if (!TextFile::ReadTextFile(file_path, &text)) {
+
+  // The source is mapped rather than read, so it is hashed and parsed
+  // without copying it.
+  MappedFile source_file;
+  if (!source_file.Open(file_path)) {
+    LOG(ERROR) << "Failed to open mesh file: " << file_path;
     return nullptr;
   }
-  stl_vector<stl_string> lines = StringUtils::Split(text, '\n');
-  text.clear();
+
+  // Use the compiled mesh if it was built from these contents of the file
+  // with the same options. The thread count doesn't change the result.
+  const FilePath cache_path(file_path.str() + "." +
+                            MeshCache::kFileExtension);
+  const bool use_cache = options.use_cache;
+  std::uint64_t source_hash = 0;
+  if (use_cache) {
+    source_hash = MeshCache::HashSource(
+        source_file.data(), source_file.size(),
+        {options.weld_vertices ? 1U : 0U,
+         options.optimize_vertex_cache ? 1U : 0U});
+    auto cached_mesh = MeshCache::Read(cache_path, source_hash, metadata);
+    if (cached_mesh != nullptr) {
+      return cached_mesh;
+    }
+  }
 
   auto mesh = AllocateUniqueObject<Mesh>(metadata);
-  MeshAttributes mesh_data;
-  for (const auto& line : lines) {
-    stl_string trimmed_line = StringUtils::Trim(line, " \t\r\n");
-    if (trimmed_line.empty() || trimmed_line[0] == '#') {
+  if (options.weld_vertices) {
+    mesh->BeginWelding();
+  }
+  const char* begin = source_file.data();
+  const char* end = begin + source_file.size();
+  bool parsed = false;
+  if (options.num_threads > 1) {
+    parsed = ParseOBJParallel(begin, end, options.num_threads,
+                              options.job_system, mesh.get());
+  } else {
+    MeshAttributes mesh_data;
+    parsed = ParseOBJ(begin, end, &mesh_data, mesh.get());
+  }
+  if (!parsed) {
+    LOG(ERROR) << "Failed to parse OBJ file: " << file_path;
+    return nullptr;
+  }
+  if (options.weld_vertices) {
+    mesh->EndWelding();
+    const std::size_t num_face_vertices =
+        mesh->mesh_faces().size() * Mesh::kVerticesPerFace;
+    const std::size_t num_vertices = mesh->mesh_vertices().size();
+    LOG(INFO) << "Welded " << num_face_vertices << " face vertices into "
+              << num_vertices << " vertices ("
+              << ((num_vertices != 0) ?
+                  static_cast<double>(num_face_vertices) / num_vertices : 0.0)
+              << "x) for mesh: " << file_path;
+  }
+
+  if (options.optimize_vertex_cache) {
+    const VertexCacheSimulator fifo_cache(VertexCacheSimulator::Policy::FIFO,
+                                          kSimulatedFIFOCacheSize);
+    const VertexCacheSimulator lru_cache(VertexCacheSimulator::Policy::LRU,
+                                         MeshProcessing::kOptimizedCacheSize);
+    const auto fifo_before = fifo_cache.Simulate(*mesh);
+    const auto lru_before = lru_cache.Simulate(*mesh);
+    MeshProcessing::OptimizeVertexCache(mesh.get());
+    const auto fifo_after = fifo_cache.Simulate(*mesh);
+    const auto lru_after = lru_cache.Simulate(*mesh);
+    LOG(INFO) << "Optimized vertex cache for mesh: " << file_path
+              << "; FIFO(" << kSimulatedFIFOCacheSize << ") ACMR "
+              << fifo_before.acmr << " -> " << fifo_after.acmr << ", ATVR "
+              << fifo_before.atvr << " -> " << fifo_after.atvr
+              << "; LRU(" << MeshProcessing::kOptimizedCacheSize << ") ACMR "
+              << lru_before.acmr << " -> " << lru_after.acmr << ", ATVR "
+              << lru_before.atvr << " -> " << lru_after.atvr;
+  }
+  if (!mesh->has_adjacency()) {
+    mesh->BuildAdjacency();
+  }
+
+  // A cache that can't be written only costs time on the next load.
+  if (use_cache) {
+    MeshCache::Write(cache_path, source_hash, *mesh);
+  }
+  return mesh;
+}
+
+template <typename FaceHandler>
+const char* MeshLoader::ParseOBJText(const char* begin, const char* end,
+                                     MeshAttributes* mesh_data,
+                                     std::uint64_t* line_number,
+                                     FaceHandler handle_face) {
+  *line_number = 0;
+  const char* line_start = begin;
+  while (line_start < end) {
+    const char* line_end = static_cast<const char*>(
+        std::memchr(line_start, '\n', end - line_start));
+    if (line_end == nullptr) {
+      line_end = end;
+    }
+    ++*line_number;
+    const char* cursor = line_start;
+    line_start = line_end + 1;
+
+    StringUtils::SkipSpaces(&cursor, line_end);
+    if (AtLineEnd(cursor, line_end)) {
       continue;
     }
-    trimmed_line = StringUtils::Replace(trimmed_line, '\t', ' ');
-    const auto tokens = StringUtils::Split(trimmed_line, ' ');
-    const stl_string& line_type = tokens[0];
-    stl_vector<float> line_floats;
+    const char* keyword = cursor;
+    while (cursor < line_end && *cursor != ' ' && *cursor != '\t' &&
+           *cursor != '\r') {
+      ++cursor;
+    }
+    const std::ptrdiff_t keyword_length = cursor - keyword;
 
-    if (line_type == "v") {
-      for (stl_vector<stl_string>::size_type token_index = 1;
-           token_index < tokens.size(); token_index++) {
-        line_floats.emplace_back(std::stof(tokens[token_index]));
-      }
-      Vector3f line_vector;
-      if (line_floats.size() == 3) {
-        line_vector = {line_floats[0], line_floats[1], line_floats[2]};
-      } else if (line_floats.size() == 4) {
+    const char* error = nullptr;
+    float line_floats[kMaxOBJAttributeValues];
+    if (KeywordEquals(keyword, keyword_length, "v")) {
+      const int num_floats = ParseOBJFloats(&cursor, line_end, line_floats);
+      if (num_floats == 3) {
+        mesh_data->vertices.push_back(
+            {line_floats[0], line_floats[1], line_floats[2]});
+      } else if (num_floats == 4) {
         // Have w coordinate, produce a 3-vector with w = 1.
         const float w = line_floats[3];
-        line_vector = {line_floats[0] / w, line_floats[1] / w,
-                       line_floats[2] / w};
+        mesh_data->vertices.push_back(
+            {line_floats[0] / w, line_floats[1] / w, line_floats[2] / w});
       } else {
-        LOG(ERROR) << "Expected 3 or 4 floats for vertex.";
-        return nullptr;
-      }
-      mesh_data.vertices.emplace_back(line_vector);
-    } else if (line_type == "vt") {
-      for (stl_vector<stl_string>::size_type token_index = 1;
-           token_index < tokens.size(); token_index++) {
-        line_floats.emplace_back(std::stof(tokens[token_index]));
-      }
-      if (line_floats.size() == 2) {
-        mesh_data.tex_coords_uv.emplace_back(
-            Vector2f({line_floats[0], line_floats[1]}));
-      } else if (line_floats.size() == 3) {
-        mesh_data.tex_coords_uvw.emplace_back(
-            Vector3f({line_floats[0], line_floats[1], line_floats[2]}));
+        error = "Expected 3 or 4 floats for vertex.";
       }
-    } else if (line_type == "vn") {
-      for (stl_vector<stl_string>::size_type token_index = 1;
-           token_index < tokens.size(); token_index++) {
-        line_floats.emplace_back(std::stof(tokens[token_index]));
+    } else if (KeywordEquals(keyword, keyword_length, "vt")) {
+      // The optional w coordinate is dropped; v defaults to 0.
+      const int num_floats = ParseOBJFloats(&cursor, line_end, line_floats);
+      if (num_floats >= 1 && num_floats <= 3) {
+        mesh_data->tex_coords_uv.push_back(
+            {line_floats[0], (num_floats > 1) ? line_floats[1] : 0.f});
+      } else {
+        error = "Expected 1 to 3 floats for texture coordinate.";
       }
-
+    } else if (KeywordEquals(keyword, keyword_length, "vn")) {
       // This does not check if the normal vector is actually normalized--
       // it leaves this possibility open on purpose.
-      mesh_data.normals.emplace_back(
-          Vector3f({line_floats[0], line_floats[1], line_floats[2]}));
-    } else if (line_type == "vp") {
-      LOG(ERROR) << "LoadOBJ cannot load parameter space vertices.";
-      return nullptr;
-    } else if (line_type == "f") {
-      // Several different formats are possible, split by '/'.
-      if (tokens.size() != 4) {  // 'f' + 3 vertices.
-        LOG(ERROR) << "Non-triangular faces are not supported.";
-        return nullptr;
+      const int num_floats = ParseOBJFloats(&cursor, line_end, line_floats);
+      if (num_floats == 3) {
+        mesh_data->normals.push_back(
+            {line_floats[0], line_floats[1], line_floats[2]});
+      } else {
+        error = "Expected 3 floats for normal.";
       }
+    } else if (KeywordEquals(keyword, keyword_length, "vp")) {
+      error = "LoadOBJ cannot load parameter space vertices.";
+    } else if (KeywordEquals(keyword, keyword_length, "f")) {
+      OBJFace face;
+      int num_face_vertices = 0, num_uvs = 0, num_normals = 0;
 
-      stl_vector<Vector3f> face_vertices;
-      stl_vector<Vector2f> face_vertex_uvs;
-      stl_vector<Vector3f> face_vertex_normals;
-      for (stl_vector<stl_string>::size_type token_index = 1;
-           token_index < tokens.size(); token_index++) {
-        const stl_string& index_specifier = tokens[token_index];
-        const auto first_slash_index = index_specifier.find_first_of('/');
-        const auto last_slash_index = index_specifier.find_last_of('/');
-        stl_string vertex_str = "", tex_str = "", normal_str = "";
-
-        if (index_specifier.find("//") != stl_string::npos) {  // v//n
-          vertex_str = index_specifier.substr(0, first_slash_index);
-          normal_str = index_specifier.substr(last_slash_index + 1);
-        } else if (first_slash_index != last_slash_index) {  // v/t/n
-          vertex_str = index_specifier.substr(0, first_slash_index);
-          tex_str = index_specifier.substr(
-              first_slash_index + 1, last_slash_index - first_slash_index - 1);
-          normal_str = index_specifier.substr(last_slash_index + 1);
-        } else if (first_slash_index != stl_string::npos &&
-                   first_slash_index == last_slash_index) {  // v/t
-          vertex_str = index_specifier.substr(0, first_slash_index);
-          tex_str = index_specifier.substr(first_slash_index + 1);
-        } else {  // v
-          vertex_str = index_specifier;
-        }
-
-        // OBJ indices start at 1, but memory indices start at 0. This function
-        // handles the conversion; it is anonymized on the assumption that it is
-        // only relevant inside the OBJ mesh loader.
-        auto convert_obj_index = [](const stl_string& index_str) {
-          int index = std::stoi(index_str);
-          if (index == 0) {
-            LOG(ERROR) << "Invalid 0 index parsed from OBJ file.";
-          } else if (index < 0) {
-            LOG(ERROR) << "Negative OBJ indices are not supported.";
-          } else {
-            --index;
-          }
-          return index;
-        };
-
-        if (!vertex_str.empty()) {
-          const BufferIndex index = convert_obj_index(vertex_str);
-          if (index > mesh_data.vertices.size()) {
-            LOG(ERROR) << "Face vertex not found for index: " << index;
-            return nullptr;
+      StringUtils::SkipSpaces(&cursor, line_end);
+      while (error == nullptr && !AtLineEnd(cursor, line_end)) {
+        if (num_face_vertices == Mesh::kVerticesPerFace) {
+          error = "Non-triangular faces are not supported.";
+        } else if (!ParseOBJFaceVertex(&cursor, line_end,
+                                       face.obj_indices[num_face_vertices])) {
+          error = "Malformed face vertex.";
+        } else {
+          const int* obj_indices = face.obj_indices[num_face_vertices];
+          if (obj_indices[0] == 0) {
+            error = "Invalid 0 index parsed from OBJ file.";
           }
-          face_vertices.emplace_back(mesh_data.vertices[index]);
+          num_uvs += (obj_indices[1] != 0) ? 1 : 0;
+          num_normals += (obj_indices[2] != 0) ? 1 : 0;
+          ++num_face_vertices;
         }
-        if (!tex_str.empty()) {
-          const BufferIndex index = convert_obj_index(tex_str);
-          if (index > mesh_data.tex_coords_uv.size()) {
-            LOG(ERROR) << "Face UV not found for index: " << index;
-            return nullptr;
-          }
-          face_vertex_uvs.emplace_back(mesh_data.tex_coords_uv[index]);
-        }
-        if (!normal_str.empty()) {
-          const BufferIndex index = convert_obj_index(normal_str);
-          if (index > mesh_data.normals.size()) {
-            LOG(ERROR) << "Face normal not found for index: " << index;
-            return nullptr;
-          }
-          face_vertex_normals.emplace_back(mesh_data.normals[index]);
+        StringUtils::SkipSpaces(&cursor, line_end);
+      }
+
+      if (error == nullptr) {
+        if (num_face_vertices != Mesh::kVerticesPerFace) {
+          error = "Faces must be triangular.";
+        } else if ((num_uvs != 0 && num_uvs != num_face_vertices) ||
+                   (num_normals != 0 && num_normals != num_face_vertices)) {
+          error = "Face vertices must all specify the same attributes.";
+        } else if (mesh_data->vertices.size() >
+                       std::numeric_limits<std::uint32_t>::max() ||
+                   mesh_data->tex_coords_uv.size() >
+                       std::numeric_limits<std::uint32_t>::max() ||
+                   mesh_data->normals.size() >
+                       std::numeric_limits<std::uint32_t>::max()) {
+          error = "Too many vertex attributes in OBJ text.";
+        } else {
+          face.num_defined[0] =
+              static_cast<std::uint32_t>(mesh_data->vertices.size());
+          face.num_defined[1] =
+              static_cast<std::uint32_t>(mesh_data->tex_coords_uv.size());
+          face.num_defined[2] =
+              static_cast<std::uint32_t>(mesh_data->normals.size());
+          error = handle_face(face);
         }
       }
+    }
 
-      if (face_vertices.size() != 3) {
-        LOG(ERROR) << "Faces must be triangular.";
-        return nullptr;
+    if (error != nullptr) {
+      return error;
+    }
+  }
+
+  return nullptr;
+}
+
+
+const bool MeshLoader::ParseOBJ(const char* begin, const char* end,
+                                MeshAttributes* mesh_data, Mesh* mesh) {
+  static const std::size_t kNoBase[3] = {0, 0, 0};
+  std::uint64_t line_number = 0;
+  const char* error = ParseOBJText(
+      begin, end, mesh_data, &line_number, [mesh_data, mesh](
+          const OBJFace& face) {
+        return AddOBJFace(face, *mesh_data, kNoBase, mesh);
+      });
+  if (error != nullptr) {
+    LOG(ERROR) << error << " OBJ line: " << line_number;
+    return false;
+  }
+  return true;
+}
+
+const bool MeshLoader::ParseOBJParallel(const char* begin, const char* end,
+                                        const int num_threads,
+                                        JobSystem* job_system, Mesh* mesh) {
+  // Split the text into newline-aligned chunks, but don't bother with chunks
+  // so small that starting a thread would cost more than parsing them.
+  const std::ptrdiff_t text_size = end - begin;
+  const std::ptrdiff_t num_chunks = std::min<std::ptrdiff_t>(
+      num_threads, text_size / kMinOBJChunkSize + 1);
+  stl_vector<OBJChunk> chunks(num_chunks);
+  const char* chunk_begin = begin;
+  for (std::ptrdiff_t i = 0; i < num_chunks; ++i) {
+    const char* chunk_end = end;
+    if (i + 1 < num_chunks) {
+      chunk_end = std::max(chunk_begin,
+                           begin + text_size / num_chunks * (i + 1));
+      const char* newline = static_cast<const char*>(
+          std::memchr(chunk_end, '\n', end - chunk_end));
+      chunk_end = (newline != nullptr) ? newline + 1 : end;
+    }
+    chunks[i].begin = chunk_begin;
+    chunks[i].end = chunk_end;
+    chunk_begin = chunk_end;
+  }
+
+  // The calling thread parses the first chunk while jobs or workers parse
+  // the rest.
+  if (job_system != nullptr) {
+    job_system->ParallelFor(0, chunks.size(), 1, [&chunks](
+        const std::size_t chunk_begin, const std::size_t chunk_end) {
+      for (std::size_t i = chunk_begin; i < chunk_end; ++i) {
+        ParseOBJChunk(&chunks[i]);
       }
-      if (!mesh->AddFace(face_vertices, face_vertex_uvs, face_vertex_normals)) {
-        LOG(ERROR) << "Failed to add mesh face.";
-        return nullptr;
+    });
+  } else {
+    stl_vector<std::thread> workers;
+    workers.reserve(num_chunks - 1);
+    for (std::ptrdiff_t i = 1; i < num_chunks; ++i) {
+      workers.emplace_back(ParseOBJChunk, &chunks[i]);
+    }
+    ParseOBJChunk(&chunks[0]);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  // Prefix sum over chunk sizes gives each chunk's offset into the combined
+  // attribute arrays and its first line number.
+  MeshAttributes mesh_data;
+  std::size_t num_attributes[3] = {0, 0, 0};
+  std::uint64_t num_lines = 0;
+  for (auto& chunk : chunks) {
+    std::copy(num_attributes, num_attributes + 3, chunk.base);
+    chunk.first_line = num_lines;
+    num_attributes[0] += chunk.attributes.vertices.size();
+    num_attributes[1] += chunk.attributes.tex_coords_uv.size();
+    num_attributes[2] += chunk.attributes.normals.size();
+    num_lines += chunk.num_lines;
+  }
+  mesh_data.vertices.resize(num_attributes[0]);
+  mesh_data.tex_coords_uv.resize(num_attributes[1]);
+  mesh_data.normals.resize(num_attributes[2]);
+  for (auto& chunk : chunks) {
+    std::copy(chunk.attributes.vertices.begin(),
+              chunk.attributes.vertices.end(),
+              mesh_data.vertices.begin() + chunk.base[0]);
+    std::copy(chunk.attributes.tex_coords_uv.begin(),
+              chunk.attributes.tex_coords_uv.end(),
+              mesh_data.tex_coords_uv.begin() + chunk.base[1]);
+    std::copy(chunk.attributes.normals.begin(),
+              chunk.attributes.normals.end(),
+              mesh_data.normals.begin() + chunk.base[2]);
+    chunk.attributes = MeshAttributes();
+  }
+
+  // Add faces in file order, stopping at the first error just as ParseOBJ
+  // would.
+  for (auto& chunk : chunks) {
+    for (const auto& face : chunk.faces) {
+      const char* error = AddOBJFace(face, mesh_data, chunk.base, mesh);
+      if (error != nullptr) {
+        // Faces don't record their lines, so parse the chunk again to find
+        // the one that failed.
+        MeshAttributes chunk_data;
+        std::uint64_t line_number = 0;
+        ParseOBJText(chunk.begin, chunk.end, &chunk_data, &line_number,
+                     [&mesh_data, &chunk](const OBJFace& chunk_face) {
+                       return AddOBJFace(chunk_face, mesh_data, chunk.base,
+                                         nullptr);
+                     });
+        LOG(ERROR) << error << " OBJ line: " << chunk.first_line + line_number;
+        return false;
       }
     }
+    if (chunk.error != nullptr) {
+      LOG(ERROR) << chunk.error << " OBJ line: "
+                 << chunk.first_line + chunk.num_lines;
+      return false;
+    }
+    stl_vector<OBJFace>().swap(chunk.faces);
   }
 
-  return mesh;
+  return true;
+}
+
+void MeshLoader::ParseOBJChunk(OBJChunk* chunk) {
+  chunk->error = ParseOBJText(
+      chunk->begin, chunk->end, &chunk->attributes, &chunk->num_lines,
+      [chunk](const OBJFace& face) -> const char* {
+        chunk->faces.push_back(face);
+        return nullptr;
+      });
 }
 
+const char* MeshLoader::AddOBJFace(const OBJFace& face,
+                                   const MeshAttributes& mesh_data,
+                                   const std::size_t base[3], Mesh* mesh) {
+  Vector3f face_vertices[Mesh::kVerticesPerFace];
+  Vector2f face_vertex_uvs[Mesh::kVerticesPerFace];
+  Vector3f face_vertex_normals[Mesh::kVerticesPerFace];
+  const bool has_uvs = face.obj_indices[0][1] != 0;
+  const bool has_normals = face.obj_indices[0][2] != 0;
+
+  for (int i = 0; i < Mesh::kVerticesPerFace; ++i) {
+    const int* obj_indices = face.obj_indices[i];
+    std::size_t index = 0;
+    const char* error = ConvertOBJIndex(
+        obj_indices[0], base[0] + face.num_defined[0], &index);
+    if (error != nullptr) {
+      return error;
+    }
+    face_vertices[i] = mesh_data.vertices[index];
+    if (has_uvs) {
+      error = ConvertOBJIndex(obj_indices[1], base[1] + face.num_defined[1],
+                              &index);
+      if (error != nullptr) {
+        return error;
+      }
+      face_vertex_uvs[i] = mesh_data.tex_coords_uv[index];
+    }
+    if (has_normals) {
+      error = ConvertOBJIndex(obj_indices[2], base[2] + face.num_defined[2],
+                              &index);
+      if (error != nullptr) {
+        return error;
+      }
+      face_vertex_normals[i] = mesh_data.normals[index];
+    }
+  }
+
+  if (mesh != nullptr) {
+    mesh->AddTriangle(face_vertices, has_uvs ? face_vertex_uvs : nullptr,
+                      has_normals ? face_vertex_normals : nullptr);
+  }
+  return nullptr;
+}
 }  // namespace ogle
@@ -4,33 +4,365 @@
  */
 
 #include "geometry/mesh_processing.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
 #include "easylogging++.h"  // NOLINT
-#include "math/vector.h"
+#include "jobs/job_system.h"
 
 namespace ogle {
 
+namespace {
+
+/// Fewest faces or vertices worth handing to their own thread or job.
+constexpr std::size_t kMinItemsPerThread = 1 << 15;
+
+/**
+ * @brief Splits a range of items into contiguous blocks processed
+ *        concurrently.
+ * @param num_items Number of items.
+ * @param num_threads Most threads to start when job_system is null,
+ *        including the calling thread.
+ * @param job_system Job system to run blocks on, or null.
+ * @param function Callable taking the (begin, end) indices of a block.
+ */
+template <typename Function>
+void ParallelFor(const std::size_t num_items, const int num_threads,
+                 JobSystem* job_system, Function function) {
+  if (job_system != nullptr) {
+    job_system->ParallelFor(0, num_items, kMinItemsPerThread, function);
+    return;
+  }
+  const std::size_t num_blocks = std::max<std::size_t>(1, std::min<std::size_t>(
+      num_threads, num_items / kMinItemsPerThread));
+  stl_vector<std::thread> workers;
+  workers.reserve(num_blocks - 1);
+  for (std::size_t block = 1; block < num_blocks; ++block) {
+    workers.emplace_back(function, num_items * block / num_blocks,
+                         num_items * (block + 1) / num_blocks);
+  }
+  function(std::size_t{0}, num_items / num_blocks);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Computes the angle between two edges leaving a corner.
+ * @param edge_0 First edge.
+ * @param edge_1 Second edge.
+ * @return Angle in radians, or 0 if either edge is degenerate.
+ */
+float CornerAngle(const Vector3f& edge_0, const Vector3f& edge_1) {
+  const double lengths = edge_0.Norm() * edge_1.Norm();
+  if (lengths == 0) {
+    return 0.f;
+  }
+  const double cosine = edge_0.Dot(edge_1) / lengths;
+  return static_cast<float>(std::acos(std::max(-1.0, std::min(1.0, cosine))));
+}
+
+///@{
+/// Tuning values for Forsyth's vertex scores, from his paper.
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kLastFaceScore = 0.75f;
+constexpr float kValenceBoostScale = 2.f;
+constexpr float kValenceBoostPower = 0.5f;
+///@}
+
+/// Largest remaining valence given its own precomputed score.
+constexpr std::uint32_t kMaxScoredValence = 64;
+
+/**
+ * @brief Computes the Forsyth score of a vertex.
+ * @param cache_position Position in modeled LRU cache, or -1 if not cached.
+ * @param remaining_valence Number of faces using the vertex still to be
+ *        emitted.
+ * @return Score. Higher scores make faces using the vertex more attractive.
+ */
+float ForsythVertexScore(const int cache_position,
+                         const std::uint32_t remaining_valence) {
+  if (remaining_valence == 0) {
+    return -1.f;
+  }
+
+  float score = 0.f;
+  if (cache_position >= 0) {
+    if (cache_position < Mesh::kVerticesPerFace) {
+      // Vertices of the face just emitted get a fixed score, so that the
+      // next face doesn't simply favor the most recent strip direction.
+      score = kLastFaceScore;
+    } else {
+      const float scale =
+          1.f / (MeshProcessing::kOptimizedCacheSize - Mesh::kVerticesPerFace);
+      score = std::pow(
+          1.f - (cache_position - Mesh::kVerticesPerFace) * scale,
+          kCacheDecayPower);
+    }
+  }
+
+  // Favor vertices with few faces left, so they can leave the cache.
+  score += kValenceBoostScale *
+      std::pow(static_cast<float>(remaining_valence), -kValenceBoostPower);
+  return score;
+}
+
+}  // namespace
+
 void MeshProcessing::ComputeAveragedNormals(Mesh* mesh) {
-  stl_vector<Vector3f> new_normals;
-  for (const Mesh::MeshVertex& mesh_vertex : mesh->mesh_vertices_) {
-    Vector3f new_vertex_normal = Vector3f::Zero();
-    for (const Mesh::MeshFace* face : mesh_vertex.adjoining_faces) {
-      CHECK(face->vertex_indices.size() == 3)
-          << "Faces are assumed to have 3 vertices.";
-      const auto& vertex_0 = mesh->mesh_vertices_[0];
-      const auto& vertex_1 = mesh->mesh_vertices_[1];
-      const auto& vertex_2 = mesh->mesh_vertices_[2];
-      new_vertex_normal +=
-          (vertex_1.vertex - vertex_0.vertex).Cross(
-              vertex_2.vertex - vertex_0.vertex).NormalizedCopy();
-    }
-    new_normals.emplace_back(new_vertex_normal.NormalizedCopy());
-  }
-
-  // Swap normals.
-  for (Mesh::VertexIndex index = 0; index < mesh->mesh_vertices_.size();
-       index++) {
-    mesh->mesh_vertices_[index].vertex_normal = new_normals[index];
+  ComputeVertexNormals(mesh, NormalWeighting::UNIFORM, nullptr, 0, nullptr);
+}
+
+void MeshProcessing::ComputeVertexNormals(Mesh* mesh,
+                                          const NormalWeighting weighting,
+                                          stl_vector<Vector4f>* tangents,
+                                          const int num_threads,
+                                          JobSystem* job_system) {
+  if (!mesh->has_adjacency()) {
+    mesh->BuildAdjacency();
+  }
+  const int max_threads = (num_threads > 0) ? num_threads :
+      std::max(1U, std::thread::hardware_concurrency());
+  const auto& mesh_faces = mesh->mesh_faces_;
+  auto& mesh_vertices = mesh->mesh_vertices_;
+  const bool compute_tangents = tangents != nullptr;
+
+  // Compute each face's normal, and the directions of increasing u and v
+  // across it if tangents are wanted.
+  stl_vector<Vector3f> face_normals(mesh_faces.size());
+  stl_vector<Vector3f> face_u_directions, face_v_directions;
+  if (compute_tangents) {
+    face_u_directions.resize(mesh_faces.size());
+    face_v_directions.resize(mesh_faces.size());
+  }
+  ParallelFor(mesh_faces.size(), max_threads, job_system,
+              [&](const std::size_t begin, const std::size_t end) {
+    for (std::size_t face_index = begin; face_index < end; ++face_index) {
+      const auto& vertex_indices = mesh_faces[face_index].vertex_indices;
+      const auto& vertex_0 = mesh_vertices[vertex_indices[0]];
+      const auto& vertex_1 = mesh_vertices[vertex_indices[1]];
+      const auto& vertex_2 = mesh_vertices[vertex_indices[2]];
+      const Vector3f edge_1 = vertex_1.vertex - vertex_0.vertex;
+      const Vector3f edge_2 = vertex_2.vertex - vertex_0.vertex;
+
+      // The cross product's length is twice the face's area.
+      const Vector3f face_normal = edge_1.Cross(edge_2);
+      face_normals[face_index] = (weighting == NormalWeighting::AREA) ?
+          face_normal : face_normal.NormalizedCopy();
+
+      if (compute_tangents) {
+        const Vector2f uv_1 = vertex_1.uv - vertex_0.uv;
+        const Vector2f uv_2 = vertex_2.uv - vertex_0.uv;
+        const float determinant = uv_1.x() * uv_2.y() - uv_2.x() * uv_1.y();
+        if (determinant != 0.f) {
+          const float inverse = 1.f / determinant;
+          face_u_directions[face_index] =
+              (edge_1 * uv_2.y() - edge_2 * uv_1.y()) * inverse;
+          face_v_directions[face_index] =
+              (edge_2 * uv_1.x() - edge_1 * uv_2.x()) * inverse;
+        } else {
+          face_u_directions[face_index] = Vector3f::Zero();
+          face_v_directions[face_index] = Vector3f::Zero();
+        }
+      }
+    }
+  });
+
+  // Each vertex gathers from its own faces, so no two threads write the same
+  // vertex.
+  if (compute_tangents) {
+    tangents->resize(mesh_vertices.size());
+  }
+  ParallelFor(mesh_vertices.size(), max_threads, job_system,
+              [&](const std::size_t begin, const std::size_t end) {
+    for (std::size_t index = begin; index < end; ++index) {
+      const auto vertex_index = static_cast<Mesh::VertexIndex>(index);
+      Vector3f vertex_normal = Vector3f::Zero();
+      Vector3f u_direction = Vector3f::Zero();
+      Vector3f v_direction = Vector3f::Zero();
+      for (const Mesh::FaceIndex face_index :
+               mesh->vertex_faces(vertex_index)) {
+        if (weighting == NormalWeighting::ANGLE) {
+          const auto& vertex_indices = mesh_faces[face_index].vertex_indices;
+          int corner = 0;
+          while (vertex_indices[corner] != vertex_index) {
+            ++corner;
+          }
+          const Vector3f& corner_vertex = mesh_vertices[vertex_index].vertex;
+          const float angle = CornerAngle(
+              mesh_vertices[vertex_indices[(corner + 1) % 3]].vertex -
+                  corner_vertex,
+              mesh_vertices[vertex_indices[(corner + 2) % 3]].vertex -
+                  corner_vertex);
+          vertex_normal += face_normals[face_index] * angle;
+        } else {
+          vertex_normal += face_normals[face_index];
+        }
+        if (compute_tangents) {
+          u_direction += face_u_directions[face_index];
+          v_direction += face_v_directions[face_index];
+        }
+      }
+      vertex_normal.NormalizeInPlace();
+      mesh_vertices[vertex_index].vertex_normal = vertex_normal;
+
+      if (compute_tangents) {
+        // Gram-Schmidt orthogonalize against the normal.
+        Vector3f tangent =
+            u_direction - vertex_normal * vertex_normal.Dot(u_direction);
+        tangent.NormalizeInPlace();
+        const float handedness =
+            (vertex_normal.Cross(tangent).Dot(v_direction) < 0.f) ? -1.f : 1.f;
+        (*tangents)[vertex_index] = {tangent.x(), tangent.y(), tangent.z(),
+                                     handedness};
+      }
+    }
+  });
+}
+
+void MeshProcessing::OptimizeVertexCache(Mesh* mesh) {
+  if (!mesh->has_adjacency()) {
+    mesh->BuildAdjacency();
+  }
+  const auto& mesh_faces = mesh->mesh_faces_;
+  const std::size_t num_vertices = mesh->mesh_vertices_.size();
+  const std::size_t num_faces = mesh_faces.size();
+
+  // Precompute scores for every cache position and common valence.
+  float cache_scores[kOptimizedCacheSize + 1][kMaxScoredValence + 1];
+  for (int position = -1; position < kOptimizedCacheSize; ++position) {
+    for (std::uint32_t valence = 0; valence <= kMaxScoredValence; ++valence) {
+      cache_scores[position + 1][valence] =
+          ForsythVertexScore(position, valence);
+    }
+  }
+  auto vertex_score = [&cache_scores](const int position,
+                                      const std::uint32_t valence) {
+    return (valence <= kMaxScoredValence) ?
+        cache_scores[position + 1][valence] :
+        ForsythVertexScore(position, valence);
+  };
+
+  stl_vector<std::uint32_t> remaining_valences(num_vertices);
+  stl_vector<int> cache_positions(num_vertices, -1);
+  stl_vector<float> vertex_scores(num_vertices);
+  for (Mesh::VertexIndex index = 0; index < num_vertices; ++index) {
+    remaining_valences[index] =
+        static_cast<std::uint32_t>(mesh->vertex_faces(index).size());
+    vertex_scores[index] = vertex_score(-1, remaining_valences[index]);
+  }
+
+  stl_vector<bool> faces_emitted(num_faces, false);
+  Mesh::FaceIndex best_face = Mesh::kInvalidIndex;
+  float best_score = -1.f;
+  for (Mesh::FaceIndex face_index = 0; face_index < num_faces; ++face_index) {
+    float score = 0.f;
+    for (const Mesh::VertexIndex index :
+             mesh_faces[face_index].vertex_indices) {
+      score += vertex_scores[index];
+    }
+    if (score > best_score) {
+      best_score = score;
+      best_face = face_index;
+    }
+  }
+
+  // Cache holds up to kVerticesPerFace extra entries while being updated.
+  stl_vector<Mesh::VertexIndex> cache, new_cache;
+  cache.reserve(kOptimizedCacheSize + Mesh::kVerticesPerFace);
+  new_cache.reserve(kOptimizedCacheSize + Mesh::kVerticesPerFace);
+  stl_vector<Mesh::MeshFace> new_faces;
+  new_faces.reserve(num_faces);
+  Mesh::FaceIndex next_unemitted_face = 0;
+  while (new_faces.size() < num_faces) {
+    if (best_face == Mesh::kInvalidIndex) {
+      // Nothing in the cache leads anywhere; restart from the first face not
+      // yet emitted.
+      while (faces_emitted[next_unemitted_face]) {
+        ++next_unemitted_face;
+      }
+      best_face = next_unemitted_face;
+    }
+
+    const Mesh::MeshFace& face = mesh_faces[best_face];
+    new_faces.emplace_back(face);
+    faces_emitted[best_face] = true;
+
+    // Move the face's vertices to the front of the cache.
+    new_cache.clear();
+    for (const Mesh::VertexIndex index : face.vertex_indices) {
+      --remaining_valences[index];
+      if (std::find(new_cache.begin(), new_cache.end(), index) ==
+          new_cache.end()) {
+        new_cache.push_back(index);
+      }
+    }
+    for (const Mesh::VertexIndex index : cache) {
+      if (std::find(new_cache.begin(), new_cache.end(), index) ==
+          new_cache.end()) {
+        new_cache.push_back(index);
+      }
+    }
+
+    // Rescore vertices in or just evicted from the cache.
+    for (std::size_t position = 0; position < new_cache.size(); ++position) {
+      const Mesh::VertexIndex index = new_cache[position];
+      cache_positions[index] = (position < kOptimizedCacheSize) ?
+          static_cast<int>(position) : -1;
+      vertex_scores[index] =
+          vertex_score(cache_positions[index], remaining_valences[index]);
+    }
+
+    // Rescore their faces, picking the best as the next face to emit.
+    best_face = Mesh::kInvalidIndex;
+    best_score = -1.f;
+    for (const Mesh::VertexIndex index : new_cache) {
+      for (const Mesh::FaceIndex face_index : mesh->vertex_faces(index)) {
+        if (faces_emitted[face_index]) {
+          continue;
+        }
+        float score = 0.f;
+        for (const Mesh::VertexIndex face_vertex :
+                 mesh_faces[face_index].vertex_indices) {
+          score += vertex_scores[face_vertex];
+        }
+        if (score > best_score) {
+          best_score = score;
+          best_face = face_index;
+        }
+      }
+    }
+
+    if (new_cache.size() > kOptimizedCacheSize) {
+      new_cache.resize(kOptimizedCacheSize);
+    }
+    cache.swap(new_cache);
+  }
+
+  // Number vertices in order of first use.
+  stl_vector<Mesh::VertexIndex> new_indices(num_vertices, Mesh::kInvalidIndex);
+  stl_vector<Mesh::MeshVertex> new_vertices;
+  new_vertices.reserve(num_vertices);
+  for (auto& new_face : new_faces) {
+    for (Mesh::VertexIndex& index : new_face.vertex_indices) {
+      if (new_indices[index] == Mesh::kInvalidIndex) {
+        new_indices[index] =
+            static_cast<Mesh::VertexIndex>(new_vertices.size());
+        new_vertices.emplace_back(mesh->mesh_vertices_[index]);
+      }
+      index = new_indices[index];
+    }
+  }
+  for (Mesh::VertexIndex index = 0; index < num_vertices; ++index) {
+    if (new_indices[index] == Mesh::kInvalidIndex) {
+      new_vertices.emplace_back(mesh->mesh_vertices_[index]);
+    }
   }
+
+  mesh->mesh_vertices_.swap(new_vertices);
+  mesh->mesh_faces_.swap(new_faces);
+  mesh->BuildAdjacency();
 }
 
 }  // namespace ogle
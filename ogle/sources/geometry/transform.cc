@@ -6,7 +6,9 @@
 #include "geometry/transform.h"
 #include <algorithm>
 #include "easylogging++.h"  // NOLINT
+#include "geometry/aabb_tree.h"
 #include "geometry/transformation_matrix.h"
+#include "memory/object_pool.h"
 
 namespace ogle {
 
@@ -14,15 +16,48 @@ const Vector3f Transform::kFrontAxis = {1.f, 0.f, 0.f};
 const Vector3f Transform::kRightAxis = {0.f, 0.f, 1.f};
 const Vector3f Transform::kUpAxis = {0.f, 1.f, 0.f};
 
+namespace {
+
+/**
+ * @brief Gets the pools that standalone transforms are allocated from.
+ *
+ * Never destroyed, so that objects may be freed during static destruction.
+ *
+ * @return Pools.
+ */
+ObjectPoolSet& TransformPools() {
+  static ObjectPoolSet* pools =
+      AllocateObject<ObjectPoolSet>("transform", sizeof(Transform), true);
+  return *pools;
+}
+
+}  // namespace
+
+void* Transform::operator new(std::size_t size) {
+  MemoryScope memory_scope(MemoryTag::ENTITY);
+  return TransformPools().Allocate(size);
+}
+
+void Transform::operator delete(void* memory, std::size_t size) {
+  TransformPools().Free(memory, size);
+}
+
 Transform::Transform(Transform *parent, Entity *entity)
   : world_position_{0.f, 0.f, 0.f}, world_orientation_{}, parent_(parent),
-    entity_(entity) {
+    entity_(entity), has_object_(false), local_bounds_(nullptr),
+    object_bounds_(Bounds::Empty()), subtree_bounds_(Bounds::Empty()),
+    subtree_unbounded_(false), subtree_num_bounded_(0),
+    object_bounds_dirty_(false), subtree_bounds_dirty_(false),
+    spatial_index_((parent != nullptr) ? parent->spatial_index_ : nullptr),
+    spatial_proxy_(AABBTree::kNullNode), spatial_moved_index_(-1) {
   if (parent_ != nullptr) {
     parent_->children_.push_back(this);
+    parent_->MarkBoundsDirty();
   }
 }
 
 Transform::~Transform() {
+  RemoveSpatialProxy();
   if (parent_ != nullptr) {
     auto it = std::find(parent_->children_.begin(), parent_->children_.end(),
                         this);
@@ -31,6 +66,7 @@ Transform::~Transform() {
     } else {
       parent_->children_.erase(it);
     }
+    parent_->MarkBoundsDirty();
   }
   for (Transform* child_transform : children_) {
     child_transform->parent_ = parent_;
@@ -39,6 +75,7 @@ Transform::~Transform() {
 
 void Transform::set_world_position(const Vector3f& new_position) {
   world_position_ = new_position;
+  MarkBoundsDirty();
 }
 
 const Vector3f& Transform::world_position() const {
@@ -47,6 +84,7 @@ const Vector3f& Transform::world_position() const {
 
 void Transform::set_world_orientation(const Quaternionf& new_orientation) {
   world_orientation_ = new_orientation;
+  MarkBoundsDirty();
 }
 
 void Transform::set_world_orientation(const Angle yaw, const Angle pitch,
@@ -87,29 +125,35 @@ Entity* Transform::entity() {
 
 void Transform::TranslateForward(const float delta) {
   world_position_ += world_front() * delta;
+  MarkBoundsDirty();
 }
 
 void Transform::TranslateRight(const float delta) {
   world_position_ += world_right() * delta;
+  MarkBoundsDirty();
 }
 
 void Transform::TranslateUp(const float delta) {
   world_position_ += world_up() * delta;
+  MarkBoundsDirty();
 }
 
 void Transform::RotateYaw(const Angle yaw) {
   world_orientation_ = Quaternionf(world_up(), yaw) * world_orientation_;
   world_orientation_.NormalizeInPlace();
+  MarkBoundsDirty();
 }
 
 void Transform::RotatePitch(const Angle pitch) {
   world_orientation_ = Quaternionf(world_right(), pitch) * world_orientation_;
   world_orientation_.NormalizeInPlace();
+  MarkBoundsDirty();
 }
 
 void Transform::RotateRoll(const Angle roll) {
   world_orientation_ = Quaternionf(world_front(), roll) * world_orientation_;
   world_orientation_.NormalizeInPlace();
+  MarkBoundsDirty();
 }
 
 const Matrix33f Transform::RotationMatrix3D() const {
@@ -121,4 +165,108 @@ const Matrix44f Transform::TransformationMatrix3D() const {
       TransformationMatrix::TranslationMatrix3D(world_position_);
 }
 
+const Bounds Transform::WorldBounds(const Bounds& local_bounds) const {
+  return local_bounds.Transformed(TransformationMatrix3D());
+}
+
+void Transform::set_local_bounds(const Bounds* local_bounds) {
+  has_object_ = true;
+  local_bounds_ = local_bounds;
+  MarkBoundsDirty();
+  UpdateSpatialProxy();
+}
+
+void Transform::RefitBounds() {
+  if (!subtree_bounds_dirty_) {
+    return;
+  }
+  if (object_bounds_dirty_) {
+    object_bounds_ = (local_bounds_ != nullptr) ? WorldBounds(*local_bounds_)
+                                                : Bounds::Empty();
+    object_bounds_dirty_ = false;
+  }
+  subtree_bounds_ = object_bounds_;
+  subtree_unbounded_ = has_object_ && local_bounds_ == nullptr;
+  subtree_num_bounded_ = has_object_bounds() ? 1 : 0;
+  for (Transform* child_transform : children_) {
+    child_transform->RefitBounds();
+    subtree_bounds_.Include(child_transform->subtree_bounds_);
+    subtree_unbounded_ |= child_transform->subtree_unbounded_;
+    subtree_num_bounded_ += child_transform->subtree_num_bounded_;
+  }
+  subtree_bounds_dirty_ = false;
+}
+
+void Transform::set_spatial_index(AABBTree* spatial_index) {
+  RemoveSpatialProxy();
+  spatial_index_ = spatial_index;
+  UpdateSpatialProxy();
+  for (Transform* child_transform : children_) {
+    child_transform->set_spatial_index(spatial_index);
+  }
+}
+
+const std::int32_t Transform::spatial_proxy() const { return spatial_proxy_; }
+
+const bool Transform::has_object_bounds() const {
+  return local_bounds_ != nullptr;
+}
+
+const Bounds& Transform::object_bounds() const { return object_bounds_; }
+
+const Bounds& Transform::subtree_bounds() const { return subtree_bounds_; }
+
+const bool Transform::subtree_unbounded() const { return subtree_unbounded_; }
+
+const size_t Transform::subtree_num_bounded() const {
+  return subtree_num_bounded_;
+}
+
+void Transform::MarkBoundsDirty() {
+  object_bounds_dirty_ = true;
+  if (spatial_proxy_ != AABBTree::kNullNode && spatial_moved_index_ < 0) {
+    auto& moved_transforms = spatial_index_->moved_transforms_;
+    spatial_moved_index_ = static_cast<std::int32_t>(moved_transforms.size());
+    moved_transforms.push_back(this);
+  }
+
+  // Ancestors of a dirty Transform are already dirty.
+  for (Transform* transform = this;
+       transform != nullptr && !transform->subtree_bounds_dirty_;
+       transform = transform->parent_) {
+    transform->subtree_bounds_dirty_ = true;
+  }
+}
+
+void Transform::UpdateSpatialProxy() {
+  if (spatial_index_ == nullptr || local_bounds_ == nullptr) {
+    RemoveSpatialProxy();
+    return;
+  }
+  const AxisAlignedBox box =
+      local_bounds_->box.Transformed(TransformationMatrix3D());
+  if (spatial_proxy_ == AABBTree::kNullNode) {
+    spatial_proxy_ = spatial_index_->Insert(box, this);
+  } else {
+    spatial_index_->Move(spatial_proxy_, box);
+  }
+}
+
+void Transform::RemoveSpatialProxy() {
+  if (spatial_moved_index_ >= 0) {
+    // Swap the last queued Transform into this one's place, so that
+    // removing many moved Transforms takes linear time.
+    auto& moved_transforms = spatial_index_->moved_transforms_;
+    Transform* last = moved_transforms.back();
+    moved_transforms[spatial_moved_index_] = last;
+    last->spatial_moved_index_ = spatial_moved_index_;
+    moved_transforms.pop_back();
+    spatial_moved_index_ = -1;
+  }
+  if (spatial_proxy_ != AABBTree::kNullNode) {
+    spatial_index_->Remove(spatial_proxy_);
+    spatial_proxy_ = AABBTree::kNullNode;
+  }
+}
+
 }  // namespace ogle
@@ -49,6 +49,28 @@ const Matrix33f TransformationMatrix::RotationMatrixZ3D(const Angle theta_z) {
           0.f, 0.f, 1.f};
 }
 
+const Matrix33f TransformationMatrix::NormalMatrix3D(
+    const Matrix44f& transformation) {
+  const Matrix44f& a = transformation;
+  const Matrix33f cofactors = {
+      a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1),
+      a(1, 2) * a(2, 0) - a(1, 0) * a(2, 2),
+      a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0),
+      a(0, 2) * a(2, 1) - a(0, 1) * a(2, 2),
+      a(0, 0) * a(2, 2) - a(0, 2) * a(2, 0),
+      a(0, 1) * a(2, 0) - a(0, 0) * a(2, 1),
+      a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1),
+      a(0, 2) * a(1, 0) - a(0, 0) * a(1, 2),
+      a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0)};
+
+  // Cofactors equal the inverse transpose times the determinant. Keep
+  // normals facing the same way when the determinant is negative.
+  const float determinant = a(0, 0) * cofactors(0, 0) +
+                            a(0, 1) * cofactors(0, 1) +
+                            a(0, 2) * cofactors(0, 2);
+  return determinant < 0.f ? cofactors * -1.f : cofactors;
+}
+
 const Matrix44f TransformationMatrix::ViewMatrix3D(
     const Vector3f& camera_position, const Vector3f& forward_vector,
     const Vector3f& up_vector) {
@@ -0,0 +1,599 @@
+/**
+ * @file triangle_bvh.cc
+ * @brief Implements triangle_bvh.h.
+ */
+
+#include "geometry/triangle_bvh.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "easylogging++.h"  // NOLINT
+#include "jobs/job_system.h"
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace ogle {
+
+constexpr int TriangleBVH::kPacketSize;
+constexpr int TriangleBVH::kMaxDepth;
+
+namespace {
+
+/// Number of bins that centroids are sorted into to find splits.
+constexpr int kNumBins = 16;
+
+/// Most triangles in a leaf.
+constexpr std::uint32_t kMaxLeafTriangles = 8;
+
+/// Cost of visiting a node, relative to testing a triangle.
+constexpr float kTraversalCost = 1.f;
+
+/// Depth past which nodes are split at the median, so that no leaf is
+/// deeper than the traversal stack allows.
+constexpr int kMedianSplitDepth = 32;
+
+/// Fewest triangles worth building a subtree in its own job.
+constexpr std::uint32_t kMinTrianglesPerJob = 1 << 15;
+
+/**
+ * @brief Box used in the inner loops of building, where the calls through
+ *        AxisAlignedBox and its Vector3f checks dominate.
+ */
+struct BuildBox {
+  float min[3] = {std::numeric_limits<float>::infinity(),
+                  std::numeric_limits<float>::infinity(),
+                  std::numeric_limits<float>::infinity()};
+  float max[3] = {-std::numeric_limits<float>::infinity(),
+                  -std::numeric_limits<float>::infinity(),
+                  -std::numeric_limits<float>::infinity()};
+
+  /**
+   * @brief Grows the box to contain another box.
+   * @param box Box to include.
+   */
+  void Include(const BuildBox& box) {
+    for (int axis = 0; axis < 3; ++axis) {
+      min[axis] = std::min(min[axis], box.min[axis]);
+      max[axis] = std::max(max[axis], box.max[axis]);
+    }
+  }
+
+  /**
+   * @brief Computes the total area of the box's faces.
+   */
+  float SurfaceArea() const {
+    const float x = max[0] - min[0];
+    const float y = max[1] - min[1];
+    const float z = max[2] - min[2];
+    return 2.f * (x * y + y * z + z * x);
+  }
+};
+
+/**
+ * @brief Triangle count and bounds of the triangles whose centroids fall in
+ *        a bin.
+ */
+struct Bin {
+  BuildBox box;
+  std::uint32_t num_triangles = 0;
+};
+
+/**
+ * @brief Computes the bin that a centroid falls into.
+ * @param centroid Coordinate of centroid along split axis.
+ * @param min Smallest centroid coordinate.
+ * @param scale Bins per unit along split axis.
+ * @return Bin index.
+ */
+int BinIndex(const float centroid, const float min, const float scale) {
+  return std::min(kNumBins - 1, static_cast<int>((centroid - min) * scale));
+}
+
+/**
+ * @brief Precomputes ray values used by slab tests.
+ * @param ray Ray to cast.
+ * @return Reciprocal of each direction component.
+ */
+const Vector3f InverseDirection(const Ray<float, 3>& ray) {
+  Vector3f inverse_direction;
+  for (VectorIndex axis = 0; axis < 3; ++axis) {
+    inverse_direction(axis) = 1.f / ray.direction_(axis);
+  }
+  return inverse_direction;
+}
+
+/**
+ * @brief Tests a ray against a box, as between the distances at which the
+ *        ray crosses each pair of faces.
+ *
+ * A ray parallel to an axis that starts on a face perpendicular to it gives
+ * 0 * infinity, a NaN distance. It lies within that pair of faces, so the
+ * axis is skipped. ClosestHitPacket() treats NaN the same way.
+ *
+ * @param box Box to test.
+ * @param ray Ray to test.
+ * @param inverse_direction Reciprocal of ray direction.
+ * @param max_distance Distance along the ray to search.
+ * @return true if the ray hits the box within max_distance.
+ */
+const bool IntersectBox(const AxisAlignedBox& box, const Ray<float, 3>& ray,
+                        const Vector3f& inverse_direction,
+                        const float max_distance) {
+  float near = 0.f;
+  float far = max_distance;
+  for (VectorIndex axis = 0; axis < 3; ++axis) {
+    float t1 = (box.min(axis) - ray.origin_(axis)) * inverse_direction(axis);
+    float t2 = (box.max(axis) - ray.origin_(axis)) * inverse_direction(axis);
+    if (std::isnan(t1) || std::isnan(t2)) {
+      continue;
+    }
+    if (t1 > t2) {
+      std::swap(t1, t2);
+    }
+    near = std::max(near, t1);
+    far = std::min(far, t2);
+  }
+  return near <= far;
+}
+
+}  // namespace
+
+struct TriangleBVH::BuildData {
+  /// Bounds of each triangle, by face.
+  stl_vector<BuildBox> boxes;
+
+  /// Center of each triangle's box, by face. A box of just one point.
+  stl_vector<BuildBox> centroids;
+};
+
+TriangleBVH::TriangleBVH(const Mesh& mesh, JobSystem* job_system) {
+  const auto& mesh_vertices = mesh.mesh_vertices();
+  const auto& mesh_faces = mesh.mesh_faces();
+  const auto num_faces = static_cast<std::uint32_t>(mesh_faces.size());
+  if (num_faces == 0) {
+    return;
+  }
+
+  BuildData build_data;
+  build_data.boxes.resize(num_faces);
+  build_data.centroids.resize(num_faces);
+  faces_.resize(num_faces);
+  for (Mesh::FaceIndex face = 0; face < num_faces; ++face) {
+    BuildBox& box = build_data.boxes[face];
+    for (const auto vertex_index : mesh_faces[face].vertex_indices) {
+      const float* vertex = mesh_vertices[vertex_index].vertex.data();
+      for (int axis = 0; axis < 3; ++axis) {
+        box.min[axis] = std::min(box.min[axis], vertex[axis]);
+        box.max[axis] = std::max(box.max[axis], vertex[axis]);
+      }
+    }
+    BuildBox& centroid = build_data.centroids[face];
+    for (int axis = 0; axis < 3; ++axis) {
+      centroid.min[axis] = (box.min[axis] + box.max[axis]) * .5f;
+      centroid.max[axis] = centroid.min[axis];
+    }
+    faces_[face] = face;
+  }
+
+  nodes_.reserve(2 * num_faces / kMaxLeafTriangles + 1);
+  BuildSubtree(build_data, 0, num_faces, 0, job_system, &nodes_);
+
+  triangles_.resize(num_faces);
+  for (std::uint32_t index = 0; index < num_faces; ++index) {
+    const auto& vertex_indices = mesh_faces[faces_[index]].vertex_indices;
+    const Vector3f& vertex0 = mesh_vertices[vertex_indices[0]].vertex;
+    triangles_[index] = {vertex0,
+                         mesh_vertices[vertex_indices[1]].vertex - vertex0,
+                         mesh_vertices[vertex_indices[2]].vertex - vertex0};
+  }
+}
+
+const bool TriangleBVH::ClosestHit(const Ray<float, 3>& ray,
+                                   const float max_distance, Hit* hit) const {
+  return Trace(ray, max_distance, false, hit);
+}
+
+const bool TriangleBVH::AnyHit(const Ray<float, 3>& ray,
+                               const float max_distance) const {
+  Hit hit;
+  return Trace(ray, max_distance, true, &hit);
+}
+
+int TriangleBVH::ClosestHitPacket(const Ray<float, 3>* rays,
+                                  const float max_distance, Hit* hits) const {
+#ifdef __SSE__
+  for (int lane = 0; lane < kPacketSize; ++lane) {
+    hits[lane] = {max_distance, Mesh::kInvalidIndex, 0.f, 0.f};
+  }
+  if (nodes_.empty()) {
+    return 0;
+  }
+
+  // Rays are stored one coordinate per register, one ray per lane.
+  __m128 origin[3];
+  __m128 direction[3];
+  __m128 inverse_direction[3];
+  for (VectorIndex axis = 0; axis < 3; ++axis) {
+    origin[axis] = _mm_setr_ps(rays[0].origin_(axis), rays[1].origin_(axis),
+                               rays[2].origin_(axis), rays[3].origin_(axis));
+    direction[axis] = _mm_setr_ps(
+        rays[0].direction_(axis), rays[1].direction_(axis),
+        rays[2].direction_(axis), rays[3].direction_(axis));
+    inverse_direction[axis] = _mm_div_ps(_mm_set1_ps(1.f), direction[axis]);
+  }
+  __m128 best = _mm_set1_ps(max_distance);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.f);
+
+  // Children are visited in the order the first ray meets them.
+  std::uint32_t stack[kMaxDepth];
+  int stack_size = 0;
+  std::uint32_t index = 0;
+  while (true) {
+    const Node& node = nodes_[index];
+    __m128 near = zero;
+    __m128 far = best;
+    for (VectorIndex axis = 0; axis < 3; ++axis) {
+      const __m128 t1 = _mm_mul_ps(
+          _mm_sub_ps(_mm_set1_ps(node.box.min(axis)), origin[axis]),
+          inverse_direction[axis]);
+      const __m128 t2 = _mm_mul_ps(
+          _mm_sub_ps(_mm_set1_ps(node.box.max(axis)), origin[axis]),
+          inverse_direction[axis]);
+      // Lanes with a NaN distance are left unclipped, as by IntersectBox().
+      // _mm_min_ps and _mm_max_ps return their second operand when either is
+      // NaN, and an all-ones mask is a NaN.
+      const __m128 parallel = _mm_cmpunord_ps(t1, t2);
+      near = _mm_max_ps(_mm_andnot_ps(parallel, _mm_min_ps(t1, t2)), near);
+      far = _mm_min_ps(_mm_or_ps(parallel, _mm_max_ps(t1, t2)), far);
+    }
+    if (_mm_movemask_ps(_mm_cmple_ps(near, far)) != 0) {
+      if (node.num_triangles == 0) {
+        std::uint32_t near_child = index + 1;
+        std::uint32_t far_child = node.offset;
+        if (rays[0].direction_(node.axis) < 0.f) {
+          std::swap(near_child, far_child);
+        }
+        stack[stack_size++] = far_child;
+        index = near_child;
+        continue;
+      }
+
+      // Moller-Trumbore, one triangle against all rays.
+      for (std::uint32_t triangle_index = node.offset;
+           triangle_index < node.offset + node.num_triangles;
+           ++triangle_index) {
+        const Triangle& triangle = triangles_[triangle_index];
+        __m128 edge1[3];
+        __m128 edge2[3];
+        __m128 to_origin[3];
+        for (VectorIndex axis = 0; axis < 3; ++axis) {
+          edge1[axis] = _mm_set1_ps(triangle.edge1(axis));
+          edge2[axis] = _mm_set1_ps(triangle.edge2(axis));
+          to_origin[axis] = _mm_sub_ps(
+              origin[axis], _mm_set1_ps(triangle.vertex0(axis)));
+        }
+        auto cross = [](const __m128* a, const __m128* b, __m128* result) {
+          result[0] = _mm_sub_ps(_mm_mul_ps(a[1], b[2]),
+                                 _mm_mul_ps(a[2], b[1]));
+          result[1] = _mm_sub_ps(_mm_mul_ps(a[2], b[0]),
+                                 _mm_mul_ps(a[0], b[2]));
+          result[2] = _mm_sub_ps(_mm_mul_ps(a[0], b[1]),
+                                 _mm_mul_ps(a[1], b[0]));
+        };
+        auto dot = [](const __m128* a, const __m128* b) -> __m128 {
+          return _mm_add_ps(
+              _mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])),
+              _mm_mul_ps(a[2], b[2]));
+        };
+        __m128 p[3];
+        __m128 q[3];
+        cross(direction, edge2, p);
+        const __m128 determinant = dot(edge1, p);
+        const __m128 inverse_determinant = _mm_div_ps(one, determinant);
+        cross(to_origin, edge1, q);
+        const __m128 u = _mm_mul_ps(dot(to_origin, p), inverse_determinant);
+        const __m128 v = _mm_mul_ps(dot(direction, q), inverse_determinant);
+        const __m128 t = _mm_mul_ps(dot(edge2, q), inverse_determinant);
+        const __m128 hit_mask = _mm_and_ps(
+            _mm_and_ps(_mm_and_ps(_mm_cmpneq_ps(determinant, zero),
+                                  _mm_cmpge_ps(u, zero)),
+                       _mm_and_ps(_mm_cmple_ps(u, one),
+                                  _mm_cmpge_ps(v, zero))),
+            _mm_and_ps(_mm_cmple_ps(_mm_add_ps(u, v), one),
+                       _mm_and_ps(_mm_cmpge_ps(t, zero),
+                                  _mm_cmplt_ps(t, best))));
+        const int mask = _mm_movemask_ps(hit_mask);
+        if (mask == 0) {
+          continue;
+        }
+        best = _mm_or_ps(_mm_and_ps(hit_mask, t),
+                         _mm_andnot_ps(hit_mask, best));
+        float lane_t[kPacketSize];
+        float lane_u[kPacketSize];
+        float lane_v[kPacketSize];
+        _mm_storeu_ps(lane_t, t);
+        _mm_storeu_ps(lane_u, u);
+        _mm_storeu_ps(lane_v, v);
+        for (int lane = 0; lane < kPacketSize; ++lane) {
+          if ((mask >> lane) & 1) {
+            hits[lane] = {lane_t[lane], faces_[triangle_index], lane_u[lane],
+                          lane_v[lane]};
+          }
+        }
+      }
+    }
+    if (stack_size == 0) {
+      break;
+    }
+    index = stack[--stack_size];
+  }
+#else
+  for (int lane = 0; lane < kPacketSize; ++lane) {
+    ClosestHit(rays[lane], max_distance, &hits[lane]);
+  }
+#endif
+
+  int num_hits = 0;
+  for (int lane = 0; lane < kPacketSize; ++lane) {
+    num_hits += (hits[lane].face != Mesh::kInvalidIndex) ? 1 : 0;
+  }
+  return num_hits;
+}
+
+const bool TriangleBVH::ClosestHitBruteForce(const Mesh& mesh,
+                                             const Ray<float, 3>& ray,
+                                             const float max_distance,
+                                             Hit* hit) {
+  const auto& mesh_vertices = mesh.mesh_vertices();
+  const auto& mesh_faces = mesh.mesh_faces();
+  *hit = {max_distance, Mesh::kInvalidIndex, 0.f, 0.f};
+  for (Mesh::FaceIndex face = 0; face < mesh_faces.size(); ++face) {
+    const auto& vertex_indices = mesh_faces[face].vertex_indices;
+    const Vector3f& vertex0 = mesh_vertices[vertex_indices[0]].vertex;
+    const Triangle triangle = {
+        vertex0, mesh_vertices[vertex_indices[1]].vertex - vertex0,
+        mesh_vertices[vertex_indices[2]].vertex - vertex0};
+    if (IntersectTriangle(triangle, ray, hit->distance, hit)) {
+      hit->face = face;
+    }
+  }
+  return hit->face != Mesh::kInvalidIndex;
+}
+
+const AxisAlignedBox& TriangleBVH::box() const {
+  static const AxisAlignedBox empty_box = AxisAlignedBox::Empty();
+  return nodes_.empty() ? empty_box : nodes_[0].box;
+}
+
+size_t TriangleBVH::num_nodes() const { return nodes_.size(); }
+
+void TriangleBVH::BuildSubtree(const BuildData& build_data,
+                               const std::uint32_t begin,
+                               const std::uint32_t end, const int depth,
+                               JobSystem* job_system,
+                               stl_vector<Node>* nodes) {
+  const auto index = static_cast<std::uint32_t>(nodes->size());
+  nodes->emplace_back();
+  BuildBox box;
+  BuildBox centroid_box;
+  for (std::uint32_t position = begin; position < end; ++position) {
+    box.Include(build_data.boxes[faces_[position]]);
+    centroid_box.Include(build_data.centroids[faces_[position]]);
+  }
+  (*nodes)[index].box = {{box.min[0], box.min[1], box.min[2]},
+                         {box.max[0], box.max[1], box.max[2]}};
+  const std::uint32_t num_triangles = end - begin;
+  auto make_leaf = [nodes, index, begin, num_triangles]() {
+    (*nodes)[index].offset = begin;
+    (*nodes)[index].num_triangles =
+        static_cast<std::uint16_t>(num_triangles);
+    (*nodes)[index].axis = 0;
+  };
+  if (num_triangles == 1) {
+    make_leaf();
+    return;
+  }
+
+  // Find the split between bins with least cost, estimated as the number of
+  // triangles on each side weighted by the chance that a ray hitting this
+  // node hits that side's box.
+  int best_axis = -1;
+  int best_split = 0;
+  float best_cost = std::numeric_limits<float>::infinity();
+  if (depth < kMedianSplitDepth) {
+    for (VectorIndex axis = 0; axis < 3; ++axis) {
+      const float min = centroid_box.min[axis];
+      const float extent = centroid_box.max[axis] - min;
+      if (!(extent > 0.f)) {
+        continue;
+      }
+      const float scale = kNumBins / extent;
+      Bin bins[kNumBins];
+      for (std::uint32_t position = begin; position < end; ++position) {
+        const Mesh::FaceIndex face = faces_[position];
+        Bin& bin =
+            bins[BinIndex(build_data.centroids[face].min[axis], min, scale)];
+        bin.box.Include(build_data.boxes[face]);
+        ++bin.num_triangles;
+      }
+
+      // Sweep from the left, then from the right, accumulating costs of
+      // the left and right sides of each split.
+      float left_costs[kNumBins - 1];
+      BuildBox side_box;
+      std::uint32_t side_count = 0;
+      for (int split = 0; split < kNumBins - 1; ++split) {
+        side_box.Include(bins[split].box);
+        side_count += bins[split].num_triangles;
+        left_costs[split] = (side_count == 0) ?
+            std::numeric_limits<float>::infinity() :
+            side_box.SurfaceArea() * side_count;
+      }
+      side_box = BuildBox();
+      side_count = 0;
+      for (int split = kNumBins - 1; split > 0; --split) {
+        side_box.Include(bins[split].box);
+        side_count += bins[split].num_triangles;
+        if (side_count == 0) {
+          continue;
+        }
+        const float cost =
+            left_costs[split - 1] + side_box.SurfaceArea() * side_count;
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_axis = static_cast<int>(axis);
+          best_split = split;
+        }
+      }
+    }
+    const float area = box.SurfaceArea();
+    if (num_triangles <= kMaxLeafTriangles &&
+        (best_axis < 0 ||
+         area * num_triangles <= kTraversalCost * area + best_cost)) {
+      make_leaf();
+      return;
+    }
+  } else if (num_triangles <= kMaxLeafTriangles) {
+    make_leaf();
+    return;
+  }
+
+  // Partition faces by bin, or at the median centroid along the longest
+  // axis if binning found no split.
+  std::uint32_t middle;
+  if (best_axis >= 0) {
+    const float min = centroid_box.min[best_axis];
+    const float scale = kNumBins / (centroid_box.max[best_axis] - min);
+    middle = static_cast<std::uint32_t>(
+        std::partition(faces_.begin() + begin, faces_.begin() + end,
+                       [&](const Mesh::FaceIndex face) {
+                         return BinIndex(
+                                    build_data.centroids[face].min[best_axis],
+                                    min, scale) < best_split;
+                       }) -
+        faces_.begin());
+  } else {
+    float extents[3];
+    for (int axis = 0; axis < 3; ++axis) {
+      extents[axis] = centroid_box.max[axis] - centroid_box.min[axis];
+    }
+    best_axis = static_cast<int>(
+        std::max_element(extents, extents + 3) - extents);
+    middle = begin + num_triangles / 2;
+    const auto& centroids = build_data.centroids;
+    std::nth_element(faces_.begin() + begin, faces_.begin() + middle,
+                     faces_.begin() + end,
+                     [&](const Mesh::FaceIndex lhs, const Mesh::FaceIndex rhs) {
+                       const float lhs_centroid = centroids[lhs].min[best_axis];
+                       const float rhs_centroid = centroids[rhs].min[best_axis];
+                       return lhs_centroid < rhs_centroid ||
+                              (lhs_centroid == rhs_centroid && lhs < rhs);
+                     });
+  }
+  (*nodes)[index].num_triangles = 0;
+  (*nodes)[index].axis = static_cast<std::uint16_t>(best_axis);
+
+  // The second child of a large subtree is built in a job, into its own
+  // array, then appended with its child offsets moved.
+  if (job_system != nullptr && num_triangles >= kMinTrianglesPerJob) {
+    stl_vector<Node> second_nodes;
+    const JobHandle second_job = job_system->Schedule([&]() {
+      BuildSubtree(build_data, middle, end, depth + 1, job_system,
+                   &second_nodes);
+    });
+    BuildSubtree(build_data, begin, middle, depth + 1, job_system, nodes);
+    job_system->Wait(second_job);
+    const auto second_offset = static_cast<std::uint32_t>(nodes->size());
+    for (Node& node : second_nodes) {
+      if (node.num_triangles == 0) {
+        node.offset += second_offset;
+      }
+    }
+    nodes->insert(nodes->end(), second_nodes.begin(), second_nodes.end());
+    (*nodes)[index].offset = second_offset;
+  } else {
+    BuildSubtree(build_data, begin, middle, depth + 1, nullptr, nodes);
+    (*nodes)[index].offset = static_cast<std::uint32_t>(nodes->size());
+    BuildSubtree(build_data, middle, end, depth + 1, nullptr, nodes);
+  }
+}
+
+const bool TriangleBVH::IntersectTriangle(const Triangle& triangle,
+                                          const Ray<float, 3>& ray,
+                                          const float max_distance,
+                                          Hit* hit) {
+  const Vector3f p = ray.direction_.Cross(triangle.edge2);
+  const float determinant = triangle.edge1.Dot(p);
+  if (determinant == 0.f) {
+    return false;
+  }
+  const float inverse_determinant = 1.f / determinant;
+  const Vector3f to_origin = ray.origin_ - triangle.vertex0;
+  const float u = to_origin.Dot(p) * inverse_determinant;
+  if (!(u >= 0.f && u <= 1.f)) {
+    return false;
+  }
+  const Vector3f q = to_origin.Cross(triangle.edge1);
+  const float v = ray.direction_.Dot(q) * inverse_determinant;
+  if (!(v >= 0.f && u + v <= 1.f)) {
+    return false;
+  }
+  const float t = triangle.edge2.Dot(q) * inverse_determinant;
+  if (!(t >= 0.f && t < max_distance)) {
+    return false;
+  }
+  hit->distance = t;
+  hit->u = u;
+  hit->v = v;
+  return true;
+}
+
+const bool TriangleBVH::Trace(const Ray<float, 3>& ray,
+                              const float max_distance, const bool any_hit,
+                              Hit* hit) const {
+  *hit = {max_distance, Mesh::kInvalidIndex, 0.f, 0.f};
+  if (nodes_.empty()) {
+    return false;
+  }
+  const Vector3f inverse_direction = InverseDirection(ray);
+
+  // Nearer children are visited first, so that hits clip the search early.
+  std::uint32_t stack[kMaxDepth];
+  int stack_size = 0;
+  std::uint32_t index = 0;
+  while (true) {
+    const Node& node = nodes_[index];
+    if (IntersectBox(node.box, ray, inverse_direction, hit->distance)) {
+      if (node.num_triangles == 0) {
+        std::uint32_t near_child = index + 1;
+        std::uint32_t far_child = node.offset;
+        if (ray.direction_(node.axis) < 0.f) {
+          std::swap(near_child, far_child);
+        }
+        stack[stack_size++] = far_child;
+        index = near_child;
+        continue;
+      }
+      for (std::uint32_t triangle_index = node.offset;
+           triangle_index < node.offset + node.num_triangles;
+           ++triangle_index) {
+        if (IntersectTriangle(triangles_[triangle_index], ray, hit->distance,
+                              hit)) {
+          hit->face = faces_[triangle_index];
+          if (any_hit) {
+            return true;
+          }
+        }
+      }
+    }
+    if (stack_size == 0) {
+      break;
+    }
+    index = stack[--stack_size];
+  }
+  return hit->face != Mesh::kInvalidIndex;
+}
+
+}  // namespace ogle
@@ -0,0 +1,58 @@
+/**
+ * @file vertex_cache_simulator.cc
+ * @brief Implements vertex_cache_simulator.h.
+ */
+
+#include "geometry/vertex_cache_simulator.h"
+#include <algorithm>
+#include "easylogging++.h"  // NOLINT
+
+namespace ogle {
+
+VertexCacheSimulator::VertexCacheSimulator(const Policy policy,
+                                           const std::size_t cache_size)
+  : policy_(policy), cache_size_(cache_size) {
+  CHECK(cache_size_ > 0) << "Vertex cache must hold at least one vertex.";
+}
+
+VertexCacheSimulator::Statistics VertexCacheSimulator::Simulate(
+    const Mesh& mesh) const {
+  // Entries are kept from oldest (or least recently used) to newest.
+  stl_vector<Mesh::VertexIndex> cache;
+  cache.reserve(cache_size_ + 1);
+  stl_vector<bool> referenced(mesh.mesh_vertices().size(), false);
+  std::size_t num_referenced = 0;
+
+  Statistics statistics;
+  for (const auto& mesh_face : mesh.mesh_faces()) {
+    for (const Mesh::VertexIndex vertex_index : mesh_face.vertex_indices) {
+      if (!referenced[vertex_index]) {
+        referenced[vertex_index] = true;
+        ++num_referenced;
+      }
+
+      auto entry = std::find(cache.begin(), cache.end(), vertex_index);
+      if (entry != cache.end()) {
+        if (policy_ == Policy::LRU) {
+          std::rotate(entry, entry + 1, cache.end());
+        }
+        continue;
+      }
+
+      ++statistics.num_misses;
+      cache.push_back(vertex_index);
+      if (cache.size() > cache_size_) {
+        cache.erase(cache.begin());
+      }
+    }
+  }
+
+  const std::size_t num_faces = mesh.mesh_faces().size();
+  statistics.acmr = (num_faces != 0) ?
+      static_cast<double>(statistics.num_misses) / num_faces : 0.0;
+  statistics.atvr = (num_referenced != 0) ?
+      static_cast<double>(statistics.num_misses) / num_referenced : 0.0;
+  return statistics;
+}
+
+}  // namespace ogle
@@ -0,0 +1,210 @@
+/**
+ * @file job_system.cc
+ * @brief Implements job_system.h.
+ */
+
+#include "jobs/job_system.h"
+#include "easylogging++.h"  // NOLINT
+
+namespace ogle {
+
+const stl_string JobSystem::kConfigModule = "jobs";
+const stl_string JobSystem::kConfigAttributeWorkerThreads = "worker_threads";
+
+namespace {
+
+/// JobSystem that the calling thread is a worker of, if any.
+thread_local const JobSystem* t_job_system = nullptr;
+
+/// Index of the calling worker thread in t_job_system.
+thread_local int t_worker_index = -1;
+
+}  // namespace
+
+const bool JobHandle::finished() const {
+  return job_ == nullptr || job_->finished.load(std::memory_order_acquire);
+}
+
+JobSystem::JobSystem(const int num_workers)
+  : queues_(AllocateBuffer<JobQueue>(std::max(num_workers, 0) + 1)),
+    num_workers_(std::max(num_workers, 0)), num_queued_(0), num_waiting_(0),
+    stopping_(false) {
+  workers_.reserve(num_workers_);
+  for (int index = 0; index < num_workers_; ++index) {
+    workers_.emplace_back(&JobSystem::WorkerLoop, this, index);
+  }
+}
+
+JobSystem::~JobSystem() {
+  // Jobs still queued are run by the workers before they see stopping_.
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+
+  // With no workers, or jobs queued by the last jobs to run, finish here.
+  while (auto job = Dequeue()) {
+    Run(job);
+  }
+}
+
+std::unique_ptr<JobSystem> JobSystem::Load(
+    const Configuration& configuration) {
+  const auto worker_threads_config =
+      configuration.Get<int>(kConfigModule, kConfigAttributeWorkerThreads);
+  int num_workers = worker_threads_config.first;
+  if (!worker_threads_config.second || num_workers < 0) {
+    num_workers =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency())) - 1;
+  }
+  LOG(INFO) << "Starting job system with " << num_workers << " workers.";
+  return AllocateUniqueObject<JobSystem>(num_workers);
+}
+
+JobHandle JobSystem::Schedule(std::function<void()> function) {
+  return Schedule(std::move(function), {});
+}
+
+JobHandle JobSystem::Schedule(std::function<void()> function,
+                              const stl_vector<JobHandle>& dependencies) {
+  auto job = std::make_shared<Job>();
+  job->function = std::move(function);
+
+  // Register with unfinished dependencies. The initial pending count keeps
+  // the job from being queued by a dependency that finishes meanwhile.
+  for (const auto& dependency : dependencies) {
+    if (dependency.job_ == nullptr) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(dependency.job_->mutex);
+    if (!dependency.job_->finished.load(std::memory_order_relaxed)) {
+      job->num_pending.fetch_add(1, std::memory_order_relaxed);
+      dependency.job_->continuations.push_back(job);
+    }
+  }
+  JobHandle handle;
+  handle.job_ = job;
+  if (job->num_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    Enqueue(std::move(job));
+  }
+  return handle;
+}
+
+JobHandle JobSystem::Continue(const JobHandle& parent,
+                              std::function<void()> function) {
+  return Schedule(std::move(function), {parent});
+}
+
+void JobSystem::Wait(const JobHandle& handle) {
+  while (!handle.finished()) {
+    if (auto job = Dequeue()) {
+      Run(job);
+      continue;
+    }
+
+    // Nothing to run, so sleep until a job is queued or finishes.
+    num_waiting_.fetch_add(1);
+    {
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      wake_.wait(lock, [this, &handle]() {
+        return handle.finished() || num_queued_.load() > 0;
+      });
+    }
+    num_waiting_.fetch_sub(1);
+  }
+}
+
+int JobSystem::num_workers() const { return num_workers_; }
+
+void JobSystem::Enqueue(std::shared_ptr<Job> job) {
+  JobQueue& queue = queues_[CurrentQueueIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+  }
+  num_queued_.fetch_add(1);
+
+  // Taking the lock orders this with sleepers checking num_queued_, so that
+  // none miss the wakeup.
+  { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+  wake_.notify_one();
+}
+
+std::shared_ptr<JobSystem::Job> JobSystem::Dequeue() {
+  if (num_queued_.load() <= 0) {
+    return nullptr;
+  }
+  const int own_index = CurrentQueueIndex();
+  const int num_queues = num_workers_ + 1;
+  for (int offset = 0; offset < num_queues; ++offset) {
+    const int index = (own_index + offset) % num_queues;
+    JobQueue& queue = queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+      continue;
+    }
+    std::shared_ptr<Job> job;
+    if (offset == 0) {
+      job = std::move(queue.jobs.back());
+      queue.jobs.pop_back();
+    } else {
+      job = std::move(queue.jobs.front());
+      queue.jobs.pop_front();
+    }
+    num_queued_.fetch_sub(1);
+    return job;
+  }
+  return nullptr;
+}
+
+void JobSystem::Run(const std::shared_ptr<Job>& job) {
+  job->function();
+  job->function = nullptr;
+
+  stl_vector<std::shared_ptr<Job>> continuations;
+  {
+    std::lock_guard<std::mutex> lock(job->mutex);
+    job->finished.store(true, std::memory_order_release);
+    continuations.swap(job->continuations);
+  }
+  for (auto& continuation : continuations) {
+    if (continuation->num_pending.fetch_sub(1, std::memory_order_acq_rel) ==
+        1) {
+      Enqueue(std::move(continuation));
+    }
+  }
+  if (num_waiting_.load() > 0) {
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_.notify_all();
+  }
+}
+
+void JobSystem::WorkerLoop(const int worker_index) {
+  t_job_system = this;
+  t_worker_index = worker_index;
+  while (true) {
+    if (auto job = Dequeue()) {
+      Run(job);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this]() {
+      return stopping_ || num_queued_.load() > 0;
+    });
+    if (stopping_ && num_queued_.load() <= 0) {
+      break;
+    }
+  }
+  t_job_system = nullptr;
+  t_worker_index = -1;
+}
+
+int JobSystem::CurrentQueueIndex() const {
+  return (t_job_system == this) ? t_worker_index : num_workers_;
+}
+
+}  // namespace ogle
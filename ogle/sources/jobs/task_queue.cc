@@ -0,0 +1,32 @@
+/**
+ * @file task_queue.cc
+ * @brief Implements task_queue.h.
+ */
+
+#include "jobs/task_queue.h"
+
+namespace ogle {
+
+void TaskQueue::Post(std::function<void()> task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  tasks_.push_back(std::move(task));
+}
+
+size_t TaskQueue::RunAll() {
+  size_t num_run = 0;
+  while (true) {
+    std::function<void()> task;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (tasks_.empty()) {
+        return num_run;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+    ++num_run;
+  }
+}
+
+}  // namespace ogle
@@ -0,0 +1,71 @@
+/**
+ * @file frame_allocator.cc
+ * @brief Implements frame_allocator.h.
+ */
+
+#include "memory/frame_allocator.h"
+#include <algorithm>
+#include <cstdint>
+#include "easylogging++.h"  // NOLINT
+
+namespace ogle {
+
+constexpr std::size_t FrameAllocator::kDefaultBlockSize;
+
+FrameAllocator::FrameAllocator(const std::size_t block_size)
+  : offset_(0), bytes_used_(0), block_size_(std::max<std::size_t>(
+                                    block_size, alignof(std::max_align_t))) {
+}
+
+FrameAllocator& FrameAllocator::ForThread() {
+  thread_local FrameAllocator allocator;
+  return allocator;
+}
+
+void* FrameAllocator::Allocate(const std::size_t size,
+                               const std::size_t alignment) {
+  CHECK(alignment > 0 && (alignment & (alignment - 1)) == 0)
+      << "Alignment must be a power of 2.";
+  if (!blocks_.empty()) {
+    Block& block = blocks_.back();
+    const auto base = reinterpret_cast<std::uintptr_t>(block.memory.get());
+    const std::size_t begin =
+        ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+    if (begin + size <= block.size) {
+      offset_ = begin + size;
+      bytes_used_ += size;
+      return block.memory.get() + begin;
+    }
+  }
+
+  // Start a new block, with room to align the allocation.
+  const std::size_t new_size = std::max(block_size_, size + alignment);
+  blocks_.push_back({std::unique_ptr<char[]>(AllocateBuffer<char>(new_size)),
+                     new_size});
+  offset_ = 0;
+  return Allocate(size, alignment);
+}
+
+void FrameAllocator::Reset() {
+  if (blocks_.size() > 1) {
+    const std::size_t total_size = capacity();
+    blocks_.clear();
+    blocks_.push_back(
+        {std::unique_ptr<char[]>(AllocateBuffer<char>(total_size)),
+         total_size});
+  }
+  offset_ = 0;
+  bytes_used_ = 0;
+}
+
+std::size_t FrameAllocator::bytes_used() const { return bytes_used_; }
+
+std::size_t FrameAllocator::capacity() const {
+  std::size_t total_size = 0;
+  for (const auto& block : blocks_) {
+    total_size += block.size;
+  }
+  return total_size;
+}
+
+}  // namespace ogle
@@ -0,0 +1,311 @@
+/**
+ * @file object_pool.cc
+ * @brief Implements object_pool.h.
+ */
+
+#include "memory/object_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <string>
+
+namespace ogle {
+
+constexpr std::size_t ObjectPool::kCacheLineSize;
+
+namespace {
+
+/// Most pools that threads can cache blocks for.
+constexpr int kMaxCachedPools = 64;
+
+/// Most free blocks a thread caches for each pool. Half are moved at once
+/// to or from the pool's shared list.
+constexpr std::size_t kThreadCacheSize = 32;
+
+/// Target size of each slab in bytes.
+constexpr std::size_t kSlabSize = 64 * 1024;
+
+/// Fewest blocks in each slab.
+constexpr std::size_t kMinBlocksPerSlab = 16;
+
+/// Pools with thread caches, by cache index.
+std::atomic<ObjectPool*> g_cached_pools[kMaxCachedPools];
+
+/// Number of cache indices assigned.
+std::atomic<int> g_num_cached_pools(0);
+
+/**
+ * @brief Gets the mutex guarding the list of all pools.
+ *
+ * Never destroyed, so pools may be destroyed during static destruction.
+ *
+ * @return Mutex.
+ */
+std::mutex& PoolsMutex() {
+  static std::mutex* mutex = AllocateObject<std::mutex>();
+  return *mutex;
+}
+
+/**
+ * @brief Gets the list of all pools. Never destroyed, like PoolsMutex().
+ * @return List of pools.
+ */
+stl_vector<const ObjectPool*>& Pools() {
+  static stl_vector<const ObjectPool*>* pools =
+      AllocateObject<stl_vector<const ObjectPool*>>();
+  return *pools;
+}
+
+}  // namespace
+
+/**
+ * @brief Free blocks cached by one thread, for each pool with thread caches.
+ */
+struct ThreadPoolCache {
+  /**
+   * @brief Free blocks cached for one pool.
+   */
+  struct List {
+    /// First block.
+    ObjectPool::FreeBlock* head;
+
+    /// Number of blocks.
+    std::size_t count;
+  };
+
+  /**
+   * @brief Destructor. Returns cached blocks to their pools.
+   */
+  ~ThreadPoolCache() {
+    for (int index = 0; index < kMaxCachedPools; ++index) {
+      List& list = lists[index];
+      ObjectPool* pool = g_cached_pools[index].load();
+      if (list.head != nullptr && pool != nullptr) {
+        ObjectPool::FreeBlock* last = list.head;
+        while (last->next != nullptr) {
+          last = last->next;
+        }
+        pool->ReturnBlocks(list.head, last);
+      }
+    }
+  }
+
+  /// Lists of free blocks, by pool cache index.
+  List lists[kMaxCachedPools];
+};
+
+namespace {
+
+/// Cache of calling thread. Zero-initialized.
+thread_local ThreadPoolCache t_pool_cache;
+
+}  // namespace
+
+float ObjectPool::Statistics::fragmentation() const {
+  if (num_blocks == 0) {
+    return 0.f;
+  }
+  return 1.f - static_cast<float>(num_live) / static_cast<float>(num_blocks);
+}
+
+ObjectPool::ObjectPool(const stl_string& name, const std::size_t block_size,
+                       const bool thread_cache)
+  : name_(name),
+    block_size_((std::max<std::size_t>(block_size, 1) + kCacheLineSize - 1) /
+                kCacheLineSize * kCacheLineSize),
+    blocks_per_slab_(std::max(kMinBlocksPerSlab, kSlabSize / block_size_)),
+    cache_index_(-1), free_list_(nullptr), num_live_(0), peak_live_(0) {
+  if (thread_cache) {
+    const int index = g_num_cached_pools.fetch_add(1);
+    if (index < kMaxCachedPools) {
+      cache_index_ = index;
+      g_cached_pools[index].store(this);
+    } else {
+      LOG(WARNING) << "Too many pools to cache blocks for " << name_ << ".";
+    }
+  }
+  std::lock_guard<std::mutex> lock(PoolsMutex());
+  Pools().push_back(this);
+}
+
+ObjectPool::~ObjectPool() {
+  {
+    std::lock_guard<std::mutex> lock(PoolsMutex());
+    auto& pools = Pools();
+    pools.erase(std::find(pools.begin(), pools.end(), this));
+  }
+  if (cache_index_ >= 0) {
+    g_cached_pools[cache_index_].store(nullptr);
+  }
+  for (void* slab : slabs_) {
+    ::operator delete(slab);
+  }
+}
+
+void* ObjectPool::Allocate() {
+  FreeBlock* block;
+  if (cache_index_ >= 0) {
+    ThreadPoolCache::List& list = t_pool_cache.lists[cache_index_];
+    if (list.head == nullptr) {
+      list.head = TakeBlocks(kThreadCacheSize / 2, &list.count);
+    }
+    block = list.head;
+    list.head = block->next;
+    --list.count;
+  } else {
+    std::size_t num_taken;
+    block = TakeBlocks(1, &num_taken);
+  }
+
+  const std::size_t num_live =
+      num_live_.fetch_add(1, std::memory_order_relaxed) + 1;
+  std::size_t peak_live = peak_live_.load(std::memory_order_relaxed);
+  while (num_live > peak_live &&
+         !peak_live_.compare_exchange_weak(peak_live, num_live,
+                                           std::memory_order_relaxed)) {
+  }
+  return block;
+}
+
+void ObjectPool::Free(void* memory) {
+  if (memory == nullptr) {
+    return;
+  }
+  num_live_.fetch_sub(1, std::memory_order_relaxed);
+  FreeBlock* block = static_cast<FreeBlock*>(memory);
+  if (cache_index_ < 0) {
+    block->next = nullptr;
+    ReturnBlocks(block, block);
+    return;
+  }
+
+  ThreadPoolCache::List& list = t_pool_cache.lists[cache_index_];
+  block->next = list.head;
+  list.head = block;
+  if (++list.count > kThreadCacheSize) {
+    FreeBlock* first = list.head;
+    FreeBlock* last = first;
+    for (std::size_t i = 1; i < kThreadCacheSize / 2; ++i) {
+      last = last->next;
+    }
+    list.head = last->next;
+    list.count -= kThreadCacheSize / 2;
+    last->next = nullptr;
+    ReturnBlocks(first, last);
+  }
+}
+
+ObjectPool::Statistics ObjectPool::statistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics statistics;
+  statistics.name = name_;
+  statistics.block_size = block_size_;
+  statistics.num_slabs = slabs_.size();
+  statistics.num_blocks = slabs_.size() * blocks_per_slab_;
+  statistics.num_live = num_live_.load(std::memory_order_relaxed);
+  statistics.peak_live = peak_live_.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+stl_vector<ObjectPool::Statistics> ObjectPool::AllStatistics() {
+  std::lock_guard<std::mutex> lock(PoolsMutex());
+  stl_vector<Statistics> all_statistics;
+  for (const ObjectPool* pool : Pools()) {
+    all_statistics.push_back(pool->statistics());
+  }
+  return all_statistics;
+}
+
+std::size_t ObjectPool::block_size() const { return block_size_; }
+
+ObjectPool::FreeBlock* ObjectPool::TakeBlocks(const std::size_t max_blocks,
+                                              std::size_t* num_taken) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (free_list_ == nullptr) {
+    // Over-allocate so that blocks can start on a cache line.
+    void* slab =
+        ::operator new(blocks_per_slab_ * block_size_ + kCacheLineSize - 1);
+    slabs_.push_back(slab);
+    const auto address = reinterpret_cast<std::uintptr_t>(slab);
+    char* first_block = reinterpret_cast<char*>(
+        (address + kCacheLineSize - 1) & ~(kCacheLineSize - 1));
+    for (std::size_t i = blocks_per_slab_; i-- > 0;) {
+      FreeBlock* block =
+          reinterpret_cast<FreeBlock*>(first_block + i * block_size_);
+      block->next = free_list_;
+      free_list_ = block;
+    }
+  }
+
+  FreeBlock* first = free_list_;
+  FreeBlock* last = first;
+  *num_taken = 1;
+  while (*num_taken < max_blocks && last->next != nullptr) {
+    last = last->next;
+    ++*num_taken;
+  }
+  free_list_ = last->next;
+  last->next = nullptr;
+  return first;
+}
+
+void ObjectPool::ReturnBlocks(FreeBlock* first, FreeBlock* last) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  last->next = free_list_;
+  free_list_ = first;
+}
+
+ObjectPoolSet::ObjectPoolSet(const stl_string& name,
+                             const std::size_t max_size,
+                             const bool thread_cache)
+  : name_(name), max_size_(max_size), thread_cache_(thread_cache) {
+  const std::size_t num_pools =
+      (max_size_ + ObjectPool::kCacheLineSize - 1) /
+      ObjectPool::kCacheLineSize;
+  pools_.reset(AllocateBuffer<std::atomic<ObjectPool*>>(num_pools));
+  for (std::size_t index = 0; index < num_pools; ++index) {
+    pools_[index].store(nullptr);
+  }
+}
+
+ObjectPoolSet::~ObjectPoolSet() {
+  const std::size_t num_pools =
+      (max_size_ + ObjectPool::kCacheLineSize - 1) /
+      ObjectPool::kCacheLineSize;
+  for (std::size_t index = 0; index < num_pools; ++index) {
+    delete pools_[index].load();
+  }
+}
+
+void* ObjectPoolSet::Allocate(const std::size_t size) {
+  if (size == 0 || size > max_size_) {
+    return ::operator new(size);
+  }
+  return GetPool(size)->Allocate();
+}
+
+void ObjectPoolSet::Free(void* memory, const std::size_t size) {
+  if (size == 0 || size > max_size_) {
+    ::operator delete(memory);
+  } else {
+    GetPool(size)->Free(memory);
+  }
+}
+
+ObjectPool* ObjectPoolSet::GetPool(const std::size_t size) {
+  const std::size_t index = (size - 1) / ObjectPool::kCacheLineSize;
+  ObjectPool* pool = pools_[index].load(std::memory_order_acquire);
+  if (pool == nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pool = pools_[index].load(std::memory_order_relaxed);
+    if (pool == nullptr) {
+      const std::size_t block_size = (index + 1) * ObjectPool::kCacheLineSize;
+      pool = AllocateObject<ObjectPool>(
+          name_ + "/" + std::to_string(block_size), block_size, thread_cache_);
+      pools_[index].store(pool, std::memory_order_release);
+    }
+  }
+  return pool;
+}
+
+}  // namespace ogle
@@ -9,17 +9,31 @@
 
 namespace ogle {
 
-BufferedMesh::BufferedMesh(const Mesh &mesh)
-  : mesh_(mesh) {
+const stl_string BufferedMesh::kConfigAttributeVertexLayout = "vertex_layout";
+
+BufferedMesh::BufferedMesh(const Mesh &mesh, const VertexLayout& vertex_layout)
+  : mesh_(mesh), vertex_layout_(vertex_layout) {
 }
 
 std::unique_ptr<BufferedMesh> BufferedMesh::Load(
     const Configuration& configuration, const Mesh& mesh) {
+  MemoryScope memory_scope(MemoryTag::RENDERER);
   const stl_string implementation = configuration.Get<stl_string>(
       MeshRenderer::kConfigModule,
       MeshRenderer::kConfigAttributeImplementation).first;
+  const auto vertex_layout_config = configuration.Get<stl_string>(
+      MeshRenderer::kConfigModule, kConfigAttributeVertexLayout);
+  VertexLayout vertex_layout;
+  if (!VertexLayout::FromName(vertex_layout_config.second ?
+                                  vertex_layout_config.first :
+                                  VertexLayout::kInterleavedLayoutName,
+                              &vertex_layout)) {
+    return nullptr;
+  }
+
   if (implementation == GLFWMeshRenderer::kConfigImplementationName) {
-    auto new_object = AllocateUniqueObject<GLFWBufferedMesh>(mesh);
+    auto new_object =
+        AllocateUniqueObject<GLFWBufferedMesh>(mesh, vertex_layout);
     if (new_object->Create()) {
       return std::move(new_object);
     } else {
@@ -31,4 +45,10 @@ std::unique_ptr<BufferedMesh> BufferedMesh::Load(
   return nullptr;
 }
 
+const Mesh& BufferedMesh::mesh() const { return mesh_; }
+
+const VertexLayout& BufferedMesh::vertex_layout() const {
+  return vertex_layout_;
+}
+
 }  // namespace ogle
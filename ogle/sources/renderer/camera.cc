@@ -9,4 +9,8 @@ namespace ogle {
 
 Camera::Camera() : Component(ComponentType::CAMERA) {}
 
+Frustum Camera::GetFrustum(const Transform& transform) const {
+  return Frustum(GetProjectionMatrix() * GetViewMatrix(transform));
+}
+
 }  // namespace ogle
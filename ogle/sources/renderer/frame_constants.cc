@@ -0,0 +1,117 @@
+/**
+ * @file frame_constants.cc
+ * @brief Implements frame_constants.h.
+ */
+
+#include "renderer/frame_constants.h"
+#include <algorithm>
+#include "config/configuration.h"
+#include "entity/entity.h"
+#include "entity/property.h"
+#include "math/matrix.h"
+#include "renderer/camera.h"
+#include "renderer/glfw_frame_constants_buffer.h"
+#include "renderer/glfw_mesh_renderer.h"
+#include "renderer/light.h"
+#include "renderer/renderer.h"
+
+namespace ogle {
+
+const stl_string FrameConstants::kBlockName = "FrameConstants";
+
+constexpr std::uint32_t FrameConstants::kBindingPoint;
+
+static_assert(sizeof(FrameConstants) == 2 * 64 + 4 * 16,
+              "FrameConstants must match its std140 uniform block.");
+
+namespace {
+
+/**
+ * @brief Copies a 3-float color property into a vec4, or black if absent.
+ * @param light Light to read property from.
+ * @param name Property name.
+ * @param[out] color Color to write.
+ */
+void CopyLightColor(const Light& light, const stl_string& name,
+                    float color[4]) {
+  std::fill(color, color + 4, 0.f);
+  const Property* property = light.GetProperty(name);
+  if (property == nullptr) {
+    return;
+  }
+  if (property->Type() != PropertyType::FLOAT || !property->IsVector() ||
+      property->dims()[0] != 3) {
+    LOG(ERROR) << "Light color must be a 3-vector of floats: " << name;
+    return;
+  }
+  const float* data = static_cast<const float*>(property->data());
+  std::copy(data, data + 3, color);
+}
+
+}  // namespace
+
+bool FrameConstants::Set(const Entity& camera_entity,
+                         const stl_vector<const Entity*>& light_entities) {
+  const Camera* camera = camera_entity.GetComponent<Camera>();
+  if (camera == nullptr) {
+    LOG(ERROR) << "Camera Entity needs Camera component.";
+    return false;
+  }
+  const Matrix44f view = camera->GetViewMatrix(camera_entity.transform_);
+  const Matrix44f projection = camera->GetProjectionMatrix();
+  // Transpose to column-major format used in std140.
+  const Matrix44f view_transpose = view.Transpose();
+  const Matrix44f projection_transpose = projection.Transpose();
+  std::copy(view_transpose.data(), view_transpose.data() + 16, view_matrix);
+  std::copy(projection_transpose.data(), projection_transpose.data() + 16,
+            projection_matrix);
+
+  std::fill(light_position, light_position + 4, 0.f);
+  std::fill(light_ambient_color, light_ambient_color + 4, 0.f);
+  std::fill(light_diffuse_color, light_diffuse_color + 4, 0.f);
+  std::fill(light_specular_color, light_specular_color + 4, 0.f);
+  if (!light_entities.empty()) {
+    if (!light_entities[0]) {
+      LOG(ERROR) << "Attempted to compute lighting from null light";
+      return true;
+    }
+    const Entity& light_entity_0 = *light_entities[0];
+    const auto& position = light_entity_0.transform_.world_position();
+    std::copy(position.data(), position.data() + 3, light_position);
+    light_position[3] = 1.f;
+
+    const Light* light = light_entity_0.GetComponent<Light>();
+    if (!light) {
+      LOG(ERROR) << "Entity does not have light attached.";
+      return true;
+    }
+    CopyLightColor(*light, Light::StandardPropertyName::kAmbientColor,
+                   light_ambient_color);
+    CopyLightColor(*light, Light::StandardPropertyName::kDiffuseColor,
+                   light_diffuse_color);
+    CopyLightColor(*light, Light::StandardPropertyName::kSpecularColor,
+                   light_specular_color);
+  }
+  return true;
+}
+
+std::unique_ptr<FrameConstantsBuffer> FrameConstantsBuffer::Load(
+    const Configuration& configuration) {
+  const stl_string implementation =
+      configuration.Get<stl_string>(Renderer::kConfigModule,
+                                    Renderer::kConfigAttributeImplementation)
+          .first;
+  if (implementation == GLFWMeshRenderer::kConfigImplementationName) {
+    auto new_object = AllocateUniqueObject<GLFWFrameConstantsBuffer>();
+    if (new_object->Create()) {
+      return std::move(new_object);
+    } else {
+      LOG(ERROR) << "GLFWFrameConstantsBuffer Create() failed.";
+    }
+  }
+  LOG(ERROR) << "Unable to create FrameConstantsBuffer for implementation: "
+             << implementation;
+  return nullptr;
+}
+
+}  // namespace ogle
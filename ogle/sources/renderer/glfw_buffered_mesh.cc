@@ -4,12 +4,69 @@
  */
 
 #include "renderer/glfw_buffered_mesh.h"
+#include <cstdint>
+#include "GL/glew.h"
 #include "easylogging++.h"  // NOLINT
 #include "geometry/mesh.h"
+#include "renderer/glfw_state_cache.h"
 
 namespace ogle {
 
-GLFWBufferedMesh::GLFWBufferedMesh(const Mesh& mesh) : BufferedMesh(mesh) {}
+namespace {
+
+/**
+ * @brief Converts a vertex component type to its OpenGL equivalent.
+ * @param type Component type.
+ * @return OpenGL type enum.
+ */
+GLenum GLComponentType(const VertexComponentType type) {
+  switch (type) {
+    case VertexComponentType::FLOAT:
+      return GL_FLOAT;
+    case VertexComponentType::INT16:
+      return GL_SHORT;
+    case VertexComponentType::UINT16:
+      return GL_UNSIGNED_SHORT;
+    case VertexComponentType::INT8:
+      return GL_BYTE;
+    case VertexComponentType::UINT8:
+      return GL_UNSIGNED_BYTE;
+  }
+  LOG(FATAL) << "Unknown vertex component type.";
+  return GL_FLOAT;
+}
+
+}  // namespace
+
+GLFWBufferedMesh::GLFWBufferedMesh(const Mesh& mesh,
+                                   const VertexLayout& vertex_layout)
+  : BufferedMesh(mesh, vertex_layout),
+    vertex_buffer_id_(0),
+    normal_buffer_id_(0),
+    uv_buffer_id_(0),
+    index_buffer_id_(0),
+    instance_buffer_id_(0),
+    vertex_array_ids_{0, 0} {}
+
+GLFWBufferedMesh::~GLFWBufferedMesh() {
+  GLFWStateCache* gl_state = GLFWStateCache::current();
+  if (gl_state != nullptr) {
+    for (const GLuint buffer_id :
+         {vertex_buffer_id_, normal_buffer_id_, uv_buffer_id_,
+          index_buffer_id_, instance_buffer_id_}) {
+      gl_state->ForgetBuffer(buffer_id);
+    }
+    for (const GLuint vertex_array_id : vertex_array_ids_) {
+      gl_state->ForgetVertexArray(vertex_array_id);
+    }
+  }
+  glDeleteBuffers(1, &vertex_buffer_id_);
+  glDeleteBuffers(1, &normal_buffer_id_);
+  glDeleteBuffers(1, &uv_buffer_id_);
+  glDeleteBuffers(1, &index_buffer_id_);
+  glDeleteBuffers(1, &instance_buffer_id_);
+  glDeleteVertexArrays(2, vertex_array_ids_);
+}
 
 const VertexBuffer& GLFWBufferedMesh::vertices() const { return vertices_; }
 
@@ -19,29 +76,74 @@ const NormalBuffer& GLFWBufferedMesh::normals() const { return normals_; }
 
 const IndexBuffer& GLFWBufferedMesh::indices() const { return indices_; }
 
+const InterleavedVertexBuffer& GLFWBufferedMesh::interleaved_vertices() const {
+  return interleaved_vertices_;
+}
+
+const void* GLFWBufferedMesh::vertex_array_key(const bool instanced) const {
+  return &vertex_array_ids_[instanced ? 1 : 0];
+}
+
+GLuint GLFWBufferedMesh::vertex_array_id(const bool instanced) const {
+  return vertex_array_ids_[instanced ? 1 : 0];
+}
+
+GLuint GLFWBufferedMesh::instance_buffer_id() const {
+  return instance_buffer_id_;
+}
+
 bool GLFWBufferedMesh::Create() {
+  GLFWStateCache* gl_state = GLFWStateCache::current();
+  if (gl_state == nullptr) {
+    LOG(ERROR) << "No OpenGL context to create buffered mesh in.";
+    return false;
+  }
+
   const auto& mesh_vertices = mesh_.mesh_vertices();
   const auto& mesh_faces = mesh_.mesh_faces();
 
-  vertices_ = std::move(VertexBuffer(mesh_vertices.size()));
-  uvs_ = std::move(TexCoordUVBuffer(mesh_vertices.size()));
-  normals_ = std::move(NormalBuffer(mesh_vertices.size()));
   indices_ = std::move(IndexBuffer(mesh_faces.size() * Mesh::kVerticesPerFace));
 
   // TODO(damlaren): Some data is not always available.
 
-  // Build per-vertex buffers.
-  for (BufferIndex index = 0; index < mesh_vertices.size(); index++) {
-    const auto& mesh_vertex = mesh_vertices[index];
-
-    if (index < 0 || index >= mesh_vertices.size()) {
-      LOG(ERROR) << "Invalid index assigned to vertex: " << index;
-      return false;
+  if (vertex_layout_.interleaved()) {
+    // Pack each vertex's attributes together.
+    const std::uint32_t stride = vertex_layout_.stride();
+    interleaved_vertices_ = std::move(
+        InterleavedVertexBuffer(mesh_vertices.size() * stride));
+    std::uint8_t* vertex_data = interleaved_vertices_.mutable_data();
+    for (const auto& mesh_vertex : mesh_vertices) {
+      for (const auto& format : vertex_layout_.attributes()) {
+        switch (format.attribute) {
+          case VertexAttribute::POSITION:
+            VertexLayout::PackAttribute(format, mesh_vertex.vertex.data(), 3,
+                                        vertex_data);
+            break;
+          case VertexAttribute::NORMAL:
+            VertexLayout::PackAttribute(format,
+                                        mesh_vertex.vertex_normal.data(), 3,
+                                        vertex_data);
+            break;
+          case VertexAttribute::UV:
+            VertexLayout::PackAttribute(format, mesh_vertex.uv.data(), 2,
+                                        vertex_data);
+            break;
+        }
+      }
+      vertex_data += stride;
     }
+  } else {
+    vertices_ = std::move(VertexBuffer(mesh_vertices.size()));
+    uvs_ = std::move(TexCoordUVBuffer(mesh_vertices.size()));
+    normals_ = std::move(NormalBuffer(mesh_vertices.size()));
 
-    vertices_.SetDataValue(index, mesh_vertex.vertex);
-    uvs_.SetDataValue(index, mesh_vertex.uv);
-    normals_.SetDataValue(index, mesh_vertex.vertex_normal);
+    // Build per-vertex buffers.
+    for (BufferIndex index = 0; index < mesh_vertices.size(); index++) {
+      const auto& mesh_vertex = mesh_vertices[index];
+      vertices_.SetDataValue(index, mesh_vertex.vertex);
+      uvs_.SetDataValue(index, mesh_vertex.uv);
+      normals_.SetDataValue(index, mesh_vertex.vertex_normal);
+    }
   }
 
   // Build index buffer.
@@ -52,7 +154,115 @@ bool GLFWBufferedMesh::Create() {
     }
   }
 
+  UploadBuffers();
+
+  // Both vertex arrays read the same vertex and index buffers. Only the
+  // instanced one reads per-instance matrices, which are streamed into the
+  // instance buffer before each instanced draw.
+  glGenVertexArrays(2, vertex_array_ids_);
+  gl_state->BindVertexArray(vertex_array_ids_[0]);
+  SetVertexAttributes();
+  gl_state->BindVertexArray(vertex_array_ids_[1]);
+  SetVertexAttributes();
+  SetInstanceAttributes();
   return true;
 }
 
+void GLFWBufferedMesh::UploadBuffers() {
+  GLFWStateCache* gl_state = GLFWStateCache::current();
+  if (vertex_layout_.interleaved()) {
+    // Copy all attributes to one buffer.
+    glGenBuffers(1, &vertex_buffer_id_);
+    gl_state->BindBuffer(GL_ARRAY_BUFFER, vertex_buffer_id_);
+    glBufferData(GL_ARRAY_BUFFER, interleaved_vertices_.SizeInBytes(),
+                 interleaved_vertices_.data(), GL_STATIC_DRAW);
+  } else {
+    // Copy each attribute to its own buffer. This may be in GPU memory, but
+    // that's up to the graphics driver.
+    glGenBuffers(1, &vertex_buffer_id_);
+    gl_state->BindBuffer(GL_ARRAY_BUFFER, vertex_buffer_id_);
+    glBufferData(GL_ARRAY_BUFFER, vertices_.SizeInBytes(), vertices_.data(),
+                 GL_STATIC_DRAW);
+    glGenBuffers(1, &normal_buffer_id_);
+    gl_state->BindBuffer(GL_ARRAY_BUFFER, normal_buffer_id_);
+    glBufferData(GL_ARRAY_BUFFER, normals_.SizeInBytes(), normals_.data(),
+                 GL_STATIC_DRAW);
+    glGenBuffers(1, &uv_buffer_id_);
+    gl_state->BindBuffer(GL_ARRAY_BUFFER, uv_buffer_id_);
+    glBufferData(GL_ARRAY_BUFFER, uvs_.SizeInBytes(), uvs_.data(),
+                 GL_STATIC_DRAW);
+  }
+
+  // The index buffer is uploaded through the array buffer target, as no
+  // vertex array is bound yet to hold an element array binding.
+  glGenBuffers(1, &index_buffer_id_);
+  gl_state->BindBuffer(GL_ARRAY_BUFFER, index_buffer_id_);
+  glBufferData(GL_ARRAY_BUFFER, indices_.SizeInBytes(), indices_.data(),
+               GL_STATIC_DRAW);
+
+  // Filled before each instanced draw.
+  glGenBuffers(1, &instance_buffer_id_);
+}
+
+void GLFWBufferedMesh::SetVertexAttributes() {
+  GLFWStateCache* gl_state = GLFWStateCache::current();
+  if (vertex_layout_.interleaved()) {
+    // Point each attribute at its offset within a vertex.
+    gl_state->BindBuffer(GL_ARRAY_BUFFER, vertex_buffer_id_);
+    for (const auto& format : vertex_layout_.attributes()) {
+      glEnableVertexAttribArray(format.location);
+      glVertexAttribPointer(format.location, format.num_components,
+                            GLComponentType(format.type),
+                            format.normalized ? GL_TRUE : GL_FALSE,
+                            vertex_layout_.stride(),
+                            reinterpret_cast<const void*>(
+                                static_cast<std::uintptr_t>(format.offset)));
+    }
+  } else {
+    gl_state->BindBuffer(GL_ARRAY_BUFFER, vertex_buffer_id_);
+    glEnableVertexAttribArray(VertexLayout::kPositionLocation);
+    glVertexAttribPointer(VertexLayout::kPositionLocation, 3, GL_FLOAT,
+                          GL_FALSE, 0, nullptr);
+    gl_state->BindBuffer(GL_ARRAY_BUFFER, normal_buffer_id_);
+    glEnableVertexAttribArray(VertexLayout::kNormalLocation);
+    glVertexAttribPointer(VertexLayout::kNormalLocation, 3, GL_FLOAT, GL_FALSE,
+                          0, nullptr);
+    gl_state->BindBuffer(GL_ARRAY_BUFFER, uv_buffer_id_);
+    glEnableVertexAttribArray(VertexLayout::kUVLocation);
+    glVertexAttribPointer(VertexLayout::kUVLocation, 2, GL_FLOAT, GL_FALSE, 0,
+                          nullptr);
+  }
+
+  // The vertex array keeps the index buffer binding.
+  gl_state->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id_);
+}
+
+void GLFWBufferedMesh::SetInstanceAttributes() {
+  // Each instance has a 4x4 model-view matrix followed by a 3x3 normal
+  // matrix. OpenGL reads each matrix column as one attribute.
+  constexpr std::size_t kModelViewSize = 16;
+  constexpr std::size_t kNormalSize = 9;
+  constexpr GLsizei kStride = (kModelViewSize + kNormalSize) * sizeof(float);
+  GLFWStateCache::current()->BindBuffer(GL_ARRAY_BUFFER, instance_buffer_id_);
+  for (GLuint column = 0; column < 4; ++column) {
+    const GLuint location =
+        VertexLayout::kInstanceModelViewMatrixLocation + column;
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+    glVertexAttribPointer(
+        location, 4, GL_FLOAT, GL_FALSE, kStride,
+        reinterpret_cast<const void*>(column * 4 * sizeof(float)));
+  }
+  for (GLuint column = 0; column < 3; ++column) {
+    const GLuint location =
+        VertexLayout::kInstanceNormalMatrixLocation + column;
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+    glVertexAttribPointer(
+        location, 3, GL_FLOAT, GL_FALSE, kStride,
+        reinterpret_cast<const void*>((kModelViewSize + column * 3) *
+                                      sizeof(float)));
+  }
+}
+
 }  // namespace ogle
@@ -0,0 +1,52 @@
+/**
+ * @file glfw_frame_constants_buffer.cc
+ * @brief Implements glfw_frame_constants_buffer.h.
+ */
+
+#include "renderer/glfw_frame_constants_buffer.h"
+#include "GL/glew.h"
+#include "GLFW/glfw3.h"
+#include "renderer/glfw_state_cache.h"
+
+namespace ogle {
+
+GLFWFrameConstantsBuffer::GLFWFrameConstantsBuffer()
+    : FrameConstantsBuffer(), uniform_buffer_id_(0) {}
+
+GLFWFrameConstantsBuffer::~GLFWFrameConstantsBuffer() {
+  GLFWStateCache* gl_state = GLFWStateCache::current();
+  if (gl_state != nullptr) {
+    gl_state->ForgetBuffer(uniform_buffer_id_);
+  }
+  glDeleteBuffers(1, &uniform_buffer_id_);
+}
+
+bool GLFWFrameConstantsBuffer::Create() {
+  GLFWStateCache* gl_state = GLFWStateCache::current();
+  if (gl_state == nullptr) {
+    LOG(ERROR) << "No OpenGL context to create frame constants in.";
+    return false;
+  }
+  glGenBuffers(1, &uniform_buffer_id_);
+  if (uniform_buffer_id_ == 0) {
+    LOG(ERROR) << "glGenBuffers() failed for frame constants.";
+    return false;
+  }
+  gl_state->BindBuffer(GL_UNIFORM_BUFFER, uniform_buffer_id_);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), nullptr,
+               GL_DYNAMIC_DRAW);
+
+  // The binding point is global state, so binding once serves every program.
+  // This also binds the buffer to the generic target, where it already is.
+  glBindBufferBase(GL_UNIFORM_BUFFER, FrameConstants::kBindingPoint,
+                   uniform_buffer_id_);
+  return true;
+}
+
+void GLFWFrameConstantsBuffer::Update(const FrameConstants& constants) {
+  GLFWStateCache::current()->BindBuffer(GL_UNIFORM_BUFFER,
+                                        uniform_buffer_id_);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstants), &constants);
+}
+
+}  // namespace ogle
@@ -4,6 +4,7 @@
  */
 
 #include "renderer/glfw_mesh_renderer.h"
+#include <algorithm>
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "entity/entity.h"
@@ -11,9 +12,10 @@
 #include "geometry/mesh.h"
 #include "geometry/transform.h"
 #include "geometry/transformation_matrix.h"
+#include "memory/frame_allocator.h"
 #include "renderer/camera.h"
+#include "renderer/glfw_state_cache.h"
 #include "renderer/glsl_shader_program.h"
-#include "renderer/light.h"
 #include "renderer/material.h"
 
 namespace ogle {
@@ -22,133 +24,210 @@ const stl_string GLFWMeshRenderer::kConfigImplementationName = "glfw";
 
 GLFWMeshRenderer::GLFWMeshRenderer(const BufferedMesh& mesh, Material* material)
     : MeshRenderer(mesh),
+      gl_mesh_(static_cast<const GLFWBufferedMesh&>(mesh)),
       material_(material),
-      vertex_buffer_id_(0),
-      normal_buffer_id_(0),
-      vertex_array_id_(0),
-      index_buffer_id_(0) {}
-
-GLFWMeshRenderer::~GLFWMeshRenderer() {
-  glDeleteBuffers(1, &vertex_buffer_id_);
-  glDeleteBuffers(1, &normal_buffer_id_);
-  glDeleteBuffers(1, &index_buffer_id_);
-  glDeleteVertexArrays(1, &vertex_array_id_);
-}
+      instanced_(false),
+      uses_model_matrix_(false),
+      uses_model_view_matrix_(false),
+      uses_normal_matrix_(false),
+      matrix_link_generation_(0) {}
 
 bool GLFWMeshRenderer::Create() {
-  // Create vertex array and bind it to be currently active.
-  glGenVertexArrays(1, &vertex_array_id_);
-  glBindVertexArray(vertex_array_id_);
-
-  // Create vertex buffer and make it active array buffer.
-  glGenBuffers(1, &vertex_buffer_id_);
-  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_id_);
-
-  // Copy data to active array buffer. This may be in GPU memory, but
-  // that's up to the graphics driver.
-  glBufferData(GL_ARRAY_BUFFER, buffered_mesh_.vertices().SizeInBytes(),
-               buffered_mesh_.vertices().data(), GL_STATIC_DRAW);
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-  // Do the same stuff again for normal buffer.
-  glGenBuffers(1, &normal_buffer_id_);
-  glBindBuffer(GL_ARRAY_BUFFER, normal_buffer_id_);
-  glBufferData(GL_ARRAY_BUFFER, buffered_mesh_.normals().SizeInBytes(),
-               buffered_mesh_.normals().data(), GL_STATIC_DRAW);
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-  // Do it all again for index buffer.
-  glGenBuffers(1, &index_buffer_id_);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id_);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffered_mesh_.indices().SizeInBytes(),
-               buffered_mesh_.indices().data(), GL_STATIC_DRAW);
+  if (GLFWStateCache::current() == nullptr) {
+    LOG(ERROR) << "No OpenGL context to create mesh renderer in.";
+    return false;
+  }
 
+  // Find which model matrices the program takes. Instanced programs take
+  // them as per-instance attributes, which the mesh's instanced vertex
+  // array reads.
+  const auto shader_program =
+      static_cast<const GLSLShaderProgram*>(material_->shader_program());
+  instanced_ = shader_program->HasAttribute(
+      ShaderProgram::StandardShaderArgumentNames::kInstanceModelViewMatrixArg);
+  if (!instanced_) {
+    CompileMatrixVariables();
+  }
   return true;
 }
 
 void GLFWMeshRenderer::Render(const Transform& transform, const Entity& camera,
                               const stl_vector<const Entity*>& lights) {
-  material_->UseProgram();
-
-  Matrix44f model_matrix = transform.TransformationMatrix3D();
+  Render(transform, camera, lights, {nullptr, nullptr, nullptr});
+}
 
-  Camera* camera_component = camera.GetComponent<Camera>();
-  if (camera_component == nullptr) {
-    LOG(ERROR) << "Camera Entity needs Camera component.";
+void GLFWMeshRenderer::Render(const Transform& transform, const Entity& camera,
+                              const stl_vector<const Entity*>& lights,
+                              const BoundState& previous) {
+  if (!instanced_ && matrix_link_generation_ !=
+                         material_->shader_program()->link_generation()) {
+    CompileMatrixVariables();
+  }
+  Matrix44f view_matrix;
+  if ((instanced_ || uses_model_view_matrix_ || uses_normal_matrix_) &&
+      !GetViewMatrix(camera, &view_matrix)) {
     return;
   }
-  Matrix44f view_matrix = camera_component->GetViewMatrix(camera.transform_);
-  Matrix44f projection_matrix = camera_component->GetProjectionMatrix();
-
-  // Set camera uniforms in shader.
-  material_->SetVariable(PropertyInstance<float>(
-      ShaderProgram::StandardShaderArgumentNames::kModelMatrixArg, {4, 4},
-      model_matrix.data()));
-  material_->SetVariable(PropertyInstance<float>(
-      ShaderProgram::StandardShaderArgumentNames::kViewMatrixArg, {4, 4},
-      view_matrix.data()));
-  material_->SetVariable(PropertyInstance<float>(
-      ShaderProgram::StandardShaderArgumentNames::kProjectionMatrixArg, {4, 4},
-      projection_matrix.data()));
-
-  // Set light uniforms in shader.
-  if (!lights.empty()) {
-    if (!lights[0]) {
-      LOG(ERROR) << "Attempted to compute lighting from null light";
-      goto end_lighting;
-    }
-    const Entity& light_entity_0 = *lights[0];
-    const auto light_position = light_entity_0.transform_.world_position();
-    material_->SetVariable(PropertyInstance<float>(
-        ShaderProgram::StandardShaderArgumentNames::kLightPosition, {3},
-        light_position.data()));
-
-    Light* light = light_entity_0.GetComponent<Light>();
-    if (!light) {
-      LOG(ERROR) << "Entity does not have light attached.";
-      goto end_lighting;
-    }
-    const Property* ambient_color_property =
-        light->GetProperty(Light::StandardPropertyName::kAmbientColor);
-    if (ambient_color_property) {
-      material_->SetVariable(
-          ShaderProgram::StandardShaderArgumentNames::kLightAmbientColor,
-          *ambient_color_property);
-    }
-    const Property* diffuse_color_property =
-        light->GetProperty(Light::StandardPropertyName::kDiffuseColor);
-    if (diffuse_color_property) {
-      material_->SetVariable(
-          ShaderProgram::StandardShaderArgumentNames::kLightDiffuseColor,
-          *diffuse_color_property);
+  BindState(previous);
+
+  // Draw.
+  static_assert(std::is_same<BufferIndex, std::uint32_t>::value,
+                "GLFWMeshRenderer assumes 32-bit unsigned BufferIndex.");
+  if (instanced_) {
+    const Transform* transform_pointer = &transform;
+    UploadInstances(view_matrix, &transform_pointer, 1);
+    glDrawElementsInstanced(GL_TRIANGLES,
+                            buffered_mesh_.indices().num_elements(),
+                            GL_UNSIGNED_INT, static_cast<void*>(0), 1);
+  } else {
+    const Matrix44f model_matrix = transform.TransformationMatrix3D();
+    if (uses_model_matrix_) {
+      material_->SetCompiledVariable(model_matrix_variable_,
+                                     model_matrix.data());
     }
-    const Property* specular_color_property =
-        light->GetProperty(Light::StandardPropertyName::kSpecularColor);
-    if (specular_color_property) {
-      material_->SetVariable(
-          ShaderProgram::StandardShaderArgumentNames::kLightSpecularColor,
-          *specular_color_property);
+    if (uses_model_view_matrix_ || uses_normal_matrix_) {
+      const Matrix44f model_view_matrix = view_matrix * model_matrix;
+      if (uses_model_view_matrix_) {
+        material_->SetCompiledVariable(model_view_matrix_variable_,
+                                       model_view_matrix.data());
+      }
+      if (uses_normal_matrix_) {
+        const Matrix33f normal_matrix =
+            TransformationMatrix::NormalMatrix3D(model_view_matrix);
+        material_->SetCompiledVariable(normal_matrix_variable_,
+                                       normal_matrix.data());
+      }
     }
+    glDrawElements(GL_TRIANGLES, buffered_mesh_.indices().num_elements(),
+                   GL_UNSIGNED_INT, static_cast<void*>(0));
   }
-end_lighting:
+}
 
-  // Set material properties on shader.
-  material_->SetBoundVariables();
+bool GLFWMeshRenderer::CanInstance(const Renderer& other) const {
+  if (!instanced_) {
+    return false;
+  }
+  const BoundState state = bound_state();
+  const BoundState other_state = other.bound_state();
+  return state.shader_program == other_state.shader_program &&
+         state.material == other_state.material &&
+         state.vertex_array == other_state.vertex_array;
+}
 
-  // Enable vertex array attribute for rendering.
-  glBindVertexArray(vertex_array_id_);
-  glEnableVertexAttribArray(0);
+void GLFWMeshRenderer::RenderInstanced(
+    const stl_vector<const Transform*>& transforms, const Entity& camera,
+    const stl_vector<const Entity*>& lights, const BoundState& previous) {
+  if (!instanced_) {
+    Renderer::RenderInstanced(transforms, camera, lights, previous);
+    return;
+  }
+  Matrix44f view_matrix;
+  if (transforms.empty() || !GetViewMatrix(camera, &view_matrix)) {
+    return;
+  }
+  BindState(previous);
+  UploadInstances(view_matrix, transforms.data(), transforms.size());
+  glDrawElementsInstanced(GL_TRIANGLES, buffered_mesh_.indices().num_elements(),
+                          GL_UNSIGNED_INT, static_cast<void*>(0),
+                          static_cast<GLsizei>(transforms.size()));
+}
 
-  // Use index buffer to specify vertex order.
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id_);
+Renderer::BoundState GLFWMeshRenderer::bound_state() const {
+  return {material_->shader_program(), material_,
+          gl_mesh_.vertex_array_key(instanced_)};
+}
 
-  // Draw.
-  static_assert(std::is_same<BufferIndex, std::uint32_t>::value,
-                "GLFWMeshRenderer assumes 32-bit unsigned BufferIndex.");
-  glDrawElements(GL_TRIANGLES, buffered_mesh_.indices().num_elements(),
-                 GL_UNSIGNED_INT, static_cast<void*>(0));
+void GLFWMeshRenderer::CompileMatrixVariables() {
+  const auto shader_program =
+      static_cast<const GLSLShaderProgram*>(material_->shader_program());
+  auto compile = [shader_program](const stl_string& name,
+                                  const std::uint8_t size,
+                                  ShaderProgram::CompiledVariable* variable) {
+    return shader_program->HasUniform(name) &&
+           shader_program->CompileVariable(name, PropertyType::FLOAT, size,
+                                           size, variable);
+  };
+  uses_model_matrix_ =
+      compile(ShaderProgram::StandardShaderArgumentNames::kModelMatrixArg, 4,
+              &model_matrix_variable_);
+  uses_model_view_matrix_ =
+      compile(ShaderProgram::StandardShaderArgumentNames::kModelViewMatrixArg,
+              4, &model_view_matrix_variable_);
+  uses_normal_matrix_ =
+      compile(ShaderProgram::StandardShaderArgumentNames::kNormalMatrixArg, 3,
+              &normal_matrix_variable_);
+  matrix_link_generation_ = shader_program->link_generation();
+}
+
+bool GLFWMeshRenderer::GetViewMatrix(const Entity& camera,
+                                     Matrix44f* view_matrix) {
+  const Camera* camera_component = camera.GetComponent<Camera>();
+  if (camera_component == nullptr) {
+    LOG(ERROR) << "Camera Entity needs Camera component.";
+    return false;
+  }
+  *view_matrix = camera_component->GetViewMatrix(camera.transform_);
+  return true;
+}
+
+void GLFWMeshRenderer::BindState(const BoundState& previous) {
+  const BoundState state = bound_state();
+  const bool program_changed = previous.shader_program == nullptr ||
+                               previous.shader_program != state.shader_program;
+  if (program_changed) {
+    material_->UseProgram();
+  }
+
+  // Set material properties on shader. These are shader program state, so
+  // another material on the same program would have replaced them.
+  if (program_changed || previous.material != state.material) {
+    material_->SetBoundVariables();
+  }
+
+  // Renderers of the same mesh share its vertex arrays, so one left bound
+  // by another renderer can be reused.
+  if (previous.vertex_array == nullptr ||
+      previous.vertex_array != state.vertex_array) {
+    // The vertex array holds attribute state and the index buffer binding.
+    GLFWStateCache::current()->BindVertexArray(
+        gl_mesh_.vertex_array_id(instanced_));
+  }
+}
+
+void GLFWMeshRenderer::UploadInstances(const Matrix44f& view_matrix,
+                                       const Transform* const* transforms,
+                                       const size_t num_instances) {
+  // Each instance has a 4x4 model-view matrix followed by a 3x3 normal
+  // matrix. OpenGL reads each matrix column as one attribute, so store
+  // transposes.
+  constexpr size_t kModelViewSize = 16;
+  constexpr size_t kNormalSize = 9;
+  constexpr size_t kInstanceSize = kModelViewSize + kNormalSize;
+
+  // Matrices are only needed until uploaded, so they're staged in frame
+  // memory.
+  const size_t num_floats = num_instances * kInstanceSize;
+  float* instance_matrices =
+      FrameAllocator::ForThread().AllocateArray<float>(num_floats);
+  for (size_t i = 0; i < num_instances; ++i) {
+    const Matrix44f model_view_matrix =
+        view_matrix * transforms[i]->TransformationMatrix3D();
+    const Matrix44f model_view_transpose = model_view_matrix.Transpose();
+    const Matrix33f normal_transpose =
+        TransformationMatrix::NormalMatrix3D(model_view_matrix).Transpose();
+    float* instance = instance_matrices + i * kInstanceSize;
+    std::copy(model_view_transpose.data(),
+              model_view_transpose.data() + kModelViewSize, instance);
+    std::copy(normal_transpose.data(), normal_transpose.data() + kNormalSize,
+              instance + kModelViewSize);
+  }
+
+  // Replacing the whole buffer lets the driver orphan storage still in use
+  // by earlier draws. The instanced vertex array already reads from it.
+  GLFWStateCache::current()->BindBuffer(GL_ARRAY_BUFFER,
+                                        gl_mesh_.instance_buffer_id());
+  glBufferData(GL_ARRAY_BUFFER, num_floats * sizeof(float), instance_matrices,
+               GL_STREAM_DRAW);
 }
 
 }  // namespace ogle
@@ -0,0 +1,280 @@
+/**
+ * @file glfw_state_cache.cc
+ * @brief Implements glfw_state_cache.h.
+ */
+
+#include "renderer/glfw_state_cache.h"
+#include <algorithm>
+#include <type_traits>
+#include "GL/glew.h"
+#include "GLFW/glfw3.h"
+
+namespace ogle {
+
+static_assert(std::is_same<GLenum, ::GLenum>::value &&
+                  std::is_same<GLuint, ::GLuint>::value,
+              "OpenGL primitive type replacements must match OpenGL.");
+
+constexpr GLuint GLFWStateCache::kMaxTextureUnits;
+constexpr GLuint GLFWStateCache::kUnknown;
+
+GLFWStateCache* GLFWStateCache::current_ = nullptr;
+
+namespace {
+
+/**
+ * @brief Queries an integer state value.
+ * @param name State to query.
+ * @return Value.
+ */
+GLint GetInteger(const GLenum name) {
+  GLint value = 0;
+  glGetIntegerv(name, &value);
+  return value;
+}
+
+}  // namespace
+
+GLFWStateCache::GLFWStateCache() { Invalidate(); }
+
+GLFWStateCache* GLFWStateCache::current() { return current_; }
+
+void GLFWStateCache::set_current(GLFWStateCache* cache) { current_ = cache; }
+
+void GLFWStateCache::Invalidate() {
+  program_ = kUnknown;
+  vertex_array_ = kUnknown;
+  std::fill(std::begin(buffers_), std::end(buffers_), kUnknown);
+  std::fill(std::begin(capabilities_), std::end(capabilities_), kUnknown);
+  depth_function_ = kUnknown;
+  depth_mask_ = kUnknown;
+  cull_face_ = kUnknown;
+  front_face_ = kUnknown;
+  blend_source_factor_ = kUnknown;
+  blend_destination_factor_ = kUnknown;
+  active_texture_unit_ = kUnknown;
+  std::fill(std::begin(textures_), std::end(textures_), kUnknown);
+}
+
+bool GLFWStateCache::Validate() const {
+  bool valid = true;
+  auto check = [&valid](const char* name, const GLuint shadow,
+                        const GLint actual) {
+    if (shadow != kUnknown && shadow != static_cast<GLuint>(actual)) {
+      LOG(ERROR) << "GL state cache has " << name << "=" << shadow
+                 << ", but context has " << actual << ".";
+      valid = false;
+    }
+  };
+  check("program", program_, GetInteger(GL_CURRENT_PROGRAM));
+  check("vertex array", vertex_array_, GetInteger(GL_VERTEX_ARRAY_BINDING));
+  check("array buffer", buffers_[kArrayBuffer],
+        GetInteger(GL_ARRAY_BUFFER_BINDING));
+  check("element array buffer", buffers_[kElementArrayBuffer],
+        GetInteger(GL_ELEMENT_ARRAY_BUFFER_BINDING));
+  check("uniform buffer", buffers_[kUniformBuffer],
+        GetInteger(GL_UNIFORM_BUFFER_BINDING));
+  check("depth test", capabilities_[kDepthTest], glIsEnabled(GL_DEPTH_TEST));
+  check("face culling", capabilities_[kCullFace], glIsEnabled(GL_CULL_FACE));
+  check("blending", capabilities_[kBlend], glIsEnabled(GL_BLEND));
+  check("depth function", depth_function_, GetInteger(GL_DEPTH_FUNC));
+  check("depth mask", depth_mask_, GetInteger(GL_DEPTH_WRITEMASK));
+  check("cull face", cull_face_, GetInteger(GL_CULL_FACE_MODE));
+  check("front face", front_face_, GetInteger(GL_FRONT_FACE));
+  check("blend source factor", blend_source_factor_,
+        GetInteger(GL_BLEND_SRC_RGB));
+  check("blend destination factor", blend_destination_factor_,
+        GetInteger(GL_BLEND_DST_RGB));
+
+  // Texture bindings are queried per unit, so switch units and switch back.
+  const GLint active_texture = GetInteger(GL_ACTIVE_TEXTURE);
+  check("active texture unit", active_texture_unit_,
+        active_texture - GL_TEXTURE0);
+  const GLuint num_units = std::min<GLuint>(
+      kMaxTextureUnits, GetInteger(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS));
+  for (GLuint unit = 0; unit < num_units; ++unit) {
+    if (textures_[unit] != kUnknown) {
+      glActiveTexture(GL_TEXTURE0 + unit);
+      check("2D texture", textures_[unit], GetInteger(GL_TEXTURE_BINDING_2D));
+    }
+  }
+  glActiveTexture(active_texture);
+  return valid;
+}
+
+void GLFWStateCache::UseProgram(const GLuint program) {
+  if (Update(&program_, program)) {
+    glUseProgram(program);
+  }
+}
+
+void GLFWStateCache::BindVertexArray(const GLuint vertex_array) {
+  if (Update(&vertex_array_, vertex_array)) {
+    glBindVertexArray(vertex_array);
+    buffers_[kElementArrayBuffer] = kUnknown;
+  }
+}
+
+void GLFWStateCache::BindBuffer(const GLenum target, const GLuint buffer) {
+  const int index = BufferTargetIndex(target);
+  if (index < 0 || Update(&buffers_[index], buffer)) {
+    if (index < 0) {
+      ++frame_statistics_.num_issued_calls;
+    }
+    glBindBuffer(target, buffer);
+  }
+}
+
+void GLFWStateCache::SetEnabled(const GLenum capability, const bool enabled) {
+  const int index = CapabilityIndex(capability);
+  if (index < 0) {
+    ++frame_statistics_.num_issued_calls;
+  } else if (!Update(&capabilities_[index], enabled ? 1 : 0)) {
+    return;
+  }
+  if (enabled) {
+    glEnable(capability);
+  } else {
+    glDisable(capability);
+  }
+}
+
+void GLFWStateCache::DepthFunc(const GLenum function) {
+  if (Update(&depth_function_, function)) {
+    glDepthFunc(function);
+  }
+}
+
+void GLFWStateCache::DepthMask(const bool enabled) {
+  if (Update(&depth_mask_, enabled ? 1 : 0)) {
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+  }
+}
+
+void GLFWStateCache::CullFace(const GLenum mode) {
+  if (Update(&cull_face_, mode)) {
+    glCullFace(mode);
+  }
+}
+
+void GLFWStateCache::FrontFace(const GLenum mode) {
+  if (Update(&front_face_, mode)) {
+    glFrontFace(mode);
+  }
+}
+
+void GLFWStateCache::BlendFunc(const GLenum source_factor,
+                               const GLenum destination_factor) {
+  if (blend_source_factor_ == source_factor &&
+      blend_destination_factor_ == destination_factor) {
+    ++frame_statistics_.num_filtered_calls;
+    return;
+  }
+  blend_source_factor_ = source_factor;
+  blend_destination_factor_ = destination_factor;
+  ++frame_statistics_.num_issued_calls;
+  glBlendFunc(source_factor, destination_factor);
+}
+
+void GLFWStateCache::BindTexture(const GLuint unit, const GLenum target,
+                                 const GLuint texture) {
+  if (target != GL_TEXTURE_2D || unit >= kMaxTextureUnits) {
+    ActiveTexture(unit);
+    ++frame_statistics_.num_issued_calls;
+    glBindTexture(target, texture);
+    return;
+  }
+  if (textures_[unit] == texture) {
+    ++frame_statistics_.num_filtered_calls;
+    return;
+  }
+  ActiveTexture(unit);
+  Update(&textures_[unit], texture);
+  glBindTexture(target, texture);
+}
+
+void GLFWStateCache::ForgetProgram(const GLuint program) {
+  if (program_ == program) {
+    program_ = kUnknown;
+  }
+}
+
+void GLFWStateCache::ForgetVertexArray(const GLuint vertex_array) {
+  if (vertex_array_ == vertex_array) {
+    vertex_array_ = kUnknown;
+    buffers_[kElementArrayBuffer] = kUnknown;
+  }
+}
+
+void GLFWStateCache::ForgetBuffer(const GLuint buffer) {
+  for (auto& bound_buffer : buffers_) {
+    if (bound_buffer == buffer) {
+      bound_buffer = kUnknown;
+    }
+  }
+}
+
+void GLFWStateCache::ForgetTexture(const GLuint texture) {
+  for (auto& bound_texture : textures_) {
+    if (bound_texture == texture) {
+      bound_texture = kUnknown;
+    }
+  }
+}
+
+int GLFWStateCache::BufferTargetIndex(const GLenum target) {
+  switch (target) {
+    case GL_ARRAY_BUFFER:
+      return kArrayBuffer;
+    case GL_ELEMENT_ARRAY_BUFFER:
+      return kElementArrayBuffer;
+    case GL_UNIFORM_BUFFER:
+      return kUniformBuffer;
+    default:
+      return -1;
+  }
+}
+
+int GLFWStateCache::CapabilityIndex(const GLenum capability) {
+  switch (capability) {
+    case GL_DEPTH_TEST:
+      return kDepthTest;
+    case GL_CULL_FACE:
+      return kCullFace;
+    case GL_BLEND:
+      return kBlend;
+    default:
+      return -1;
+  }
+}
+
+void GLFWStateCache::EndFrame() {
+  statistics_ = frame_statistics_;
+  frame_statistics_ = Statistics();
+}
+
+const GLFWStateCache::Statistics& GLFWStateCache::statistics() const {
+  return statistics_;
+}
+
+const GLFWStateCache::Statistics& GLFWStateCache::frame_statistics() const {
+  return frame_statistics_;
+}
+
+bool GLFWStateCache::Update(GLuint* shadow, const GLuint value) {
+  if (*shadow == value) {
+    ++frame_statistics_.num_filtered_calls;
+    return false;
+  }
+  *shadow = value;
+  ++frame_statistics_.num_issued_calls;
+  return true;
+}
+
+void GLFWStateCache::ActiveTexture(const GLuint unit) {
+  if (Update(&active_texture_unit_, unit)) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+  }
+}
+
+}  // namespace ogle
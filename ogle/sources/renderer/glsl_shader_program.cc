@@ -8,6 +8,8 @@
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "entity/property.h"
+#include "renderer/frame_constants.h"
+#include "renderer/glfw_state_cache.h"
 #include "renderer/glsl_shader.h"
 #include "resource/resource_metadata.h"
 
@@ -33,6 +35,17 @@ bool GLSLShaderProgram::Create() {
     return false;
   }
 
+  GLFWStateCache* gl_state = GLFWStateCache::current();
+  if (gl_state == nullptr) {
+    LOG(ERROR) << "No OpenGL context to create shader program in.";
+    return false;
+  }
+
+  // Relinking may change variable locations.
+  gl_state->ForgetProgram(program_id_);
+  glDeleteProgram(program_id_);
+  variable_ids_.clear();
+
   program_id_ = glCreateProgram();
   if (program_id_ == 0) {
     LOG(ERROR) << "glCreateProgram() failed.";
@@ -55,10 +68,21 @@ bool GLSLShaderProgram::Create() {
     LOG(ERROR) << log;
     return false;
   }
+
+  // Attach per-frame constants, if the program reads them.
+  const GLuint block_index =
+      glGetUniformBlockIndex(program_id_, FrameConstants::kBlockName.c_str());
+  if (block_index != GL_INVALID_INDEX) {
+    glUniformBlockBinding(program_id_, block_index,
+                          FrameConstants::kBindingPoint);
+  }
+  ++link_generation_;
   return true;
 }
 
-void GLSLShaderProgram::UseProgram() { glUseProgram(program_id_); }
+void GLSLShaderProgram::UseProgram() {
+  GLFWStateCache::current()->UseProgram(program_id_);
+}
 
 void GLSLShaderProgram::SetVariable(const stl_string& variable_name,
                                     const Property& variable) {
@@ -94,6 +118,77 @@ void GLSLShaderProgram::SetVariable(const stl_string& variable_name,
   }
 }
 
+bool GLSLShaderProgram::HasAttribute(const stl_string& attribute_name) const {
+  return glGetAttribLocation(program_id_, attribute_name.c_str()) != -1;
+}
+
+bool GLSLShaderProgram::HasUniform(const stl_string& variable_name) const {
+  return glGetUniformLocation(program_id_, variable_name.c_str()) != -1;
+}
+
+bool GLSLShaderProgram::CompileVariable(const stl_string& variable_name,
+                                        const PropertyType type,
+                                        const std::uint8_t rows,
+                                        const std::uint8_t columns,
+                                        CompiledVariable* compiled) const {
+  if (type != PropertyType::FLOAT) {
+    LOG(ERROR) << "Only floats are currently supported in CompileVariable: "
+               << variable_name;
+    return false;
+  }
+  const bool scalar = rows == 1 && columns == 1;
+  const bool vector = rows >= 2 && rows <= 4 && columns == 1;
+  const bool matrix = rows >= 2 && rows <= 4 && columns == rows;
+  if (!(scalar || vector || matrix)) {
+    LOG(ERROR) << "Unsupported shader variable size " << int(rows) << "x"
+               << int(columns) << ": " << variable_name;
+    return false;
+  }
+  const GLint location =
+      glGetUniformLocation(program_id_, variable_name.c_str());
+  if (location == -1) {
+    LOG(ERROR) << "Could not find uniform on program " << program_id_ << ": "
+               << variable_name;
+    return false;
+  }
+  *compiled = {location, type, rows, columns, nullptr};
+  return true;
+}
+
+void GLSLShaderProgram::SetCompiledVariable(const CompiledVariable& variable,
+                                            const void* data) {
+  const GLfloat* values = static_cast<const GLfloat*>(data);
+  if (variable.columns == 1) {
+    switch (variable.rows) {
+      case 1:
+        glUniform1fv(variable.location, 1, values);
+        break;
+      case 2:
+        glUniform2fv(variable.location, 1, values);
+        break;
+      case 3:
+        glUniform3fv(variable.location, 1, values);
+        break;
+      case 4:
+        glUniform4fv(variable.location, 1, values);
+        break;
+    }
+  } else {
+    // Let OpenGL transpose from row-major, instead of copying.
+    switch (variable.rows) {
+      case 2:
+        glUniformMatrix2fv(variable.location, 1, GL_TRUE, values);
+        break;
+      case 3:
+        glUniformMatrix3fv(variable.location, 1, GL_TRUE, values);
+        break;
+      case 4:
+        glUniformMatrix4fv(variable.location, 1, GL_TRUE, values);
+        break;
+    }
+  }
+}
+
 GLint GLSLShaderProgram::GetUniformLocation(const stl_string& variable) {
   // Getting uniform location is slow. Cache it.
   auto it = variable_ids_.find(variable);
@@ -5,7 +5,6 @@
 
 #include "renderer/material.h"
 #include "file_system/text_file.h"
-#include "renderer/shader_program.h"
 #include "resource/resource_manager.h"
 #include "util/string_utils.h"
 
@@ -22,7 +21,10 @@ const stl_string Material::StandardPropertyName::kSpecularExponent =
 
 const stl_string Material::kMTLImplementation = "mtl";
 
-Material::Material(const ResourceMetadata& metadata) : Resource(metadata) {}
+Material::Material(const ResourceMetadata& metadata)
+    : Resource(metadata),
+      shader_program_(nullptr),
+      compiled_link_generation_(0) {}
 
 const stl_string Material::implementation() const {
   return shader_program_->implementation();
@@ -65,6 +67,7 @@ std::unique_ptr<Material> Material::Load(const ResourceMetadata& metadata,
 }
 
 bool Material::LoadMTL(const stl_string& text) {
+  compiled_link_generation_ = 0;
   int newmtl_count = 0;
   for (const auto& line : StringUtils::Split(text, '\n')) {
     const auto trimmed_line = StringUtils::Trim(line, " \t\n\r");
@@ -79,11 +82,11 @@ bool Material::LoadMTL(const stl_string& text) {
         LOG(ERROR) << "Not enough tokens to read Vector3f.";
         return false;
       }
-      std::vector<float> values = {std::stof(tokens[1]), std::stof(tokens[2]),
-                                   std::stof(tokens[3])};
+      stl_vector<float> values = {std::stof(tokens[1]), std::stof(tokens[2]),
+                                  std::stof(tokens[3])};
       variable_bindings_.emplace_back(
           AllocateObject<PropertyInstance<float>>(
-              name, std::vector<PropertyDimIndex>({3}), values.data()));
+              name, stl_vector<PropertyDimIndex>({3}), values.data()));
       return true;
     };
 
@@ -107,7 +110,7 @@ bool Material::LoadMTL(const stl_string& text) {
         float float_val = std::stof(tokens[1]);
         variable_bindings_.emplace_back(AllocateObject<PropertyInstance<float>>(
             stl_string(StandardPropertyName::kSpecularExponent),
-            std::vector<PropertyDimIndex>(), &float_val));
+            stl_vector<PropertyDimIndex>(), &float_val));
       }
     }
     if (!ok) {
@@ -118,6 +121,10 @@ bool Material::LoadMTL(const stl_string& text) {
   return true;
 }
 
+const ShaderProgram* Material::shader_program() const {
+  return shader_program_;
+}
+
 void Material::UseProgram() { shader_program_->UseProgram(); }
 
 void Material::SetVariable(const Property &variable) {
@@ -128,10 +135,31 @@ void Material::SetVariable(const stl_string& name, const Property& variable) {
   shader_program_->SetVariable(name, variable);
 }
 
+void Material::SetCompiledVariable(
+    const ShaderProgram::CompiledVariable& variable, const void* data) {
+  shader_program_->SetCompiledVariable(variable, data);
+}
+
 void Material::SetBoundVariables() {
+  if (compiled_link_generation_ == 0 ||
+      compiled_link_generation_ != shader_program_->link_generation()) {
+    CompileBindings();
+  }
+  for (const auto& variable : compiled_bindings_) {
+    shader_program_->SetCompiledVariable(variable, variable.data);
+  }
+}
+
+void Material::CompileBindings() {
+  compiled_bindings_.clear();
   for (const auto& variable : variable_bindings_) {
-    SetVariable(*variable.get());
+    ShaderProgram::CompiledVariable compiled;
+    if (shader_program_->CompileVariable(variable->name(), *variable.get(),
+                                         &compiled)) {
+      compiled_bindings_.push_back(compiled);
+    }
   }
+  compiled_link_generation_ = shader_program_->link_generation();
 }
 
 }  // namespace ogle
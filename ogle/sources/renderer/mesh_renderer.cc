@@ -5,6 +5,8 @@
 
 #include "renderer/mesh_renderer.h"
 #include "config/configuration.h"
+#include "geometry/mesh.h"
+#include "renderer/buffered_mesh.h"
 #include "renderer/glfw_mesh_renderer.h"
 #include "renderer/glsl_shader_program.h"
 #include "renderer/material.h"
@@ -39,4 +41,12 @@ MeshRenderer* MeshRenderer::Load(const Configuration& configuration,
 MeshRenderer::MeshRenderer(const BufferedMesh& mesh)
     : Renderer(), buffered_mesh_(mesh) {}
 
+const Bounds* MeshRenderer::local_bounds() const {
+  return &buffered_mesh_.mesh().bounds();
+}
+
+const TriangleBVH* MeshRenderer::local_bvh() const {
+  return buffered_mesh_.mesh().bvh();
+}
+
 }  // namespace ogle
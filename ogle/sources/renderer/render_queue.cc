@@ -0,0 +1,110 @@
+/**
+ * @file render_queue.cc
+ * @brief Implements render_queue.h.
+ */
+
+#include "renderer/render_queue.h"
+#include <cstring>
+#include "renderer/renderer.h"
+
+namespace ogle {
+
+constexpr int RenderQueue::kLayerBits;
+constexpr int RenderQueue::kShaderProgramBits;
+constexpr int RenderQueue::kMaterialBits;
+constexpr int RenderQueue::kVertexArrayBits;
+constexpr int RenderQueue::kDepthBits;
+
+static_assert(RenderQueue::kLayerBits + RenderQueue::kShaderProgramBits +
+                      RenderQueue::kMaterialBits +
+                      RenderQueue::kVertexArrayBits +
+                      RenderQueue::kDepthBits ==
+                  64,
+              "Sort key fields must fill 64 bits.");
+
+namespace {
+
+/// Bits sorted per radix sort pass.
+constexpr int kRadixBits = 8;
+
+/// Buckets per radix sort pass.
+constexpr int kRadixBuckets = 1 << kRadixBits;
+
+}  // namespace
+
+void RenderQueue::Clear() { items_.clear(); }
+
+void RenderQueue::Add(Renderer* renderer, const Transform* transform,
+                      const float depth) {
+  const Renderer::BoundState state = renderer->bound_state();
+  SortKey key = renderer->layer();
+  key = (key << kShaderProgramBits) |
+        SortID(state.shader_program, kShaderProgramBits, &shader_program_ids_);
+  key = (key << kMaterialBits) |
+        SortID(state.material, kMaterialBits, &material_ids_);
+  key = (key << kVertexArrayBits) |
+        SortID(state.vertex_array, kVertexArrayBits, &vertex_array_ids_);
+  key = (key << kDepthBits) | QuantizeDepth(depth);
+  items_.push_back({key, renderer, transform});
+}
+
+void RenderQueue::Sort() {
+  const size_t num_items = items_.size();
+  sort_buffer_.resize(num_items);
+  for (int shift = 0; shift < 64; shift += kRadixBits) {
+    size_t offsets[kRadixBuckets] = {0};
+    for (const auto& item : items_) {
+      ++offsets[(item.key >> shift) & (kRadixBuckets - 1)];
+    }
+
+    // Skip the pass if every key has the same digit, which is common for
+    // the layer and any state shared by the whole scene.
+    if (num_items == 0 ||
+        offsets[(items_[0].key >> shift) & (kRadixBuckets - 1)] == num_items) {
+      continue;
+    }
+
+    size_t total = 0;
+    for (auto& offset : offsets) {
+      const size_t count = offset;
+      offset = total;
+      total += count;
+    }
+    for (const auto& item : items_) {
+      sort_buffer_[offsets[(item.key >> shift) & (kRadixBuckets - 1)]++] = item;
+    }
+    items_.swap(sort_buffer_);
+  }
+}
+
+const stl_vector<RenderQueue::Item>& RenderQueue::items() const {
+  return items_;
+}
+
+RenderQueue::SortKey RenderQueue::QuantizeDepth(const float depth) {
+  // Also maps -0 and NaN to 0.
+  const float clamped_depth = depth > 0.f ? depth : 0.f;
+  std::uint32_t bits;
+  std::memcpy(&bits, &clamped_depth, sizeof(bits));
+  return bits >> (32 - kDepthBits);
+}
+
+RenderQueue::SortKey RenderQueue::SortID(
+    const void* object, const int num_bits,
+    stl_unordered_map<const void*, SortKey>* ids) {
+  if (object == nullptr) {
+    return 0;
+  }
+  auto iter = ids->find(object);
+  if (iter != ids->end()) {
+    return iter->second;
+  }
+  if (ids->size() + 1 >= (SortKey(1) << num_bits)) {
+    ids->clear();
+  }
+  const SortKey id = ids->size() + 1;
+  ids->emplace(object, id);
+  return id;
+}
+
+}  // namespace ogle
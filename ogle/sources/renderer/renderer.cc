@@ -12,7 +12,38 @@ const stl_string Renderer::kConfigModule = "render";
 const stl_string Renderer::kConfigAttributeImplementation = "implementation";
 
 Renderer::Renderer()
-  : Component(ComponentType::RENDERER) {
+  : Component(ComponentType::RENDERER), layer_(0) {
 }
 
+void Renderer::Render(const Transform& transform, const Entity& camera,
+                      const stl_vector<const Entity*>& lights,
+                      const BoundState& previous) {
+  Render(transform, camera, lights);
+}
+
+bool Renderer::CanInstance(const Renderer& other) const { return false; }
+
+void Renderer::RenderInstanced(const stl_vector<const Transform*>& transforms,
+                               const Entity& camera,
+                               const stl_vector<const Entity*>& lights,
+                               const BoundState& previous) {
+  BoundState bound = previous;
+  for (const Transform* transform : transforms) {
+    Render(*transform, camera, lights, bound);
+    bound = bound_state();
+  }
+}
+
+Renderer::BoundState Renderer::bound_state() const {
+  return {nullptr, nullptr, nullptr};
+}
+
+const Bounds* Renderer::local_bounds() const { return nullptr; }
+
+const TriangleBVH* Renderer::local_bvh() const { return nullptr; }
+
+std::uint8_t Renderer::layer() const { return layer_; }
+
+void Renderer::set_layer(const std::uint8_t layer) { layer_ = layer; }
+
 }  // namespace ogle
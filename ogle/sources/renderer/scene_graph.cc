@@ -4,11 +4,67 @@
  */
 
 #include "renderer/scene_graph.h"
+#include "geometry/triangle_bvh.h"
+#include "renderer/renderer.h"
 
 namespace ogle {
 
 SceneGraph::SceneGraph()
   : root_(AllocateUniqueObject<Entity>(nullptr)) {
+  root_->transform_.set_spatial_index(&spatial_index_);
+}
+
+SceneGraph::~SceneGraph() {
+  root_->transform_.set_spatial_index(nullptr);
+}
+
+const AABBTree& SceneGraph::spatial_index() {
+  spatial_index_.Update();
+  return spatial_index_;
+}
+
+Entity* SceneGraph::Pick(const Ray<float, 3>& ray, const float max_distance,
+                         float* distance) {
+  Entity* nearest_entity = nullptr;
+  float nearest_distance = max_distance;
+  spatial_index().RayCast(ray, max_distance, [&](const std::int32_t proxy) {
+    Transform* transform = spatial_index_.transform(proxy);
+    Entity* entity = transform->entity();
+    const Renderer* renderer =
+        (entity != nullptr) ? entity->GetComponent<Renderer>() : nullptr;
+    const TriangleBVH* bvh =
+        (renderer != nullptr) ? renderer->local_bvh() : nullptr;
+    Matrix44f world_to_local;
+    if (bvh == nullptr ||
+        !transform->TransformationMatrix3D().Inverse(&world_to_local)) {
+      return nearest_distance;
+    }
+
+    // The BVH is in local space, where distances along the ray are scaled by
+    // the length of its transformed direction.
+    Vector3f local_origin;
+    Vector3f local_direction;
+    for (MatrixIndex i = 0; i < 3; ++i) {
+      local_origin(i) = world_to_local(i, 3);
+      local_direction(i) = 0.f;
+      for (MatrixIndex j = 0; j < 3; ++j) {
+        local_origin(i) += world_to_local(i, j) * ray.origin_(j);
+        local_direction(i) += world_to_local(i, j) * ray.direction_(j);
+      }
+    }
+    const float scale = local_direction.Norm();
+    TriangleBVH::Hit hit;
+    if (bvh->ClosestHit(Ray<float, 3>(local_origin, local_direction),
+                        nearest_distance * scale, &hit)) {
+      nearest_entity = entity;
+      nearest_distance = hit.distance / scale;
+    }
+    return nearest_distance;
+  });
+  if (distance != nullptr && nearest_entity != nullptr) {
+    *distance = nearest_distance;
+  }
+  return nearest_entity;
 }
 
 }  // namespace ogle
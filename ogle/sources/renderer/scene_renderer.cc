@@ -5,36 +5,196 @@
 
 #include "renderer/scene_renderer.h"
 #include "easylogging++.h"  // NOLINT
+#include "config/configuration.h"
 #include "entity/entity.h"
 #include "renderer/camera.h"
+#include "renderer/glfw_state_cache.h"
 #include "renderer/renderer.h"
 #include "renderer/scene_graph.h"
+#include "std/allocation_counter.h"
 
 namespace ogle {
 
+const stl_string SceneRenderer::kConfigAttributeValidateState =
+    "validate_state";
+
+bool SceneRenderer::Create(const Configuration& configuration) {
+  frame_constants_buffer_ = FrameConstantsBuffer::Load(configuration);
+  if (!frame_constants_buffer_) {
+    LOG(ERROR) << "Failed to create frame constants buffer.";
+    return false;
+  }
+  const auto validate_state_config = configuration.Get<bool>(
+      Renderer::kConfigModule, kConfigAttributeValidateState);
+  validate_state_ =
+      validate_state_config.second && validate_state_config.first;
+  return true;
+}
+
 void SceneRenderer::RenderScene(const Entity& camera_entity,
                                 const stl_vector<const Entity*>& light_entities,
                                 SceneGraph* scene_graph) {
-  // This is the dumbest possible solution: just iterate through the entire
-  // graph and draw objects in the order they are encountered.
+  MemoryScope memory_scope(MemoryTag::RENDERER);
   if (scene_graph->root_ == nullptr) {
     LOG(ERROR) << "Scene graph has no root.";
-  } else if (camera_entity.GetComponent<Camera>() == nullptr) {
-    LOG(ERROR) << "Camera Entity for RenderScene has no Camera attached.";
+  } else if (frame_constants_buffer_ == nullptr) {
+    LOG(ERROR) << "SceneRenderer must be created before rendering.";
+  } else if (frame_constants_.Set(camera_entity, light_entities)) {
+    const auto num_allocations = AllocationCounter::num_allocations();
+    const GLFWStateCache* gl_state = GLFWStateCache::current();
+    const GLFWStateCache::Statistics gl_statistics =
+        (gl_state != nullptr) ? gl_state->frame_statistics() :
+                                GLFWStateCache::Statistics();
+    statistics_ = RenderQueue::Statistics();
+    frame_constants_buffer_->Update(frame_constants_);
+    render_queue_.Clear();
+    cull_bounds_.Clear();
+    cull_candidates_.clear();
+    Enqueue(camera_entity, scene_graph->root_.get());
+    Cull(camera_entity);
+    render_queue_.Sort();
+    Submit(camera_entity, light_entities);
+    statistics_.num_allocations =
+        AllocationCounter::num_allocations() - num_allocations;
+    if (gl_state != nullptr) {
+      statistics_.num_api_state_calls =
+          gl_state->frame_statistics().num_issued_calls -
+          gl_statistics.num_issued_calls;
+      statistics_.num_api_state_calls_saved =
+          gl_state->frame_statistics().num_filtered_calls -
+          gl_statistics.num_filtered_calls;
+      if (validate_state_) {
+        gl_state->Validate();
+      }
+    }
+    VLOG(1) << "Culled " << statistics_.num_culled << " of "
+            << statistics_.num_tested << " objects, and rendered "
+            << statistics_.num_instances << " objects in "
+            << statistics_.num_draws << " draws with "
+            << statistics_.num_state_changes << " state changes, saved "
+            << statistics_.num_state_changes_saved << ", issued "
+            << statistics_.num_api_state_calls << " API state calls, saved "
+            << statistics_.num_api_state_calls_saved << ", and made "
+            << statistics_.num_allocations << " allocations.";
+  }
+}
+
+const RenderQueue::Statistics& SceneRenderer::statistics() const {
+  return statistics_;
+}
+
+void SceneRenderer::Enqueue(const Entity& camera_entity, Entity* entity) {
+  const Camera* camera = camera_entity.GetComponent<Camera>();
+  if (camera == nullptr) {
+    LOG(ERROR) << "Camera Entity needs Camera component.";
+    frustum_ = Frustum();
   } else {
-    Render(camera_entity, light_entities, scene_graph->root_.get());
+    frustum_ = camera->GetFrustum(camera_entity.transform_);
   }
+  entity->transform_.RefitBounds();
+  EnqueueSubtree(camera_entity, &entity->transform_, Frustum::kAllPlanes);
 }
 
-void SceneRenderer::Render(const Entity& camera_entity,
-                           const stl_vector<const Entity*>& light_entities,
-                           Entity *entity) {
-  Renderer* renderer = entity->GetComponent<Renderer>();
+void SceneRenderer::EnqueueSubtree(const Entity& camera_entity,
+                                   Transform* transform,
+                                   std::uint8_t plane_mask) {
+  Entity* entity = transform->entity();
+  Renderer* renderer =
+      (entity != nullptr) ? entity->GetComponent<Renderer>() : nullptr;
+  if (plane_mask != 0 && !transform->subtree_unbounded()) {
+    // Leaves are held back to be tested in batches.
+    if (transform->children().empty()) {
+      if (renderer != nullptr && transform->has_object_bounds()) {
+        cull_bounds_.Add(transform->object_bounds());
+        cull_candidates_.push_back({renderer, transform});
+      }
+      return;
+    }
+    ++statistics_.num_tested;
+    if (!frustum_.Intersects(transform->subtree_bounds(), &plane_mask)) {
+      statistics_.num_culled += transform->subtree_num_bounded();
+      return;
+    }
+  }
+
+  // Objects in a subtree entirely inside the frustum need no more tests.
   if (renderer != nullptr) {
-    renderer->Render(entity->transform_, camera_entity, light_entities);
+    if (plane_mask == 0 || !transform->has_object_bounds()) {
+      QueueDraw(camera_entity, renderer, transform);
+    } else {
+      cull_bounds_.Add(transform->object_bounds());
+      cull_candidates_.push_back({renderer, transform});
+    }
   }
-  for (Transform* child_transform : entity->transform_.children()) {
-    Render(camera_entity, light_entities, child_transform->entity());
+  for (Transform* child_transform : transform->children()) {
+    EnqueueSubtree(camera_entity, child_transform, plane_mask);
+  }
+}
+
+void SceneRenderer::QueueDraw(const Entity& camera_entity, Renderer* renderer,
+                              const Transform* transform) {
+  const auto offset =
+      transform->world_position() - camera_entity.transform_.world_position();
+  render_queue_.Add(renderer, transform, offset.NormSquared());
+}
+
+void SceneRenderer::Cull(const Entity& camera_entity) {
+  const size_t num_visible = frustum_.Cull(cull_bounds_, &cull_visible_);
+  for (size_t index = 0; index < cull_candidates_.size(); ++index) {
+    if (cull_visible_[index]) {
+      QueueDraw(camera_entity, cull_candidates_[index].renderer,
+                cull_candidates_[index].transform);
+    }
+  }
+  statistics_.num_tested += cull_candidates_.size();
+  statistics_.num_culled += cull_candidates_.size() - num_visible;
+}
+
+void SceneRenderer::Submit(const Entity& camera_entity,
+                           const stl_vector<const Entity*>& light_entities) {
+  Renderer::BoundState bound = {nullptr, nullptr, nullptr};
+  const auto& items = render_queue_.items();
+  for (size_t i = 0; i < items.size();) {
+    const auto& item = items[i];
+    const Renderer::BoundState next = item.renderer->bound_state();
+
+    // Gather the run of items that can be drawn as instances of this one.
+    instance_transforms_.clear();
+    instance_transforms_.push_back(item.transform);
+    size_t end = i + 1;
+    while (end < items.size() &&
+           item.renderer->CanInstance(*items[end].renderer)) {
+      instance_transforms_.push_back(items[end].transform);
+      ++end;
+    }
+
+    // Material variables live in the shader program, so they are only kept
+    // if the program is.
+    const bool keep_program = bound.shader_program != nullptr &&
+                              bound.shader_program == next.shader_program;
+    const bool keep_material = keep_program && bound.material != nullptr &&
+                               bound.material == next.material;
+    const bool keep_vertex_array = bound.vertex_array != nullptr &&
+                                   bound.vertex_array == next.vertex_array;
+    for (const bool keep : {keep_program, keep_material, keep_vertex_array}) {
+      if (keep) {
+        ++statistics_.num_state_changes_saved;
+      } else {
+        ++statistics_.num_state_changes;
+      }
+    }
+
+    if (instance_transforms_.size() > 1) {
+      item.renderer->RenderInstanced(instance_transforms_, camera_entity,
+                                     light_entities, bound);
+    } else {
+      item.renderer->Render(*item.transform, camera_entity, light_entities,
+                            bound);
+    }
+    bound = next;
+    ++statistics_.num_draws;
+    statistics_.num_instances += instance_transforms_.size();
+    i = end;
   }
 }
 
@@ -14,6 +14,18 @@ const stl_string Shader::kVertexShaderSubType = "vertex";
 const stl_string Shader::kFragmentShaderSubType = "fragment";
 
 std::unique_ptr<Shader> Shader::Load(const ResourceMetadata& metadata) {
+  auto new_object = Read(metadata);
+  if (new_object == nullptr) {
+    return nullptr;
+  }
+  if (!new_object->Create()) {
+    LOG(ERROR) << "Shader Create() failed.";
+    return nullptr;
+  }
+  return new_object;
+}
+
+std::unique_ptr<Shader> Shader::Read(const ResourceMetadata& metadata) {
   if (metadata.type() != ResourceType::SHADER) {
     LOG(ERROR) << "Attempt to load Shader from incorrect metadata type: "
                << metadata.type();
@@ -41,13 +53,7 @@ std::unique_ptr<Shader> Shader::Load(const ResourceMetadata& metadata) {
   const auto implementation =
       metadata.Get<stl_string>(Resource::kImplementationField).first;
   if (implementation == GLSLShader::kImplementationName) {
-    auto new_object = AllocateUniqueObject<GLSLShader>(metadata, text, type);
-    if (new_object->Create()) {
-      return std::move(new_object);
-    } else {
-      LOG(ERROR) << "Shader Create() failed.";
-      return nullptr;
-    }
+    return AllocateUniqueObject<GLSLShader>(metadata, text, type);
   }
 
   LOG(ERROR) << "Unable to create Shader for implementation: "
@@ -15,6 +15,17 @@ namespace ogle {
 
 const stl_string ShaderProgram::StandardShaderArgumentNames::kModelMatrixArg =
     "model_matrix";
+const stl_string
+    ShaderProgram::StandardShaderArgumentNames::kModelViewMatrixArg =
+        "model_view_matrix";
+const stl_string ShaderProgram::StandardShaderArgumentNames::kNormalMatrixArg =
+    "normal_matrix";
+const stl_string
+    ShaderProgram::StandardShaderArgumentNames::kInstanceModelViewMatrixArg =
+        "instance_model_view_matrix";
+const stl_string
+    ShaderProgram::StandardShaderArgumentNames::kInstanceNormalMatrixArg =
+        "instance_normal_matrix";
 const stl_string ShaderProgram::StandardShaderArgumentNames::kViewMatrixArg =
     "view_matrix";
 const stl_string
@@ -107,7 +118,37 @@ std::unique_ptr<ShaderProgram> ShaderProgram::Link(
   return nullptr;
 }
 
+bool ShaderProgram::CompileVariable(const stl_string& variable_name,
+                                    const Property& value,
+                                    CompiledVariable* compiled) const {
+  const auto& dims = value.dims();
+  std::uint8_t rows = 1;
+  std::uint8_t columns = 1;
+  if (value.IsVector()) {
+    rows = static_cast<std::uint8_t>(dims[0]);
+  } else if (value.IsMatrix()) {
+    rows = static_cast<std::uint8_t>(dims[0]);
+    columns = static_cast<std::uint8_t>(dims[1]);
+  } else if (!value.IsSingle()) {
+    LOG(ERROR) << "Unsupported shader property dimension: " << dims.size();
+    return false;
+  }
+  if (!value.data()) {
+    LOG(ERROR) << "Cannot compile shader var from null data.";
+    return false;
+  }
+  if (!CompileVariable(variable_name, value.Type(), rows, columns, compiled)) {
+    return false;
+  }
+  compiled->data = value.data();
+  return true;
+}
+
+std::uint32_t ShaderProgram::link_generation() const {
+  return link_generation_;
+}
+
 ShaderProgram::ShaderProgram(const ResourceMetadata& metadata)
-    : Resource(metadata) {}
+    : Resource(metadata), link_generation_(0) {}
 
 }  // namespace ogle
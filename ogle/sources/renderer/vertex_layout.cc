@@ -0,0 +1,187 @@
+/**
+ * @file vertex_layout.cc
+ * @brief Implementation of vertex_layout.h.
+ */
+
+#include "renderer/vertex_layout.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "easylogging++.h"  // NOLINT
+
+namespace ogle {
+
+namespace {
+
+/// Alignment of attributes and vertices in interleaved layouts.
+constexpr std::uint32_t kInterleavedAlignment = 4;
+
+/**
+ * @brief Rounds a size up to a multiple of #kInterleavedAlignment.
+ */
+std::uint32_t AlignInterleaved(const std::uint32_t size) {
+  return (size + kInterleavedAlignment - 1) & ~(kInterleavedAlignment - 1);
+}
+
+/**
+ * @brief Converts a float to an integer component type.
+ * @param value Value to convert.
+ * @param normalized Whether to map the unit range onto the integer range.
+ * @return Converted value, clamped to the type's range.
+ */
+template <typename T>
+T ConvertComponent(const float value, const bool normalized) {
+  constexpr float kMin = static_cast<float>(std::numeric_limits<T>::min());
+  constexpr float kMax = static_cast<float>(std::numeric_limits<T>::max());
+  float scaled = value;
+  if (normalized) {
+    scaled = std::max(std::numeric_limits<T>::is_signed ? -1.f : 0.f,
+                      std::min(1.f, value)) * kMax;
+  }
+  return static_cast<T>(std::round(std::max(kMin, std::min(kMax, scaled))));
+}
+
+/**
+ * @brief Writes one converted component.
+ * @param value Value to write.
+ * @param normalized Whether to map the unit range onto the integer range.
+ * @param[out] destination Where to write component. May be unaligned.
+ */
+template <typename T>
+void WriteComponent(const float value, const bool normalized,
+                    std::uint8_t* destination) {
+  const T component = ConvertComponent<T>(value, normalized);
+  std::memcpy(destination, &component, sizeof(component));
+}
+
+}  // namespace
+
+constexpr std::uint32_t VertexLayout::kPositionLocation;
+constexpr std::uint32_t VertexLayout::kNormalLocation;
+constexpr std::uint32_t VertexLayout::kUVLocation;
+constexpr std::uint32_t VertexLayout::kInstanceModelViewMatrixLocation;
+constexpr std::uint32_t VertexLayout::kInstanceNormalMatrixLocation;
+
+const stl_string VertexLayout::kSplitLayoutName = "split";
+const stl_string VertexLayout::kInterleavedLayoutName = "interleaved";
+const stl_string VertexLayout::kInterleavedCompactLayoutName =
+    "interleaved_compact";
+
+VertexLayout::VertexLayout()
+  : interleaved_(false), stride_(0) {
+}
+
+const bool VertexLayout::FromName(const stl_string& name,
+                                  VertexLayout* layout) {
+  if (name == kSplitLayoutName) {
+    *layout = Split();
+  } else if (name == kInterleavedLayoutName) {
+    // 32 bytes per vertex.
+    *layout = Interleaved({
+        {VertexAttribute::POSITION, kPositionLocation, 3,
+         VertexComponentType::FLOAT, false, 0},
+        {VertexAttribute::NORMAL, kNormalLocation, 3,
+         VertexComponentType::FLOAT, false, 0},
+        {VertexAttribute::UV, kUVLocation, 2, VertexComponentType::FLOAT,
+         false, 0}});
+  } else if (name == kInterleavedCompactLayoutName) {
+    // 28 bytes per vertex; normals lose precision beyond 1/32767.
+    *layout = Interleaved({
+        {VertexAttribute::POSITION, kPositionLocation, 3,
+         VertexComponentType::FLOAT, false, 0},
+        {VertexAttribute::NORMAL, kNormalLocation, 3,
+         VertexComponentType::INT16, true, 0},
+        {VertexAttribute::UV, kUVLocation, 2, VertexComponentType::FLOAT,
+         false, 0}});
+  } else {
+    LOG(ERROR) << "Unknown vertex layout: " << name;
+    return false;
+  }
+  return true;
+}
+
+VertexLayout VertexLayout::Split() {
+  VertexLayout layout;
+  layout.attributes_ = {
+      {VertexAttribute::POSITION, kPositionLocation, 3,
+       VertexComponentType::FLOAT, false, 0},
+      {VertexAttribute::NORMAL, kNormalLocation, 3,
+       VertexComponentType::FLOAT, false, 0},
+      {VertexAttribute::UV, kUVLocation, 2, VertexComponentType::FLOAT,
+       false, 0}};
+  return layout;
+}
+
+VertexLayout VertexLayout::Interleaved(
+    const stl_vector<VertexAttributeFormat>& attributes) {
+  VertexLayout layout;
+  layout.interleaved_ = true;
+  layout.attributes_ = attributes;
+  std::uint32_t offset = 0;
+  for (auto& format : layout.attributes_) {
+    format.offset = offset;
+    offset = AlignInterleaved(
+        offset + format.num_components * ComponentSize(format.type));
+  }
+  layout.stride_ = offset;
+  return layout;
+}
+
+std::uint32_t VertexLayout::ComponentSize(const VertexComponentType type) {
+  switch (type) {
+    case VertexComponentType::FLOAT:
+      return sizeof(float);
+    case VertexComponentType::INT16:  // Fall through.
+    case VertexComponentType::UINT16:
+      return sizeof(std::uint16_t);
+    case VertexComponentType::INT8:  // Fall through.
+    case VertexComponentType::UINT8:
+      return sizeof(std::uint8_t);
+  }
+  LOG(FATAL) << "Unknown vertex component type.";
+  return 0;
+}
+
+void VertexLayout::PackAttribute(const VertexAttributeFormat& format,
+                                 const float* values, const int num_values,
+                                 std::uint8_t* vertex) {
+  const std::uint32_t component_size = ComponentSize(format.type);
+  std::uint8_t* destination = vertex + format.offset;
+  for (std::uint32_t index = 0; index < format.num_components; ++index) {
+    const float value =
+        (static_cast<int>(index) < num_values) ? values[index] : 0.f;
+    switch (format.type) {
+      case VertexComponentType::FLOAT:
+        std::memcpy(destination, &value, sizeof(value));
+        break;
+      case VertexComponentType::INT16:
+        WriteComponent<std::int16_t>(value, format.normalized, destination);
+        break;
+      case VertexComponentType::UINT16:
+        WriteComponent<std::uint16_t>(value, format.normalized, destination);
+        break;
+      case VertexComponentType::INT8:
+        WriteComponent<std::int8_t>(value, format.normalized, destination);
+        break;
+      case VertexComponentType::UINT8:
+        WriteComponent<std::uint8_t>(value, format.normalized, destination);
+        break;
+    }
+    destination += component_size;
+  }
+}
+
+const bool VertexLayout::interleaved() const {
+  return interleaved_;
+}
+
+std::uint32_t VertexLayout::stride() const {
+  return stride_;
+}
+
+const stl_vector<VertexAttributeFormat>& VertexLayout::attributes() const {
+  return attributes_;
+}
+
+}  // namespace ogle
@@ -8,6 +8,7 @@
 #include "algorithms/directed_graph.h"
 #include "file_system/directory.h"
 #include "geometry/mesh.h"
+#include "jobs/job_system.h"
 #include "renderer/material.h"
 #include "renderer/shader.h"
 #include "renderer/shader_program.h"
@@ -16,6 +17,17 @@
 
 namespace ogle {
 
+namespace {
+
+/// Number of metadata files parsed by each job.
+constexpr size_t kMetadataGrainSize = 16;
+
+}  // namespace
+
+ResourceManager::ResourceManager(JobSystem* job_system)
+  : job_system_(job_system) {
+}
+
 void ResourceManager::AddResourceDirectory(const FilePath& directory_path) {
   resource_dirs_.emplace_back(directory_path);
 }
@@ -32,7 +44,7 @@ const bool ResourceManager::LoadResource(const ResourceMetadata& metadata) {
       resource = std::move(Material::Load(metadata, this));
       break;
     case ResourceType::MESH:
-      resource = std::move(Mesh::Load(metadata));
+      resource = std::move(Mesh::Load(metadata, job_system_));
       break;
     case ResourceType::SHADER:
       resource = std::move(Shader::Load(metadata));
@@ -54,6 +66,7 @@ const bool ResourceManager::LoadResource(const ResourceMetadata& metadata) {
 }
 
 const bool ResourceManager::LoadResources() {
+  MemoryScope memory_scope(MemoryTag::RESOURCE);
   stl_list<FilePath> directories_to_search;
   for (const auto& resource_dir : resource_dirs_) {
     directories_to_search.emplace_back(resource_dir);
@@ -62,6 +75,7 @@ const bool ResourceManager::LoadResources() {
   using ResourceGraph = DirectedGraph<ResourceID, ResourceMetadata>;
   ResourceGraph resource_graph;
   stl_unordered_multimap<ResourceID, ResourceID> dependencies;
+  stl_vector<FilePath> metadata_paths;
   while (!directories_to_search.empty()) {
     const auto search_dir = directories_to_search.front();
     directories_to_search.pop_front();
@@ -72,7 +86,7 @@ const bool ResourceManager::LoadResources() {
       continue;
     }
 
-    // Load all resource metadata upfront, so resource dependencies can be
+    // Find all resource metadata upfront, so resource dependencies can be
     // tracked.
     for (const auto& directory_entry : contents.first) {
       const auto& entry_path = directory_entry.path();
@@ -80,26 +94,46 @@ const bool ResourceManager::LoadResources() {
         directories_to_search.emplace_back(entry_path);
       } else if (StringUtils::Lower(entry_path.Extension()) ==
                  ResourceMetadata::kFileExtension) {
-        auto metadata_result = ResourceMetadata::Load(entry_path);
-        if (!metadata_result.second) {
-          LOG(ERROR) << "Failed to load metadata from: " << entry_path;
-        } else {
-          const ResourceID& resource_id = metadata_result.first.id();
-          if (!resource_graph.AddNode(resource_id, metadata_result.first)) {
-            LOG(ERROR) << "Failed to track resource in dependency graph.";
-          } else {
-            const auto get_result = resource_graph.GetValue(resource_id);
-            CHECK(get_result.second == true)
-                << "Added resource not found in graph.";
-            for (const auto& dependency_id : get_result.first.dependencies()) {
-              dependencies.emplace(resource_id, dependency_id);
-            }
-          }
-        }
+        metadata_paths.emplace_back(entry_path);
       }
     }
   }
 
+  // Parse metadata files in parallel, then track them in order.
+  stl_vector<std::pair<ResourceMetadata, bool>> metadata_results(
+      metadata_paths.size());
+  auto load_metadata = [&](const size_t begin, const size_t end) {
+    MemoryScope job_memory_scope(MemoryTag::RESOURCE);
+    for (size_t index = begin; index < end; ++index) {
+      metadata_results[index] = ResourceMetadata::Load(metadata_paths[index]);
+    }
+  };
+  if (job_system_) {
+    job_system_->ParallelFor(0, metadata_paths.size(), kMetadataGrainSize,
+                             load_metadata);
+  } else {
+    load_metadata(0, metadata_paths.size());
+  }
+  for (size_t index = 0; index < metadata_paths.size(); ++index) {
+    auto& metadata_result = metadata_results[index];
+    if (!metadata_result.second) {
+      LOG(ERROR) << "Failed to load metadata from: " << metadata_paths[index];
+      continue;
+    }
+    const ResourceID& resource_id = metadata_result.first.id();
+    if (!resource_graph.AddNode(resource_id, metadata_result.first)) {
+      LOG(ERROR) << "Failed to track resource in dependency graph.";
+    } else {
+      const auto get_result = resource_graph.GetValue(resource_id);
+      CHECK(get_result.second == true)
+          << "Added resource not found in graph.";
+      for (const auto& dependency_id : get_result.first.dependencies()) {
+        dependencies.emplace(resource_id, dependency_id);
+      }
+    }
+  }
+  metadata_results.clear();
+
   // Add edges between dependencies.
   for (const auto& dependency : dependencies) {
     const ResourceID& resource_id = dependency.first;
@@ -111,21 +145,53 @@ const bool ResourceManager::LoadResources() {
   }
   dependencies.clear();
 
-  // Load resources, being careful of dependencies.
+  // Load resources, being careful of dependencies. Each wave holds resources
+  // whose dependencies are all loaded, so its resources are read in parallel.
+  // Graphics objects are then created here, before the next wave can use
+  // them.
+  stl_vector<std::unique_ptr<Resource>> loaded_resources;
   while (!resource_graph.Empty()) {
-    auto undependent_resources = resource_graph.GetMatches([](
-        const ResourceGraph::Node* node) { return node->neighbors().empty(); });
+    auto undependent_resources = resource_graph.TakeReady();
     if (undependent_resources.empty()) {
       LOG(ERROR) << "Unable to load remaining resources because of cyclic "
                  << "dependencies; bailing out.";
       return false;
     }
-    for (const auto& resource_data : undependent_resources) {
-      if (!LoadResource(*resource_data.second)) {
+
+    loaded_resources.clear();
+    loaded_resources.resize(undependent_resources.size());
+    auto read_resources = [&](const size_t begin, const size_t end) {
+      MemoryScope job_memory_scope(MemoryTag::RESOURCE);
+      for (size_t index = begin; index < end; ++index) {
+        if (resources_.find(undependent_resources[index].first) ==
+            resources_.end()) {
+          ReadResource(*undependent_resources[index].second,
+                       &loaded_resources[index]);
+        }
+      }
+    };
+    if (job_system_) {
+      job_system_->ParallelFor(0, undependent_resources.size(), 1,
+                               read_resources);
+    } else {
+      read_resources(0, undependent_resources.size());
+    }
+    context_tasks_.RunAll();
+
+    for (size_t index = 0; index < undependent_resources.size(); ++index) {
+      const auto& resource_data = undependent_resources[index];
+      if (resources_.find(resource_data.first) != resources_.end()) {
+        LOG(ERROR) << "Resource has already been loaded: "
+                   << resource_data.first;
+      } else if (loaded_resources[index] == nullptr) {
         LOG(ERROR) << "Failed to load resource from metadata in: "
                    << resource_data.second->resource_path();
         return false;  // Can't load dependent resources.
+      } else {
+        resources_[resource_data.first] = std::move(loaded_resources[index]);
       }
+    }
+    for (const auto& resource_data : undependent_resources) {
       CHECK(resource_graph.Remove(resource_data.first))
           << "Expected to remove node that is known to exist.";
     }
@@ -143,4 +209,38 @@ Resource* ResourceManager::FindResource(const ResourceID& id) {
   return it->second.get();
 }
 
+void ResourceManager::ReadResource(const ResourceMetadata& metadata,
+                                   std::unique_ptr<Resource>* resource) {
+  switch (metadata.type()) {
+    case ResourceType::MATERIAL:
+      *resource = std::move(Material::Load(metadata, this));
+      break;
+    case ResourceType::MESH:
+      *resource = std::move(Mesh::Load(metadata, job_system_));
+      break;
+    case ResourceType::SHADER: {
+      auto shader = Shader::Read(metadata);
+      if (shader != nullptr) {
+        Shader* shader_ptr = shader.get();
+        *resource = std::move(shader);
+        context_tasks_.Post([shader_ptr, resource]() {
+          if (!shader_ptr->Create()) {
+            LOG(ERROR) << "Shader Create() failed.";
+            resource->reset();
+          }
+        });
+      }
+      break;
+    }
+    case ResourceType::SHADER_PROGRAM:
+      // Linking is all graphics work.
+      context_tasks_.Post([this, &metadata, resource]() {
+        *resource = std::move(ShaderProgram::Load(metadata, this));
+      });
+      break;
+    default:
+      break;
+  }
+}
+
 }  // namespace ogle
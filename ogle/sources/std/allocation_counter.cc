@@ -0,0 +1,148 @@
+/**
+ * @file allocation_counter.cc
+ * @brief Implements allocation_counter.h, and replaces global new and delete.
+ */
+
+#include "std/allocation_counter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "std/memory_tracker.h"
+
+// Tracking accounts memory from inside the replaced operators, so it needs
+// them too.
+#if defined(OGLE_COUNT_ALLOCATIONS) || defined(OGLE_TRACKING_ALLOCATOR)
+#define OGLE_REPLACE_GLOBAL_NEW
+#endif
+
+namespace ogle {
+
+#if defined(OGLE_REPLACE_GLOBAL_NEW)
+
+namespace {
+
+/// Allocations made so far.
+std::atomic<std::uint64_t> g_num_allocations(0);
+
+/// Deallocations made so far.
+std::atomic<std::uint64_t> g_num_deallocations(0);
+
+#if defined(OGLE_TRACKING_ALLOCATOR)
+/**
+ * @brief Precedes each allocation when tracking, to credit its memory back
+ *        to the subsystem that allocated it. Padded to keep allocations
+ *        aligned as malloc aligns them.
+ */
+struct alignas(alignof(std::max_align_t)) TrackingHeader {
+  /// Size requested, in bytes.
+  std::size_t size;
+
+  /// Subsystem the allocation is accounted to.
+  MemoryTag tag;
+};
+#endif
+
+/**
+ * @brief Allocates memory and counts the allocation.
+ *
+ * Exceptions are disabled, so running out of memory aborts.
+ *
+ * @param size Size in bytes.
+ * @return Allocated memory.
+ */
+void* CountedAllocate(std::size_t size) {
+#if defined(OGLE_TRACKING_ALLOCATOR)
+  void* memory = std::malloc(sizeof(TrackingHeader) + size);
+#else
+  void* memory = std::malloc(size == 0 ? 1 : size);
+#endif
+  if (memory == nullptr) {
+    std::abort();
+  }
+  g_num_allocations.fetch_add(1, std::memory_order_relaxed);
+#if defined(OGLE_TRACKING_ALLOCATOR)
+  TrackingHeader* header = static_cast<TrackingHeader*>(memory);
+  header->size = size;
+  header->tag = MemoryTracker::current_tag();
+  MemoryTracker::RecordAllocation(header->tag, size);
+  memory = header + 1;
+#endif
+  return memory;
+}
+
+/**
+ * @brief Frees memory and counts the deallocation.
+ * @param memory Memory to free, or nullptr.
+ */
+void CountedFree(void* memory) {
+  if (memory != nullptr) {
+    g_num_deallocations.fetch_add(1, std::memory_order_relaxed);
+#if defined(OGLE_TRACKING_ALLOCATOR)
+    TrackingHeader* header = static_cast<TrackingHeader*>(memory) - 1;
+    MemoryTracker::RecordDeallocation(header->tag, header->size);
+    memory = header;
+#endif
+    std::free(memory);
+  }
+}
+
+}  // namespace
+
+const bool AllocationCounter::enabled() {
+  return true;
+}
+
+std::uint64_t AllocationCounter::num_allocations() {
+  return g_num_allocations.load(std::memory_order_relaxed);
+}
+
+std::uint64_t AllocationCounter::num_deallocations() {
+  return g_num_deallocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+const bool AllocationCounter::enabled() {
+  return false;
+}
+
+std::uint64_t AllocationCounter::num_allocations() {
+  return 0;
+}
+
+std::uint64_t AllocationCounter::num_deallocations() {
+  return 0;
+}
+
+#endif
+
+}  // namespace ogle
+
+#if defined(OGLE_REPLACE_GLOBAL_NEW)
+
+void* operator new(std::size_t size) { return ogle::CountedAllocate(size); }
+
+void* operator new[](std::size_t size) { return ogle::CountedAllocate(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return ogle::CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return ogle::CountedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept { ogle::CountedFree(memory); }
+
+void operator delete[](void* memory) noexcept { ogle::CountedFree(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept {
+  ogle::CountedFree(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+  ogle::CountedFree(memory);
+}
+
+#endif
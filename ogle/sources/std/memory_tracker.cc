@@ -0,0 +1,325 @@
+/**
+ * @file memory_tracker.cc
+ * @brief Implements memory_tracker.h.
+ */
+
+#include "std/memory_tracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include "easylogging++.h"  // NOLINT
+
+namespace ogle {
+
+constexpr int MemoryTracker::kNumTags;
+
+namespace {
+
+/**
+ * @brief Running counts of one thread, for each tag.
+ *
+ * Only the owning thread writes them, with plain loads and stores; they are
+ * atomic so that queries from other threads may read them.
+ */
+struct ThreadCounters {
+  std::atomic<std::uint64_t> allocated_bytes[MemoryTracker::kNumTags];
+  std::atomic<std::uint64_t> freed_bytes[MemoryTracker::kNumTags];
+  std::atomic<std::uint64_t> num_allocations[MemoryTracker::kNumTags];
+  std::atomic<std::uint64_t> num_deallocations[MemoryTracker::kNumTags];
+
+  /// Whether a live thread owns these counters.
+  std::atomic<bool> in_use;
+
+  /// Next counters in g_thread_counters.
+  ThreadCounters* next;
+};
+
+/**
+ * @brief Sums of all threads' counts, for each tag.
+ */
+struct Totals {
+  std::uint64_t allocated_bytes[MemoryTracker::kNumTags];
+  std::uint64_t freed_bytes[MemoryTracker::kNumTags];
+  std::uint64_t num_allocations[MemoryTracker::kNumTags];
+  std::uint64_t num_deallocations[MemoryTracker::kNumTags];
+};
+
+/// Counters of every thread that has allocated. Counters are never freed;
+/// those of exited threads are reused by new threads, keeping their counts.
+std::atomic<ThreadCounters*> g_thread_counters(nullptr);
+
+/// Counters for allocations made while a thread exits, after its own
+/// counters are released. Shared, so updated with atomic adds.
+ThreadCounters g_exit_counters;
+
+/// Guards the frame and peak state below.
+std::mutex g_frame_mutex;
+
+/// Totals at the end of the last frame.
+Totals g_last_frame_totals;
+
+/// Totals allocated during the last frame.
+Totals g_frame_totals;
+
+/// Highest live bytes seen.
+std::int64_t g_peak_bytes[MemoryTracker::kNumTags];
+
+/// Counters of the calling thread, if acquired and not yet released.
+thread_local ThreadCounters* t_counters = nullptr;
+
+/// Set once the calling thread has released its counters.
+thread_local bool t_exited = false;
+
+/// Tag of the calling thread's innermost MemoryScope.
+thread_local MemoryTag t_tag = MemoryTag::UNTAGGED;
+
+/**
+ * @brief Releases the calling thread's counters when it exits.
+ */
+struct ThreadCountersOwner {
+  ~ThreadCountersOwner() {
+    if (counters != nullptr) {
+      counters->in_use.store(false, std::memory_order_release);
+    }
+    t_counters = nullptr;
+    t_exited = true;
+  }
+
+  /// Counters owned.
+  ThreadCounters* counters;
+};
+
+/// Owner of the calling thread's counters.
+thread_local ThreadCountersOwner t_owner;
+
+/**
+ * @brief Takes counters released by an exited thread, or creates new ones.
+ *
+ * Memory is taken from malloc, since this runs inside global new.
+ *
+ * @return Counters, owned by the calling thread.
+ */
+ThreadCounters* AcquireThreadCounters() {
+  for (ThreadCounters* counters =
+           g_thread_counters.load(std::memory_order_acquire);
+       counters != nullptr; counters = counters->next) {
+    bool in_use = false;
+    if (!counters->in_use.load(std::memory_order_relaxed) &&
+        counters->in_use.compare_exchange_strong(in_use, true,
+                                                 std::memory_order_acq_rel)) {
+      return counters;
+    }
+  }
+
+  void* memory = std::malloc(sizeof(ThreadCounters));
+  if (memory == nullptr) {
+    std::abort();
+  }
+  ThreadCounters* counters = new (memory) ThreadCounters();
+  counters->in_use.store(true, std::memory_order_relaxed);
+  counters->next = g_thread_counters.load(std::memory_order_relaxed);
+  while (!g_thread_counters.compare_exchange_weak(
+             counters->next, counters, std::memory_order_release,
+             std::memory_order_relaxed)) {
+  }
+  return counters;
+}
+
+/**
+ * @brief Gets the calling thread's counters, acquiring them if needed.
+ * @return Counters, or nullptr if the thread is exiting.
+ */
+ThreadCounters* CurrentThreadCounters() {
+  if (t_counters == nullptr && !t_exited) {
+    t_counters = AcquireThreadCounters();
+    t_owner.counters = t_counters;
+  }
+  return t_counters;
+}
+
+/**
+ * @brief Adds to a counter.
+ * @param counter Counter to add to.
+ * @param value Amount to add.
+ * @param owned Whether only the calling thread writes the counter.
+ */
+void Increase(std::atomic<std::uint64_t>* counter, const std::uint64_t value,
+              const bool owned) {
+  if (owned) {
+    counter->store(counter->load(std::memory_order_relaxed) + value,
+                   std::memory_order_relaxed);
+  } else {
+    counter->fetch_add(value, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Adds one thread's counters to totals.
+ * @param counters Counters to add.
+ * @param[in,out] totals Totals to add to.
+ */
+void AddCounters(const ThreadCounters& counters, Totals* totals) {
+  for (int index = 0; index < MemoryTracker::kNumTags; ++index) {
+    totals->allocated_bytes[index] +=
+        counters.allocated_bytes[index].load(std::memory_order_relaxed);
+    totals->freed_bytes[index] +=
+        counters.freed_bytes[index].load(std::memory_order_relaxed);
+    totals->num_allocations[index] +=
+        counters.num_allocations[index].load(std::memory_order_relaxed);
+    totals->num_deallocations[index] +=
+        counters.num_deallocations[index].load(std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Sums the counters of all threads, and raises peaks to match.
+ *
+ * Call with g_frame_mutex held.
+ *
+ * @return Totals.
+ */
+Totals SumCounters() {
+  Totals totals = {};
+  for (const ThreadCounters* counters =
+           g_thread_counters.load(std::memory_order_acquire);
+       counters != nullptr; counters = counters->next) {
+    AddCounters(*counters, &totals);
+  }
+  AddCounters(g_exit_counters, &totals);
+
+  for (int index = 0; index < MemoryTracker::kNumTags; ++index) {
+    const std::int64_t live_bytes =
+        static_cast<std::int64_t>(totals.allocated_bytes[index] -
+                                  totals.freed_bytes[index]);
+    g_peak_bytes[index] = std::max(g_peak_bytes[index], live_bytes);
+  }
+  return totals;
+}
+
+}  // namespace
+
+const bool MemoryTracker::enabled() {
+#if defined(OGLE_TRACKING_ALLOCATOR)
+  return true;
+#else
+  return false;
+#endif
+}
+
+MemoryTag MemoryTracker::current_tag() { return t_tag; }
+
+void MemoryTracker::RecordAllocation(const MemoryTag tag,
+                                     const std::size_t size) {
+  const int index = static_cast<int>(tag);
+  ThreadCounters* counters = CurrentThreadCounters();
+  const bool owned = counters != nullptr;
+  if (!owned) {
+    counters = &g_exit_counters;
+  }
+  Increase(&counters->allocated_bytes[index], size, owned);
+  Increase(&counters->num_allocations[index], 1, owned);
+}
+
+void MemoryTracker::RecordDeallocation(const MemoryTag tag,
+                                       const std::size_t size) {
+  const int index = static_cast<int>(tag);
+  ThreadCounters* counters = CurrentThreadCounters();
+  const bool owned = counters != nullptr;
+  if (!owned) {
+    counters = &g_exit_counters;
+  }
+  Increase(&counters->freed_bytes[index], size, owned);
+  Increase(&counters->num_deallocations[index], 1, owned);
+}
+
+void MemoryTracker::EndFrame() {
+  std::lock_guard<std::mutex> lock(g_frame_mutex);
+  const Totals totals = SumCounters();
+  for (int index = 0; index < kNumTags; ++index) {
+    g_frame_totals.allocated_bytes[index] =
+        totals.allocated_bytes[index] -
+        g_last_frame_totals.allocated_bytes[index];
+    g_frame_totals.num_allocations[index] =
+        totals.num_allocations[index] -
+        g_last_frame_totals.num_allocations[index];
+  }
+  g_last_frame_totals = totals;
+}
+
+MemoryTracker::Statistics MemoryTracker::statistics(const MemoryTag tag) {
+  const int index = static_cast<int>(tag);
+  std::lock_guard<std::mutex> lock(g_frame_mutex);
+  const Totals totals = SumCounters();
+  Statistics statistics;
+  statistics.live_bytes = static_cast<std::int64_t>(
+      totals.allocated_bytes[index] - totals.freed_bytes[index]);
+  statistics.peak_bytes = g_peak_bytes[index];
+  statistics.num_allocations = totals.num_allocations[index];
+  statistics.num_deallocations = totals.num_deallocations[index];
+  statistics.frame_allocations = g_frame_totals.num_allocations[index];
+  statistics.frame_bytes = g_frame_totals.allocated_bytes[index];
+  return statistics;
+}
+
+stl_string MemoryTracker::ToJSON() {
+  std::ostringstream json;
+  json << "{";
+  for (int index = 0; index < kNumTags; ++index) {
+    const MemoryTag tag = static_cast<MemoryTag>(index);
+    const Statistics tag_statistics = statistics(tag);
+    json << (index == 0 ? "\n" : ",\n")
+         << "  \"" << TagName(tag) << "\": {"
+         << "\"live_bytes\": " << tag_statistics.live_bytes
+         << ", \"peak_bytes\": " << tag_statistics.peak_bytes
+         << ", \"num_allocations\": " << tag_statistics.num_allocations
+         << ", \"num_deallocations\": " << tag_statistics.num_deallocations
+         << ", \"frame_allocations\": " << tag_statistics.frame_allocations
+         << ", \"frame_bytes\": " << tag_statistics.frame_bytes << "}";
+  }
+  json << "\n}\n";
+  return json.str();
+}
+
+const bool MemoryTracker::WriteJSON(const stl_string& file_path) {
+  std::ofstream file(file_path);
+  if (!file) {
+    LOG(ERROR) << "Failed to open memory statistics file: " << file_path;
+    return false;
+  }
+  file << ToJSON();
+  if (!file) {
+    LOG(ERROR) << "Failed to write memory statistics file: " << file_path;
+    return false;
+  }
+  return true;
+}
+
+const char* MemoryTracker::TagName(const MemoryTag tag) {
+  switch (tag) {
+    case MemoryTag::UNTAGGED:
+      return "untagged";
+    case MemoryTag::MESH:
+      return "mesh";
+    case MemoryTag::RESOURCE:
+      return "resource";
+    case MemoryTag::RENDERER:
+      return "renderer";
+    case MemoryTag::ENTITY:
+      return "entity";
+    case MemoryTag::CONFIG:
+      return "config";
+  }
+  return "unknown";
+}
+
+MemoryScope::MemoryScope(const MemoryTag tag) : previous_tag_(t_tag) {
+  t_tag = tag;
+}
+
+MemoryScope::~MemoryScope() { t_tag = previous_tag_; }
+
+}  // namespace ogle
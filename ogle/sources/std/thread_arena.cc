@@ -0,0 +1,265 @@
+/**
+ * @file thread_arena.cc
+ * @brief Implements thread_arena.h.
+ */
+
+#include "std/thread_arena.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace ogle {
+
+constexpr std::size_t ThreadArena::kMaxBlockSize;
+
+namespace {
+
+/// Size classes are multiples of this many bytes, which also aligns blocks.
+constexpr std::size_t kGranularity = 16;
+
+/// Number of size classes.
+constexpr std::size_t kNumSizeClasses = ThreadArena::kMaxBlockSize /
+                                        kGranularity;
+
+/// Bytes taken from the heap whenever an arena runs out. Chunks are aligned
+/// to their size, so a block's chunk is found by masking its address.
+constexpr std::size_t kChunkSize = 64 * 1024;
+
+/**
+ * @brief A freed block, linked into a free list.
+ */
+struct FreeBlock {
+  /// Next free block of the same size class.
+  FreeBlock* next;
+};
+
+struct Arena;
+
+/**
+ * @brief Start of each chunk, before its blocks.
+ */
+struct alignas(kGranularity) ChunkHeader {
+  /// Arena that the chunk's blocks are freed to.
+  Arena* owner;
+};
+
+/**
+ * @brief Arena owned by at most one thread at a time.
+ *
+ * Only the owning thread touches the free lists and current chunk. Other
+ * threads push the blocks they free onto the remote free lists, which the
+ * owner takes over when its own list of a class runs out.
+ */
+struct Arena {
+  /// Free blocks of each size class.
+  FreeBlock* free_lists[kNumSizeClasses];
+
+  /// Blocks of each size class freed by other threads.
+  std::atomic<FreeBlock*> remote_free_lists[kNumSizeClasses];
+
+  /// Unused part of the current chunk.
+  char* chunk_begin;
+  char* chunk_end;
+
+  /// Whether a live thread owns this arena.
+  std::atomic<bool> in_use;
+
+  /// Next arena in g_arenas.
+  Arena* next;
+};
+
+/// Arenas of every thread that has allocated. Arenas and their chunks are
+/// never freed; those of exited threads are reused by new threads, along
+/// with the blocks still free in them.
+std::atomic<Arena*> g_arenas(nullptr);
+
+/// Arena for allocations made while a thread exits, after its own arena is
+/// released. Shared, so used with g_exit_mutex held.
+Arena g_exit_arena;
+
+/// Guards allocation from g_exit_arena.
+std::mutex g_exit_mutex;
+
+/// Arena of calling thread, if acquired and not yet released.
+thread_local Arena* t_arena = nullptr;
+
+/// Set once the calling thread has released its arena.
+thread_local bool t_exited = false;
+
+/**
+ * @brief Releases the calling thread's arena when it exits.
+ */
+struct ArenaOwner {
+  ~ArenaOwner() {
+    if (arena != nullptr) {
+      arena->in_use.store(false, std::memory_order_release);
+    }
+    t_arena = nullptr;
+    t_exited = true;
+  }
+
+  /// Arena owned.
+  Arena* arena;
+};
+
+/// Owner of the calling thread's arena.
+thread_local ArenaOwner t_owner;
+
+/**
+ * @brief Finds the size class of a block.
+ * @param size Size in bytes, from 1 to ThreadArena::kMaxBlockSize.
+ * @return Index of size class.
+ */
+inline std::size_t SizeClass(const std::size_t size) {
+  return (size - 1) / kGranularity;
+}
+
+/**
+ * @brief Finds the chunk that a block was carved from.
+ * @param memory Block.
+ * @return Header of chunk.
+ */
+inline ChunkHeader* ChunkOf(void* memory) {
+  return reinterpret_cast<ChunkHeader*>(
+      reinterpret_cast<std::uintptr_t>(memory) &
+      ~static_cast<std::uintptr_t>(kChunkSize - 1));
+}
+
+/**
+ * @brief Allocates a chunk aligned to its size. Aborts if out of memory.
+ * @return Chunk.
+ */
+char* AllocateChunk() {
+  void* memory = nullptr;
+#if defined(_WIN32)
+  memory = _aligned_malloc(kChunkSize, kChunkSize);
+#else
+  if (posix_memalign(&memory, kChunkSize, kChunkSize) != 0) {
+    memory = nullptr;
+  }
+#endif
+  if (memory == nullptr) {
+    std::abort();
+  }
+  return static_cast<char*>(memory);
+}
+
+/**
+ * @brief Takes an arena released by an exited thread, or creates a new one.
+ *
+ * Memory is taken from malloc, since this may run inside STL allocation.
+ *
+ * @return Arena, owned by the calling thread.
+ */
+Arena* AcquireArena() {
+  for (Arena* arena = g_arenas.load(std::memory_order_acquire);
+       arena != nullptr; arena = arena->next) {
+    bool in_use = false;
+    if (!arena->in_use.load(std::memory_order_relaxed) &&
+        arena->in_use.compare_exchange_strong(in_use, true,
+                                              std::memory_order_acq_rel)) {
+      return arena;
+    }
+  }
+
+  void* memory = std::malloc(sizeof(Arena));
+  if (memory == nullptr) {
+    std::abort();
+  }
+  Arena* arena = new (memory) Arena();
+  arena->in_use.store(true, std::memory_order_relaxed);
+  arena->next = g_arenas.load(std::memory_order_relaxed);
+  while (!g_arenas.compare_exchange_weak(arena->next, arena,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+  }
+  return arena;
+}
+
+/**
+ * @brief Gets the calling thread's arena, acquiring it if needed.
+ * @return Arena, or nullptr if the thread is exiting.
+ */
+Arena* CurrentArena() {
+  if (t_arena == nullptr && !t_exited) {
+    t_arena = AcquireArena();
+    t_owner.arena = t_arena;
+  }
+  return t_arena;
+}
+
+/**
+ * @brief Allocates a block from an arena. Call only from its owner.
+ * @param arena Arena to allocate from.
+ * @param size_class Size class of block.
+ * @return Block.
+ */
+void* AllocateFrom(Arena* arena, const std::size_t size_class) {
+  FreeBlock* block = arena->free_lists[size_class];
+  if (block == nullptr) {
+    block = arena->remote_free_lists[size_class].exchange(
+        nullptr, std::memory_order_acquire);
+  }
+  if (block != nullptr) {
+    arena->free_lists[size_class] = block->next;
+    return block;
+  }
+
+  // The rest of a chunk too small for this block is abandoned.
+  const std::size_t block_size = (size_class + 1) * kGranularity;
+  if (static_cast<std::size_t>(arena->chunk_end - arena->chunk_begin) <
+      block_size) {
+    char* chunk = AllocateChunk();
+    new (chunk) ChunkHeader{arena};
+    arena->chunk_begin = chunk + sizeof(ChunkHeader);
+    arena->chunk_end = chunk + kChunkSize;
+  }
+  void* memory = arena->chunk_begin;
+  arena->chunk_begin += block_size;
+  return memory;
+}
+
+}  // namespace
+
+void* ThreadArena::Allocate(const std::size_t size) {
+  if (size == 0 || size > kMaxBlockSize) {
+    return ::operator new(size);
+  }
+  Arena* arena = CurrentArena();
+  if (arena == nullptr) {
+    std::lock_guard<std::mutex> lock(g_exit_mutex);
+    return AllocateFrom(&g_exit_arena, SizeClass(size));
+  }
+  return AllocateFrom(arena, SizeClass(size));
+}
+
+void ThreadArena::Deallocate(void* memory, const std::size_t size) {
+  if (memory == nullptr) {
+    return;
+  }
+  if (size == 0 || size > kMaxBlockSize) {
+    ::operator delete(memory);
+    return;
+  }
+  Arena* owner = ChunkOf(memory)->owner;
+  const std::size_t size_class = SizeClass(size);
+  FreeBlock* block = static_cast<FreeBlock*>(memory);
+  if (owner == t_arena) {
+    block->next = owner->free_lists[size_class];
+    owner->free_lists[size_class] = block;
+    return;
+  }
+  std::atomic<FreeBlock*>& remote_list = owner->remote_free_lists[size_class];
+  block->next = remote_list.load(std::memory_order_relaxed);
+  while (!remote_list.compare_exchange_weak(block->next, block,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace ogle
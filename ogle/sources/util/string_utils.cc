@@ -5,10 +5,48 @@
 
 #include "util/string_utils.h"
 #include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 
 namespace ogle {
 
+namespace {
+
+/// Powers of 10 that are exactly representable as doubles.
+constexpr double kExactPowersOf10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/// Largest exponent for which #kExactPowersOf10 can be used.
+constexpr int kMaxExactExponent = 22;
+
+/// Most decimal digits that are always exactly representable in a double.
+constexpr int kMaxExactDigits = 15;
+
+/// Most digits that can be accumulated in a 64-bit mantissa.
+constexpr int kMaxMantissaDigits = 19;
+
+/// Low bits of a double's mantissa that a float drops, and their value when
+/// the double lies exactly halfway between two floats.
+constexpr std::uint64_t kFloatDroppedBitsMask = (1ull << 29) - 1;
+constexpr std::uint64_t kFloatHalfwayBits = 1ull << 28;
+
+/// Longest token that is copied out for slow-path float parsing.
+constexpr int kMaxFloatTokenLength = 64;
+
+inline bool IsDigit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+inline bool IsSpace(const char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+}  // namespace
+
 const stl_string StringUtils::Replace(const stl_string& input,
                                       const char to_replace,
                                       const char replacement) {
@@ -60,4 +98,168 @@ const stl_string StringUtils::Upper(const stl_string& input) {
   return result;
 }
 
+void StringUtils::SkipSpaces(const char** cursor, const char* end) {
+  const char* position = *cursor;
+  while (position < end &&
+         (*position == ' ' || *position == '\t' || *position == '\r')) {
+    ++position;
+  }
+  *cursor = position;
+}
+
+const bool StringUtils::ParseFloat(const char** cursor, const char* end,
+                                   float* value) {
+  SkipSpaces(cursor, end);
+  const char* position = *cursor;
+
+  bool negative = false;
+  if (position < end && (*position == '-' || *position == '+')) {
+    negative = (*position == '-');
+    ++position;
+  }
+
+  // Accumulate significant digits into an integer mantissa, tracking the
+  // decimal exponent separately.
+  std::uint64_t mantissa = 0;
+  int num_significant_digits = 0;
+  int exponent = 0;
+  bool found_digits = false;
+  bool truncated = false;
+  while (position < end && IsDigit(*position)) {
+    found_digits = true;
+    const int digit = *position - '0';
+    if (num_significant_digits < kMaxMantissaDigits) {
+      if (mantissa != 0 || digit != 0) {
+        mantissa = mantissa * 10 + digit;
+        ++num_significant_digits;
+      }
+    } else {
+      truncated = true;
+      ++exponent;
+    }
+    ++position;
+  }
+  if (position < end && *position == '.') {
+    ++position;
+    while (position < end && IsDigit(*position)) {
+      found_digits = true;
+      const int digit = *position - '0';
+      if (num_significant_digits < kMaxMantissaDigits) {
+        if (mantissa != 0 || digit != 0) {
+          mantissa = mantissa * 10 + digit;
+          ++num_significant_digits;
+        }
+        --exponent;
+      } else {
+        truncated = true;
+      }
+      ++position;
+    }
+  }
+
+  if (found_digits && position < end &&
+      (*position == 'e' || *position == 'E')) {
+    // Only consume the exponent if digits follow it.
+    const char* exponent_position = position + 1;
+    bool negative_exponent = false;
+    if (exponent_position < end &&
+        (*exponent_position == '-' || *exponent_position == '+')) {
+      negative_exponent = (*exponent_position == '-');
+      ++exponent_position;
+    }
+    if (exponent_position < end && IsDigit(*exponent_position)) {
+      int explicit_exponent = 0;
+      while (exponent_position < end && IsDigit(*exponent_position)) {
+        if (explicit_exponent < 10000) {
+          explicit_exponent = explicit_exponent * 10 +
+                              (*exponent_position - '0');
+        }
+        ++exponent_position;
+      }
+      exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+      position = exponent_position;
+    }
+  }
+
+  if (found_digits && !truncated) {
+    if (mantissa == 0) {
+      *value = negative ? -0.f : 0.f;
+      *cursor = position;
+      return true;
+    }
+    if (num_significant_digits <= kMaxExactDigits &&
+        exponent >= -kMaxExactExponent && exponent <= kMaxExactExponent) {
+      // Both operands are exact, so the double result is correctly rounded.
+      double result = static_cast<double>(mantissa);
+      if (exponent < 0) {
+        result /= kExactPowersOf10[-exponent];
+      } else {
+        result *= kExactPowersOf10[exponent];
+      }
+
+      // Rounding that to float gives the correctly rounded float, unless the
+      // double landed exactly halfway between two floats. The exact value
+      // may then lie on either side, so strtof has to decide.
+      std::uint64_t bits;
+      std::memcpy(&bits, &result, sizeof(bits));
+      if ((bits & kFloatDroppedBitsMask) != kFloatHalfwayBits) {
+        *value = static_cast<float>(negative ? -result : result);
+        *cursor = position;
+        return true;
+      }
+    }
+  }
+
+  // Slow path for long mantissas, large exponents, and special values. The
+  // token is copied to a terminated stack buffer so strtof cannot run past
+  // the end of the text.
+  char token[kMaxFloatTokenLength];
+  int token_length = 0;
+  for (const char* token_position = *cursor;
+       token_position < end && !IsSpace(*token_position) &&
+       token_length < kMaxFloatTokenLength - 1;
+       ++token_position) {
+    token[token_length++] = *token_position;
+  }
+  token[token_length] = '\0';
+  char* token_end = nullptr;
+  const float result = std::strtof(token, &token_end);
+  if (token_end == token) {
+    return false;
+  }
+  *value = result;
+  *cursor += token_end - token;
+  return true;
+}
+
+const bool StringUtils::ParseInt(const char** cursor, const char* end,
+                                 int* value) {
+  SkipSpaces(cursor, end);
+  const char* position = *cursor;
+
+  bool negative = false;
+  if (position < end && (*position == '-' || *position == '+')) {
+    negative = (*position == '-');
+    ++position;
+  }
+  if (position >= end || !IsDigit(*position)) {
+    return false;
+  }
+
+  const std::int64_t limit =
+      negative ? -static_cast<std::int64_t>(INT_MIN) : INT_MAX;
+  std::int64_t magnitude = 0;
+  while (position < end && IsDigit(*position)) {
+    magnitude = magnitude * 10 + (*position - '0');
+    if (magnitude > limit) {
+      return false;
+    }
+    ++position;
+  }
+
+  *value = static_cast<int>(negative ? -magnitude : magnitude);
+  *cursor = position;
+  return true;
+}
+
 }  // namespace ogle
@@ -18,6 +18,9 @@ GLFWWindow::GLFWWindow()
 }
 
 GLFWWindow::~GLFWWindow() {
+  if (GLFWStateCache::current() == &gl_state_) {
+    GLFWStateCache::set_current(nullptr);
+  }
   if (window_ != nullptr) {
     glfwDestroyWindow(window_);
   }
@@ -56,6 +59,15 @@ bool GLFWWindow::Create(
     return false;
   }
 
+  // Fixed-function state is only changed through the state cache, so it
+  // only needs to be set once.
+  GLFWStateCache::set_current(&gl_state_);
+  gl_state_.SetEnabled(GL_DEPTH_TEST, true);
+  gl_state_.SetEnabled(GL_CULL_FACE, true);
+  gl_state_.DepthFunc(GL_LESS);
+  gl_state_.CullFace(GL_BACK);
+  gl_state_.FrontFace(GL_CCW);
+
   glfwSetInputMode(window_, GLFW_STICKY_KEYS, GL_TRUE);
 
   glfwSetFramebufferSizeCallback(window_, GLFWWindow::FramebufferSizeCallback);
@@ -69,17 +81,12 @@ void GLFWWindow::ClearWindow() {
 
 void GLFWWindow::SwapBuffers() {
   glfwSwapBuffers(window_);
+  gl_state_.EndFrame();
 }
 
 bool GLFWWindow::HandleWindowEvents() {
   glfwPollEvents();
 
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_CULL_FACE);
-  glDepthFunc(GL_LESS);
-  glCullFace(GL_BACK);
-  glFrontFace(GL_CCW);
-
   if (glfwWindowShouldClose(window_) == 0) {
     return true;
   } else {
@@ -5,7 +5,16 @@
 in vec3 vertex_position;
 out vec3 color;
 
-uniform mat4 model_matrix, view_matrix, projection_matrix;
+layout (std140) uniform FrameConstants {
+  mat4 view_matrix;
+  mat4 projection_matrix;
+  vec4 light_position;  // World frame.
+  vec4 light_ambient_color;
+  vec4 light_diffuse_color;
+  vec4 light_specular_color;
+};
+
+uniform mat4 model_matrix;
 uniform vec3 ambient_reflectance;
 
 void main () {
@@ -0,0 +1,26 @@
+// Vertex shader that performs basic transforms, taking the model-view and
+// normal matrices from per-instance attributes.
+
+#version 400
+
+layout (std140) uniform FrameConstants {
+  mat4 view_matrix;
+  mat4 projection_matrix;
+  vec4 light_position;  // World frame.
+  vec4 light_ambient_color;
+  vec4 light_diffuse_color;
+  vec4 light_specular_color;
+};
+
+in layout (location = 0) vec3 vertex_position;
+in layout (location = 1) vec3 vertex_normal;
+in layout (location = 3) mat4 instance_model_view_matrix;
+in layout (location = 7) mat3 instance_normal_matrix;
+
+out vec3 position_eye, normal_eye;
+
+void main () {
+  position_eye = vec3(instance_model_view_matrix * vec4(vertex_position, 1.0));
+  normal_eye = normalize(instance_normal_matrix * vertex_normal);
+  gl_Position = projection_matrix * vec4(position_eye, 1.0);
+}
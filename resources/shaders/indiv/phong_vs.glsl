@@ -2,7 +2,17 @@
 
 #version 400
 
-uniform mat4 model_matrix, view_matrix, projection_matrix;
+layout (std140) uniform FrameConstants {
+  mat4 view_matrix;
+  mat4 projection_matrix;
+  vec4 light_position;  // World frame.
+  vec4 light_ambient_color;
+  vec4 light_diffuse_color;
+  vec4 light_specular_color;
+};
+
+uniform mat4 model_view_matrix;
+uniform mat3 normal_matrix;
 
 in layout (location = 0) vec3 vertex_position;
 in layout (location = 1) vec3 vertex_normal;
@@ -10,7 +20,7 @@ in layout (location = 1) vec3 vertex_normal;
 out vec3 position_eye, normal_eye;
 
 void main () {
-  position_eye = vec3(view_matrix * model_matrix * vec4(vertex_position, 1.0));
-  normal_eye = normalize(vec3(transpose(inverse(view_matrix * model_matrix)) * vec4(vertex_normal, 1.0)));
+  position_eye = vec3(model_view_matrix * vec4(vertex_position, 1.0));
+  normal_eye = normalize(normal_matrix * vertex_normal);
   gl_Position = projection_matrix * vec4(position_eye, 1.0);
 }